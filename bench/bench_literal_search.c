@@ -0,0 +1,152 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "frameworks/hipaa.h"
+#include "matcher/literal_search.h"
+#include "matcher/pattern_matcher.h"
+
+// Literal search microbenchmark
+//
+// Runs every HIPAA check pattern against a synthetic configuration that
+// contains none of them (the worst case: each check has to read the whole
+// document) and compares the old strstr path, each vectorized kernel the CPU
+// supports and the single-pass Aho-Corasick matcher.
+
+#define DEFAULT_SIZE_MB 16
+#define ROUNDS 5
+
+static const char *const words[] = {
+    "encryption", "audit", "logging", "monitoring", "session", "ttl",
+    "backup", "tls", "ssl", "mfa", "user", "access", "kms", "key", "enabled",
+    "disabled", "false", "policy", "retention", "region", "bucket", "role"
+};
+
+// Deterministic config-like text: "word_word: word\n" lines
+static char* make_haystack(size_t size) {
+    char *buffer = malloc(size + 1);
+    if (!buffer) return NULL;
+
+    unsigned int seed = 12345;
+    size_t word_count = sizeof(words) / sizeof(words[0]);
+    size_t pos = 0;
+
+    while (pos < size) {
+        seed = seed * 1103515245u + 12345u;
+        const char *a = words[(seed >> 16) % word_count];
+        seed = seed * 1103515245u + 12345u;
+        const char *b = words[(seed >> 16) % word_count];
+        seed = seed * 1103515245u + 12345u;
+        const char *v = (seed >> 16) % 2 ? "disabled" : "false";
+
+        char line[96];
+        int n = snprintf(line, sizeof(line), "%s_%s: %s\n", a, b, v);
+        if (n <= 0) break;
+        size_t copy = pos + (size_t)n <= size ? (size_t)n : size - pos;
+        memcpy(buffer + pos, line, copy);
+        pos += copy;
+    }
+
+    buffer[size] = '\0';
+    return buffer;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Search every check pattern with strstr, as hipaa_checks.c used to
+static size_t run_strstr(const char *haystack, size_t length) {
+    (void)length;
+    size_t hits = 0;
+    for (int check = 0; check < HIPAA_CHECK_COUNT; check++) {
+        for (const char *const *p = hipaa_check_pattern_list(check); *p; p++) {
+            if (strstr(haystack, *p)) hits++;
+        }
+    }
+    return hits;
+}
+
+static literal_search_fn bench_kernel = NULL;
+
+// Search every check pattern with one literal search kernel
+static size_t run_kernel(const char *haystack, size_t length) {
+    size_t hits = 0;
+    for (int check = 0; check < HIPAA_CHECK_COUNT; check++) {
+        for (const char *const *p = hipaa_check_pattern_list(check); *p; p++) {
+            if (bench_kernel(haystack, length, *p, strlen(*p))) hits++;
+        }
+    }
+    return hits;
+}
+
+// One Aho-Corasick pass for all patterns
+static size_t run_matcher(const char *haystack, size_t length) {
+    uint32_t hit_mask = 0;
+    hipaa_match_checks(haystack, length, &hit_mask);
+    return (size_t)__builtin_popcount(hit_mask);
+}
+
+// Best-of-N timing, reported as document throughput
+static void report(const char *name, size_t (*fn)(const char *, size_t),
+                   const char *haystack, size_t length, size_t pattern_count) {
+    double best = 0.0;
+    size_t hits = 0;
+
+    for (int round = 0; round < ROUNDS; round++) {
+        double start = now_seconds();
+        hits = fn(haystack, length);
+        double elapsed = now_seconds() - start;
+        if (round == 0 || elapsed < best) best = elapsed;
+    }
+
+    double mb = (double)length / (1024.0 * 1024.0);
+    printf("  %-22s %10.2f ms %10.1f MB/s %10.2f GB/s (pattern-bytes)  hits=%zu\n",
+           name, best * 1000.0, mb / best,
+           (double)length * (double)pattern_count / best / 1e9, hits);
+}
+
+int main(int argc, char *argv[]) {
+    size_t size_mb = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : DEFAULT_SIZE_MB;
+    if (size_mb == 0) size_mb = DEFAULT_SIZE_MB;
+
+    size_t length = size_mb * 1024 * 1024;
+    char *haystack = make_haystack(length);
+    if (!haystack) {
+        fprintf(stderr, "Error: could not allocate %zu MB haystack\n", size_mb);
+        return 1;
+    }
+
+    size_t pattern_count = 0;
+    for (int check = 0; check < HIPAA_CHECK_COUNT; check++) {
+        for (const char *const *p = hipaa_check_pattern_list(check); *p; p++) {
+            pattern_count++;
+        }
+    }
+
+    printf("Literal search benchmark: %zu MB haystack, %zu patterns, best of %d\n",
+           size_mb, pattern_count, ROUNDS);
+    printf("Active kernel: %s\n\n",
+           literal_search_level_name(literal_search_active_level()));
+
+    report("strstr (baseline)", run_strstr, haystack, length, pattern_count);
+
+    for (int level = LITERAL_SEARCH_SCALAR; level < LITERAL_SEARCH_LEVEL_COUNT; level++) {
+        bench_kernel = literal_search_kernel((literal_search_level_t)level);
+        if (!bench_kernel) {
+            printf("  %-22s (not supported on this CPU)\n",
+                   literal_search_level_name((literal_search_level_t)level));
+            continue;
+        }
+        report(literal_search_level_name((literal_search_level_t)level),
+               run_kernel, haystack, length, pattern_count);
+    }
+
+    report("aho-corasick", run_matcher, haystack, length, pattern_count);
+
+    free(haystack);
+    return 0;
+}
@@ -0,0 +1,445 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "frameworks/hipaa.h"
+#include "parsers/file_parsers.h"
+#include "batch/batch_scan.h"
+#include "matcher/literal_search.h"
+
+// End-to-end pipeline benchmark
+//
+// Times each stage of a scan on the corpus written by gen_corpus:
+//   read      read_file_contents()
+//   parse     parse_file() - the format's parser, without indexing
+//   scan      hipaa_scan_config() on the parsed text
+//   pipeline  batch_run() as the scanner runs it: load, parse, index, match
+// Every stage is run best-of-N on each corpus file, and on the small/
+// directory as one input (where files/s is the figure that matters).
+//
+// Results are written to stdout as JSON with a fixed layout, so runs of
+// different releases can be compared field by field; progress goes to stderr.
+
+#define BENCH_SCHEMA_VERSION 1
+#define DEFAULT_ROUNDS 5
+#define ROUND_TIME_BUDGET 1.0    // Seconds; no more rounds once a stage used this
+#define MIN_ROUND_TIME 0.01      // Seconds
+#define MAX_ITERATIONS 65536
+
+typedef enum {
+    STAGE_READ = 0,
+    STAGE_PARSE,
+    STAGE_SCAN,
+    STAGE_PIPELINE,
+    STAGE_COUNT
+} bench_stage_t;
+
+static const char *const stage_names[STAGE_COUNT] = { "read", "parse", "scan", "pipeline" };
+
+// One benchmark input: a corpus file or the small-file directory
+typedef struct {
+    char *name;
+    char **paths;
+    size_t path_count;
+    uint64_t bytes;             // On disk
+    uint64_t content_bytes;     // After parsing
+    const char *format;         // "mixed" for a directory
+    parse_result_t **parsed;    // Parsed once for the scan stage
+    double seconds[STAGE_COUNT];
+    int rounds[STAGE_COUNT];
+    int iterations[STAGE_COUNT];    // Runs per round
+} bench_input_t;
+
+static int pipeline_threads = 1;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static const char* format_name(file_type_t type) {
+    switch (type) {
+        case FILE_TYPE_MD:   return "markdown";
+        case FILE_TYPE_JSON: return "json";
+        case FILE_TYPE_PDF:  return "pdf";
+        case FILE_TYPE_YAML: return "yaml";
+        case FILE_TYPE_TEXT: return "text";
+        default:             return "unknown";
+    }
+}
+
+// ==================== Stages ====================
+
+static int run_read(bench_input_t *input) {
+    for (size_t i = 0; i < input->path_count; i++) {
+        size_t length;
+        char *data = read_file_contents(input->paths[i], &length);
+        if (!data) return 0;
+        free(data);
+    }
+    return 1;
+}
+
+static int run_parse(bench_input_t *input) {
+    for (size_t i = 0; i < input->path_count; i++) {
+        parse_result_t *result = parse_file(input->paths[i], NULL);
+        int ok = result && result->success;
+        free_parse_result(result);
+        if (!ok) return 0;
+    }
+    return 1;
+}
+
+static int run_scan(bench_input_t *input) {
+    for (size_t i = 0; i < input->path_count; i++) {
+        scan_result_t *result = hipaa_scan_config(input->parsed[i]->content, NULL);
+        if (!result) return 0;
+        free_scan_result(result);
+    }
+    return 1;
+}
+
+static int run_pipeline(bench_input_t *input) {
+    batch_t *batch = batch_create();
+    if (!batch) return 0;
+
+    int ok = 1;
+    for (size_t i = 0; i < input->path_count && ok; i++) {
+        ok = batch_add_path(batch, input->paths[i]);
+    }
+    if (ok) {
+        batch_run(batch, pipeline_threads);
+        ok = batch->error_files == 0;
+    }
+    batch_free(batch);
+    return ok;
+}
+
+static int (*const stage_functions[STAGE_COUNT])(bench_input_t *) = {
+    run_read, run_parse, run_scan, run_pipeline
+};
+
+// Seconds per run of a stage, repeated iterations times; negative on failure
+static double time_round(bench_input_t *input, bench_stage_t stage, int iterations) {
+    double start = now_seconds();
+    for (int i = 0; i < iterations; i++) {
+        if (!stage_functions[stage](input)) return -1.0;
+    }
+    return (now_seconds() - start) / iterations;
+}
+
+// Best-of-N time of one stage; returns 0 if the stage failed
+// Small inputs are run several times per round - doubling until a round
+// lasts MIN_ROUND_TIME - so that the clock's resolution does not matter.
+// The last calibration round counts as the first measured one.
+static int time_stage(bench_input_t *input, bench_stage_t stage, int max_rounds) {
+    int iterations = 1;
+    double elapsed = time_round(input, stage, iterations);
+    while (elapsed >= 0.0 && elapsed * iterations < MIN_ROUND_TIME &&
+           iterations < MAX_ITERATIONS) {
+        iterations *= 2;
+        elapsed = time_round(input, stage, iterations);
+    }
+    if (elapsed < 0.0) return 0;
+
+    double best = elapsed;
+    double total = elapsed * iterations;
+    int round = 1;
+
+    while (round < max_rounds && total < ROUND_TIME_BUDGET) {
+        elapsed = time_round(input, stage, iterations);
+        if (elapsed < 0.0) return 0;
+
+        if (elapsed < best) best = elapsed;
+        total += elapsed * iterations;
+        round++;
+    }
+
+    input->seconds[stage] = best;
+    input->rounds[stage] = round;
+    input->iterations[stage] = iterations;
+    return 1;
+}
+
+// Parse every file once, keeping the text for the scan stage
+static int prepare_scan(bench_input_t *input) {
+    input->parsed = calloc(input->path_count, sizeof(parse_result_t *));
+    if (!input->parsed) return 0;
+
+    for (size_t i = 0; i < input->path_count; i++) {
+        input->parsed[i] = parse_file(input->paths[i], NULL);
+        if (!input->parsed[i] || !input->parsed[i]->success) return 0;
+        input->content_bytes += input->parsed[i]->content_length;
+    }
+    return 1;
+}
+
+static void release_scan(bench_input_t *input) {
+    if (!input->parsed) return;
+    for (size_t i = 0; i < input->path_count; i++) {
+        free_parse_result(input->parsed[i]);
+    }
+    free(input->parsed);
+    input->parsed = NULL;
+}
+
+// ==================== Corpus ====================
+
+typedef struct {
+    bench_input_t *items;
+    size_t count;
+    size_t capacity;
+} bench_corpus_t;
+
+static int add_path(bench_input_t *input, const char *path, uint64_t size) {
+    char **paths = realloc(input->paths, (input->path_count + 1) * sizeof(char *));
+    if (!paths) return 0;
+    input->paths = paths;
+    input->paths[input->path_count] = strdup(path);
+    if (!input->paths[input->path_count]) return 0;
+    input->path_count++;
+    input->bytes += size;
+    return 1;
+}
+
+static bench_input_t* add_input(bench_corpus_t *corpus, const char *name, const char *format) {
+    if (corpus->count == corpus->capacity) {
+        size_t capacity = corpus->capacity ? corpus->capacity * 2 : 32;
+        bench_input_t *items = realloc(corpus->items, capacity * sizeof(bench_input_t));
+        if (!items) return NULL;
+        corpus->items = items;
+        corpus->capacity = capacity;
+    }
+
+    bench_input_t *input = &corpus->items[corpus->count];
+    memset(input, 0, sizeof(*input));
+    input->name = strdup(name);
+    input->format = format;
+    if (!input->name) return NULL;
+    corpus->count++;
+    return input;
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Sorted names of the supported files in directory
+static char** list_directory(const char *directory, size_t *count) {
+    DIR *dir = opendir(directory);
+    if (!dir) return NULL;
+
+    char **names = NULL;
+    size_t capacity = 0;
+    *count = 0;
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!is_supported_file(entry->d_name)) continue;
+        if (*count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            char **grown = realloc(names, capacity * sizeof(char *));
+            if (!grown) break;
+            names = grown;
+        }
+        names[*count] = strdup(entry->d_name);
+        if (names[*count]) (*count)++;
+    }
+    closedir(dir);
+
+    if (names) qsort(names, *count, sizeof(char *), compare_names);
+    return names;
+}
+
+// Corpus files by kind, then by size; the small/ directory last
+static int compare_inputs(const void *a, const void *b) {
+    const bench_input_t *x = a;
+    const bench_input_t *y = b;
+
+    if ((x->path_count > 1) != (y->path_count > 1)) {
+        return x->path_count > 1 ? 1 : -1;
+    }
+
+    const char *x_dash = strrchr(x->name, '-');
+    const char *y_dash = strrchr(y->name, '-');
+    size_t x_kind = x_dash ? (size_t)(x_dash - x->name) : strlen(x->name);
+    size_t y_kind = y_dash ? (size_t)(y_dash - y->name) : strlen(y->name);
+    int kind = strncmp(x->name, y->name, x_kind < y_kind ? x_kind : y_kind);
+    if (kind != 0) return kind;
+    if (x_kind != y_kind) return x_kind < y_kind ? -1 : 1;
+
+    if (x->bytes != y->bytes) return x->bytes < y->bytes ? -1 : 1;
+    return strcmp(x->name, y->name);
+}
+
+static int load_corpus(const char *directory, bench_corpus_t *corpus) {
+    size_t count;
+    char **names = list_directory(directory, &count);
+    if (!names) return 0;
+
+    int ok = 1;
+    char path[8192];
+    for (size_t i = 0; i < count && ok; i++) {
+        snprintf(path, sizeof(path), "%s/%s", directory, names[i]);
+        struct stat st;
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+
+        bench_input_t *input = add_input(corpus, names[i], format_name(detect_file_type(path)));
+        ok = input && add_path(input, path, (uint64_t)st.st_size);
+    }
+
+    char small_directory[4096];
+    snprintf(small_directory, sizeof(small_directory), "%s/small", directory);
+    size_t small_count;
+    char **small_names = ok ? list_directory(small_directory, &small_count) : NULL;
+    if (small_names && small_count > 0) {
+        bench_input_t *input = add_input(corpus, "small/", "mixed");
+        ok = input != NULL;
+        for (size_t i = 0; i < small_count && ok; i++) {
+            snprintf(path, sizeof(path), "%s/%s", small_directory, small_names[i]);
+            struct stat st;
+            ok = stat(path, &st) == 0 && add_path(input, path, (uint64_t)st.st_size);
+        }
+    }
+    if (small_names) {
+        for (size_t i = 0; i < small_count; i++) free(small_names[i]);
+        free(small_names);
+    }
+
+    for (size_t i = 0; i < count; i++) free(names[i]);
+    free(names);
+
+    qsort(corpus->items, corpus->count, sizeof(bench_input_t), compare_inputs);
+    return ok && corpus->count > 0;
+}
+
+static void free_corpus(bench_corpus_t *corpus) {
+    for (size_t i = 0; i < corpus->count; i++) {
+        bench_input_t *input = &corpus->items[i];
+        release_scan(input);
+        for (size_t p = 0; p < input->path_count; p++) free(input->paths[p]);
+        free(input->paths);
+        free(input->name);
+    }
+    free(corpus->items);
+}
+
+// ==================== Report ====================
+
+static double mb_per_second(uint64_t bytes, double seconds) {
+    return seconds > 0.0 ? (double)bytes / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+static double files_per_second(size_t files, double seconds) {
+    return seconds > 0.0 ? (double)files / seconds : 0.0;
+}
+
+static void print_json(const bench_corpus_t *corpus, int max_rounds) {
+    printf("{\n");
+    printf("  \"schema\": %d,\n", BENCH_SCHEMA_VERSION);
+    printf("  \"benchmark\": \"pipeline\",\n");
+    printf("  \"literal_search\": \"%s\",\n",
+           literal_search_level_name(literal_search_active_level()));
+    printf("  \"threads\": %d,\n", pipeline_threads);
+    printf("  \"max_rounds\": %d,\n", max_rounds);
+    printf("  \"inputs\": [");
+
+    for (size_t i = 0; i < corpus->count; i++) {
+        const bench_input_t *input = &corpus->items[i];
+        printf("%s\n    {\n", i > 0 ? "," : "");
+        printf("      \"name\": \"%s\",\n", input->name);
+        printf("      \"format\": \"%s\",\n", input->format);
+        printf("      \"files\": %zu,\n", input->path_count);
+        printf("      \"bytes\": %llu,\n", (unsigned long long)input->bytes);
+        printf("      \"content_bytes\": %llu,\n", (unsigned long long)input->content_bytes);
+        printf("      \"stages\": {");
+        for (int stage = 0; stage < STAGE_COUNT; stage++) {
+            printf("%s\n        \"%s\": {\"seconds\": %.9f, \"mb_per_s\": %.1f, "
+                   "\"files_per_s\": %.1f, \"rounds\": %d, \"iterations\": %d}",
+                   stage > 0 ? "," : "", stage_names[stage], input->seconds[stage],
+                   mb_per_second(input->bytes, input->seconds[stage]),
+                   files_per_second(input->path_count, input->seconds[stage]),
+                   input->rounds[stage], input->iterations[stage]);
+        }
+        printf("\n      }\n    }");
+    }
+
+    printf("\n  ]\n}\n");
+}
+
+static void print_usage(const char *program_name) {
+    fprintf(stderr, "Usage: %s [-j THREADS] [--rounds N] <corpus-directory>\n\n", program_name);
+    fprintf(stderr, "Benchmarks read, parse, scan and the full pipeline on a corpus written\n");
+    fprintf(stderr, "by gen_corpus and prints the results as JSON. -j sets the pipeline's\n");
+    fprintf(stderr, "worker threads (default: online CPUs).\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *directory = NULL;
+    int max_rounds = DEFAULT_ROUNDS;
+    pipeline_threads = batch_default_thread_count();
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--threads") == 0) && i + 1 < argc) {
+            pipeline_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            max_rounds = atoi(argv[++i]);
+        } else if (argv[i][0] == '-' || directory) {
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            directory = argv[i];
+        }
+    }
+    if (!directory || pipeline_threads < 1 || max_rounds < 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    bench_corpus_t corpus = { NULL, 0, 0 };
+    if (!load_corpus(directory, &corpus)) {
+        fprintf(stderr, "Error: no benchmark corpus in %s (generate it with gen_corpus)\n",
+                directory);
+        free_corpus(&corpus);
+        return 1;
+    }
+
+    fprintf(stderr, "Pipeline benchmark: %zu inputs, %d threads, best of up to %d rounds\n\n",
+            corpus.count, pipeline_threads, max_rounds);
+    fprintf(stderr, "  %-22s %10s %10s %10s %10s %12s\n",
+            "input", "read", "parse", "scan", "pipeline", "files/s");
+
+    for (size_t i = 0; i < corpus.count; i++) {
+        bench_input_t *input = &corpus.items[i];
+
+        int ok = prepare_scan(input);
+        for (int stage = 0; stage < STAGE_COUNT && ok; stage++) {
+            ok = time_stage(input, (bench_stage_t)stage, max_rounds);
+        }
+        // The parsed text of a large input is not needed any more
+        release_scan(input);
+
+        if (!ok) {
+            fprintf(stderr, "Error: cannot scan %s\n", input->name);
+            free_corpus(&corpus);
+            return 1;
+        }
+
+        fprintf(stderr, "  %-22s %7.1f MB/s %7.1f MB/s %7.1f MB/s %7.1f MB/s %12.1f\n",
+                input->name,
+                mb_per_second(input->bytes, input->seconds[STAGE_READ]),
+                mb_per_second(input->bytes, input->seconds[STAGE_PARSE]),
+                mb_per_second(input->bytes, input->seconds[STAGE_SCAN]),
+                mb_per_second(input->bytes, input->seconds[STAGE_PIPELINE]),
+                files_per_second(input->path_count, input->seconds[STAGE_PIPELINE]));
+    }
+
+    print_json(&corpus, max_rounds);
+    free_corpus(&corpus);
+    return 0;
+}
@@ -0,0 +1,487 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+// Synthetic benchmark corpus generator
+//
+// Writes Markdown, JSON (flat and deeply nested), YAML and PDF (one
+// compressed content stream per page) inputs from 1 KB up to --max-size,
+// plus a directory of small mixed files for files/s measurements. Output is
+// deterministic - the same arguments produce byte-identical files, PDF
+// streams depending only on the zlib version - so benchmark runs of
+// different releases read the same bytes. The documents use configuration
+// vocabulary with disabled values, so no check passes early and every scan
+// reads its input to the end.
+//
+// Files that already exist are kept; delete the directory to regenerate.
+
+#define DEFAULT_MAX_SIZE ((uint64_t)16 * 1024 * 1024)
+#define SMALL_FILE_COUNT 1000
+#define SMALL_FILE_MIN 1024
+#define SMALL_FILE_SPREAD 3072
+#define DEEP_JSON_DEPTH 128
+#define PDF_LINES_PER_PAGE 48
+
+typedef struct {
+    const char *label;
+    uint64_t size;
+} corpus_size_t;
+
+static const corpus_size_t corpus_sizes[] = {
+    { "1K",   (uint64_t)1024 },
+    { "64K",  (uint64_t)64 * 1024 },
+    { "1M",   (uint64_t)1024 * 1024 },
+    { "16M",  (uint64_t)16 * 1024 * 1024 },
+    { "256M", (uint64_t)256 * 1024 * 1024 },
+    { "1G",   (uint64_t)1024 * 1024 * 1024 }
+};
+
+static const char *const keys[] = {
+    "encryption", "audit", "logging", "monitoring", "session", "ttl",
+    "backup", "tls", "ssl", "mfa", "user", "access", "kms", "key", "policy",
+    "retention", "region", "bucket", "role", "replica", "timeout", "quota"
+};
+
+static const char *const values[] = {
+    "disabled", "false", "none", "off", "pending", "legacy", "manual"
+};
+
+static const char *const prose[] = {
+    "the", "service", "stores", "records", "for", "each", "tenant", "and",
+    "reviews", "configuration", "changes", "before", "deployment", "to",
+    "production", "systems", "with", "staff", "who", "handle", "requests"
+};
+
+#define COUNT(array) (sizeof(array) / sizeof((array)[0]))
+
+// ==================== Output ====================
+
+// Output file with a deterministic random stream
+typedef struct {
+    FILE *file;
+    uint64_t written;
+    uint64_t state;
+    int failed;
+} corpus_writer_t;
+
+static uint32_t next_random(corpus_writer_t *w) {
+    // xorshift64*
+    w->state ^= w->state >> 12;
+    w->state ^= w->state << 25;
+    w->state ^= w->state >> 27;
+    return (uint32_t)((w->state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static const char* pick(corpus_writer_t *w, const char *const *list, size_t count) {
+    return list[next_random(w) % count];
+}
+
+static void write_bytes(corpus_writer_t *w, const void *data, size_t length) {
+    if (length > 0 && fwrite(data, 1, length, w->file) != length) {
+        w->failed = 1;
+    }
+    w->written += length;
+}
+
+static void write_text(corpus_writer_t *w, const char *text) {
+    write_bytes(w, text, strlen(text));
+}
+
+static void write_format(corpus_writer_t *w, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static void write_format(corpus_writer_t *w, const char *format, ...) {
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (n > 0) {
+        write_bytes(w, line, (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1);
+    }
+}
+
+// ==================== Generators ====================
+
+// Words are drawn into locals before formatting: argument evaluation order is
+// unspecified, and the corpus must not depend on the compiler
+
+// A "section_name: value" setting
+typedef struct {
+    const char *section;
+    const char *name;
+    const char *value;
+} corpus_setting_t;
+
+static corpus_setting_t next_setting(corpus_writer_t *w) {
+    corpus_setting_t setting;
+    setting.section = pick(w, keys, COUNT(keys));
+    setting.name = pick(w, keys, COUNT(keys));
+    setting.value = pick(w, values, COUNT(values));
+    return setting;
+}
+
+// Policy document: headings, prose, key/value lists and tables
+static void generate_md(corpus_writer_t *w, uint64_t target) {
+    write_text(w, "# Security Configuration Review\n\n");
+
+    for (unsigned section = 1; w->written < target; section++) {
+        const char *topic = pick(w, keys, COUNT(keys));
+        const char *word = pick(w, prose, COUNT(prose));
+        write_format(w, "## %u. %s %s\n\n", section, topic, word);
+
+        for (int sentence = 0; sentence < 4; sentence++) {
+            int words = 6 + (int)(next_random(w) % 10);
+            for (int i = 0; i < words; i++) {
+                write_format(w, i == 0 ? "%s" : " %s", pick(w, prose, COUNT(prose)));
+            }
+            write_text(w, ". ");
+        }
+        write_text(w, "\n\n");
+
+        for (int item = 0; item < 5; item++) {
+            corpus_setting_t setting = next_setting(w);
+            write_format(w, "- **%s_%s**: %s\n", setting.section, setting.name, setting.value);
+        }
+
+        write_text(w, "\n| Setting | Value | Owner |\n|---------|-------|-------|\n");
+        for (int row = 0; row < 3; row++) {
+            corpus_setting_t setting = next_setting(w);
+            unsigned team = next_random(w) % 100;
+            write_format(w, "| %s.%s | %s | team-%u |\n",
+                         setting.section, setting.name, setting.value, team);
+        }
+
+        corpus_setting_t setting = next_setting(w);
+        write_format(w, "\n```yaml\n%s:\n  %s: %s\n```\n\n",
+                     setting.section, setting.name, setting.value);
+    }
+}
+
+// One service object with a few nested settings
+static void write_json_service(corpus_writer_t *w, unsigned index) {
+    write_format(w, "    {\n      \"name\": \"svc-%u\",\n      \"replicas\": %u,\n"
+                 "      \"settings\": {\n", index, next_random(w) % 16);
+    for (int i = 0; i < 6; i++) {
+        corpus_setting_t setting = next_setting(w);
+        write_format(w, "        \"%s_%s\": \"%s\",\n",
+                     setting.section, setting.name, setting.value);
+    }
+
+    corpus_setting_t setting = next_setting(w);
+    unsigned limit = next_random(w) % 10000;
+    const char *first_tag = pick(w, prose, COUNT(prose));
+    const char *second_tag = pick(w, prose, COUNT(prose));
+    write_format(w, "        \"%s\": { \"%s\": %s, \"limit\": %u, \"tags\": [\"%s\", \"%s\"] }\n"
+                 "      }\n    }", setting.section, setting.name,
+                 strcmp(setting.value, "false") == 0 ? "false" : "null",
+                 limit, first_tag, second_tag);
+}
+
+// Typical configuration export: an array of service objects
+static void generate_json(corpus_writer_t *w, uint64_t target) {
+    write_text(w, "{\n  \"version\": 1,\n  \"services\": [\n");
+    for (unsigned index = 0; index == 0 || w->written < target; index++) {
+        if (index > 0) write_text(w, ",\n");
+        write_json_service(w, index);
+    }
+    write_text(w, "\n  ]\n}\n");
+}
+
+// Records nested DEEP_JSON_DEPTH objects deep, for the parser's path handling
+static void generate_json_deep(corpus_writer_t *w, uint64_t target) {
+    write_text(w, "{\"tenants\": [\n");
+    for (unsigned index = 0; index == 0 || w->written < target; index++) {
+        if (index > 0) write_text(w, ",\n");
+        for (int depth = 0; depth < DEEP_JSON_DEPTH; depth++) {
+            write_format(w, "{\"%s%d\": ", pick(w, keys, COUNT(keys)), depth);
+        }
+
+        corpus_setting_t setting = next_setting(w);
+        unsigned flag = next_random(w) % 100;
+        write_format(w, "{\"id\": %u, \"%s_%s\": \"%s\", \"flags\": [false, null, %u]}",
+                     index, setting.section, setting.name, setting.value, flag);
+        for (int depth = 0; depth < DEEP_JSON_DEPTH; depth++) {
+            write_text(w, "}");
+        }
+    }
+    write_text(w, "\n]}\n");
+}
+
+// Kubernetes-style YAML with nested mappings and lists
+static void generate_yaml(corpus_writer_t *w, uint64_t target) {
+    write_text(w, "apiVersion: v1\nservices:\n");
+    for (unsigned index = 0; index == 0 || w->written < target; index++) {
+        write_format(w, "  - name: svc-%u\n    replicas: %u\n    settings:\n",
+                     index, next_random(w) % 16);
+        for (int i = 0; i < 6; i++) {
+            corpus_setting_t setting = next_setting(w);
+            write_format(w, "      %s_%s: %s\n", setting.section, setting.name, setting.value);
+        }
+
+        const char *first_tag = pick(w, prose, COUNT(prose));
+        const char *second_tag = pick(w, prose, COUNT(prose));
+        write_format(w, "    tags:\n      - %s\n      - %s\n", first_tag, second_tag);
+    }
+}
+
+// Object offsets of the PDF being written
+typedef struct {
+    uint64_t *offsets;
+    size_t count;
+    size_t capacity;
+} pdf_xref_t;
+
+static int pdf_begin_object(corpus_writer_t *w, pdf_xref_t *xref, size_t number) {
+    if (number >= xref->capacity) {
+        size_t capacity = xref->capacity ? xref->capacity * 2 : 1024;
+        while (capacity <= number) capacity *= 2;
+        uint64_t *offsets = realloc(xref->offsets, capacity * sizeof(uint64_t));
+        if (!offsets) return 0;
+        memset(offsets + xref->capacity, 0, (capacity - xref->capacity) * sizeof(uint64_t));
+        xref->offsets = offsets;
+        xref->capacity = capacity;
+    }
+    xref->offsets[number] = w->written;
+    if (number >= xref->count) xref->count = number + 1;
+    write_format(w, "%zu 0 obj\n", number);
+    return 1;
+}
+
+// Text operators for one page: plain Tj lines and kerned TJ arrays
+static size_t pdf_page_content(corpus_writer_t *w, char *content, size_t size) {
+    size_t pos = (size_t)snprintf(content, size, "BT\n/F1 10 Tf\n72 760 Td\n13 TL\n");
+    for (int line = 0; line < PDF_LINES_PER_PAGE && pos < size; line++) {
+        int n;
+        if (next_random(w) % 3 == 0) {
+            corpus_setting_t setting = next_setting(w);
+            const char *word = pick(w, prose, COUNT(prose));
+            n = snprintf(content + pos, size - pos, "[(%s_) -20 (%s: %s) -250 (%s)] TJ T*\n",
+                         setting.section, setting.name, setting.value, word);
+        } else {
+            const char *first = pick(w, prose, COUNT(prose));
+            const char *second = pick(w, prose, COUNT(prose));
+            const char *third = pick(w, prose, COUNT(prose));
+            corpus_setting_t setting = next_setting(w);
+            n = snprintf(content + pos, size - pos, "(%s %s %s %s_%s: %s) Tj T*\n",
+                         first, second, third, setting.section, setting.name, setting.value);
+        }
+        if (n < 0) break;
+        pos += (size_t)n;
+    }
+    if (pos < size) {
+        pos += (size_t)snprintf(content + pos, size - pos, "ET\n");
+    }
+    return pos < size ? pos : size - 1;
+}
+
+// Multi-page PDF with one Flate-compressed content stream per page
+// Objects: 1 catalog, 2 page tree (written last), 3 font, then a content
+// stream and a page object for every page.
+static void generate_pdf(corpus_writer_t *w, uint64_t target) {
+    pdf_xref_t xref = { NULL, 0, 0 };
+    char content[8192];
+    unsigned char packed[8192 + 1024];
+
+    write_text(w, "%PDF-1.7\n%\xE2\xE3\xCF\xD3\n");
+    pdf_begin_object(w, &xref, 1);
+    write_text(w, "<< /Type /Catalog /Pages 2 0 R >>\nendobj\n");
+    pdf_begin_object(w, &xref, 3);
+    write_text(w, "<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>\nendobj\n");
+
+    size_t pages = 0;
+    while (pages == 0 || w->written < target) {
+        size_t content_number = 4 + pages * 2;
+        size_t length = pdf_page_content(w, content, sizeof(content));
+        uLongf packed_length = sizeof(packed);
+        if (compress2(packed, &packed_length, (const Bytef *)content, length,
+                      Z_DEFAULT_COMPRESSION) != Z_OK ||
+            !pdf_begin_object(w, &xref, content_number)) {
+            w->failed = 1;
+            break;
+        }
+        write_format(w, "<< /Length %lu /Filter /FlateDecode >>\nstream\n",
+                     (unsigned long)packed_length);
+        write_bytes(w, packed, packed_length);
+        write_text(w, "\nendstream\nendobj\n");
+
+        if (!pdf_begin_object(w, &xref, content_number + 1)) {
+            w->failed = 1;
+            break;
+        }
+        write_format(w, "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] "
+                     "/Resources << /Font << /F1 3 0 R >> >> /Contents %zu 0 R >>\nendobj\n",
+                     content_number);
+        pages++;
+    }
+
+    if (pdf_begin_object(w, &xref, 2)) {
+        write_format(w, "<< /Type /Pages /Count %zu /Kids [", pages);
+        for (size_t page = 0; page < pages; page++) {
+            write_format(w, page % 8 == 7 ? "%zu 0 R\n" : "%zu 0 R ", 5 + page * 2);
+        }
+        write_text(w, "] >>\nendobj\n");
+    }
+
+    uint64_t xref_offset = w->written;
+    write_format(w, "xref\n0 %zu\n0000000000 65535 f \n", xref.count);
+    for (size_t number = 1; number < xref.count; number++) {
+        write_format(w, "%010llu 00000 n \n", (unsigned long long)xref.offsets[number]);
+    }
+    write_format(w, "trailer\n<< /Size %zu /Root 1 0 R >>\nstartxref\n%llu\n%%%%EOF\n",
+                 xref.count, (unsigned long long)xref_offset);
+    free(xref.offsets);
+}
+
+// ==================== Corpus ====================
+
+typedef void (*generator_fn)(corpus_writer_t *w, uint64_t target);
+
+typedef struct {
+    const char *kind;
+    const char *extension;
+    generator_fn generate;
+} corpus_kind_t;
+
+static const corpus_kind_t corpus_kinds[] = {
+    { "md",        "md",   generate_md },
+    { "json",      "json", generate_json },
+    { "json-deep", "json", generate_json_deep },
+    { "yaml",      "yaml", generate_yaml },
+    { "pdf",       "pdf",  generate_pdf }
+};
+
+// Seed from the file name so every file has its own stream
+static uint64_t seed_for(const char *name) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (const char *p = name; *p; p++) {
+        hash = (hash ^ (unsigned char)*p) * 1099511628211ULL;
+    }
+    return hash ? hash : 1;
+}
+
+// Generate one file unless it exists; returns 0 on a write error
+static int generate_file(const char *directory, const char *name, const corpus_kind_t *kind,
+                         uint64_t target, int verbose) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", directory, name);
+
+    struct stat st;
+    if (stat(path, &st) == 0) {
+        return 1;
+    }
+
+    char temp_path[4200];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    corpus_writer_t w = { fopen(temp_path, "wb"), 0, seed_for(name), 0 };
+    if (!w.file) {
+        fprintf(stderr, "Error: cannot create %s: %s\n", temp_path, strerror(errno));
+        return 0;
+    }
+
+    kind->generate(&w, target);
+    if (fclose(w.file) != 0) w.failed = 1;
+    if (w.failed || rename(temp_path, path) != 0) {
+        fprintf(stderr, "Error: cannot write %s\n", path);
+        remove(temp_path);
+        return 0;
+    }
+
+    if (verbose) {
+        printf("  %-24s %12llu bytes\n", name, (unsigned long long)w.written);
+    }
+    return 1;
+}
+
+// Parse "64K", "16M", "1G" or a byte count
+static int parse_size(const char *text, uint64_t *size) {
+    char *end;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (errno || end == text) return 0;
+
+    switch (*end) {
+        case 'k': case 'K': value *= 1024ULL; end++; break;
+        case 'm': case 'M': value *= 1024ULL * 1024; end++; break;
+        case 'g': case 'G': value *= 1024ULL * 1024 * 1024; end++; break;
+        default: break;
+    }
+    if (*end != '\0' || value == 0) return 0;
+
+    *size = value;
+    return 1;
+}
+
+static void print_usage(const char *program_name) {
+    fprintf(stderr, "Usage: %s [--max-size SIZE] <directory>\n\n", program_name);
+    fprintf(stderr, "Writes the benchmark corpus: Markdown, JSON, deeply nested JSON, YAML\n");
+    fprintf(stderr, "and PDF files of 1K, 64K, 1M, 16M, 256M and 1G up to SIZE (default 16M),\n");
+    fprintf(stderr, "and %d small mixed files in <directory>/small.\n", SMALL_FILE_COUNT);
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t max_size = DEFAULT_MAX_SIZE;
+    const char *directory = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--max-size") == 0) {
+            if (i + 1 >= argc || !parse_size(argv[i + 1], &max_size)) {
+                fprintf(stderr, "Error: --max-size requires a size such as 64K, 16M or 1G\n");
+                return 1;
+            }
+            i++;
+        } else if (argv[i][0] == '-' || directory) {
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            directory = argv[i];
+        }
+    }
+    if (!directory) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    char small_directory[4096];
+    snprintf(small_directory, sizeof(small_directory), "%s/small", directory);
+    if ((mkdir(directory, 0755) != 0 && errno != EEXIST) ||
+        (mkdir(small_directory, 0755) != 0 && errno != EEXIST)) {
+        fprintf(stderr, "Error: cannot create %s: %s\n", small_directory, strerror(errno));
+        return 1;
+    }
+
+    printf("Generating benchmark corpus in %s\n", directory);
+
+    for (size_t s = 0; s < COUNT(corpus_sizes); s++) {
+        if (corpus_sizes[s].size > max_size) break;
+        for (size_t k = 0; k < COUNT(corpus_kinds); k++) {
+            char name[64];
+            snprintf(name, sizeof(name), "%s-%s.%s", corpus_kinds[k].kind,
+                     corpus_sizes[s].label, corpus_kinds[k].extension);
+            if (!generate_file(directory, name, &corpus_kinds[k], corpus_sizes[s].size, 1)) {
+                return 1;
+            }
+        }
+    }
+
+    // Many small files of every type, as in a repository of configurations
+    corpus_writer_t sizes = { NULL, 0, seed_for("small"), 0 };
+    for (int i = 0; i < SMALL_FILE_COUNT; i++) {
+        const corpus_kind_t *kind = &corpus_kinds[i % COUNT(corpus_kinds)];
+        uint64_t target = SMALL_FILE_MIN + next_random(&sizes) % SMALL_FILE_SPREAD;
+        char name[64];
+        snprintf(name, sizeof(name), "%04d-%s.%s", i, kind->kind, kind->extension);
+        if (!generate_file(small_directory, name, kind, target, 0)) {
+            return 1;
+        }
+    }
+    printf("  %-24s %12d files\n", "small/", SMALL_FILE_COUNT);
+
+    return 0;
+}
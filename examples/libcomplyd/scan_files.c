@@ -0,0 +1,98 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "complyd.h"
+
+// Minimal libcomplyd client: reads the files named on the command line into
+// memory and scans them with one complyd_scan_many() call.
+//
+//     scan_files [--framework hipaa,soc2] file...
+//
+// Exit code 0 if every file is compliant, 1 if any is not, 2 on errors.
+
+static char* read_file(const char *path, size_t *length) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return NULL;
+
+    char *data = NULL;
+    long size = -1;
+    if (fseek(fp, 0, SEEK_END) == 0 && (size = ftell(fp)) >= 0 && fseek(fp, 0, SEEK_SET) == 0) {
+        data = malloc((size_t)size + 1);
+    }
+    if (data && fread(data, 1, (size_t)size, fp) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(fp);
+
+    *length = data ? (size_t)size : 0;
+    return data;
+}
+
+int main(int argc, char *argv[]) {
+    complyd_options_t options = {0};
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "--framework") == 0) {
+        options.frameworks = argv[2];
+        first = 3;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "Usage: %s [--framework LIST] file...\n", argv[0]);
+        return 2;
+    }
+
+    complyd_context_t *context = complyd_context_create(&options);
+    if (!context || complyd_context_error(context)) {
+        fprintf(stderr, "Error: %s\n", context ? complyd_context_error(context) : "Out of memory");
+        complyd_context_free(context);
+        return 2;
+    }
+
+    size_t count = (size_t)(argc - first);
+    complyd_document_t *documents = calloc(count, sizeof(complyd_document_t));
+    complyd_result_t **results = calloc(count, sizeof(complyd_result_t*));
+    int exit_code = documents && results ? 0 : 2;
+
+    for (size_t i = 0; i < count && exit_code == 0; i++) {
+        documents[i].name = argv[first + i];
+        documents[i].format = COMPLYD_FORMAT_AUTO;
+        documents[i].data = read_file(documents[i].name, &documents[i].length);
+        if (!documents[i].data) {
+            fprintf(stderr, "Error: cannot read %s\n", documents[i].name);
+            exit_code = 2;
+        }
+    }
+
+    if (exit_code == 0 && !complyd_scan_many(context, documents, count, results)) {
+        fprintf(stderr, "Error: scan failed\n");
+        exit_code = 2;
+    }
+
+    for (size_t i = 0; i < count && exit_code != 2; i++) {
+        const complyd_result_t *result = results[i];
+        if (!result->ok) {
+            printf("ERROR %s: %s\n", documents[i].name, result->error_message);
+            exit_code = 2;
+            continue;
+        }
+
+        printf("%s %5.1f%% %zu/%zu %s\n", result->compliant ? "PASS" : "FAIL",
+               result->score, result->passed_count, result->check_count, documents[i].name);
+        for (size_t f = 0; f < result->framework_count; f++) {
+            const complyd_framework_verdict_t *framework = &result->frameworks[f];
+            printf("     %5.1f%% %zu/%zu %s\n", framework->score, framework->passed_count,
+                   framework->check_count, framework->name);
+        }
+        if (!result->compliant) exit_code = 1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (documents) free((void *)documents[i].data);
+        if (results) complyd_result_free(results[i]);
+    }
+    free(documents);
+    free(results);
+    complyd_context_free(context);
+    return exit_code;
+}
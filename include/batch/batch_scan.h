@@ -0,0 +1,105 @@
+#ifndef BATCH_SCAN_H
+#define BATCH_SCAN_H
+
+#include <stddef.h>
+#include "frameworks/hipaa.h"
+#include "parsers/file_parsers.h"
+#include "runtime/task_runtime.h"
+#include "cache/result_cache.h"
+
+// Parsed documents at least twice this size are matched in parallel chunks
+#define BATCH_CHUNK_SIZE (4 * 1024 * 1024)
+
+// Block size of the per-worker arenas - most parsed configurations fit in one
+#define BATCH_ARENA_BLOCK_SIZE (256 * 1024)
+
+// Text, YAML and PDF files at least this big are streamed through the
+// matcher instead of being loaded whole: text in SCAN_STREAM_CHUNK_SIZE
+// pieces, PDFs one content stream at a time
+#define BATCH_STREAM_MIN_SIZE ((size_t)256 * 1024 * 1024)
+
+// Archive members read but not yet scanned are held in memory; the reader
+// hands them out in two windows of half this size and waits for the older
+// window's scans before reusing it
+#define BATCH_ARCHIVE_READAHEAD ((size_t)64 * 1024 * 1024)
+
+typedef struct batch_file_result batch_file_result_t;
+
+// Called on the worker that scanned a file, as soon as its result is in
+typedef void (*batch_file_fn)(const batch_file_result_t *file, void *context);
+
+// Per-file outcome of a batch scan
+struct batch_file_result {
+    char *path;
+    file_type_t file_type;
+    size_t file_size;           // Size on disk, used to schedule big files first
+    int parsed;                 // 1 if the file was parsed and scanned
+    char *error_message;        // Set when parsing or scanning failed
+    size_t content_length;      // Bytes of parsed content
+    scan_result_t *scan_result; // Check results (NULL on error)
+    const rule_set_t *framework;         // Rule set used (set by batch_run)
+    arena_t *const *worker_arenas;       // Scratch arena per worker (set by batch_run)
+    result_cache_t *cache;               // Result cache (set by batch_run)
+    int cached;                          // 1 if the verdict came from the cache
+    batch_file_fn on_done;               // Completion callback (set by batch_run)
+    void *on_done_context;
+    int expanded;                        // Archive that was opened and read
+    batch_file_result_t **members;       // Its scanned members, which batch_run
+    size_t member_count;                 // moves into the batch in its place
+};
+
+// A batch of files scanned in one process
+typedef struct {
+    batch_file_result_t *files;
+    size_t file_count;
+    size_t file_capacity;
+
+    // Rule set to scan with, NULL for the built-in checks
+    const rule_set_t *framework;
+
+    // Verdicts of unchanged files are reused from here when set
+    result_cache_t *cache;
+
+    // Optional, called for every file as soon as it is scanned - from
+    // several worker threads at once
+    batch_file_fn on_file_done;
+    void *on_file_done_context;
+
+    // Aggregated totals, filled in by batch_run()
+    size_t passed_files;
+    size_t failed_files;
+    size_t error_files;
+    size_t cached_files;
+    double elapsed_seconds;
+
+    // Scheduler counters from the last batch_run(), one entry per worker
+    task_worker_stats_t *worker_stats;
+    int worker_count;
+} batch_t;
+
+// Batch functions
+// Archives (.tar, .tar.gz, .tgz, .zip) are read in place and reported as one
+// record per supported member, with paths of the form "archive!/member".
+batch_t* batch_create(void);
+int batch_add_path(batch_t *batch, const char *path);   // File or directory (recursive)
+void batch_run(batch_t *batch, int thread_count);
+void batch_free(batch_t *batch);
+
+// Incremental updates (watch mode): scanned records of a second batch are
+// moved in with batch_put_file(), then batch_tally() recounts the totals
+batch_file_result_t* batch_find_file(batch_t *batch, const char *path);
+int batch_put_file(batch_t *batch, batch_file_result_t *file);
+void batch_remove_file(batch_t *batch, size_t index);
+void batch_tally(batch_t *batch);
+
+// Helpers
+int batch_default_thread_count(void);
+
+// Streamed scans (see BATCH_STREAM_MIN_SIZE)
+// bytes_scanned gets the bytes matched - the extracted text for PDFs - and
+// pdf_stats, which may be NULL, what the PDF reader read and skipped.
+int batch_streams_file(file_type_t file_type, size_t file_size);
+scan_result_t* batch_stream_scan(const rule_set_t *rules, file_type_t file_type, FILE *input,
+                                 size_t *bytes_scanned, pdf_stream_stats_t *pdf_stats);
+
+#endif // BATCH_SCAN_H
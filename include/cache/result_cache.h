@@ -0,0 +1,75 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "frameworks/hipaa.h"
+#include "parsers/file_parsers.h"
+
+// Persistent result cache
+//
+// Scan verdicts are stored on disk keyed by what determines them: a hash of
+// the file's bytes, its length and type, and a hash of the active rule set
+// (control metadata and patterns). An unchanged file scanned with unchanged
+// rules is answered from the cache without being parsed or matched. Entries
+// of different rule sets share one cache directory.
+//
+// The cache lives in <directory>/results.idx and is loaded on open and
+// written back (atomically, via rename) on close. It never holds more than
+// max_entries verdicts: storing a new one into a full cache evicts the least
+// recently used entry, so long-running modes (watch, serve) stay bounded.
+// Lookups and stores are safe from several threads.
+
+#define RESULT_CACHE_DEFAULT_MAX_ENTRIES 100000
+
+// Identity of one scanned input
+typedef struct {
+    uint64_t content_hash;      // XXH64 of the file bytes
+    uint64_t length;
+    uint32_t file_type;         // Same bytes parse differently per type
+} result_cache_key_t;
+
+// Counters for the current process
+typedef struct {
+    uint64_t lookups;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t stores;
+    uint64_t evictions;         // Least recently used entries dropped to stay within max_entries
+    size_t entries;             // Entries currently held
+} result_cache_stats_t;
+
+typedef struct result_cache result_cache_t;
+
+// Open (or create) the cache in directory for a rule set (NULL = built-in
+// checks). Returns NULL only when out of memory; check the error message
+// with result_cache_error() before use.
+result_cache_t* result_cache_open(const char *directory, size_t max_entries,
+                                  const rule_set_t *framework);
+const char* result_cache_error(const result_cache_t *cache);
+
+// Write the cache back if it changed; returns 0 if it could not be saved.
+// The cache is freed either way.
+int result_cache_close(result_cache_t *cache);
+
+// Hash content into a key; result_cache_key_file() returns 0 if the file
+// cannot be read
+int result_cache_key_file(const char *path, file_type_t file_type, result_cache_key_t *key);
+void result_cache_key_buffer(const char *data, size_t length, file_type_t file_type,
+                             result_cache_key_t *key);
+
+// Heap-allocated result for key, NULL on a miss. content_length receives the
+// parsed length recorded with the result.
+scan_result_t* result_cache_lookup(result_cache_t *cache, const result_cache_key_t *key,
+                                   size_t *content_length);
+
+// Remember a verdict
+int result_cache_store(result_cache_t *cache, const result_cache_key_t *key,
+                       const scan_result_t *result, size_t content_length);
+
+void result_cache_get_stats(result_cache_t *cache, result_cache_stats_t *stats);
+
+// 64-bit XXH64 hash
+uint64_t result_cache_hash(const void *data, size_t length, uint64_t seed);
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,124 @@
+#ifndef COMPLYD_H
+#define COMPLYD_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// libcomplyd - the scanner as an in-process library
+//
+// A context holds the compiled rules of the selected frameworks and a pool
+// of scratch arenas. Scans only read the rules and take arenas from the pool
+// under a lock, so any number of threads may scan with the same context at
+// the same time.
+//
+//     complyd_context_t *context = complyd_context_create(NULL);
+//     complyd_result_t *result = complyd_scan_buffer(context, data, length,
+//                                                    COMPLYD_FORMAT_JSON);
+//     if (result && result->ok && !result->compliant) { ... }
+//     complyd_result_free(result);
+//     complyd_context_free(context);
+//
+// This header is the stable interface: it includes nothing of the scanner's
+// internals, and the structures below only ever grow at their end.
+
+#define COMPLYD_VERSION "1.0.0"
+
+typedef struct complyd_context complyd_context_t;
+
+// Document formats; AUTO goes by the document name's extension and falls
+// back to sniffing the content (JSON, PDF, otherwise text)
+typedef enum {
+    COMPLYD_FORMAT_AUTO = 0,
+    COMPLYD_FORMAT_TEXT,
+    COMPLYD_FORMAT_YAML,
+    COMPLYD_FORMAT_JSON,
+    COMPLYD_FORMAT_MARKDOWN,
+    COMPLYD_FORMAT_PDF
+} complyd_format_t;
+
+// Context options - a zeroed structure (or NULL) selects the defaults
+typedef struct {
+    const char *frameworks;          // Comma-separated keys ("hipaa,soc2"); NULL = "hipaa"
+                                     // unless rules files are given
+    const char *const *rules_files;  // YAML rules files, each one more framework
+    size_t rules_file_count;
+    int thread_count;                // Workers for complyd_scan_many(), 0 = one per CPU
+    size_t arena_block_size;         // Scratch arena block size, 0 = default
+} complyd_options_t;
+
+// One document to scan; data is only read during the call
+typedef struct {
+    const char *name;                // Optional, used by COMPLYD_FORMAT_AUTO
+    const void *data;
+    size_t length;
+    complyd_format_t format;
+} complyd_document_t;
+
+// Verdict of one control
+typedef struct {
+    const char *control_id;
+    const char *control_name;
+    const char *framework;           // Name of the framework the control belongs to
+    const char *severity;            // "CRITICAL", "HIGH", "MEDIUM", "LOW", "INFO"
+    const char *details;
+    const char *remediation;         // NULL when passed
+    int passed;
+} complyd_check_t;
+
+// Verdict of one framework
+typedef struct {
+    const char *name;
+    double score;                    // Percentage of passed checks
+    size_t passed_count;
+    size_t check_count;
+    int compliant;                   // 1 if score reaches the 80% threshold
+} complyd_framework_verdict_t;
+
+// Scan result - one allocation, released with complyd_result_free()
+// The strings point into the context and stay valid until it is freed.
+typedef struct {
+    int ok;                          // 1 if the document was parsed and scanned
+    const char *error_message;       // Why not, when ok is 0
+    int compliant;                   // 1 if every framework is compliant
+    double score;
+    size_t passed_count;
+    size_t check_count;
+    const complyd_check_t *checks;
+    const complyd_framework_verdict_t *frameworks;
+    size_t framework_count;
+} complyd_result_t;
+
+const char* complyd_version(void);
+
+// Context lifecycle
+// complyd_context_create() returns NULL only when out of memory; a context
+// that could not load its rules reports why through complyd_context_error()
+// and must only be freed.
+complyd_context_t* complyd_context_create(const complyd_options_t *options);
+const char* complyd_context_error(const complyd_context_t *context);
+void complyd_context_free(complyd_context_t *context);
+
+// Scan one document in the calling thread
+// NULL when out of memory or the context has an error; a document that
+// cannot be parsed gives a result with ok = 0.
+complyd_result_t* complyd_scan_buffer(complyd_context_t *context, const void *data,
+                                      size_t length, complyd_format_t format);
+complyd_result_t* complyd_scan_document(complyd_context_t *context,
+                                        const complyd_document_t *document);
+
+// Scan count documents in parallel on thread_count workers; results[i] is
+// the result of documents[i]. Returns 0 (with every results[i] NULL) when
+// out of memory or the context has an error.
+int complyd_scan_many(complyd_context_t *context, const complyd_document_t *documents,
+                      size_t count, complyd_result_t **results);
+
+void complyd_result_free(complyd_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COMPLYD_H
@@ -0,0 +1,174 @@
+#ifndef FRAMEWORK_H
+#define FRAMEWORK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "grc_scanner.h"
+#include "matcher/pattern_matcher.h"
+
+// Compliance frameworks
+//
+// A framework is a named list of controls, and a control passes when any of
+// its literal patterns occurs in the document. Any number of frameworks
+// (compiled-in ones and YAML rules files) are registered into one rule set,
+// whose patterns are compiled into a single automaton with pattern id =
+// control index across the whole set. Checking N frameworks therefore costs
+// one parse and one pass over the content, and the results are split per
+// framework afterwards.
+
+// Minimum compliance score (percent of checks passed) for a passing scan;
+// with several frameworks every one of them has to reach it
+#define COMPLIANCE_THRESHOLD 80.0
+
+// Read size used by streamed scans - the only buffer a streamed scan needs
+#define SCAN_STREAM_CHUNK_SIZE (4 * 1024 * 1024)
+
+// Everything a check result needs besides the verdict - static for the
+// compiled-in frameworks, owned by the rule set for registered controls
+typedef struct {
+    const char *id;
+    const char *name;
+    const char *severity;    // Severity when the check fails
+    const char *pass_details;
+    const char *fail_details;
+    const char *remediation;
+} control_info_t;
+
+// A compiled-in framework (src/frameworks/<name>/)
+typedef struct {
+    const char *key;                        // Command-line name ("soc2")
+    const char *name;                       // Display name
+    const control_info_t *controls;
+    const char *const *const *patterns;     // NULL-terminated list per control
+    size_t control_count;
+} framework_definition_t;
+
+extern const framework_definition_t hipaa_framework_definition;
+extern const framework_definition_t soc2_framework_definition;
+extern const framework_definition_t pci_dss_framework_definition;
+extern const framework_definition_t iso27001_framework_definition;
+
+// Compiled-in framework by key (case-insensitive), NULL if unknown
+const framework_definition_t* framework_find(const char *key);
+// Compiled-in frameworks in listing order, NULL past the last one
+const framework_definition_t* framework_at(size_t index);
+
+// Control of a rule set
+typedef struct {
+    char *id;
+    char *name;
+    char *description;
+    char *category;
+    const char *severity;    // Severity when the control fails ("CRITICAL" ... "LOW")
+    char *remediation;
+    char *pass_details;      // Result details (optional)
+    char *fail_details;
+    char **patterns;         // The control passes when any pattern occurs
+    size_t pattern_count;
+    control_info_t info;     // Result metadata, points at the fields above
+} rule_control_t;
+
+// One framework's share of a rule set
+typedef struct {
+    char *name;
+    size_t first_control;    // Controls [first_control, first_control + control_count)
+    size_t control_count;
+} rule_framework_t;
+
+// Rule set
+// Frameworks are added one after another, then compiled once. Control ids
+// are unique across the set, so a result is identified by its id alone.
+typedef struct {
+    rule_framework_t *frameworks;
+    size_t framework_count;
+    rule_control_t *controls;
+    size_t control_count;
+    size_t control_capacity;
+    pattern_matcher_t *matcher;
+    char *error_message;     // Set when a framework could not be added
+} rule_set_t;
+
+// Check result structure
+// Only the verdict and optional evidence belong to the result; the other
+// strings point into the control metadata, so results of a rule set must
+// not outlive it.
+typedef struct {
+    bool passed;
+    const char *control_id;
+    const char *control_name;
+    const char *severity;  // "CRITICAL", "HIGH", "MEDIUM", "LOW", "INFO"
+    const char *details;
+    const char *remediation;  // NULL when passed
+    char *evidence;           // Optional dynamic detail, from the scan result's arena if it has one
+} check_result_t;
+
+// Verdict of one framework: results [first_result, first_result + result_count)
+typedef struct {
+    const char *name;
+    size_t first_result;
+    size_t result_count;
+    size_t passed_count;
+} framework_result_t;
+
+// Scan result structure
+// The results and frameworks arrays share the scan result's allocation.
+// Results created in an arena are released with it; free_scan_result() does
+// nothing for them.
+typedef struct {
+    check_result_t *results;
+    size_t result_count;
+    size_t passed_count;
+    size_t failed_count;
+    framework_result_t *frameworks;  // Per-framework split, NULL for a single framework
+    size_t framework_count;
+    arena_t *arena;           // Owning arena, NULL when heap-allocated
+} scan_result_t;
+
+// Rule set construction
+// The add functions return 0 (with error_message set) on failure; a rule set
+// with an error must not be compiled or scanned with.
+rule_set_t* rule_set_create(void);
+int rule_set_add_definition(rule_set_t *rules, const framework_definition_t *definition);
+int rule_set_add_file(rule_set_t *rules, const char *yaml_file);
+int rule_set_compile(rule_set_t *rules);
+void rule_set_free(rule_set_t *rules);
+
+// Matching - hits is a bitset of MATCHER_BITSET_WORDS(rules->control_count)
+// words, bit N = control N
+int rule_set_match(const rule_set_t *rules, const char *config_data, size_t length,
+                   uint64_t *hits);
+int rule_set_match_index(const rule_set_t *rules, const config_t *config, uint64_t *hits);
+scan_result_t* rule_set_create_result(const rule_set_t *rules, const uint64_t *hits,
+                                      arena_t *arena);
+
+// Scan with a rule set, or the built-in HIPAA checks when rules is NULL
+scan_result_t* rule_set_scan(const rule_set_t *rules, const config_t *config,
+                             const char *config_data, size_t length, arena_t *arena);
+scan_result_t* rule_set_scan_stream(const rule_set_t *rules, FILE *input,
+                                    size_t *bytes_scanned);
+
+// Incremental scan with a rule set (or the HIPAA checks when rules is NULL)
+// The document is fed in pieces of any size; feed returns 1 once every
+// control has passed and the rest of the document need not be read.
+// Results are heap-allocated.
+typedef struct rule_set_stream rule_set_stream_t;
+rule_set_stream_t* rule_set_stream_create(const rule_set_t *rules);
+int rule_set_stream_feed(rule_set_stream_t *stream, const char *data, size_t length);
+size_t rule_set_stream_bytes(const rule_set_stream_t *stream);
+scan_result_t* rule_set_stream_result(const rule_set_stream_t *stream);
+void rule_set_stream_free(rule_set_stream_t *stream);
+
+// Result allocation and cleanup
+scan_result_t* scan_result_alloc(size_t result_count, size_t framework_count, arena_t *arena);
+void free_scan_result(scan_result_t *result);
+void check_result_init(check_result_t *result, const control_info_t *info, int passed);
+
+// Verdicts - percentage of passed checks, and whether every framework
+// reaches COMPLIANCE_THRESHOLD
+double scan_result_score(const scan_result_t *result);
+double framework_result_score(const framework_result_t *framework);
+int scan_result_compliant(const scan_result_t *result);
+
+#endif // FRAMEWORK_H
@@ -1,45 +1,57 @@
 #ifndef HIPAA_H
 #define HIPAA_H
 
-#include <stdbool.h>
-#include <stddef.h>
+#include "frameworks/framework.h"
 
-// HIPAA Control structure
-typedef struct {
-    char *id;
-    char *name;
-    char *description;
-    char *category;
-} hipaa_control_t;
+// The built-in HIPAA checks, used when no framework is selected. They have
+// their own fixed-size matcher and a 32-bit hit mask; as a rule set they are
+// hipaa_framework_definition.
 
-// HIPAA Framework structure
-typedef struct {
-    hipaa_control_t *controls;
-    size_t control_count;
-    size_t control_capacity;
-} hipaa_framework_t;
+// HIPAA check identifiers - bit positions in the hit mask returned by
+// hipaa_match_checks()
+typedef enum {
+    HIPAA_CHECK_ENCRYPTION_AT_REST = 0,
+    HIPAA_CHECK_AUDIT_CONTROLS,
+    HIPAA_CHECK_AUTHENTICATION,
+    HIPAA_CHECK_ENCRYPTION_IN_TRANSIT,
+    HIPAA_CHECK_UNIQUE_USER_ID,
+    HIPAA_CHECK_DATA_BACKUP,
+    HIPAA_CHECK_ACCESS_TERMINATION,
+    HIPAA_CHECK_AUTO_LOGOFF,
+    HIPAA_CHECK_COUNT
+} hipaa_check_id_t;
 
-// Check result structure
-typedef struct {
-    bool passed;
-    char *control_id;
-    char *control_name;
-    const char *severity;  // "CRITICAL", "HIGH", "MEDIUM", "LOW", "INFO"
-    char *details;
-    char *remediation;
-} check_result_t;
+// Hit mask with every check passed
+#define HIPAA_ALL_CHECKS_MASK ((1u << HIPAA_CHECK_COUNT) - 1)
 
-// Scan result structure
-typedef struct {
-    check_result_t **results;
-    size_t result_count;
-    size_t passed_count;
-    size_t failed_count;
-} scan_result_t;
+// Single-pass matching of every check pattern against a buffer
+// Sets bit N of *hit_mask when check N passed; returns 0 on failure
+int hipaa_match_checks(const char *config_data, size_t length, uint32_t *hit_mask);
 
-// Framework loader functions
-hipaa_framework_t* hipaa_load_framework(const char *yaml_file);
-void hipaa_free_framework(hipaa_framework_t *framework);
+// Resolve checks through a key/value index - one lookup per pattern instead
+// of a pass over the document. "key: value" patterns match the value after
+// trimming and unquoting (case-insensitive); "key:" and bare-word patterns
+// only need the key. Sets the bits of the checks found; returns 0 on failure.
+int hipaa_match_index(const config_t *config, uint32_t *hit_mask);
+int hipaa_index_has_pattern(const config_t *config, const char *pattern);
+
+// Streaming matcher - feed a document in chunks of any size. Matcher state
+// is carried across calls, so a pattern split between two chunks is still
+// found and no overlap has to be re-read.
+typedef struct hipaa_stream hipaa_stream_t;
+
+hipaa_stream_t* hipaa_stream_create(void);
+int hipaa_stream_feed(hipaa_stream_t *stream, const char *data, size_t length);  // 1 once every check passed
+uint32_t hipaa_stream_hit_mask(const hipaa_stream_t *stream);
+size_t hipaa_stream_bytes(const hipaa_stream_t *stream);
+void hipaa_stream_free(hipaa_stream_t *stream);
+
+// Literal patterns behind each check (NULL-terminated list)
+const char* const* hipaa_check_pattern_list(hipaa_check_id_t check);
+
+// Longest check pattern - buffers scanned in pieces must overlap by this
+// many bytes minus one so no match is lost at a boundary
+size_t hipaa_max_pattern_length(void);
 
 // Check functions - return 1 (true) if passed, 0 (false) if failed
 int hipaa_check_encryption_at_rest(const char *config_data);
@@ -51,21 +63,16 @@ int hipaa_check_data_backup(const char *config_data);
 int hipaa_check_access_termination(const char *config_data);
 int hipaa_check_auto_logoff(const char *config_data);
 
-// Result creator functions
-check_result_t* create_hipaa_encryption_result(int passed, const char *details);
-check_result_t* create_hipaa_audit_result(int passed, const char *details);
-check_result_t* create_hipaa_mfa_result(int passed, const char *details);
-check_result_t* create_hipaa_transit_encryption_result(int passed, const char *details);
-check_result_t* create_hipaa_user_id_result(int passed, const char *details);
-check_result_t* create_hipaa_backup_result(int passed, const char *details);
-check_result_t* create_hipaa_termination_result(int passed, const char *details);
-check_result_t* create_hipaa_logoff_result(int passed, const char *details);
-
-// Scanner function
-scan_result_t* hipaa_scan_config(const char *config_data);
+// Check metadata
+const control_info_t* hipaa_check_info(hipaa_check_id_t check);
 
-// Cleanup functions
-void free_check_result(check_result_t *result);
-void free_scan_result(scan_result_t *result);
+// Scanner functions
+// The result and any scratch memory come from arena when one is given
+// (NULL = heap). Streamed scans always return heap results.
+scan_result_t* hipaa_scan_config(const char *config_data, arena_t *arena);
+scan_result_t* hipaa_scan_indexed(const config_t *config, const char *config_data, size_t length,
+                                  arena_t *arena);
+scan_result_t* hipaa_create_scan_result(uint32_t hit_mask, arena_t *arena);
+scan_result_t* hipaa_scan_stream(FILE *input, size_t *bytes_scanned);
 
 #endif // HIPAA_H
\ No newline at end of file
@@ -3,18 +3,29 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "runtime/arena.h"
 
 // Configuration item structure
 typedef struct {
     char *key;
     char *value;
+    const char *name;       // Lookup name: last component of key ("a.b[2].c" -> "c")
+    size_t next;            // Index + 1 of the next item with the same name, 0 if none
 } config_item_t;
 
 // Configuration structure
+// Items are hashed by name (case-insensitive) into an open-addressing table,
+// so a lookup is one probe sequence regardless of the document size.
 typedef struct {
     config_item_t *items;
     size_t count;
     size_t capacity;
+
+    char *strings;          // Storage for every key and value
+    uint32_t *slots;        // Index + 1 of the first item per name, 0 = empty
+    size_t slot_count;      // Power of two
+    arena_t *arena;         // Owning arena, NULL when heap-allocated
 } config_t;
 
 // Scanner core functions
@@ -22,4 +33,15 @@ config_t* scanner_load_config(const char *filepath);
 void scanner_free_config(config_t *config);
 char* config_to_string(const config_t *config);
 
-#endif // GRC_SCANNER_H
\ No newline at end of file
+// Key/value index over parser output - one pass over "key: value" and
+// "key = value" lines; lines whose key contains spaces (prose) are skipped.
+// With an arena the whole index lives in it and scanner_free_config() is a
+// no-op.
+config_t* config_from_text(const char *text, size_t length, arena_t *arena);
+
+// First item whose name matches (case-insensitive), NULL if none. Further
+// items with the same name follow through config_next().
+const config_item_t* config_lookup(const config_t *config, const char *name);
+const config_item_t* config_next(const config_t *config, const config_item_t *item);
+
+#endif // GRC_SCANNER_H
@@ -0,0 +1,35 @@
+#ifndef LITERAL_SEARCH_H
+#define LITERAL_SEARCH_H
+
+#include <stddef.h>
+
+// Vectorized single-literal search
+//
+// Candidate positions are found by comparing two anchor bytes of the needle
+// (the first/last-byte filter, with the anchors moved to the needle's rarest
+// bytes) against a whole vector of haystack positions at once; only positions
+// where both match are confirmed with memcmp. The widest kernel supported by
+// the CPU is selected once at startup.
+
+typedef enum {
+    LITERAL_SEARCH_SCALAR = 0,
+    LITERAL_SEARCH_SSE2,
+    LITERAL_SEARCH_AVX2,
+    LITERAL_SEARCH_AVX512,
+    LITERAL_SEARCH_LEVEL_COUNT
+} literal_search_level_t;
+
+// Returns a pointer to the first occurrence of needle, or NULL if absent
+typedef const char* (*literal_search_fn)(const char *haystack, size_t haystack_len,
+                                         const char *needle, size_t needle_len);
+
+// Search using the best kernel for this CPU
+const char* literal_search(const char *haystack, size_t haystack_len,
+                           const char *needle, size_t needle_len);
+
+// Kernel selection
+literal_search_level_t literal_search_active_level(void);
+literal_search_fn literal_search_kernel(literal_search_level_t level);  // NULL if unsupported
+const char* literal_search_level_name(literal_search_level_t level);
+
+#endif // LITERAL_SEARCH_H
@@ -0,0 +1,45 @@
+#ifndef PATTERN_MATCHER_H
+#define PATTERN_MATCHER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Multi-pattern literal matcher (Aho-Corasick automaton)
+//
+// Patterns are added with a caller-chosen id, compiled once, and then any
+// number of documents can be scanned concurrently in a single pass. Every id
+// whose pattern occurs in the input gets its bit set in a caller-owned
+// bitset of MATCHER_BITSET_WORDS(matcher_id_count(m)) words.
+
+typedef struct pattern_matcher pattern_matcher_t;
+
+// Scan state carried between calls to matcher_feed()
+// Only valid with the matcher it was initialised for: row is an offset into
+// that matcher's transition table, not a portable node number.
+typedef struct {
+    uint32_t row;           // Transition table row of the current node
+    size_t remaining;       // Ids not yet seen (0 = every id matched)
+} matcher_state_t;
+
+#define MATCHER_BITSET_WORDS(ids) (((ids) + 63) / 64)
+#define MATCHER_BIT_IS_SET(hits, id) (((hits)[(id) / 64] >> ((id) % 64)) & 1u)
+
+// Build functions - add patterns, then compile before scanning
+pattern_matcher_t* matcher_create(void);
+int matcher_add_pattern(pattern_matcher_t *matcher, const char *pattern,
+                        size_t length, unsigned int id);
+int matcher_compile(pattern_matcher_t *matcher);
+void matcher_free(pattern_matcher_t *matcher);
+
+// Automaton properties
+size_t matcher_id_count(const pattern_matcher_t *matcher);
+size_t matcher_max_pattern_length(const pattern_matcher_t *matcher);
+
+// Scan functions - the compiled matcher is read-only and thread-safe
+void matcher_state_init(const pattern_matcher_t *matcher, matcher_state_t *state);
+int matcher_feed(const pattern_matcher_t *matcher, matcher_state_t *state,
+                 const char *data, size_t length, uint64_t *hits);
+void matcher_scan(const pattern_matcher_t *matcher, const char *data,
+                  size_t length, uint64_t *hits);
+
+#endif // PATTERN_MATCHER_H
@@ -0,0 +1,61 @@
+#ifndef ARCHIVE_READER_H
+#define ARCHIVE_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "parsers/file_parsers.h"
+
+// Archive reader
+//
+// Members of tar, tar.gz and zip archives are read one after another without
+// extracting anything to disk. Tarballs are decompressed on the fly while
+// the headers are walked front to back (zlib reads plain tar files as they
+// are); zip members are located through the central directory and stored or
+// deflated members are inflated straight into the member buffer. Members
+// that are not read are skipped - seeked over when the input allows it.
+// The reader itself holds no member data; each archive_read_member() call
+// returns a buffer the caller owns, so how many read members are kept in
+// memory at once is up to the caller.
+
+typedef enum {
+    ARCHIVE_NONE = 0,
+    ARCHIVE_TAR,             // .tar, .tar.gz, .tgz
+    ARCHIVE_ZIP              // .zip
+} archive_format_t;
+
+// Member paths are reported as "<archive>!/<member>"
+#define ARCHIVE_MEMBER_SEPARATOR "!/"
+
+// Members larger than this are reported instead of read
+#define ARCHIVE_MAX_MEMBER_SIZE ((uint64_t)1024 * 1024 * 1024)
+
+typedef struct archive_reader archive_reader_t;
+
+// Regular file in the archive
+typedef struct {
+    const char *name;        // Path inside the archive, valid until the next archive_next()
+    uint64_t size;           // Uncompressed size
+} archive_member_t;
+
+// Archive format by file name, ARCHIVE_NONE for other files
+archive_format_t archive_format_of(const char *filename);
+
+// Length of the archive part of a member path, 0 if path is not one
+size_t archive_member_prefix(const char *path);
+
+// Open an archive; NULL with *error set (a static message) on failure
+archive_reader_t* archive_open(const char *filename, archive_format_t format,
+                               const char **error);
+
+// Advance to the next regular file: 1 if there is one, 0 at the end of the
+// archive, -1 if it is damaged (see archive_error())
+int archive_next(archive_reader_t *reader, archive_member_t *member);
+const char* archive_error(const archive_reader_t *reader);
+
+// Read the current member into a NUL-terminated heap buffer; returns 0 with
+// *error set when this member cannot be read (the archive may still go on)
+int archive_read_member(archive_reader_t *reader, file_buffer_t *buffer, const char **error);
+
+void archive_close(archive_reader_t *reader);
+
+#endif // ARCHIVE_READER_H
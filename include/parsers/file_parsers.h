@@ -2,6 +2,10 @@
 #define FILE_PARSERS_H
 
 #include <stddef.h>
+#include <stdio.h>
+#include "grc_scanner.h"
+#include "parsers/pdf_document.h"
+#include "runtime/arena.h"
 
 // File types supported
 typedef enum {
@@ -13,23 +17,101 @@ typedef enum {
     FILE_TYPE_TEXT
 } file_type_t;
 
+// Who owns parse_result_t.content
+typedef enum {
+    PARSE_CONTENT_HEAP = 0,  // malloc'd buffer, released with free()
+    PARSE_CONTENT_MAPPED,    // Borrowed file mapping, released with munmap()
+    PARSE_CONTENT_ARENA      // Released when the result's arena is rewound
+} parse_content_owner_t;
+
 // Parser result structure
+// A result parsed into an arena lives entirely in it - the structure, error
+// message, content and index - and goes away when the arena is rewound;
+// free_parse_result() does nothing for it.
 typedef struct {
-    char *content;           // Parsed content as text
+    char *content;           // Parsed content as text (always NUL-terminated)
     size_t content_length;   // Length of content
     int success;             // 1 if parsing succeeded, 0 otherwise
     char *error_message;     // Error message if parsing failed
+    parse_content_owner_t content_owner;
+    size_t mapped_length;    // Mapping size when content_owner is MAPPED
+    config_t *config;        // Key/value index, set by parse_result_build_index()
+    arena_t *arena;          // Owning arena, NULL when heap-allocated
 } parse_result_t;
 
+// Raw file contents, either memory-mapped or read into the heap
+// A mapping is private but writable: parsers rewrite data in place, and the
+// NUL terminator is the zero-filled tail of its last page.
+typedef struct {
+    char *data;              // File bytes followed by a NUL terminator
+    size_t length;           // File size
+    size_t mapped_length;    // Non-zero if data is an mmap'd region
+    arena_t *arena;          // Set if data was read into an arena
+} file_buffer_t;
+
+// Bump when a parser change alters the text extracted from a document (and
+// so possibly its verdict); cached verdicts of older parsers are then dropped
+#define PARSER_VERSION 1
+
+// Error of a file that shrank while it was mapped (see parse_result_truncated())
+#define FILE_TRUNCATED_ERROR "File was truncated while it was scanned"
+
+// Files smaller than this are read() into the heap instead of mapped
+#define FILE_MAP_MIN_SIZE (64 * 1024)
+
 // Function declarations for file parsers
+// arena may be NULL, in which case the result is heap-allocated and released
+// with free_parse_result()
 file_type_t detect_file_type(const char *filename);
-parse_result_t* parse_file(const char *filename);
-parse_result_t* parse_md_file(const char *filename);
-parse_result_t* parse_json_file(const char *filename);
-parse_result_t* parse_pdf_file(const char *filename);
+int is_supported_file(const char *filename);
+parse_result_t* parse_file(const char *filename, arena_t *arena);
+parse_result_t* parse_md_file(const char *filename, arena_t *arena);
+parse_result_t* parse_json_file(const char *filename, arena_t *arena);
+parse_result_t* parse_pdf_file(const char *filename, arena_t *arena);
+
+// Content already in memory (e.g. received over a socket); the bytes are copied
+parse_result_t* parse_buffer(const char *data, size_t length, file_type_t type, arena_t *arena);
+
+// Per-format parsers for a loaded buffer; they take it over (*buffer is
+// cleared) and release it when it does not become the result content
+parse_result_t* parse_md_buffer(file_buffer_t *buffer, arena_t *arena);
+parse_result_t* parse_json_buffer(file_buffer_t *buffer, arena_t *arena);
+parse_result_t* parse_pdf_buffer(file_buffer_t *buffer, arena_t *arena);
+parse_result_t* parse_loaded_buffer(file_buffer_t *buffer, file_type_t type, arena_t *arena);
 void free_parse_result(parse_result_t *result);
 
+// Constant-memory PDF text extraction for files too large to load: the text
+// of each content stream goes to on_text in file order (see pdf_stream_file()).
+// on_text returns 0 to stop; returns 0 if the input could not be read.
+typedef int (*parse_text_fn)(const char *text, size_t length, void *context);
+int parse_pdf_stream(FILE *input, parse_text_fn on_text, void *context,
+                     pdf_stream_stats_t *stats);
+
+// Helpers shared by the parsers
+parse_result_t* parse_result_create(arena_t *arena);
+parse_result_t* parse_result_fail(parse_result_t *result, const char *message);
+int parse_result_take_buffer(parse_result_t *result, file_buffer_t *buffer);
+int parse_result_take_heap(parse_result_t *result, char *content, size_t length);
+
+// Index the key/value lines of the parsed content for config_lookup()
+// Worth doing for configuration formats (JSON, YAML, text); returns 0 on failure
+int parse_result_build_index(parse_result_t *result);
+int file_type_has_index(file_type_t type);
+
+// A file that shrinks while it is mapped does not crash the scan: the missing
+// pages read as zeros. Scanners check this after using mapped content and
+// fail the file; parsers that consume a mapping get it from
+// release_file_buffer().
+int parse_result_truncated(const parse_result_t *result);
+
 // Helper function to read entire file
 char* read_file_contents(const char *filename, size_t *length);
 
+// Zero-copy input: map large files, read small ones
+// Small files are read into arena when one is given. release_file_buffer()
+// returns 0 if the file was truncated while it was mapped.
+int load_file_buffer(const char *filename, file_buffer_t *buffer, arena_t *arena);
+int copy_file_buffer(const char *data, size_t length, file_buffer_t *buffer, arena_t *arena);
+int release_file_buffer(file_buffer_t *buffer);
+
 #endif // FILE_PARSERS_H
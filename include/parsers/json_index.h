@@ -0,0 +1,58 @@
+#ifndef JSON_INDEX_H
+#define JSON_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Structural index for JSON (stage 1)
+//
+// The document is classified 64 bytes at a time into bitmasks of quotes,
+// backslashes, brackets, separators and whitespace with vector compares.
+// Escaped quotes are removed with carry arithmetic on the backslash mask and
+// string interiors with a prefix XOR of the quote mask, leaving the positions
+// the flattener has to look at: unescaped quotes, brackets outside strings
+// and the first byte of each number/literal. The positions are produced a
+// window at a time, so memory use does not grow with the document.
+
+#define JSON_INDEX_WINDOW (16 * 1024)   // Bytes classified per refill (multiple of 64)
+
+typedef struct {
+    const char *data;
+    size_t length;
+    size_t indexed;         // Bytes classified so far
+
+    // Carries from the previous 64-byte block
+    uint64_t in_string;     // All ones if the block ended inside a string
+    uint64_t escaped;       // 1 if the next byte is escaped
+    uint64_t scalar;        // 1 if the block ended inside a number/literal
+
+    size_t *positions;      // Structural positions of the current window
+    size_t count;
+    size_t cursor;
+} json_index_t;
+
+// Index functions
+int json_index_init(json_index_t *index, const char *data, size_t length);
+int json_index_refill(json_index_t *index);    // 0 once the document is exhausted
+void json_index_free(json_index_t *index);
+
+// Kernel selected for this CPU ("scalar", "sse2", "avx2" or "avx512")
+const char* json_index_kernel_name(void);
+
+// Next structural position, or index->length at the end of the document
+static inline size_t json_index_next(json_index_t *index) {
+    if (index->cursor == index->count && !json_index_refill(index)) {
+        return index->length;
+    }
+    return index->positions[index->cursor++];
+}
+
+// Following structural position without consuming it
+static inline size_t json_index_peek(json_index_t *index) {
+    if (index->cursor == index->count && !json_index_refill(index)) {
+        return index->length;
+    }
+    return index->positions[index->cursor];
+}
+
+#endif // JSON_INDEX_H
@@ -0,0 +1,67 @@
+#ifndef PDF_DOCUMENT_H
+#define PDF_DOCUMENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// PDF object index
+//
+// Objects are located through the cross-reference data at the end of the
+// file: classic xref tables, xref streams and hybrid files, following /Prev
+// through incremental updates. Objects packed into object streams are
+// resolved by decoding the object stream once. When the xref data is missing
+// or damaged the index is rebuilt by scanning the file for "N G obj".
+//
+// Opening a document only walks the page tree; page content streams are
+// located up front but decoded (FlateDecode) lazily, one page at a time, so
+// images and fonts are never inflated. Page content decoding only reads the
+// document and is safe to run for several pages concurrently.
+
+// Upper bound for a single decoded stream, guards against deflate bombs
+#define PDF_MAX_STREAM_SIZE ((size_t)256 * 1024 * 1024)
+
+typedef struct pdf_document pdf_document_t;
+
+// Document functions - data must stay valid until pdf_document_close()
+pdf_document_t* pdf_document_open(const char *data, size_t length);
+void pdf_document_close(pdf_document_t *document);
+
+// Page access
+size_t pdf_document_page_count(const pdf_document_t *document);
+char* pdf_document_page_content(const pdf_document_t *document, size_t page,
+                                size_t *length);   // Decoded content, caller frees
+
+// 1 if the object index had to be rebuilt by scanning the file
+int pdf_document_was_rebuilt(const pdf_document_t *document);
+
+// Streaming object reader
+//
+// Documents too large to load are read front to back through a window of
+// PDF_STREAM_WINDOW_SIZE bytes instead of through the object index. Every
+// "N G obj << ... >> stream" object is classified by its dictionary alone:
+// streams that may show text (unfiltered or FlateDecode, not an image, font,
+// XRef, object stream or metadata) are inflated and handed to on_content in
+// file order; the rest are skipped - seeked over when /Length is direct and
+// the input is seekable. Memory use is the window plus the largest decoded
+// content stream, whatever the file size.
+
+#define PDF_STREAM_WINDOW_SIZE (1024 * 1024)
+
+// Called with each decoded content stream; return 0 to stop reading
+typedef int (*pdf_content_fn)(const char *content, size_t length, void *context);
+
+typedef struct {
+    uint64_t bytes_read;        // Bytes read from the input
+    uint64_t bytes_skipped;     // Bytes of skipped streams never read
+    size_t content_streams;     // Streams handed to on_content
+    size_t skipped_streams;     // Images, fonts and other non-content streams
+} pdf_stream_stats_t;
+
+// Returns 0 if the input could not be read; stats may be NULL
+int pdf_stream_file(FILE *input, pdf_content_fn on_content, void *context,
+                    pdf_stream_stats_t *stats);
+int pdf_stream_buffer(const char *data, size_t length, pdf_content_fn on_content,
+                      void *context, pdf_stream_stats_t *stats);
+
+#endif // PDF_DOCUMENT_H
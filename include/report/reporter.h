@@ -0,0 +1,112 @@
+#ifndef REPORTER_H
+#define REPORTER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "frameworks/hipaa.h"
+#include "batch/batch_scan.h"
+#include "cache/result_cache.h"
+#include "watch/watch.h"
+
+// Scan reporters
+//
+// Batch and watch results are rendered by a reporter chosen with --format:
+//   text    The colored terminal report
+//   ndjson  One JSON object per line - a record per file, then a summary
+//   sarif   A SARIF 2.1.0 log, one result per failed check
+// All output goes through one large buffer that is written out when it
+// fills up, at most every REPORT_FLUSH_INTERVAL while files keep finishing,
+// and at the end. In batch mode a file is reported as soon as its scan
+// finishes, from whichever worker ran it.
+
+// ANSI color codes for terminal output
+#define COLOR_RESET   "\033[0m"
+#define COLOR_RED     "\033[31m"
+#define COLOR_GREEN   "\033[32m"
+#define COLOR_YELLOW  "\033[33m"
+#define COLOR_BLUE    "\033[34m"
+#define COLOR_MAGENTA "\033[35m"
+#define COLOR_CYAN    "\033[36m"
+#define COLOR_BOLD    "\033[1m"
+
+#define REPORT_BUFFER_SIZE (256 * 1024)
+
+// Buffered records are written out at least this often (seconds)
+#define REPORT_FLUSH_INTERVAL 0.1
+
+typedef enum {
+    REPORT_FORMAT_TEXT = 0,
+    REPORT_FORMAT_NDJSON,
+    REPORT_FORMAT_SARIF
+} report_format_t;
+
+// Output buffer in front of a stdio stream
+// A writer without an output stream collects everything in memory (data is
+// grown as needed and never flushed).
+typedef struct {
+    FILE *output;
+    char *data;
+    size_t length;
+    size_t capacity;
+    double last_flush;
+} report_writer_t;
+
+void report_write(report_writer_t *writer, const char *data, size_t length);
+void report_puts(report_writer_t *writer, const char *text);
+void report_printf(report_writer_t *writer, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+void report_repeat(report_writer_t *writer, char c, size_t count);
+void report_json_string(report_writer_t *writer, const char *text);   // Quoted and escaped
+void report_flush(report_writer_t *writer);
+
+typedef struct reporter reporter_t;
+
+// One implementation per format; every entry point is optional
+typedef struct {
+    void (*begin)(reporter_t *reporter, size_t file_count, int thread_count);
+    void (*file)(reporter_t *reporter, const batch_file_result_t *file);
+    void (*update)(reporter_t *reporter, const batch_file_result_t *file,
+                   watch_change_t change, double elapsed_seconds);
+    void (*end)(reporter_t *reporter, const batch_t *batch, int thread_count,
+                result_cache_t *cache);
+    void (*destroy)(reporter_t *reporter);
+} reporter_ops_t;
+
+struct reporter {
+    report_format_t format;
+    const reporter_ops_t *ops;
+    report_writer_t writer;
+    pthread_mutex_t lock;                 // Files are reported from worker threads
+    const rule_set_t *framework;          // NULL for the built-in checks
+    size_t file_count;                    // Files reported so far
+    void *state;                          // Format-specific
+};
+
+// Lifecycle
+reporter_t* reporter_create(report_format_t format, FILE *output,
+                            const rule_set_t *framework);
+void reporter_free(reporter_t *reporter);       // Flushes what is left
+
+int report_format_from_name(const char *name, report_format_t *format);
+
+// Reporting
+void reporter_begin(reporter_t *reporter, size_t file_count, int thread_count);
+void reporter_file(reporter_t *reporter, const batch_file_result_t *file);
+void reporter_update(reporter_t *reporter, const batch_file_result_t *file,
+                     watch_change_t change, double elapsed_seconds);
+void reporter_end(reporter_t *reporter, const batch_t *batch, int thread_count,
+                  result_cache_t *cache);
+
+// batch_t.on_file_done adapter; context is the reporter
+void reporter_file_done(const batch_file_result_t *file, void *context);
+
+// Formats
+extern const reporter_ops_t text_reporter_ops;
+extern const reporter_ops_t ndjson_reporter_ops;
+extern const reporter_ops_t sarif_reporter_ops;
+
+// Display name for a file type ("Markdown", "JSON", ...)
+const char* report_file_type_name(file_type_t file_type);
+
+#endif // REPORTER_H
@@ -0,0 +1,68 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Per-scan bump allocator
+//
+// Everything a scan allocates (the parse result, small file buffers, the
+// key/value index, scan results, evidence strings) is carved out of large
+// blocks by bumping a pointer, and released all at once by rewinding the
+// arena to a mark. Resources that cannot live in a block (file mappings,
+// buffers grown with realloc) register a cleanup that runs on the rewind.
+//
+// Marks nest like a stack, so one arena per thread can be shared by scans
+// that run inside each other (a batch worker picking up another file while
+// it waits for its own subtasks). Rewound blocks are kept for the next scan.
+// An arena is not thread-safe; tasks running on other workers must not use
+// their spawner's arena.
+
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+typedef struct arena_block arena_block_t;
+typedef struct arena_cleanup arena_cleanup_t;
+
+typedef void (*arena_cleanup_fn)(void *data, size_t size);
+
+typedef struct {
+    arena_block_t *current;     // Block allocations are bumped from
+    arena_block_t *spare;       // Rewound standard-size blocks, reused first
+    arena_cleanup_t *cleanups;  // Newest first
+    size_t block_size;
+
+    size_t bytes_allocated;     // Live bytes handed out (including cleanup records)
+    size_t peak_bytes;          // High-water mark of bytes_allocated
+    size_t blocks_created;      // malloc calls made for blocks
+    size_t allocations;         // arena_alloc calls served
+} arena_t;
+
+// Position to rewind to
+typedef struct {
+    arena_block_t *block;
+    size_t used;
+    arena_cleanup_t *cleanups;
+    size_t bytes_allocated;
+} arena_mark_t;
+
+// Lifecycle
+arena_t* arena_create(size_t block_size);      // 0 = ARENA_DEFAULT_BLOCK_SIZE
+void arena_destroy(arena_t *arena);
+
+// Allocation - 16-byte aligned; NULL only when out of memory
+void* arena_alloc(arena_t *arena, size_t size);
+void* arena_calloc(arena_t *arena, size_t count, size_t size);
+char* arena_strdup(arena_t *arena, const char *text);
+
+// Grow the most recent allocation in place when it has room, otherwise copy
+// it into a new allocation (the old space is reclaimed on rewind)
+void* arena_realloc(arena_t *arena, void *data, size_t old_size, size_t new_size);
+
+// Run fn(data, size) when the arena is rewound past this point
+int arena_add_cleanup(arena_t *arena, arena_cleanup_fn fn, void *data, size_t size);
+
+// Rewinding
+arena_mark_t arena_mark(const arena_t *arena);
+void arena_rewind(arena_t *arena, arena_mark_t mark);
+void arena_reset(arena_t *arena);
+
+#endif // ARENA_H
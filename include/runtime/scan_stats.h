@@ -0,0 +1,65 @@
+#ifndef SCAN_STATS_H
+#define SCAN_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "frameworks/hipaa.h"
+#include "parsers/file_parsers.h"
+#include "runtime/arena.h"
+
+// Pipeline instrumentation
+//
+// Counts operations, bytes and monotonic-clock time for each stage of a scan,
+// split by file format, plus verdicts per check and arena allocation counts.
+// Nothing is recorded until scan_stats_enable() is called; after that the
+// recording functions are relaxed atomic adds, safe from any worker thread.
+// Stage times are summed over threads, so with several workers they can add
+// up to more than the elapsed time.
+//
+// Spans that contain file reads (parse_file() loads its input itself) leave
+// them out: time recorded for SCAN_STAGE_READ on the same thread while a span
+// is open is subtracted from it.
+
+typedef enum {
+    SCAN_STAGE_READ = 0,    // Loading file bytes (read or mmap)
+    SCAN_STAGE_CACHE,       // Result cache key hashing, lookup and store
+    SCAN_STAGE_PARSE,       // Format parsers (PDF extraction, JSON flattening, ...)
+    SCAN_STAGE_INDEX,       // Key/value index of configuration formats
+    SCAN_STAGE_SCAN,        // Matching the checks
+    SCAN_STAGE_REPORT,      // Formatting and writing results
+    SCAN_STAGE_COUNT
+} scan_stage_t;
+
+// Checks past this many are counted in the totals only
+#define SCAN_STATS_MAX_CHECKS 256
+
+// An open timing span
+typedef struct {
+    uint64_t start_ns;          // 0 when collection is off
+    uint64_t read_ns;           // The thread's read time when the span began
+} scan_span_t;
+
+// Collection switch (off by default)
+void scan_stats_enable(void);
+int scan_stats_enabled(void);
+
+// Time a stage: bytes is the input size the stage worked through
+scan_span_t scan_stats_begin(void);
+void scan_stats_end(scan_span_t span, scan_stage_t stage, file_type_t type, uint64_t bytes);
+
+// Verdicts of one scan, by check
+void scan_stats_count_checks(const scan_result_t *result);
+
+// Allocation counters of an arena about to be destroyed
+void scan_stats_add_arena(const arena_t *arena);
+
+// Summary table for humans; elapsed_seconds is the run's wall-clock time
+void scan_stats_print(FILE *output, double elapsed_seconds);
+
+// Prometheus text format, for the node exporter's textfile collector
+// The file is replaced atomically; returns 0 (errno set) if it cannot be written.
+int scan_stats_write_prometheus(const char *path, double elapsed_seconds);
+
+const char* scan_stage_name(scan_stage_t stage);
+
+#endif // SCAN_STATS_H
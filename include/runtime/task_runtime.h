@@ -0,0 +1,57 @@
+#ifndef TASK_RUNTIME_H
+#define TASK_RUNTIME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Work-stealing task runtime
+//
+// Each worker owns a deque: it pushes and pops its own tasks at the bottom
+// (LIFO, cache friendly) while idle workers steal the oldest task from the
+// top of a victim's deque. Tasks may spawn subtasks (file -> document chunks,
+// PDF pages) and wait for them with a task group; a waiting worker keeps
+// executing tasks instead of blocking, so nested parallelism never idles a
+// core. The thread that creates the runtime becomes worker 0.
+
+typedef void (*task_fn)(void *arg);
+
+typedef struct task_runtime task_runtime_t;
+
+// Completion counter for a set of spawned tasks
+typedef struct {
+    atomic_size_t pending;
+} task_group_t;
+
+// Per-worker counters
+typedef struct {
+    uint64_t tasks_executed;    // Tasks run by this worker (any nesting level)
+    uint64_t steals;            // Tasks taken from another worker's deque
+    uint64_t steal_attempts;    // Steal attempts, successful or not
+    double busy_seconds;        // Time running top-level tasks
+    double idle_seconds;        // Time spent looking for or waiting on work
+} task_worker_stats_t;
+
+// Runtime lifecycle
+task_runtime_t* task_runtime_create(int worker_count);
+void task_runtime_destroy(task_runtime_t *runtime);
+int task_runtime_worker_count(const task_runtime_t *runtime);
+
+// Task functions
+void task_group_init(task_group_t *group);
+int task_runtime_spawn(task_runtime_t *runtime, task_group_t *group, task_fn fn, void *arg);
+void task_group_wait(task_runtime_t *runtime, task_group_t *group);
+
+// Runtime the calling thread works for (NULL outside of any runtime), so
+// parsers and scanners can split their work without an explicit handle
+task_runtime_t* task_runtime_current(void);
+
+// Index of the calling worker in its runtime (0 .. worker_count - 1), -1 if
+// the thread is not a worker; lets callers keep per-worker scratch state
+int task_runtime_current_worker(void);
+
+// Statistics
+void task_runtime_worker_stats(const task_runtime_t *runtime, int worker,
+                               task_worker_stats_t *stats);
+
+#endif // TASK_RUNTIME_H
@@ -0,0 +1,62 @@
+#ifndef SCAN_SERVER_H
+#define SCAN_SERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <signal.h>
+#include "frameworks/hipaa.h"
+#include "cache/result_cache.h"
+
+// Scan daemon on a Unix domain socket
+//
+// The rule set is compiled once and kept for every request, so a client pays
+// for a connect, one parse and one matcher pass instead of a process start.
+// Each connection is served by its own thread with a reusable arena; any
+// number of requests may be sent on one connection.
+//
+// Requests are single lines; every request is answered with one line of
+// JSON:
+//
+//   SCAN <path>                 Scan a file (relative to the server's directory)
+//   DATA <type> <length>        Scan the <length> bytes that follow the line;
+//                               <type> is a file extension (json, md, yaml, ...)
+//   PING                        Liveness check
+//   QUIT                        Close the connection
+//
+//   {"ok":true,"pass":false,"score":87.5,"passed":7,"total":8,
+//    "failed":["164.312(b)"],"cached":false,"us":142}
+//   {"ok":false,"error":"Failed to read file"}
+//
+// With several frameworks a verdict also lists "frameworks":[{"name":"SOC 2",
+// "pass":true,"score":88.9},...] before "cached".
+
+#define SERVE_DEFAULT_MAX_CONNECTIONS 64
+
+// Largest DATA payload accepted
+#define SERVE_MAX_CONTENT_SIZE ((size_t)64 * 1024 * 1024)
+
+// Longest request line accepted
+#define SERVE_MAX_LINE_LENGTH 4096
+
+typedef struct {
+    const char *socket_path;
+    const rule_set_t *framework;          // NULL for the built-in checks
+    result_cache_t *cache;                // Optional
+    int max_connections;                  // 0 = SERVE_DEFAULT_MAX_CONNECTIONS
+    volatile sig_atomic_t *stop;          // Serving ends when this becomes nonzero
+} scan_server_options_t;
+
+// Totals over the server's lifetime
+typedef struct {
+    uint64_t connections;
+    uint64_t requests;
+    uint64_t errors;            // Requests answered with "ok":false
+    uint64_t rejected;          // Connections refused at max_connections
+} scan_server_stats_t;
+
+// Serve until *options->stop is set; open connections are closed and their
+// threads joined before returning. Returns 0 with errno set if the socket
+// could not be set up. A stale socket file left by a dead server is replaced.
+int scan_server_run(const scan_server_options_t *options, scan_server_stats_t *stats);
+
+#endif // SCAN_SERVER_H
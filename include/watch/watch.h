@@ -0,0 +1,50 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include <signal.h>
+#include "batch/batch_scan.h"
+
+// Watch mode
+//
+// Keeps the results of a scanned batch in memory and follows the files on
+// disk with inotify. Changed, created, moved and deleted files are collected
+// until the writes settle (debouncing editor saves and checkouts that touch
+// many files at once), then only those files are parsed and scanned again -
+// as a small batch of their own, so a burst of changes still uses every
+// worker. Files whose verdict changed are handed to the report callback.
+//
+// Directories are watched recursively, including ones created later. For a
+// single file its directory is watched, so saves that replace the file by
+// renaming a temporary copy over it are seen as well.
+
+#define WATCH_DEFAULT_DEBOUNCE_MS 50
+
+// Changes settle for at most this many debounce periods - a file that is
+// written continuously is still rescanned regularly
+#define WATCH_MAX_DEBOUNCE_PERIODS 10
+
+typedef enum {
+    WATCH_FILE_ADDED,
+    WATCH_FILE_CHANGED,         // Verdict differs from the previous scan
+    WATCH_FILE_REMOVED
+} watch_change_t;
+
+// Called with the file's new record (the old one for WATCH_FILE_REMOVED).
+// elapsed_seconds runs from the first change of the burst to the verdict.
+typedef void (*watch_report_fn)(const batch_file_result_t *file, watch_change_t change,
+                                double elapsed_seconds, void *context);
+
+typedef struct {
+    int debounce_ms;            // 0 = WATCH_DEFAULT_DEBOUNCE_MS
+    int thread_count;           // Workers for rescanning a burst of changes
+    watch_report_fn report;
+    void *context;
+    volatile sig_atomic_t *stop;  // Watching ends when this becomes nonzero
+} watch_options_t;
+
+// Follow paths (the ones batch was built from) until *options->stop is set.
+// batch must have been scanned with batch_run(); its records and totals are
+// kept up to date. Returns 0 with errno set if inotify could not be set up.
+int watch_run(batch_t *batch, char **paths, int path_count, const watch_options_t *options);
+
+#endif // WATCH_H
@@ -0,0 +1,787 @@
+#define _POSIX_C_SOURCE 200809L
+#include "batch/batch_scan.h"
+#include "parsers/archive_reader.h"
+#include "runtime/scan_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Create an empty batch
+batch_t* batch_create(void) {
+    batch_t *batch = calloc(1, sizeof(batch_t));
+    if (!batch) return NULL;
+
+    batch->file_capacity = 64;
+    batch->files = calloc(batch->file_capacity, sizeof(batch_file_result_t));
+    if (!batch->files) {
+        free(batch);
+        return NULL;
+    }
+
+    return batch;
+}
+
+// Append a single file to the batch
+static int batch_add_file(batch_t *batch, const char *path) {
+    if (batch->file_count >= batch->file_capacity) {
+        size_t new_capacity = batch->file_capacity * 2;
+        batch_file_result_t *grown = realloc(batch->files,
+                                             new_capacity * sizeof(batch_file_result_t));
+        if (!grown) return 0;
+        batch->files = grown;
+        batch->file_capacity = new_capacity;
+    }
+
+    batch_file_result_t *file = &batch->files[batch->file_count];
+    memset(file, 0, sizeof(*file));
+    file->path = strdup(path);
+    if (!file->path) return 0;
+    file->file_type = detect_file_type(path);
+
+    struct stat st;
+    if (stat(path, &st) == 0) {
+        file->file_size = (size_t)st.st_size;
+    }
+
+    batch->file_count++;
+    return 1;
+}
+
+static int compare_file_paths(const void *a, const void *b) {
+    const batch_file_result_t *fa = a;
+    const batch_file_result_t *fb = b;
+    return strcmp(fa->path, fb->path);
+}
+
+// Recursively collect supported files below a directory
+// Hidden entries (.git, editor swap files, ...) are skipped.
+static int batch_add_directory(batch_t *batch, const char *dir_path) {
+    DIR *dir = opendir(dir_path);
+    if (!dir) return 0;
+
+    int ok = 1;
+    struct dirent *entry;
+    while (ok && (entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+
+        size_t dir_len = strlen(dir_path);
+        const char *separator = dir_len > 0 && dir_path[dir_len - 1] == '/' ? "" : "/";
+        size_t path_len = dir_len + strlen(entry->d_name) + 2;
+        char *child = malloc(path_len);
+        if (!child) {
+            ok = 0;
+            break;
+        }
+        snprintf(child, path_len, "%s%s%s", dir_path, separator, entry->d_name);
+
+        struct stat st;
+        if (stat(child, &st) == 0) {
+            if (S_ISDIR(st.st_mode)) {
+                ok = batch_add_directory(batch, child);
+            } else if (S_ISREG(st.st_mode) && is_supported_file(child)) {
+                ok = batch_add_file(batch, child);
+            }
+        }
+        free(child);
+    }
+
+    closedir(dir);
+    return ok;
+}
+
+// Add a file or every supported file below a directory
+int batch_add_path(batch_t *batch, const char *path) {
+    if (!batch || !path) return 0;
+
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        // Keep it so the missing file is reported as an error
+        return batch_add_file(batch, path);
+    }
+
+    if (!S_ISDIR(st.st_mode)) {
+        return batch_add_file(batch, path);
+    }
+
+    // Directory listings come back in arbitrary order - sort for stable output
+    size_t first = batch->file_count;
+    int ok = batch_add_directory(batch, path);
+    qsort(batch->files + first, batch->file_count - first,
+          sizeof(batch_file_result_t), compare_file_paths);
+    return ok;
+}
+
+// Hits are kept as a bitset for both rule kinds: the built-in checks use the
+// low bits of word 0 (the hipaa_match_checks() mask), a loaded rule set one
+// bit per control.
+static size_t hit_words(const rule_set_t *framework) {
+    size_t words = framework ? MATCHER_BITSET_WORDS(framework->control_count) : 1;
+    return words ? words : 1;
+}
+
+static int match_content(const rule_set_t *framework, const char *data, size_t length,
+                         uint64_t *hits) {
+    if (framework) {
+        return rule_set_match(framework, data, length, hits);
+    }
+
+    uint32_t hit_mask = 0;
+    if (!hipaa_match_checks(data, length, &hit_mask)) return 0;
+    hits[0] |= hit_mask;
+    return 1;
+}
+
+// Resolve what the key/value index can, returns 1 if nothing is left open
+static int match_index(const rule_set_t *framework, const config_t *config,
+                       uint64_t *hits) {
+    if (!framework) {
+        uint32_t hit_mask = (uint32_t)hits[0];
+        hipaa_match_index(config, &hit_mask);
+        hits[0] = hit_mask;
+        return hit_mask == HIPAA_ALL_CHECKS_MASK;
+    }
+
+    rule_set_match_index(framework, config, hits);
+    for (size_t i = 0; i < framework->control_count; i++) {
+        if (!MATCHER_BIT_IS_SET(hits, i)) return 0;
+    }
+    return 1;
+}
+
+// Batch results outlive the per-file arena, so they stay on the heap
+static scan_result_t* create_result(const rule_set_t *framework, const uint64_t *hits) {
+    return framework ? rule_set_create_result(framework, hits, NULL)
+                     : hipaa_create_scan_result((uint32_t)hits[0], NULL);
+}
+
+// Scratch memory from the worker's arena, or the heap without one
+static void* scratch_calloc(arena_t *arena, size_t count, size_t size) {
+    return arena ? arena_calloc(arena, count, size) : calloc(count, size);
+}
+
+static void scratch_free(arena_t *arena, void *data) {
+    if (!arena) free(data);
+}
+
+typedef struct {
+    const rule_set_t *framework;
+    const char *data;
+    size_t length;
+    uint64_t *hits;
+    int ok;
+} scan_chunk_t;
+
+static void scan_chunk_task(void *arg) {
+    scan_chunk_t *chunk = arg;
+    chunk->ok = match_content(chunk->framework, chunk->data, chunk->length, chunk->hits);
+}
+
+// Match parsed content; checks the key/value index (if any) resolves skip the
+// text pass. Large documents are split into chunks that overlap by the
+// longest pattern so idle workers can steal part of the matching.
+static scan_result_t* batch_scan_content(const rule_set_t *framework, const config_t *config,
+                                         const char *content, size_t length, arena_t *arena) {
+    task_runtime_t *runtime = task_runtime_current();
+    size_t words = hit_words(framework);
+
+    uint64_t *hits = scratch_calloc(arena, words, sizeof(uint64_t));
+    if (!hits) return NULL;
+
+    scan_result_t *result = NULL;
+    if (config && match_index(framework, config, hits)) {
+        result = create_result(framework, hits);
+        scratch_free(arena, hits);
+        return result;
+    }
+
+    size_t chunk_count = (length + BATCH_CHUNK_SIZE - 1) / BATCH_CHUNK_SIZE;
+    scan_chunk_t *chunks = NULL;
+    uint64_t *chunk_hits = NULL;
+
+    if (runtime && task_runtime_worker_count(runtime) >= 2 && length >= 2 * BATCH_CHUNK_SIZE) {
+        chunks = scratch_calloc(arena, chunk_count, sizeof(scan_chunk_t));
+        chunk_hits = scratch_calloc(arena, chunk_count * words, sizeof(uint64_t));
+    }
+
+    if (!chunks || !chunk_hits) {
+        if (match_content(framework, content, length, hits)) {
+            result = create_result(framework, hits);
+        }
+        scratch_free(arena, chunks);
+        scratch_free(arena, chunk_hits);
+        scratch_free(arena, hits);
+        return result;
+    }
+
+    size_t overlap = framework ? matcher_max_pattern_length(framework->matcher)
+                               : hipaa_max_pattern_length();
+    overlap = overlap > 0 ? overlap - 1 : 0;
+
+    task_group_t group;
+    task_group_init(&group);
+
+    for (size_t i = 0; i < chunk_count; i++) {
+        size_t start = i * BATCH_CHUNK_SIZE;
+        size_t end = start + BATCH_CHUNK_SIZE + overlap;
+        if (end > length) end = length;
+
+        chunks[i].framework = framework;
+        chunks[i].data = content + start;
+        chunks[i].length = end - start;
+        chunks[i].hits = chunk_hits + i * words;
+        task_runtime_spawn(runtime, &group, scan_chunk_task, &chunks[i]);
+    }
+
+    task_group_wait(runtime, &group);
+
+    int ok = 1;
+    for (size_t i = 0; i < chunk_count; i++) {
+        ok = ok && chunks[i].ok;
+        for (size_t w = 0; w < words; w++) {
+            hits[w] |= chunks[i].hits[w];
+        }
+    }
+
+    if (ok) {
+        result = create_result(framework, hits);
+    }
+
+    scratch_free(arena, chunks);
+    scratch_free(arena, chunk_hits);
+    scratch_free(arena, hits);
+    return result;
+}
+
+int batch_streams_file(file_type_t file_type, size_t file_size) {
+    return (file_type == FILE_TYPE_TEXT || file_type == FILE_TYPE_YAML ||
+            file_type == FILE_TYPE_PDF) && file_size >= BATCH_STREAM_MIN_SIZE;
+}
+
+// Extracted PDF text -> matcher, joined by newlines as for loaded PDFs;
+// reading stops once every control has passed
+static int feed_pdf_text(const char *text, size_t length, void *context) {
+    rule_set_stream_t *stream = context;
+    if (rule_set_stream_feed(stream, text, length)) return 0;
+    return text[length-1] == '\n' || !rule_set_stream_feed(stream, "\n", 1);
+}
+
+scan_result_t* batch_stream_scan(const rule_set_t *rules, file_type_t file_type, FILE *input,
+                                 size_t *bytes_scanned, pdf_stream_stats_t *pdf_stats) {
+    if (file_type != FILE_TYPE_PDF) {
+        return rule_set_scan_stream(rules, input, bytes_scanned);
+    }
+
+    rule_set_stream_t *stream = rule_set_stream_create(rules);
+    if (!stream) return NULL;
+
+    scan_result_t *result = NULL;
+    if (parse_pdf_stream(input, feed_pdf_text, stream, pdf_stats)) {
+        result = rule_set_stream_result(stream);
+    }
+    if (bytes_scanned) {
+        *bytes_scanned = rule_set_stream_bytes(stream);
+    }
+
+    rule_set_stream_free(stream);
+    return result;
+}
+
+// Scan a large document without loading it
+static void batch_stream_file(batch_file_result_t *file) {
+    FILE *input = fopen(file->path, "rb");
+    if (!input) {
+        file->error_message = strdup("Failed to read file");
+        return;
+    }
+
+    // Reading and matching are one pass here; both count as the scan stage
+    scan_span_t span = scan_stats_begin();
+    file->scan_result = batch_stream_scan(file->framework, file->file_type, input,
+                                          &file->content_length, NULL);
+    scan_stats_end(span, SCAN_STAGE_SCAN, file->file_type, file->content_length);
+    fclose(input);
+
+    if (!file->scan_result) {
+        file->error_message = strdup("Scan failed");
+        return;
+    }
+
+    file->parsed = 1;
+}
+
+// Parse and scan one file, or the archive member already read into member
+// The parse result, index and scratch buffers live in the worker's arena and
+// are dropped with one rewind. A worker waiting on its own subtasks may pick
+// up another file; that scan marks and rewinds above this one.
+static void batch_process_file(batch_file_result_t *file, file_buffer_t *member) {
+
+    if (!member && batch_streams_file(file->file_type, file->file_size)) {
+        batch_stream_file(file);
+        return;
+    }
+
+    // Unchanged content scanned with unchanged rules needs no parse at all
+    scan_span_t span = scan_stats_begin();
+    result_cache_key_t key;
+    int keyed = 0;
+    if (file->cache && member) {
+        result_cache_key_buffer(member->data, member->length, file->file_type, &key);
+        keyed = 1;
+    } else if (file->cache) {
+        keyed = result_cache_key_file(file->path, file->file_type, &key);
+    }
+    if (keyed) {
+        file->scan_result = result_cache_lookup(file->cache, &key, &file->content_length);
+        scan_stats_end(span, SCAN_STAGE_CACHE, file->file_type, file->file_size);
+        if (file->scan_result) {
+            release_file_buffer(member);
+            file->parsed = 1;
+            file->cached = 1;
+            return;
+        }
+    }
+
+    int worker = task_runtime_current_worker();
+    arena_t *arena = file->worker_arenas && worker >= 0 ? file->worker_arenas[worker] : NULL;
+    arena_mark_t mark = arena_mark(arena);
+
+    span = scan_stats_begin();
+    parse_result_t *parse_result = member ? parse_loaded_buffer(member, file->file_type, arena)
+                                          : parse_file(file->path, arena);
+    scan_stats_end(span, SCAN_STAGE_PARSE, file->file_type, file->file_size);
+
+    if (!parse_result || !parse_result->success) {
+        file->error_message = strdup(parse_result && parse_result->error_message
+                                     ? parse_result->error_message
+                                     : "Unknown error");
+        free_parse_result(parse_result);
+        arena_rewind(arena, mark);
+        return;
+    }
+
+    if (file_type_has_index(file->file_type)) {
+        span = scan_stats_begin();
+        parse_result_build_index(parse_result);
+        scan_stats_end(span, SCAN_STAGE_INDEX, file->file_type, parse_result->content_length);
+    }
+
+    file->content_length = parse_result->content_length;
+    span = scan_stats_begin();
+    file->scan_result = batch_scan_content(file->framework, parse_result->config,
+                                           parse_result->content, parse_result->content_length,
+                                           arena);
+    scan_stats_end(span, SCAN_STAGE_SCAN, file->file_type, file->content_length);
+    int truncated = parse_result_truncated(parse_result);
+    free_parse_result(parse_result);
+    arena_rewind(arena, mark);
+
+    if (truncated) {
+        free_scan_result(file->scan_result);
+        file->scan_result = NULL;
+        file->error_message = strdup(FILE_TRUNCATED_ERROR);
+        return;
+    }
+    if (!file->scan_result) {
+        file->error_message = strdup("Scan failed");
+        return;
+    }
+
+    if (keyed) {
+        span = scan_stats_begin();
+        result_cache_store(file->cache, &key, file->scan_result, file->content_length);
+        scan_stats_end(span, SCAN_STAGE_CACHE, file->file_type, 0);
+    }
+    file->parsed = 1;
+}
+
+static void batch_file_clear(batch_file_result_t *file) {
+    for (size_t i = 0; i < file->member_count; i++) {
+        batch_file_clear(file->members[i]);
+        free(file->members[i]);
+    }
+    free(file->members);
+    free(file->path);
+    free(file->error_message);
+    free_scan_result(file->scan_result);
+    memset(file, 0, sizeof(*file));
+}
+
+static void batch_file_done(batch_file_result_t *file) {
+    scan_stats_count_checks(file->scan_result);
+    if (file->on_done) {
+        file->on_done(file, file->on_done_context);
+    }
+}
+
+typedef struct {
+    batch_file_result_t *file;
+    file_buffer_t buffer;
+} batch_member_task_t;
+
+static void batch_scan_member(void *arg) {
+    batch_member_task_t *task = arg;
+
+    batch_process_file(task->file, &task->buffer);
+    batch_file_done(task->file);
+    free(task);
+}
+
+// Directory scans skip hidden entries; so do archive scans, at any level
+// (this also covers the ".wh." whiteouts of container image layers)
+static int batch_wants_member(const char *name) {
+    for (const char *component = name; component; ) {
+        if (component[0] == '.') return 0;
+        component = strchr(component, '/');
+        if (component) component++;
+    }
+    return is_supported_file(name) && archive_format_of(name) == ARCHIVE_NONE;
+}
+
+// Record for one member, scanned with the archive's settings
+static batch_file_result_t* batch_add_member(batch_file_result_t *archive,
+                                             const archive_member_t *member) {
+    if (archive->member_count % 64 == 0) {
+        batch_file_result_t **grown = realloc(archive->members,
+                                              (archive->member_count + 64) *
+                                              sizeof(batch_file_result_t*));
+        if (!grown) return NULL;
+        archive->members = grown;
+    }
+
+    batch_file_result_t *file = calloc(1, sizeof(batch_file_result_t));
+    size_t path_length = strlen(archive->path) + strlen(ARCHIVE_MEMBER_SEPARATOR) +
+                         strlen(member->name) + 1;
+    char *path = malloc(path_length);
+    if (!file || !path) {
+        free(file);
+        free(path);
+        return NULL;
+    }
+    snprintf(path, path_length, "%s%s%s", archive->path, ARCHIVE_MEMBER_SEPARATOR, member->name);
+
+    file->path = path;
+    file->file_type = detect_file_type(member->name);
+    file->file_size = (size_t)member->size;
+    file->framework = archive->framework;
+    file->worker_arenas = archive->worker_arenas;
+    file->cache = archive->cache;
+    file->on_done = archive->on_done;
+    file->on_done_context = archive->on_done_context;
+    archive->members[archive->member_count++] = file;
+    return file;
+}
+
+// Read an archive front to back and scan its members in parallel
+// Only the reading is sequential: each member is handed to a task as soon as
+// it is in memory. Tasks are spawned in two windows of half the read-ahead
+// each; when one is full, reading moves on to the other once the scans last
+// spawned there are done, so at most BATCH_ARCHIVE_READAHEAD bytes of read
+// members are in flight without the reader draining every scan. A damaged
+// archive keeps the members read before the damage and is reported as an
+// error itself, as is an archive without any member to scan.
+static void batch_scan_archive(batch_file_result_t *file) {
+    const char *error = NULL;
+    archive_reader_t *reader = archive_open(file->path, archive_format_of(file->path), &error);
+    if (!reader) {
+        file->error_message = strdup(error);
+        return;
+    }
+    file->expanded = 1;
+
+    task_runtime_t *runtime = task_runtime_current();
+    task_group_t windows[2];
+    task_group_init(&windows[0]);
+    task_group_init(&windows[1]);
+    int window = 0;
+    size_t pending = 0;
+
+    archive_member_t member;
+    const char *failure = NULL;
+    int status;
+    while ((status = archive_next(reader, &member)) == 1) {
+        if (!batch_wants_member(member.name)) continue;
+
+        batch_file_result_t *record = batch_add_member(file, &member);
+        batch_member_task_t *task = record ? malloc(sizeof(batch_member_task_t)) : NULL;
+        if (!task) {
+            failure = "Memory allocation failed";
+            break;
+        }
+        task->file = record;
+
+        scan_span_t span = scan_stats_begin();
+        if (!archive_read_member(reader, &task->buffer, &error)) {
+            record->error_message = strdup(error);
+            free(task);
+            batch_file_done(record);
+            continue;
+        }
+        scan_stats_end(span, SCAN_STAGE_READ, record->file_type, task->buffer.length);
+
+        pending += task->buffer.length;
+        if (!runtime || !task_runtime_spawn(runtime, &windows[window], batch_scan_member, task)) {
+            batch_scan_member(task);
+        }
+        if (runtime && pending >= BATCH_ARCHIVE_READAHEAD / 2) {
+            window ^= 1;
+            task_group_wait(runtime, &windows[window]);
+            pending = 0;
+        }
+    }
+    if (runtime) {
+        task_group_wait(runtime, &windows[0]);
+        task_group_wait(runtime, &windows[1]);
+    }
+
+    if (status < 0) {
+        failure = archive_error(reader);
+    } else if (!failure && file->member_count == 0) {
+        failure = "No supported files in archive";
+    }
+    if (failure) {
+        file->error_message = strdup(failure);
+    }
+    archive_close(reader);
+}
+
+// Scan one file and report it (runs as a task on a worker thread)
+static void batch_scan_file(void *arg) {
+    batch_file_result_t *file = arg;
+
+    if (archive_format_of(file->path) != ARCHIVE_NONE) {
+        batch_scan_archive(file);
+        if (file->expanded && !file->error_message) return;
+    } else {
+        batch_process_file(file, NULL);
+    }
+    batch_file_done(file);
+}
+
+// Replace every archive that was read by its member records, in place
+// Archives that could not be read, or not to the end, keep their error record.
+static void batch_expand_archives(batch_t *batch) {
+    size_t count = 0;
+    int any = 0;
+    for (size_t i = 0; i < batch->file_count; i++) {
+        const batch_file_result_t *file = &batch->files[i];
+        any = any || file->expanded;
+        count += file->member_count + (file->expanded && !file->error_message ? 0 : 1);
+    }
+    if (!any) return;
+
+    batch_file_result_t *files = calloc(count ? count : 1, sizeof(batch_file_result_t));
+    if (!files) return;
+
+    size_t n = 0;
+    for (size_t i = 0; i < batch->file_count; i++) {
+        batch_file_result_t *file = &batch->files[i];
+        for (size_t m = 0; m < file->member_count; m++) {
+            files[n++] = *file->members[m];
+            free(file->members[m]);
+        }
+        free(file->members);
+        file->members = NULL;
+        file->member_count = 0;
+
+        if (file->expanded && !file->error_message) {
+            batch_file_clear(file);
+        } else {
+            files[n++] = *file;
+        }
+    }
+
+    free(batch->files);
+    batch->files = files;
+    batch->file_count = n;
+    batch->file_capacity = count ? count : 1;
+}
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int compare_file_size_desc(const void *a, const void *b) {
+    const batch_file_result_t *fa = *(batch_file_result_t *const *)a;
+    const batch_file_result_t *fb = *(batch_file_result_t *const *)b;
+    if (fa->file_size != fb->file_size) return fa->file_size < fb->file_size ? 1 : -1;
+    return 0;
+}
+
+// Scan every file in the batch on a work-stealing runtime
+void batch_run(batch_t *batch, int thread_count) {
+    if (!batch) return;
+
+    double start = monotonic_seconds();
+
+    if (thread_count < 1) thread_count = 1;
+
+    task_runtime_t *runtime = task_runtime_create(thread_count);
+    if (!runtime) {
+        // Could not start the workers - scan on the calling thread alone
+        runtime = task_runtime_create(1);
+    }
+
+    // Queue the largest files first: thieves take from the old end of the
+    // deque, so big files start early and small ones fill in the gaps
+    batch_file_result_t **order = malloc(batch->file_count * sizeof(batch_file_result_t*));
+    if (order) {
+        for (size_t i = 0; i < batch->file_count; i++) order[i] = &batch->files[i];
+        qsort(order, batch->file_count, sizeof(batch_file_result_t*), compare_file_size_desc);
+    }
+
+    if (runtime) {
+        // One arena per worker, reused by every file the worker scans
+        int worker_count = task_runtime_worker_count(runtime);
+        arena_t **arenas = calloc((size_t)worker_count, sizeof(arena_t*));
+        for (int i = 0; arenas && i < worker_count; i++) {
+            arenas[i] = arena_create(BATCH_ARENA_BLOCK_SIZE);
+            if (!arenas[i]) {
+                for (int j = 0; j < i; j++) arena_destroy(arenas[j]);
+                free(arenas);
+                arenas = NULL;
+            }
+        }
+
+        task_group_t group;
+        task_group_init(&group);
+        for (size_t i = 0; i < batch->file_count; i++) {
+            batch->files[i].framework = batch->framework;
+            batch->files[i].worker_arenas = arenas;
+            batch->files[i].cache = batch->cache;
+            batch->files[i].on_done = batch->on_file_done;
+            batch->files[i].on_done_context = batch->on_file_done_context;
+        }
+        for (size_t i = 0; i < batch->file_count; i++) {
+            task_runtime_spawn(runtime, &group, batch_scan_file,
+                               order ? order[i] : &batch->files[i]);
+        }
+        task_group_wait(runtime, &group);
+        batch_expand_archives(batch);
+
+        free(batch->worker_stats);
+        batch->worker_count = task_runtime_worker_count(runtime);
+        batch->worker_stats = calloc((size_t)batch->worker_count, sizeof(task_worker_stats_t));
+        if (batch->worker_stats) {
+            for (int i = 0; i < batch->worker_count; i++) {
+                task_runtime_worker_stats(runtime, i, &batch->worker_stats[i]);
+            }
+        } else {
+            batch->worker_count = 0;
+        }
+
+        task_runtime_destroy(runtime);
+        for (int i = 0; arenas && i < worker_count; i++) {
+            scan_stats_add_arena(arenas[i]);
+            arena_destroy(arenas[i]);
+        }
+        free(arenas);
+        for (size_t i = 0; i < batch->file_count; i++) {
+            batch->files[i].worker_arenas = NULL;
+        }
+    } else {
+        for (size_t i = 0; i < batch->file_count; i++) {
+            batch->files[i].framework = batch->framework;
+            batch->files[i].cache = batch->cache;
+            batch->files[i].on_done = batch->on_file_done;
+            batch->files[i].on_done_context = batch->on_file_done_context;
+            batch_scan_file(&batch->files[i]);
+        }
+        batch_expand_archives(batch);
+    }
+    free(order);
+
+    batch_tally(batch);
+    batch->elapsed_seconds = monotonic_seconds() - start;
+}
+
+// Recount the aggregated totals from the per-file results
+void batch_tally(batch_t *batch) {
+    if (!batch) return;
+
+    batch->passed_files = 0;
+    batch->failed_files = 0;
+    batch->error_files = 0;
+    batch->cached_files = 0;
+    for (size_t i = 0; i < batch->file_count; i++) {
+        const batch_file_result_t *file = &batch->files[i];
+        batch->cached_files += file->cached ? 1 : 0;
+        if (!file->parsed) {
+            batch->error_files++;
+        } else if (scan_result_compliant(file->scan_result)) {
+            batch->passed_files++;
+        } else {
+            batch->failed_files++;
+        }
+    }
+}
+
+// File with exactly this path, NULL if not in the batch
+batch_file_result_t* batch_find_file(batch_t *batch, const char *path) {
+    if (!batch || !path) return NULL;
+
+    for (size_t i = 0; i < batch->file_count; i++) {
+        if (strcmp(batch->files[i].path, path) == 0) {
+            return &batch->files[i];
+        }
+    }
+    return NULL;
+}
+
+// Move a scanned file record into the batch, replacing the record with the
+// same path if there is one; *file is left empty
+int batch_put_file(batch_t *batch, batch_file_result_t *file) {
+    if (!batch || !file || !file->path) return 0;
+
+    batch_file_result_t *slot = batch_find_file(batch, file->path);
+    if (slot) {
+        batch_file_clear(slot);
+    } else {
+        if (batch->file_count >= batch->file_capacity) {
+            size_t new_capacity = batch->file_capacity * 2;
+            batch_file_result_t *grown = realloc(batch->files,
+                                                 new_capacity * sizeof(batch_file_result_t));
+            if (!grown) return 0;
+            batch->files = grown;
+            batch->file_capacity = new_capacity;
+        }
+        slot = &batch->files[batch->file_count++];
+    }
+
+    *slot = *file;
+    memset(file, 0, sizeof(*file));
+    return 1;
+}
+
+// Drop one file record, keeping the order of the others
+void batch_remove_file(batch_t *batch, size_t index) {
+    if (!batch || index >= batch->file_count) return;
+
+    batch_file_clear(&batch->files[index]);
+    memmove(&batch->files[index], &batch->files[index + 1],
+            (batch->file_count - index - 1) * sizeof(batch_file_result_t));
+    batch->file_count--;
+}
+
+// Free batch and all per-file results
+void batch_free(batch_t *batch) {
+    if (!batch) return;
+
+    for (size_t i = 0; i < batch->file_count; i++) {
+        batch_file_clear(&batch->files[i]);
+    }
+    free(batch->files);
+    free(batch->worker_stats);
+    free(batch);
+}
+
+// Number of online CPUs, used when -j is not given
+int batch_default_thread_count(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
@@ -0,0 +1,777 @@
+#define _POSIX_C_SOURCE 200809L
+#include "cache/result_cache.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Bump when the file format or the matching semantics change, so verdicts
+// computed by an older scanner are never reused (parser changes bump
+// PARSER_VERSION instead, which is part of every rules hash)
+#define RESULT_CACHE_VERSION 2
+
+#define RESULT_CACHE_FILE "results.idx"
+#define RESULT_CACHE_MAGIC "CMPLYRC1"
+
+// Sanity limit for controls per cached result (larger counts mean a corrupt file)
+#define MAX_CACHED_RESULTS (1u << 20)
+
+// ==================== XXH64 ====================
+
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ull
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define XXH_PRIME64_3 0x165667B19E3779F9ull
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ull
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ull
+
+static uint64_t rotl64(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static uint64_t read64(const unsigned char *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t read32(const unsigned char *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t xxh_round(uint64_t acc, uint64_t input) {
+    acc += input * XXH_PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+static uint64_t xxh_merge_round(uint64_t acc, uint64_t value) {
+    acc ^= xxh_round(0, value);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+uint64_t result_cache_hash(const void *data, size_t length, uint64_t seed) {
+    const unsigned char *p = data;
+    const unsigned char *end = p + length;
+    uint64_t hash;
+
+    if (length >= 32) {
+        uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        uint64_t v2 = seed + XXH_PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME64_1;
+
+        const unsigned char *limit = end - 32;
+        do {
+            v1 = xxh_round(v1, read64(p));
+            v2 = xxh_round(v2, read64(p + 8));
+            v3 = xxh_round(v3, read64(p + 16));
+            v4 = xxh_round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        hash = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        hash = xxh_merge_round(hash, v1);
+        hash = xxh_merge_round(hash, v2);
+        hash = xxh_merge_round(hash, v3);
+        hash = xxh_merge_round(hash, v4);
+    } else {
+        hash = seed + XXH_PRIME64_5;
+    }
+
+    hash += (uint64_t)length;
+
+    while (p + 8 <= end) {
+        hash ^= xxh_round(0, read64(p));
+        hash = rotl64(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        hash ^= (uint64_t)read32(p) * XXH_PRIME64_1;
+        hash = rotl64(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+    while (p < end) {
+        hash ^= (*p) * XXH_PRIME64_5;
+        hash = rotl64(hash, 11) * XXH_PRIME64_1;
+        p++;
+    }
+
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+// ==================== Cache Table ====================
+
+typedef struct {
+    result_cache_key_t key;
+    uint64_t rules_hash;
+    uint64_t last_used;         // Value of the cache clock at the last hit or store
+    uint64_t content_length;
+    uint32_t result_count;
+    uint32_t newer;             // Recency list neighbours, index + 1, 0 = none
+    uint32_t older;
+    size_t words;               // Offset of the pass bits in the word pool
+} cache_entry_t;
+
+// On-disk record, followed by MATCHER_BITSET_WORDS(result_count) words
+typedef struct {
+    uint64_t content_hash;
+    uint64_t length;
+    uint64_t rules_hash;
+    uint64_t last_used;
+    uint64_t content_length;
+    uint32_t file_type;
+    uint32_t result_count;
+} cache_record_t;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t clock;
+    uint64_t count;
+} cache_header_t;
+
+struct result_cache {
+    char *path;                 // <directory>/results.idx
+    size_t max_entries;
+    const rule_set_t *framework;
+    uint64_t rules_hash;
+    char *error_message;
+
+    pthread_mutex_t lock;
+    cache_entry_t *entries;
+    size_t count;
+    size_t capacity;
+    uint32_t *slots;            // Index + 1 of the entry, 0 = empty
+    size_t slot_count;          // Power of two
+    uint32_t newest;            // Ends of the recency list, index + 1
+    uint32_t oldest;
+    uint64_t *pool;             // Pass bits of every entry
+    size_t pool_length;
+    size_t pool_capacity;
+    size_t pool_garbage;        // Words no entry refers to any more
+
+    uint64_t clock;
+    int dirty;
+    result_cache_stats_t stats;
+};
+
+static void set_error(result_cache_t *cache, const char *format, ...) {
+    if (cache->error_message) return;
+
+    char message[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    cache->error_message = strdup(message);
+}
+
+static size_t key_slot(const result_cache_t *cache, const result_cache_key_t *key,
+                       uint64_t rules_hash) {
+    uint64_t mixed = key->content_hash ^ rotl64(rules_hash, 17) ^ (key->length * XXH_PRIME64_3) ^
+                     key->file_type;
+    mixed ^= mixed >> 29;
+    return (size_t)mixed & (cache->slot_count - 1);
+}
+
+static int key_equal(const cache_entry_t *entry, const result_cache_key_t *key, uint64_t rules_hash) {
+    return entry->key.content_hash == key->content_hash && entry->key.length == key->length &&
+           entry->key.file_type == key->file_type && entry->rules_hash == rules_hash;
+}
+
+// Slot holding key, or the empty slot where it belongs
+static size_t find_slot(const result_cache_t *cache, const result_cache_key_t *key,
+                        uint64_t rules_hash) {
+    size_t mask = cache->slot_count - 1;
+    size_t slot = key_slot(cache, key, rules_hash);
+    while (cache->slots[slot] &&
+           !key_equal(&cache->entries[cache->slots[slot] - 1], key, rules_hash)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static int rehash(result_cache_t *cache, size_t slot_count) {
+    uint32_t *slots = calloc(slot_count, sizeof(uint32_t));
+    if (!slots) return 0;
+
+    free(cache->slots);
+    cache->slots = slots;
+    cache->slot_count = slot_count;
+    for (size_t i = 0; i < cache->count; i++) {
+        const cache_entry_t *entry = &cache->entries[i];
+        cache->slots[find_slot(cache, &entry->key, entry->rules_hash)] = (uint32_t)(i + 1);
+    }
+    return 1;
+}
+
+// Empty a slot, moving later entries of the probe run back so that
+// find_slot() still reaches them
+static void remove_slot(result_cache_t *cache, size_t slot) {
+    size_t mask = cache->slot_count - 1;
+    size_t hole = slot;
+    for (size_t next = (slot + 1) & mask; cache->slots[next]; next = (next + 1) & mask) {
+        const cache_entry_t *entry = &cache->entries[cache->slots[next] - 1];
+        size_t home = key_slot(cache, &entry->key, entry->rules_hash);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            cache->slots[hole] = cache->slots[next];
+            hole = next;
+        }
+    }
+    cache->slots[hole] = 0;
+}
+
+static void lru_unlink(result_cache_t *cache, uint32_t index) {
+    cache_entry_t *entry = &cache->entries[index];
+    if (entry->newer) cache->entries[entry->newer - 1].older = entry->older;
+    else cache->newest = entry->older;
+    if (entry->older) cache->entries[entry->older - 1].newer = entry->newer;
+    else cache->oldest = entry->newer;
+    entry->newer = entry->older = 0;
+}
+
+static void lru_push_newest(result_cache_t *cache, uint32_t index) {
+    cache_entry_t *entry = &cache->entries[index];
+    entry->newer = 0;
+    entry->older = cache->newest;
+    if (cache->newest) cache->entries[cache->newest - 1].newer = index + 1;
+    else cache->oldest = index + 1;
+    cache->newest = index + 1;
+}
+
+static int compare_last_used(const void *a, const void *b) {
+    const cache_entry_t *ea = *(const cache_entry_t *const *)a;
+    const cache_entry_t *eb = *(const cache_entry_t *const *)b;
+    if (ea->last_used != eb->last_used) return ea->last_used < eb->last_used ? -1 : 1;
+    return 0;
+}
+
+// Order the recency list by last_used (entries are loaded in file order)
+static int lru_rebuild(result_cache_t *cache) {
+    cache_entry_t **order = malloc((cache->count ? cache->count : 1) * sizeof(cache_entry_t*));
+    if (!order) return 0;
+    for (size_t i = 0; i < cache->count; i++) order[i] = &cache->entries[i];
+    qsort(order, cache->count, sizeof(cache_entry_t*), compare_last_used);
+
+    cache->newest = cache->oldest = 0;
+    for (size_t i = 0; i < cache->count; i++) {
+        lru_push_newest(cache, (uint32_t)(order[i] - cache->entries));
+    }
+    free(order);
+    return 1;
+}
+
+// Drop the least recently used entry; its words stay in the pool and are
+// returned through words/word_count for reuse
+static void evict_oldest(result_cache_t *cache, size_t *words, size_t *word_count) {
+    uint32_t index = cache->oldest - 1;
+    cache_entry_t *entry = &cache->entries[index];
+    *words = entry->words;
+    *word_count = MATCHER_BITSET_WORDS(entry->result_count);
+
+    lru_unlink(cache, index);
+    remove_slot(cache, find_slot(cache, &entry->key, entry->rules_hash));
+
+    // Fill the hole with the last entry
+    uint32_t last = (uint32_t)(cache->count - 1);
+    if (index != last) {
+        cache_entry_t *moved = &cache->entries[last];
+        cache->slots[find_slot(cache, &moved->key, moved->rules_hash)] = index + 1;
+        if (moved->newer) cache->entries[moved->newer - 1].older = index + 1;
+        else cache->newest = index + 1;
+        if (moved->older) cache->entries[moved->older - 1].newer = index + 1;
+        else cache->oldest = index + 1;
+        *entry = *moved;
+    }
+    cache->count--;
+    cache->stats.evictions++;
+}
+
+// Copy the live words into a new pool once most of it is garbage
+static void pool_compact(result_cache_t *cache) {
+    size_t capacity = cache->pool_length - cache->pool_garbage;
+    uint64_t *pool = malloc((capacity ? capacity : 1) * sizeof(uint64_t));
+    if (!pool) return;
+
+    size_t length = 0;
+    for (size_t i = 0; i < cache->count; i++) {
+        cache_entry_t *entry = &cache->entries[i];
+        size_t word_count = MATCHER_BITSET_WORDS(entry->result_count);
+        memcpy(pool + length, cache->pool + entry->words, word_count * sizeof(uint64_t));
+        entry->words = length;
+        length += word_count;
+    }
+
+    free(cache->pool);
+    cache->pool = pool;
+    cache->pool_length = length;
+    cache->pool_capacity = capacity;
+    cache->pool_garbage = 0;
+}
+
+// Copy words into the pool, returns the offset or SIZE_MAX when out of memory
+static size_t pool_append(result_cache_t *cache, const uint64_t *words, size_t word_count) {
+    if (cache->pool_garbage > 1024 && cache->pool_garbage > cache->pool_length / 2) {
+        pool_compact(cache);
+    }
+
+    if (cache->pool_length + word_count > cache->pool_capacity) {
+        size_t capacity = cache->pool_capacity ? cache->pool_capacity : 1024;
+        while (cache->pool_length + word_count > capacity) capacity *= 2;
+        uint64_t *pool = realloc(cache->pool, capacity * sizeof(uint64_t));
+        if (!pool) return SIZE_MAX;
+        cache->pool = pool;
+        cache->pool_capacity = capacity;
+    }
+
+    size_t offset = cache->pool_length;
+    memcpy(cache->pool + offset, words, word_count * sizeof(uint64_t));
+    cache->pool_length += word_count;
+    return offset;
+}
+
+// Add or replace an entry and make it the most recently used, evicting the
+// least recently used one when the cache is full (caller holds the lock or
+// owns the cache)
+static int insert_entry(result_cache_t *cache, const result_cache_key_t *key, uint64_t rules_hash,
+                        uint64_t last_used, uint64_t content_length, uint32_t result_count,
+                        const uint64_t *words) {
+    size_t word_count = MATCHER_BITSET_WORDS(result_count);
+    size_t slot = find_slot(cache, key, rules_hash);
+
+    if (cache->slots[slot]) {
+        uint32_t index = cache->slots[slot] - 1;
+        cache_entry_t *entry = &cache->entries[index];
+        if (entry->result_count == result_count) {
+            memcpy(cache->pool + entry->words, words, word_count * sizeof(uint64_t));
+        } else {
+            size_t offset = pool_append(cache, words, word_count);
+            if (offset == SIZE_MAX) return 0;
+            entry = &cache->entries[index];
+            cache->pool_garbage += MATCHER_BITSET_WORDS(entry->result_count);
+            entry->words = offset;
+            entry->result_count = result_count;
+        }
+        entry->last_used = last_used;
+        entry->content_length = content_length;
+        lru_unlink(cache, index);
+        lru_push_newest(cache, index);
+        return 1;
+    }
+
+    if (cache->count >= UINT32_MAX - 1) return 0;
+
+    if ((cache->count + 1) * 2 > cache->slot_count &&
+        !rehash(cache, cache->slot_count ? cache->slot_count * 2 : 1024)) {
+        return 0;
+    }
+    if (cache->count == cache->capacity) {
+        size_t capacity = cache->capacity ? cache->capacity * 2 : 1024;
+        cache_entry_t *entries = realloc(cache->entries, capacity * sizeof(cache_entry_t));
+        if (!entries) return 0;
+        cache->entries = entries;
+        cache->capacity = capacity;
+    }
+
+    // A full cache makes room first and hands the evicted words on
+    size_t offset = SIZE_MAX;
+    if (cache->count > 0 && cache->count >= cache->max_entries) {
+        size_t evicted_words, evicted_count;
+        evict_oldest(cache, &evicted_words, &evicted_count);
+        if (evicted_count == word_count) {
+            offset = evicted_words;
+            memcpy(cache->pool + offset, words, word_count * sizeof(uint64_t));
+        } else {
+            cache->pool_garbage += evicted_count;
+        }
+    }
+
+    if (offset == SIZE_MAX) {
+        offset = pool_append(cache, words, word_count);
+        if (offset == SIZE_MAX) return 0;
+    }
+
+    uint32_t index = (uint32_t)cache->count++;
+    cache_entry_t *entry = &cache->entries[index];
+    entry->key = *key;
+    entry->rules_hash = rules_hash;
+    entry->last_used = last_used;
+    entry->content_length = content_length;
+    entry->result_count = result_count;
+    entry->words = offset;
+    cache->slots[find_slot(cache, key, rules_hash)] = index + 1;
+    lru_push_newest(cache, index);
+    return 1;
+}
+
+// ==================== Rule Set Hash ====================
+
+static uint64_t hash_text(uint64_t hash, const char *text) {
+    // The terminator separates fields; NULL hashes differently from ""
+    return text ? result_cache_hash(text, strlen(text) + 1, hash) : result_cache_hash("\xff", 1, hash);
+}
+
+static uint64_t hash_info(uint64_t hash, const control_info_t *info) {
+    hash = hash_text(hash, info->id);
+    hash = hash_text(hash, info->name);
+    hash = hash_text(hash, info->severity);
+    hash = hash_text(hash, info->pass_details);
+    hash = hash_text(hash, info->fail_details);
+    return hash_text(hash, info->remediation);
+}
+
+// Everything that shapes a verdict: the parsers, control metadata, patterns
+// and frameworks
+static uint64_t rules_hash(const rule_set_t *framework) {
+    uint64_t hash = RESULT_CACHE_VERSION ^ ((uint64_t)PARSER_VERSION << 32);
+
+    if (!framework) {
+        hash = hash_text(hash, "builtin");
+        for (unsigned int check = 0; check < HIPAA_CHECK_COUNT; check++) {
+            hash = hash_info(hash, hipaa_check_info((hipaa_check_id_t)check));
+            for (const char *const *pattern = hipaa_check_pattern_list((hipaa_check_id_t)check);
+                 pattern && *pattern; pattern++) {
+                hash = hash_text(hash, *pattern);
+            }
+            hash = hash_text(hash, NULL);
+        }
+        return hash;
+    }
+
+    hash = hash_text(hash, "rules");
+    for (size_t i = 0; i < framework->control_count; i++) {
+        const rule_control_t *control = &framework->controls[i];
+        hash = hash_info(hash, &control->info);
+        for (size_t p = 0; p < control->pattern_count; p++) {
+            hash = hash_text(hash, control->patterns[p]);
+        }
+        hash = hash_text(hash, NULL);
+    }
+
+    // Results are split per framework, so the split is part of the verdict
+    for (size_t i = 0; i < framework->framework_count; i++) {
+        const rule_framework_t *section = &framework->frameworks[i];
+        uint64_t bounds[2] = { section->first_control, section->control_count };
+        hash = hash_text(hash, section->name);
+        hash = result_cache_hash(bounds, sizeof(bounds), hash);
+    }
+    return hash;
+}
+
+// ==================== Persistence ====================
+
+// mkdir -p
+static int make_directories(const char *directory) {
+    char *path = strdup(directory);
+    if (!path) return 0;
+
+    int ok = 1;
+    for (char *p = path + 1; ok; p++) {
+        if (*p == '/' || *p == '\0') {
+            char saved = *p;
+            *p = '\0';
+            if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+                ok = 0;
+            }
+            *p = saved;
+            if (saved == '\0') break;
+        }
+    }
+
+    free(path);
+    return ok;
+}
+
+// Read the entries of an existing cache file; a missing file is an empty
+// cache and a damaged one is ignored from the first bad record on
+static void load_entries(result_cache_t *cache) {
+    FILE *fp = fopen(cache->path, "rb");
+    if (!fp) return;
+
+    cache_header_t header;
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        memcmp(header.magic, RESULT_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != RESULT_CACHE_VERSION) {
+        fclose(fp);
+        return;
+    }
+    cache->clock = header.clock;
+
+    uint64_t *words = NULL;
+    size_t words_capacity = 0;
+    // Records are written most recently used first, so a lowered limit keeps
+    // the newest ones
+    uint64_t i;
+    for (i = 0; i < header.count && cache->count < cache->max_entries; i++) {
+        cache_record_t record;
+        if (fread(&record, sizeof(record), 1, fp) != 1 || record.result_count > MAX_CACHED_RESULTS) {
+            break;
+        }
+
+        size_t word_count = MATCHER_BITSET_WORDS(record.result_count);
+        if (word_count > words_capacity) {
+            uint64_t *grown = realloc(words, word_count * sizeof(uint64_t));
+            if (!grown) break;
+            words = grown;
+            words_capacity = word_count;
+        }
+        if (word_count > 0 && fread(words, sizeof(uint64_t), word_count, fp) != word_count) {
+            break;
+        }
+
+        result_cache_key_t key = {
+            .content_hash = record.content_hash,
+            .length = record.length,
+            .file_type = record.file_type,
+        };
+        if (!insert_entry(cache, &key, record.rules_hash, record.last_used,
+                          record.content_length, record.result_count, words)) {
+            break;
+        }
+        if (record.last_used >= cache->clock) {
+            cache->clock = record.last_used + 1;
+        }
+    }
+
+    if (cache->count == cache->max_entries && i < header.count) {
+        cache->stats.evictions += header.count - i;
+        cache->dirty = 1;
+    }
+
+    free(words);
+    fclose(fp);
+    if (!lru_rebuild(cache)) {
+        set_error(cache, "out of memory");
+    }
+}
+
+// Write the entries, most recently used first, to a temporary file and
+// rename it over the cache file
+static int save_entries(result_cache_t *cache) {
+    size_t temp_size = strlen(cache->path) + 32;
+    char *temp_path = malloc(temp_size);
+    if (!temp_path) {
+        set_error(cache, "out of memory");
+        return 0;
+    }
+    snprintf(temp_path, temp_size, "%s.%ld.tmp", cache->path, (long)getpid());
+
+    FILE *fp = fopen(temp_path, "wb");
+    int ok = fp != NULL;
+    if (ok) {
+        cache_header_t header = {0};
+        memcpy(header.magic, RESULT_CACHE_MAGIC, sizeof(header.magic));
+        header.version = RESULT_CACHE_VERSION;
+        header.clock = cache->clock;
+        header.count = cache->count;
+        ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+
+        for (uint32_t next = cache->newest; ok && next; next = cache->entries[next - 1].older) {
+            const cache_entry_t *entry = &cache->entries[next - 1];
+            cache_record_t record = {
+                .content_hash = entry->key.content_hash,
+                .length = entry->key.length,
+                .rules_hash = entry->rules_hash,
+                .last_used = entry->last_used,
+                .content_length = entry->content_length,
+                .file_type = entry->key.file_type,
+                .result_count = entry->result_count,
+            };
+            size_t word_count = MATCHER_BITSET_WORDS(entry->result_count);
+            ok = fwrite(&record, sizeof(record), 1, fp) == 1 &&
+                 fwrite(cache->pool + entry->words, sizeof(uint64_t), word_count, fp) == word_count;
+        }
+
+        ok = (fclose(fp) == 0) && ok;
+    }
+
+    if (ok && rename(temp_path, cache->path) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        set_error(cache, "cannot write %s: %s", cache->path, strerror(errno));
+        unlink(temp_path);
+    }
+
+    free(temp_path);
+    return ok;
+}
+
+// ==================== Public API ====================
+
+// Open the cache for a rule set
+result_cache_t* result_cache_open(const char *directory, size_t max_entries,
+                                  const rule_set_t *framework) {
+    result_cache_t *cache = calloc(1, sizeof(result_cache_t));
+    if (!cache) return NULL;
+
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->max_entries = max_entries ? max_entries : RESULT_CACHE_DEFAULT_MAX_ENTRIES;
+    cache->framework = framework;
+    cache->rules_hash = rules_hash(framework);
+
+    if (!directory || !*directory) {
+        set_error(cache, "no cache directory given");
+        return cache;
+    }
+
+    size_t path_size = strlen(directory) + sizeof(RESULT_CACHE_FILE) + 2;
+    cache->path = malloc(path_size);
+    if (!cache->path) {
+        set_error(cache, "out of memory");
+        return cache;
+    }
+    snprintf(cache->path, path_size, "%s/%s", directory, RESULT_CACHE_FILE);
+
+    if (!make_directories(directory)) {
+        set_error(cache, "cannot create cache directory %s: %s", directory, strerror(errno));
+        return cache;
+    }
+
+    if (!rehash(cache, 1024)) {
+        set_error(cache, "out of memory");
+        return cache;
+    }
+
+    load_entries(cache);
+    cache->stats.entries = cache->count;
+    return cache;
+}
+
+const char* result_cache_error(const result_cache_t *cache) {
+    return cache ? cache->error_message : "out of memory";
+}
+
+// Persist (if anything changed) and free the cache
+int result_cache_close(result_cache_t *cache) {
+    if (!cache) return 0;
+
+    int ok = 1;
+    if (cache->dirty && !cache->error_message) {
+        ok = save_entries(cache);
+    }
+
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->entries);
+    free(cache->slots);
+    free(cache->pool);
+    free(cache->path);
+    free(cache->error_message);
+    free(cache);
+    return ok;
+}
+
+// Hash a file into a cache key
+int result_cache_key_file(const char *path, file_type_t file_type, result_cache_key_t *key) {
+    if (!path || !key) return 0;
+
+    file_buffer_t buffer;
+    if (!load_file_buffer(path, &buffer, NULL)) {
+        return 0;
+    }
+
+    result_cache_key_buffer(buffer.data, buffer.length, file_type, key);
+    return release_file_buffer(&buffer);
+}
+
+// Key for content already in memory (e.g. an archive member)
+void result_cache_key_buffer(const char *data, size_t length, file_type_t file_type,
+                             result_cache_key_t *key) {
+    key->content_hash = result_cache_hash(data, length, 0);
+    key->length = length;
+    key->file_type = (uint32_t)file_type;
+}
+
+// Rebuild the stored verdict for key
+scan_result_t* result_cache_lookup(result_cache_t *cache, const result_cache_key_t *key,
+                                   size_t *content_length) {
+    if (!cache || !key || cache->error_message) return NULL;
+
+    size_t expected = cache->framework ? cache->framework->control_count : HIPAA_CHECK_COUNT;
+    size_t word_count = MATCHER_BITSET_WORDS(expected);
+    uint64_t small_hits[1] = {0};
+    uint64_t *hits = word_count <= 1 ? small_hits : calloc(word_count, sizeof(uint64_t));
+    if (!hits) return NULL;
+
+    int found = 0;
+    pthread_mutex_lock(&cache->lock);
+    cache->stats.lookups++;
+    size_t slot = find_slot(cache, key, cache->rules_hash);
+    if (cache->slots[slot]) {
+        cache_entry_t *entry = &cache->entries[cache->slots[slot] - 1];
+        if (entry->result_count == expected) {
+            memcpy(hits, cache->pool + entry->words, word_count * sizeof(uint64_t));
+            if (content_length) *content_length = (size_t)entry->content_length;
+            entry->last_used = cache->clock++;
+            lru_unlink(cache, cache->slots[slot] - 1);
+            lru_push_newest(cache, cache->slots[slot] - 1);
+            cache->dirty = 1;
+            found = 1;
+        }
+    }
+    if (found) cache->stats.hits++; else cache->stats.misses++;
+    pthread_mutex_unlock(&cache->lock);
+
+    scan_result_t *result = NULL;
+    if (found) {
+        result = cache->framework ? rule_set_create_result(cache->framework, hits, NULL)
+                                  : hipaa_create_scan_result((uint32_t)hits[0], NULL);
+    }
+
+    if (hits != small_hits) free(hits);
+    return result;
+}
+
+// Record a verdict
+int result_cache_store(result_cache_t *cache, const result_cache_key_t *key,
+                       const scan_result_t *result, size_t content_length) {
+    if (!cache || !key || !result || cache->error_message ||
+        result->result_count > MAX_CACHED_RESULTS) {
+        return 0;
+    }
+
+    size_t word_count = MATCHER_BITSET_WORDS(result->result_count);
+    uint64_t small_hits[1] = {0};
+    uint64_t *hits = word_count <= 1 ? small_hits : calloc(word_count, sizeof(uint64_t));
+    if (!hits) return 0;
+
+    for (size_t i = 0; i < result->result_count; i++) {
+        if (result->results[i].passed) {
+            hits[i / 64] |= 1ull << (i % 64);
+        }
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    int ok = insert_entry(cache, key, cache->rules_hash, cache->clock++, content_length,
+                          (uint32_t)result->result_count, hits);
+    if (ok) {
+        cache->stats.stores++;
+        cache->dirty = 1;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    if (hits != small_hits) free(hits);
+    return ok;
+}
+
+void result_cache_get_stats(result_cache_t *cache, result_cache_stats_t *stats) {
+    if (!cache || !stats) return;
+
+    pthread_mutex_lock(&cache->lock);
+    *stats = cache->stats;
+    stats->entries = cache->count;
+    pthread_mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,28 @@
+#define _POSIX_C_SOURCE 200809L
+#include "frameworks/framework.h"
+#include <strings.h>
+
+// Compiled-in frameworks, selectable with --framework
+static const framework_definition_t *const builtin_frameworks[] = {
+    &hipaa_framework_definition,
+    &soc2_framework_definition,
+    &pci_dss_framework_definition,
+    &iso27001_framework_definition,
+};
+
+#define BUILTIN_FRAMEWORK_COUNT (sizeof(builtin_frameworks) / sizeof(builtin_frameworks[0]))
+
+const framework_definition_t* framework_find(const char *key) {
+    if (!key) return NULL;
+
+    for (size_t i = 0; i < BUILTIN_FRAMEWORK_COUNT; i++) {
+        if (strcasecmp(builtin_frameworks[i]->key, key) == 0) {
+            return builtin_frameworks[i];
+        }
+    }
+    return NULL;
+}
+
+const framework_definition_t* framework_at(size_t index) {
+    return index < BUILTIN_FRAMEWORK_COUNT ? builtin_frameworks[index] : NULL;
+}
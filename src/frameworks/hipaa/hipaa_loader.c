@@ -1,39 +0,0 @@
-#define _POSIX_C_SOURCE 200809L
-#include "frameworks/hipaa.h"
-#include <stdlib.h>
-#include <string.h>
-
-// Load HIPAA framework from YAML file
-// This is a placeholder implementation
-hipaa_framework_t* hipaa_load_framework(const char *yaml_file) {
-    if (!yaml_file) return NULL;
-    
-    hipaa_framework_t *framework = calloc(1, sizeof(hipaa_framework_t));
-    if (!framework) return NULL;
-    
-    framework->control_capacity = 100;
-    framework->controls = calloc(framework->control_capacity, sizeof(hipaa_control_t));
-    framework->control_count = 0;
-    
-    // TODO: Implement YAML parsing
-    // For now, return empty framework
-    
-    return framework;
-}
-
-// Free HIPAA framework
-void hipaa_free_framework(hipaa_framework_t *framework) {
-    if (!framework) return;
-    
-    if (framework->controls) {
-        for (size_t i = 0; i < framework->control_count; i++) {
-            free(framework->controls[i].id);
-            free(framework->controls[i].name);
-            free(framework->controls[i].description);
-            free(framework->controls[i].category);
-        }
-        free(framework->controls);
-    }
-    
-    free(framework);
-}
\ No newline at end of file
@@ -2,83 +2,107 @@
 #include "frameworks/hipaa.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
 
 // Scan configuration against HIPAA compliance checks
-scan_result_t* hipaa_scan_config(const char *config_data) {
+scan_result_t* hipaa_scan_config(const char *config_data, arena_t *arena) {
     if (!config_data) {
         return NULL;
     }
     
-    // Allocate scan result
-    scan_result_t *result = calloc(1, sizeof(scan_result_t));
-    if (!result) {
+    // Match every check pattern in a single pass over the configuration
+    uint32_t hit_mask = 0;
+    if (!hipaa_match_checks(config_data, strlen(config_data), &hit_mask)) {
         return NULL;
     }
     
-    // Allocate results array (8 checks)
-    result->results = calloc(8, sizeof(check_result_t*));
-    if (!result->results) {
-        free(result);
+    return hipaa_create_scan_result(hit_mask, arena);
+}
+
+// Scan parsed content that has a key/value index
+// Checks are resolved by index lookups first; the text matcher only runs when
+// some check is still open, so content the index cannot see (prose, unusual
+// layouts) is judged exactly as by hipaa_scan_config().
+scan_result_t* hipaa_scan_indexed(const config_t *config, const char *config_data, size_t length,
+                                  arena_t *arena) {
+    if (!config_data) {
         return NULL;
     }
     
-    result->result_count = 0;
-    result->passed_count = 0;
-    result->failed_count = 0;
-    
-    // Check 1: Encryption at Rest
-    int check1 = hipaa_check_encryption_at_rest(config_data);
-    result->results[result->result_count++] = create_hipaa_encryption_result(check1, NULL);
-    if (check1) result->passed_count++; else result->failed_count++;
-    
-    // Check 2: Audit Controls
-    int check2 = hipaa_check_audit_controls(config_data);
-    result->results[result->result_count++] = create_hipaa_audit_result(check2, NULL);
-    if (check2) result->passed_count++; else result->failed_count++;
+    uint32_t hit_mask = 0;
+    if (config && !hipaa_match_index(config, &hit_mask)) {
+        return NULL;
+    }
     
-    // Check 3: Authentication (MFA)
-    int check3 = hipaa_check_authentication(config_data);
-    result->results[result->result_count++] = create_hipaa_mfa_result(check3, NULL);
-    if (check3) result->passed_count++; else result->failed_count++;
+    if (hit_mask != HIPAA_ALL_CHECKS_MASK) {
+        uint32_t text_mask = 0;
+        if (!hipaa_match_checks(config_data, length, &text_mask)) {
+            return NULL;
+        }
+        hit_mask |= text_mask;
+    }
     
-    // Check 4: Encryption in Transit
-    int check4 = hipaa_check_encryption_in_transit(config_data);
-    result->results[result->result_count++] = create_hipaa_transit_encryption_result(check4, NULL);
-    if (check4) result->passed_count++; else result->failed_count++;
+    return hipaa_create_scan_result(hit_mask, arena);
+}
+
+// Feed a stream into a streamed scan in SCAN_STREAM_CHUNK_SIZE pieces
+// Returns 0 on a read error
+static int feed_stream(hipaa_stream_t *stream, FILE *input) {
+    char *chunk = malloc(SCAN_STREAM_CHUNK_SIZE);
+    if (!chunk) {
+        return 0;
+    }
     
-    // Check 5: Unique User ID
-    int check5 = hipaa_check_unique_user_id(config_data);
-    result->results[result->result_count++] = create_hipaa_user_id_result(check5, NULL);
-    if (check5) result->passed_count++; else result->failed_count++;
+    size_t n;
+    while ((n = fread(chunk, 1, SCAN_STREAM_CHUNK_SIZE, input)) > 0) {
+        if (hipaa_stream_feed(stream, chunk, n)) {
+            break;
+        }
+    }
     
-    // Check 6: Data Backup
-    int check6 = hipaa_check_data_backup(config_data);
-    result->results[result->result_count++] = create_hipaa_backup_result(check6, NULL);
-    if (check6) result->passed_count++; else result->failed_count++;
+    free(chunk);
+    return !ferror(input);
+}
+
+// Scan a document read from a stream in fixed-size chunks
+// Memory use is bounded by SCAN_STREAM_CHUNK_SIZE regardless of input size,
+// and reading stops as soon as every check has passed.
+scan_result_t* hipaa_scan_stream(FILE *input, size_t *bytes_scanned) {
+    if (!input) {
+        return NULL;
+    }
     
-    // Check 7: Access Termination
-    int check7 = hipaa_check_access_termination(config_data);
-    result->results[result->result_count++] = create_hipaa_termination_result(check7, NULL);
-    if (check7) result->passed_count++; else result->failed_count++;
+    hipaa_stream_t *stream = hipaa_stream_create();
+    if (!stream) {
+        return NULL;
+    }
     
-    // Check 8: Auto Logoff
-    int check8 = hipaa_check_auto_logoff(config_data);
-    result->results[result->result_count++] = create_hipaa_logoff_result(check8, NULL);
-    if (check8) result->passed_count++; else result->failed_count++;
+    scan_result_t *result = NULL;
+    if (feed_stream(stream, input)) {
+        result = hipaa_create_scan_result(hipaa_stream_hit_mask(stream), NULL);
+    }
+    if (bytes_scanned) {
+        *bytes_scanned = hipaa_stream_bytes(stream);
+    }
     
+    hipaa_stream_free(stream);
     return result;
 }
 
-// Free scan result
-void free_scan_result(scan_result_t *result) {
-    if (!result) return;
+// Build the per-check results from a hipaa_match_checks() hit mask
+// The only allocation is the scan result itself; check metadata is static.
+scan_result_t* hipaa_create_scan_result(uint32_t hit_mask, arena_t *arena) {
+    scan_result_t *result = scan_result_alloc(HIPAA_CHECK_COUNT, 0, arena);
+    if (!result) {
+        return NULL;
+    }
     
-    if (result->results) {
-        for (size_t i = 0; i < result->result_count; i++) {
-            free_check_result(result->results[i]);
-        }
-        free(result->results);
+    for (unsigned int check = 0; check < HIPAA_CHECK_COUNT; check++) {
+        int passed = (hit_mask >> check) & 1u;
+        check_result_init(&result->results[result->result_count++],
+                          hipaa_check_info((hipaa_check_id_t)check), passed);
+        if (passed) result->passed_count++; else result->failed_count++;
     }
     
-    free(result);
-}
\ No newline at end of file
+    return result;
+}
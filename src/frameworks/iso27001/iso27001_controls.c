@@ -0,0 +1,176 @@
+#define _POSIX_C_SOURCE 200809L
+#include "frameworks/framework.h"
+
+// ==================== ISO/IEC 27001 Controls ====================
+// Technological and organizational controls of ISO/IEC 27001:2022 Annex A
+// that show up in configuration. As with the HIPAA checks, a control passes
+// when any of its patterns occurs in the configuration.
+
+typedef enum {
+    ISO_ACCESS_CONTROL = 0,
+    ISO_ACCESS_RIGHTS,
+    ISO_AUTHENTICATION,
+    ISO_MALWARE,
+    ISO_VULNERABILITIES,
+    ISO_BACKUP,
+    ISO_LOGGING,
+    ISO_MONITORING,
+    ISO_CRYPTOGRAPHY,
+    ISO_CHANGE_MANAGEMENT,
+    ISO_CONTROL_COUNT
+} iso27001_control_id_t;
+
+static const char *const access_control_patterns[] = {
+    "access_control: enabled",
+    "rbac: enabled",
+    "role_based_access: true",
+    "least_privilege: true",
+    NULL
+};
+
+static const char *const access_rights_patterns[] = {
+    "access_review: enabled",
+    "access_termination: automated",
+    "offboarding: enabled",
+    "account_lifecycle: managed",
+    NULL
+};
+
+static const char *const authentication_patterns[] = {
+    "mfa_enabled: true",
+    "multi_factor: true",
+    "require_mfa: true",
+    "mfa: enforced",
+    NULL
+};
+
+static const char *const malware_patterns[] = {
+    "antivirus: enabled",
+    "anti_malware: enabled",
+    "endpoint_protection: enabled",
+    NULL
+};
+
+static const char *const vulnerabilities_patterns[] = {
+    "vulnerability_scanning: enabled",
+    "patch_management: enabled",
+    "auto_patching: enabled",
+    NULL
+};
+
+static const char *const backup_patterns[] = {
+    "backup: enabled",
+    "backup_enabled: true",
+    "automated_backup: true",
+    NULL
+};
+
+static const char *const logging_patterns[] = {
+    "audit_log: enabled",
+    "audit_enabled: true",
+    "logging: true",
+    "cloudtrail: enabled",
+    NULL
+};
+
+static const char *const monitoring_patterns[] = {
+    "monitoring: enabled",
+    "alerting: enabled",
+    "siem_enabled: true",
+    NULL
+};
+
+static const char *const cryptography_patterns[] = {
+    "encryption: enabled",
+    "encrypt_at_rest: true",
+    "encrypted: true",
+    "kms_key_id:",
+    NULL
+};
+
+static const char *const change_management_patterns[] = {
+    "change_management: enabled",
+    "change_approval: required",
+    "code_review: required",
+    NULL
+};
+
+static const char *const *const iso27001_patterns[ISO_CONTROL_COUNT] = {
+    [ISO_ACCESS_CONTROL]    = access_control_patterns,
+    [ISO_ACCESS_RIGHTS]     = access_rights_patterns,
+    [ISO_AUTHENTICATION]    = authentication_patterns,
+    [ISO_MALWARE]           = malware_patterns,
+    [ISO_VULNERABILITIES]   = vulnerabilities_patterns,
+    [ISO_BACKUP]            = backup_patterns,
+    [ISO_LOGGING]           = logging_patterns,
+    [ISO_MONITORING]        = monitoring_patterns,
+    [ISO_CRYPTOGRAPHY]      = cryptography_patterns,
+    [ISO_CHANGE_MANAGEMENT] = change_management_patterns,
+};
+
+static const control_info_t iso27001_controls[ISO_CONTROL_COUNT] = {
+    [ISO_ACCESS_CONTROL] = {
+        "A.5.15", "Access Control", "HIGH",
+        "Access control rules are enforced",
+        "Access control rules are NOT enforced",
+        "Enforce role-based, least-privilege access to information and assets"
+    },
+    [ISO_ACCESS_RIGHTS] = {
+        "A.5.18", "Access Rights", "MEDIUM",
+        "Access rights are reviewed and revoked",
+        "Access rights are NOT reviewed or revoked",
+        "Review access rights regularly and revoke them when people leave"
+    },
+    [ISO_AUTHENTICATION] = {
+        "A.8.5", "Secure Authentication", "HIGH",
+        "Multi-factor authentication is enabled",
+        "Multi-factor authentication is NOT enabled",
+        "Require multi-factor authentication for access to information systems"
+    },
+    [ISO_MALWARE] = {
+        "A.8.7", "Protection Against Malware", "MEDIUM",
+        "Malware protection is enabled",
+        "Malware protection is NOT enabled",
+        "Deploy anti-malware or endpoint protection on all endpoints and servers"
+    },
+    [ISO_VULNERABILITIES] = {
+        "A.8.8", "Management of Technical Vulnerabilities", "MEDIUM",
+        "Vulnerabilities are scanned for and patched",
+        "Vulnerability management is NOT configured",
+        "Scan for vulnerabilities and apply patches on a defined schedule"
+    },
+    [ISO_BACKUP] = {
+        "A.8.13", "Information Backup", "HIGH",
+        "Backups are configured",
+        "Backups are NOT configured",
+        "Take regular automated backups and test restoring them"
+    },
+    [ISO_LOGGING] = {
+        "A.8.15", "Logging", "HIGH",
+        "Activity logging is enabled",
+        "Activity logging is NOT enabled",
+        "Log user activities, exceptions and security events, and protect the logs"
+    },
+    [ISO_MONITORING] = {
+        "A.8.16", "Monitoring Activities", "MEDIUM",
+        "Systems are monitored for anomalous behaviour",
+        "Systems are NOT monitored",
+        "Monitor networks and systems for anomalous behaviour and alert on it"
+    },
+    [ISO_CRYPTOGRAPHY] = {
+        "A.8.24", "Use of Cryptography", "HIGH",
+        "Data is encrypted at rest",
+        "Data is NOT encrypted at rest",
+        "Encrypt stored information and manage the keys, for example with a KMS"
+    },
+    [ISO_CHANGE_MANAGEMENT] = {
+        "A.8.32", "Change Management", "MEDIUM",
+        "Changes go through review and approval",
+        "Changes do NOT go through review and approval",
+        "Require review and approval for changes to information processing facilities"
+    },
+};
+
+const framework_definition_t iso27001_framework_definition = {
+    "iso27001", "ISO/IEC 27001", iso27001_controls, iso27001_patterns, ISO_CONTROL_COUNT
+};
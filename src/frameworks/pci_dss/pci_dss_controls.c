@@ -0,0 +1,193 @@
+#define _POSIX_C_SOURCE 200809L
+#include "frameworks/framework.h"
+
+// ==================== PCI DSS Controls ====================
+// Configuration-level requirements of PCI DSS v4.0. As with the HIPAA
+// checks, a control passes when any of its patterns occurs in the
+// configuration.
+
+typedef enum {
+    PCI_NETWORK_CONTROLS = 0,
+    PCI_VENDOR_DEFAULTS,
+    PCI_STORED_DATA,
+    PCI_TRANSMISSION,
+    PCI_ANTI_MALWARE,
+    PCI_PATCHING,
+    PCI_SESSION_TIMEOUT,
+    PCI_MFA,
+    PCI_AUDIT_LOGS,
+    PCI_LOG_RETENTION,
+    PCI_VULNERABILITY_SCANS,
+    PCI_CONTROL_COUNT
+} pci_dss_control_id_t;
+
+static const char *const network_controls_patterns[] = {
+    "firewall: enabled",
+    "network_segmentation: true",
+    "default_deny: true",
+    NULL
+};
+
+static const char *const vendor_defaults_patterns[] = {
+    "default_accounts: disabled",
+    "default_passwords: changed",
+    NULL
+};
+
+static const char *const stored_data_patterns[] = {
+    "encryption: enabled",
+    "encrypt_at_rest: true",
+    "encrypted: true",
+    "kms_key_id:",
+    "tokenization: enabled",
+    NULL
+};
+
+// Only TLS 1.2 and later count as strong cryptography
+static const char *const transmission_patterns[] = {
+    "tls_version: 1.2",
+    "tls_version: 1.3",
+    "https_only: true",
+    "enforce_ssl: true",
+    NULL
+};
+
+static const char *const anti_malware_patterns[] = {
+    "antivirus: enabled",
+    "anti_malware: enabled",
+    "malware_scanning: true",
+    "endpoint_protection: enabled",
+    NULL
+};
+
+static const char *const patching_patterns[] = {
+    "auto_patching: enabled",
+    "patch_management: enabled",
+    "automatic_updates: true",
+    NULL
+};
+
+static const char *const session_timeout_patterns[] = {
+    "auto_logoff: enabled",
+    "session_timeout:",
+    "idle_timeout:",
+    NULL
+};
+
+static const char *const mfa_patterns[] = {
+    "mfa_enabled: true",
+    "multi_factor: true",
+    "require_mfa: true",
+    "2fa_required: true",
+    "mfa: enforced",
+    NULL
+};
+
+static const char *const audit_logs_patterns[] = {
+    "audit_log: enabled",
+    "audit_enabled: true",
+    "cloudtrail: enabled",
+    "logging: true",
+    NULL
+};
+
+static const char *const log_retention_patterns[] = {
+    "log_retention_days:",
+    "log_retention:",
+    "retention_period:",
+    NULL
+};
+
+static const char *const vulnerability_scans_patterns[] = {
+    "vulnerability_scanning: enabled",
+    "vulnerability_scan: enabled",
+    "vuln_scanning: true",
+    NULL
+};
+
+static const char *const *const pci_dss_patterns[PCI_CONTROL_COUNT] = {
+    [PCI_NETWORK_CONTROLS]    = network_controls_patterns,
+    [PCI_VENDOR_DEFAULTS]     = vendor_defaults_patterns,
+    [PCI_STORED_DATA]         = stored_data_patterns,
+    [PCI_TRANSMISSION]        = transmission_patterns,
+    [PCI_ANTI_MALWARE]        = anti_malware_patterns,
+    [PCI_PATCHING]            = patching_patterns,
+    [PCI_SESSION_TIMEOUT]     = session_timeout_patterns,
+    [PCI_MFA]                 = mfa_patterns,
+    [PCI_AUDIT_LOGS]          = audit_logs_patterns,
+    [PCI_LOG_RETENTION]       = log_retention_patterns,
+    [PCI_VULNERABILITY_SCANS] = vulnerability_scans_patterns,
+};
+
+static const control_info_t pci_dss_controls[PCI_CONTROL_COUNT] = {
+    [PCI_NETWORK_CONTROLS] = {
+        "1.2.1", "Network Security Controls", "HIGH",
+        "Network security controls are configured",
+        "Network security controls are NOT configured",
+        "Segment the cardholder data environment and deny traffic by default"
+    },
+    [PCI_VENDOR_DEFAULTS] = {
+        "2.2.2", "Vendor Default Accounts", "HIGH",
+        "Vendor default accounts are disabled",
+        "Vendor default accounts are NOT disabled",
+        "Disable vendor default accounts or change their passwords before use"
+    },
+    [PCI_STORED_DATA] = {
+        "3.5.1", "Stored Account Data Unreadable", "CRITICAL",
+        "Stored account data is encrypted or tokenized",
+        "Stored account data is NOT encrypted or tokenized",
+        "Render stored PAN unreadable with strong encryption or tokenization"
+    },
+    [PCI_TRANSMISSION] = {
+        "4.2.1", "Strong Cryptography in Transit", "CRITICAL",
+        "Account data is sent over TLS 1.2 or higher",
+        "Account data is NOT sent over TLS 1.2 or higher",
+        "Require TLS 1.2 or higher for every transmission of account data"
+    },
+    [PCI_ANTI_MALWARE] = {
+        "5.2.1", "Anti-Malware", "HIGH",
+        "Anti-malware protection is enabled",
+        "Anti-malware protection is NOT enabled",
+        "Deploy anti-malware or endpoint protection on all system components"
+    },
+    [PCI_PATCHING] = {
+        "6.3.3", "Security Patches", "HIGH",
+        "Security patches are applied automatically",
+        "Security patching is NOT configured",
+        "Enable patch management so critical patches are installed within one month"
+    },
+    [PCI_SESSION_TIMEOUT] = {
+        "8.2.8", "Idle Session Timeout", "MEDIUM",
+        "Idle sessions time out",
+        "Idle sessions do NOT time out",
+        "Terminate or lock sessions after at most 15 minutes of inactivity"
+    },
+    [PCI_MFA] = {
+        "8.4.2", "Multi-Factor Authentication", "CRITICAL",
+        "Multi-factor authentication is required",
+        "Multi-factor authentication is NOT required",
+        "Require MFA for all access into the cardholder data environment"
+    },
+    [PCI_AUDIT_LOGS] = {
+        "10.2.1", "Audit Logs", "HIGH",
+        "Audit logging is enabled",
+        "Audit logging is NOT enabled",
+        "Enable audit logs for all system components and cardholder data access"
+    },
+    [PCI_LOG_RETENTION] = {
+        "10.5.1", "Audit Log Retention", "MEDIUM",
+        "Audit log retention is configured",
+        "Audit log retention is NOT configured",
+        "Retain audit logs for at least 12 months, three months immediately available"
+    },
+    [PCI_VULNERABILITY_SCANS] = {
+        "11.3.1", "Internal Vulnerability Scans", "MEDIUM",
+        "Vulnerability scanning is enabled",
+        "Vulnerability scanning is NOT enabled",
+        "Run internal vulnerability scans at least once every three months"
+    },
+};
+
+const framework_definition_t pci_dss_framework_definition = {
+    "pci-dss", "PCI DSS", pci_dss_controls, pci_dss_patterns, PCI_CONTROL_COUNT
+};
@@ -0,0 +1,293 @@
+#define _POSIX_C_SOURCE 200809L
+#include "frameworks/framework.h"
+#include "frameworks/hipaa.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// ==================== Matching ====================
+
+// Single pass of every framework's patterns over the buffer
+int rule_set_match(const rule_set_t *rules, const char *config_data, size_t length,
+                   uint64_t *hits) {
+    if (!rules || !rules->matcher || !config_data || !hits) {
+        return 0;
+    }
+
+    matcher_scan(rules->matcher, config_data, length, hits);
+    return 1;
+}
+
+// Resolve controls with index lookups, skipping those already set in hits
+int rule_set_match_index(const rule_set_t *rules, const config_t *config, uint64_t *hits) {
+    if (!rules || !config || !hits) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < rules->control_count; i++) {
+        if (MATCHER_BIT_IS_SET(hits, i)) {
+            continue;
+        }
+
+        const rule_control_t *control = &rules->controls[i];
+        for (size_t p = 0; p < control->pattern_count; p++) {
+            if (hipaa_index_has_pattern(config, control->patterns[p])) {
+                hits[i / 64] |= 1ull << (i % 64);
+                break;
+            }
+        }
+    }
+
+    return 1;
+}
+
+// Build the per-control results from a hit bitset, split per framework when
+// the rule set has more than one
+scan_result_t* rule_set_create_result(const rule_set_t *rules, const uint64_t *hits,
+                                      arena_t *arena) {
+    if (!rules || !hits) {
+        return NULL;
+    }
+
+    size_t framework_count = rules->framework_count > 1 ? rules->framework_count : 0;
+    scan_result_t *result = scan_result_alloc(rules->control_count, framework_count, arena);
+    if (!result) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < rules->control_count; i++) {
+        int passed = MATCHER_BIT_IS_SET(hits, i);
+        check_result_init(&result->results[result->result_count++], &rules->controls[i].info, passed);
+        if (passed) result->passed_count++; else result->failed_count++;
+    }
+
+    for (size_t f = 0; f < framework_count; f++) {
+        const rule_framework_t *framework = &rules->frameworks[f];
+        framework_result_t *split = &result->frameworks[result->framework_count++];
+        split->name = framework->name;
+        split->first_result = framework->first_control;
+        split->result_count = framework->control_count;
+        for (size_t i = 0; i < framework->control_count; i++) {
+            split->passed_count += result->results[framework->first_control + i].passed;
+        }
+    }
+
+    return result;
+}
+
+// ==================== Scanning ====================
+
+// Scan parsed content with a rule set (NULL = built-in checks)
+// As with hipaa_scan_indexed(), the text pass only runs when the index
+// leaves a control open - and it is one pass for every framework together.
+scan_result_t* rule_set_scan(const rule_set_t *rules, const config_t *config,
+                             const char *config_data, size_t length, arena_t *arena) {
+    if (!rules) {
+        return hipaa_scan_indexed(config, config_data, length, arena);
+    }
+
+    if (!config_data) {
+        return NULL;
+    }
+
+    size_t words = MATCHER_BITSET_WORDS(rules->control_count);
+    uint64_t *hits = arena ? arena_calloc(arena, words ? words : 1, sizeof(uint64_t))
+                           : calloc(words ? words : 1, sizeof(uint64_t));
+    if (!hits) {
+        return NULL;
+    }
+
+    size_t resolved = 0;
+    if (config && rule_set_match_index(rules, config, hits)) {
+        for (size_t w = 0; w < words; w++) {
+            resolved += (size_t)__builtin_popcountll(hits[w]);
+        }
+    }
+
+    // Controls resolved by the index no longer hold up the matcher's early exit
+    if (resolved < rules->control_count && rules->matcher) {
+        matcher_state_t state;
+        matcher_state_init(rules->matcher, &state);
+        state.remaining = state.remaining > resolved ? state.remaining - resolved : 0;
+        matcher_feed(rules->matcher, &state, config_data, length, hits);
+    }
+
+    scan_result_t *result = rule_set_create_result(rules, hits, arena);
+
+    if (!arena) {
+        free(hits);
+    }
+    return result;
+}
+
+// Incremental matching state of a streamed scan
+struct rule_set_stream {
+    const rule_set_t *rules;
+    hipaa_stream_t *hipaa;   // When rules is NULL
+    matcher_state_t state;
+    uint64_t *hits;
+    size_t bytes;
+};
+
+rule_set_stream_t* rule_set_stream_create(const rule_set_t *rules) {
+    if (rules && !rules->matcher) {
+        return NULL;
+    }
+
+    rule_set_stream_t *stream = calloc(1, sizeof(rule_set_stream_t));
+    if (!stream) {
+        return NULL;
+    }
+
+    stream->rules = rules;
+    if (!rules) {
+        stream->hipaa = hipaa_stream_create();
+        if (!stream->hipaa) {
+            free(stream);
+            return NULL;
+        }
+        return stream;
+    }
+
+    size_t words = MATCHER_BITSET_WORDS(rules->control_count);
+    stream->hits = calloc(words ? words : 1, sizeof(uint64_t));
+    if (!stream->hits) {
+        free(stream);
+        return NULL;
+    }
+    matcher_state_init(rules->matcher, &stream->state);
+    return stream;
+}
+
+int rule_set_stream_feed(rule_set_stream_t *stream, const char *data, size_t length) {
+    if (stream->hipaa) {
+        return hipaa_stream_feed(stream->hipaa, data, length);
+    }
+
+    if (stream->state.remaining > 0) {
+        stream->bytes += length;
+        matcher_feed(stream->rules->matcher, &stream->state, data, length, stream->hits);
+    }
+    return stream->state.remaining == 0;
+}
+
+size_t rule_set_stream_bytes(const rule_set_stream_t *stream) {
+    return stream->hipaa ? hipaa_stream_bytes(stream->hipaa) : stream->bytes;
+}
+
+scan_result_t* rule_set_stream_result(const rule_set_stream_t *stream) {
+    if (stream->hipaa) {
+        return hipaa_create_scan_result(hipaa_stream_hit_mask(stream->hipaa), NULL);
+    }
+    return rule_set_create_result(stream->rules, stream->hits, NULL);
+}
+
+void rule_set_stream_free(rule_set_stream_t *stream) {
+    if (!stream) {
+        return;
+    }
+    hipaa_stream_free(stream->hipaa);
+    free(stream->hits);
+    free(stream);
+}
+
+// Streamed scan with a rule set (NULL = built-in checks)
+// Reads SCAN_STREAM_CHUNK_SIZE pieces and stops once every control passed.
+scan_result_t* rule_set_scan_stream(const rule_set_t *rules, FILE *input,
+                                    size_t *bytes_scanned) {
+    if (!rules) {
+        return hipaa_scan_stream(input, bytes_scanned);
+    }
+
+    rule_set_stream_t *stream = input ? rule_set_stream_create(rules) : NULL;
+    char *chunk = stream ? malloc(SCAN_STREAM_CHUNK_SIZE) : NULL;
+    if (!chunk) {
+        rule_set_stream_free(stream);
+        return NULL;
+    }
+
+    size_t n;
+    while ((n = fread(chunk, 1, SCAN_STREAM_CHUNK_SIZE, input)) > 0) {
+        if (rule_set_stream_feed(stream, chunk, n)) {
+            break;
+        }
+    }
+
+    scan_result_t *result = ferror(input) ? NULL : rule_set_stream_result(stream);
+    if (bytes_scanned) {
+        *bytes_scanned = rule_set_stream_bytes(stream);
+    }
+
+    free(chunk);
+    rule_set_stream_free(stream);
+    return result;
+}
+
+// ==================== Results ====================
+
+// Allocate a scan result with room for result_count results and
+// framework_count framework verdicts in the same block
+scan_result_t* scan_result_alloc(size_t result_count, size_t framework_count, arena_t *arena) {
+    size_t size = sizeof(scan_result_t) + result_count * sizeof(check_result_t) +
+                  framework_count * sizeof(framework_result_t);
+    scan_result_t *result = arena ? arena_calloc(arena, 1, size) : calloc(1, size);
+    if (!result) {
+        return NULL;
+    }
+
+    result->results = (check_result_t *)(result + 1);
+    if (framework_count > 0) {
+        result->frameworks = (framework_result_t *)(result->results + result_count);
+    }
+    result->arena = arena;
+    return result;
+}
+
+// Free scan result (arena results go with their arena)
+void free_scan_result(scan_result_t *result) {
+    if (!result || result->arena) return;
+
+    for (size_t i = 0; i < result->result_count; i++) {
+        free(result->results[i].evidence);
+    }
+
+    free(result);
+}
+
+// Fill in a result from control metadata - no allocation
+void check_result_init(check_result_t *result, const control_info_t *info, int passed) {
+    result->passed = passed;
+    result->control_id = info->id;
+    result->control_name = info->name;
+    result->severity = passed ? "INFO" : info->severity;
+    result->details = passed ? info->pass_details : info->fail_details;
+    result->remediation = passed ? NULL : info->remediation;
+    result->evidence = NULL;
+}
+
+// Percentage of passed checks
+double scan_result_score(const scan_result_t *result) {
+    if (!result || result->result_count == 0) return 0.0;
+    return (double)result->passed_count / result->result_count * 100.0;
+}
+
+double framework_result_score(const framework_result_t *framework) {
+    if (!framework || framework->result_count == 0) return 0.0;
+    return (double)framework->passed_count / framework->result_count * 100.0;
+}
+
+// A result passes when every framework in it does
+int scan_result_compliant(const scan_result_t *result) {
+    if (!result) return 0;
+
+    if (result->framework_count == 0) {
+        return scan_result_score(result) >= COMPLIANCE_THRESHOLD;
+    }
+
+    for (size_t i = 0; i < result->framework_count; i++) {
+        if (framework_result_score(&result->frameworks[i]) < COMPLIANCE_THRESHOLD) {
+            return 0;
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,433 @@
+#define _POSIX_C_SOURCE 200809L
+#include "frameworks/framework.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <yaml.h>
+
+// Rules file format:
+//
+//   framework: Acme HIPAA profile
+//   controls:
+//     - id: "164.312(d)"
+//       name: Person or Entity Authentication
+//       category: Technical Safeguards
+//       description: Verify the identity of anyone accessing PHI
+//       severity: CRITICAL          # CRITICAL, HIGH, MEDIUM or LOW (default MEDIUM)
+//       remediation: Enforce MFA for every account
+//       pass_details: MFA is enforced
+//       fail_details: MFA is NOT enforced
+//       patterns:                   # The control passes when any pattern occurs
+//         - "mfa_enabled: true"
+//         - "require_mfa: true"
+//
+// Each rules file becomes one framework of the rule set; compiled-in
+// frameworks are added the same way from their static tables.
+
+static const char *const severity_levels[] = { "CRITICAL", "HIGH", "MEDIUM", "LOW", "INFO" };
+
+// Record the first error
+static void set_error(rule_set_t *rules, const char *format, ...) {
+    if (rules->error_message) return;
+
+    char message[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    rules->error_message = strdup(message);
+}
+
+// ==================== YAML Helpers ====================
+
+static const char* scalar_value(yaml_node_t *node) {
+    if (!node || node->type != YAML_SCALAR_NODE) return NULL;
+    return (const char *)node->data.scalar.value;
+}
+
+// Value node for key in a mapping node, NULL if absent
+static yaml_node_t* mapping_get(yaml_document_t *document, yaml_node_t *mapping, const char *key) {
+    if (!mapping || mapping->type != YAML_MAPPING_NODE) return NULL;
+
+    for (yaml_node_pair_t *pair = mapping->data.mapping.pairs.start;
+         pair < mapping->data.mapping.pairs.top; pair++) {
+        const char *name = scalar_value(yaml_document_get_node(document, pair->key));
+        if (name && strcmp(name, key) == 0) {
+            return yaml_document_get_node(document, pair->value);
+        }
+    }
+    return NULL;
+}
+
+// Copy of a scalar field, NULL if absent or not a scalar
+static char* mapping_strdup(yaml_document_t *document, yaml_node_t *mapping, const char *key) {
+    const char *value = scalar_value(mapping_get(document, mapping, key));
+    return (value && *value) ? strdup(value) : NULL;
+}
+
+// strdup() that passes NULL through
+static char* copy_string(const char *text) {
+    return text ? strdup(text) : NULL;
+}
+
+// ==================== Controls ====================
+
+static void free_control(rule_control_t *control) {
+    free(control->id);
+    free(control->name);
+    free(control->description);
+    free(control->category);
+    free(control->remediation);
+    free(control->pass_details);
+    free(control->fail_details);
+    for (size_t i = 0; i < control->pattern_count; i++) {
+        free(control->patterns[i]);
+    }
+    free(control->patterns);
+}
+
+// Append an empty control, NULL (with error_message set) if out of memory
+static rule_control_t* new_control(rule_set_t *rules) {
+    if (rules->control_count == rules->control_capacity) {
+        size_t new_capacity = rules->control_capacity * 2;
+        rule_control_t *controls = realloc(rules->controls, new_capacity * sizeof(rule_control_t));
+        if (!controls) {
+            set_error(rules, "out of memory");
+            return NULL;
+        }
+        rules->controls = controls;
+        rules->control_capacity = new_capacity;
+    }
+
+    rule_control_t *control = &rules->controls[rules->control_count];
+    memset(control, 0, sizeof(*control));
+    rules->control_count++;
+    return control;
+}
+
+// Ids identify results on their own, so they are unique across frameworks
+static int check_unique_id(rule_set_t *rules, const rule_control_t *control) {
+    for (size_t i = 0; i + 1 < rules->control_count; i++) {
+        if (strcmp(rules->controls[i].id, control->id) == 0) {
+            set_error(rules, "duplicate control id '%s'", control->id);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Fill in missing result details and point the result metadata at the
+// control's strings
+static int finish_control(rule_set_t *rules, rule_control_t *control) {
+    if (!control->pass_details || !control->fail_details) {
+        size_t size = strlen(control->name) + 32;
+        if (!control->pass_details && (control->pass_details = malloc(size))) {
+            snprintf(control->pass_details, size, "%s: requirement met", control->name);
+        }
+        if (!control->fail_details && (control->fail_details = malloc(size))) {
+            snprintf(control->fail_details, size, "%s: requirement NOT met", control->name);
+        }
+        if (!control->pass_details || !control->fail_details) {
+            set_error(rules, "out of memory");
+            return 0;
+        }
+    }
+
+    control->info.id = control->id;
+    control->info.name = control->name;
+    control->info.severity = control->severity;
+    control->info.pass_details = control->pass_details;
+    control->info.fail_details = control->fail_details;
+    control->info.remediation = control->remediation;
+    return 1;
+}
+
+// Read one entry of the controls list, returns 0 (with error_message set) if invalid
+static int load_control(rule_set_t *rules, yaml_document_t *document,
+                        yaml_node_t *node, size_t position) {
+    if (!node || node->type != YAML_MAPPING_NODE) {
+        set_error(rules, "control %zu: expected a mapping", position);
+        return 0;
+    }
+
+    rule_control_t *control = new_control(rules);
+    if (!control) {
+        return 0;
+    }
+
+    control->id = mapping_strdup(document, node, "id");
+    control->name = mapping_strdup(document, node, "name");
+    control->description = mapping_strdup(document, node, "description");
+    control->category = mapping_strdup(document, node, "category");
+    control->remediation = mapping_strdup(document, node, "remediation");
+    control->pass_details = mapping_strdup(document, node, "pass_details");
+    control->fail_details = mapping_strdup(document, node, "fail_details");
+
+    if (!control->id || !control->name) {
+        set_error(rules, "control %zu: 'id' and 'name' are required", position);
+        return 0;
+    }
+
+    if (!check_unique_id(rules, control)) {
+        return 0;
+    }
+
+    // Severity is stored as one of the static level names
+    const char *severity = scalar_value(mapping_get(document, node, "severity"));
+    control->severity = "MEDIUM";
+    if (severity) {
+        control->severity = NULL;
+        for (size_t i = 0; i < sizeof(severity_levels) / sizeof(severity_levels[0]); i++) {
+            if (strcasecmp(severity, severity_levels[i]) == 0) {
+                control->severity = severity_levels[i];
+            }
+        }
+        if (!control->severity) {
+            set_error(rules, "control '%s': unknown severity '%s'", control->id, severity);
+            return 0;
+        }
+    }
+
+    yaml_node_t *patterns = mapping_get(document, node, "patterns");
+    if (!patterns || patterns->type != YAML_SEQUENCE_NODE ||
+        patterns->data.sequence.items.top == patterns->data.sequence.items.start) {
+        set_error(rules, "control '%s': 'patterns' must be a non-empty list", control->id);
+        return 0;
+    }
+
+    size_t pattern_total = (size_t)(patterns->data.sequence.items.top -
+                                    patterns->data.sequence.items.start);
+    control->patterns = calloc(pattern_total, sizeof(char*));
+    if (!control->patterns) {
+        set_error(rules, "out of memory");
+        return 0;
+    }
+
+    for (yaml_node_item_t *item = patterns->data.sequence.items.start;
+         item < patterns->data.sequence.items.top; item++) {
+        const char *pattern = scalar_value(yaml_document_get_node(document, *item));
+        if (!pattern || !*pattern) {
+            set_error(rules, "control '%s': patterns must be non-empty strings", control->id);
+            return 0;
+        }
+
+        control->patterns[control->pattern_count] = strdup(pattern);
+        if (!control->patterns[control->pattern_count]) {
+            set_error(rules, "out of memory");
+            return 0;
+        }
+        control->pattern_count++;
+    }
+
+    return finish_control(rules, control);
+}
+
+// ==================== Frameworks ====================
+
+// Record the controls added since first_control as one framework
+static int add_framework(rule_set_t *rules, const char *name, size_t first_control) {
+    rule_framework_t *frameworks = realloc(rules->frameworks,
+                                           (rules->framework_count + 1) * sizeof(rule_framework_t));
+    if (!frameworks) {
+        set_error(rules, "out of memory");
+        return 0;
+    }
+    rules->frameworks = frameworks;
+
+    rule_framework_t *framework = &rules->frameworks[rules->framework_count];
+    framework->name = strdup(name);
+    framework->first_control = first_control;
+    framework->control_count = rules->control_count - first_control;
+    if (!framework->name) {
+        set_error(rules, "out of memory");
+        return 0;
+    }
+
+    rules->framework_count++;
+    return 1;
+}
+
+// Create an empty rule set
+rule_set_t* rule_set_create(void) {
+    rule_set_t *rules = calloc(1, sizeof(rule_set_t));
+    if (!rules) return NULL;
+
+    rules->control_capacity = 16;
+    rules->controls = calloc(rules->control_capacity, sizeof(rule_control_t));
+    if (!rules->controls) {
+        free(rules);
+        return NULL;
+    }
+
+    return rules;
+}
+
+// Add a compiled-in framework (its strings are copied)
+int rule_set_add_definition(rule_set_t *rules, const framework_definition_t *definition) {
+    if (!rules || !definition || rules->error_message || rules->matcher) return 0;
+
+    size_t first_control = rules->control_count;
+    for (size_t i = 0; i < definition->control_count; i++) {
+        const control_info_t *info = &definition->controls[i];
+        const char *const *patterns = definition->patterns[i];
+
+        rule_control_t *control = new_control(rules);
+        if (!control) {
+            return 0;
+        }
+
+        control->id = copy_string(info->id);
+        control->name = copy_string(info->name);
+        control->remediation = copy_string(info->remediation);
+        control->pass_details = copy_string(info->pass_details);
+        control->fail_details = copy_string(info->fail_details);
+        control->severity = info->severity;
+
+        size_t pattern_total = 0;
+        while (patterns[pattern_total]) pattern_total++;
+        control->patterns = calloc(pattern_total ? pattern_total : 1, sizeof(char*));
+
+        if (!control->id || !control->name || !control->patterns ||
+            (info->remediation && !control->remediation)) {
+            set_error(rules, "out of memory");
+            return 0;
+        }
+
+        if (!check_unique_id(rules, control)) {
+            return 0;
+        }
+
+        for (size_t p = 0; p < pattern_total; p++) {
+            control->patterns[p] = strdup(patterns[p]);
+            if (!control->patterns[p]) {
+                set_error(rules, "out of memory");
+                return 0;
+            }
+            control->pattern_count++;
+        }
+
+        if (!finish_control(rules, control)) {
+            return 0;
+        }
+    }
+
+    return add_framework(rules, definition->name, first_control);
+}
+
+// Add the framework defined in a YAML rules file
+int rule_set_add_file(rule_set_t *rules, const char *yaml_file) {
+    if (!rules || !yaml_file || rules->error_message || rules->matcher) return 0;
+
+    FILE *fp = fopen(yaml_file, "rb");
+    if (!fp) {
+        set_error(rules, "cannot open %s", yaml_file);
+        return 0;
+    }
+
+    yaml_parser_t parser;
+    yaml_document_t document;
+    if (!yaml_parser_initialize(&parser)) {
+        fclose(fp);
+        set_error(rules, "out of memory");
+        return 0;
+    }
+    yaml_parser_set_input_file(&parser, fp);
+
+    if (!yaml_parser_load(&parser, &document)) {
+        set_error(rules, "%s:%zu: %s", yaml_file, parser.problem_mark.line + 1,
+                  parser.problem ? parser.problem : "invalid YAML");
+        yaml_parser_delete(&parser);
+        fclose(fp);
+        return 0;
+    }
+
+    size_t first_control = rules->control_count;
+    yaml_node_t *root = yaml_document_get_root_node(&document);
+    yaml_node_t *controls = mapping_get(&document, root, "controls");
+
+    if (!controls || controls->type != YAML_SEQUENCE_NODE) {
+        set_error(rules, "%s: expected a 'controls' list", yaml_file);
+    } else {
+        size_t position = 1;
+        for (yaml_node_item_t *item = controls->data.sequence.items.start;
+             item < controls->data.sequence.items.top; item++, position++) {
+            if (!load_control(rules, &document, yaml_document_get_node(&document, *item), position)) {
+                break;
+            }
+        }
+
+        if (!rules->error_message && rules->control_count == first_control) {
+            set_error(rules, "%s: no controls defined", yaml_file);
+        }
+    }
+
+    // Unnamed rule sets are known by their file name
+    if (!rules->error_message) {
+        const char *name = scalar_value(mapping_get(&document, root, "framework"));
+        add_framework(rules, name && *name ? name : yaml_file, first_control);
+    }
+
+    yaml_document_delete(&document);
+    yaml_parser_delete(&parser);
+    fclose(fp);
+
+    return rules->error_message == NULL;
+}
+
+// Compile the patterns of every framework into one automaton
+int rule_set_compile(rule_set_t *rules) {
+    if (!rules || rules->error_message || rules->matcher) return 0;
+
+    if (rules->control_count == 0) {
+        set_error(rules, "no controls defined");
+        return 0;
+    }
+
+    rules->matcher = matcher_create();
+    if (!rules->matcher) {
+        set_error(rules, "out of memory");
+        return 0;
+    }
+
+    for (size_t i = 0; i < rules->control_count; i++) {
+        const rule_control_t *control = &rules->controls[i];
+        for (size_t p = 0; p < control->pattern_count; p++) {
+            if (!matcher_add_pattern(rules->matcher, control->patterns[p],
+                                     strlen(control->patterns[p]), (unsigned int)i)) {
+                set_error(rules, "out of memory");
+                return 0;
+            }
+        }
+    }
+
+    if (!matcher_compile(rules->matcher)) {
+        set_error(rules, "failed to compile patterns");
+        return 0;
+    }
+
+    return 1;
+}
+
+// Free a rule set
+void rule_set_free(rule_set_t *rules) {
+    if (!rules) return;
+
+    if (rules->controls) {
+        for (size_t i = 0; i < rules->control_count; i++) {
+            free_control(&rules->controls[i]);
+        }
+        free(rules->controls);
+    }
+
+    for (size_t i = 0; i < rules->framework_count; i++) {
+        free(rules->frameworks[i].name);
+    }
+    free(rules->frameworks);
+
+    matcher_free(rules->matcher);
+    free(rules->error_message);
+    free(rules);
+}
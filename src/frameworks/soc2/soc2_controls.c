@@ -0,0 +1,166 @@
+#define _POSIX_C_SOURCE 200809L
+#include "frameworks/framework.h"
+
+// ==================== SOC 2 Controls ====================
+// Trust Services Criteria (2017) common criteria plus the availability and
+// confidentiality categories. As with the HIPAA checks, a control passes
+// when any of its patterns occurs in the configuration.
+
+typedef enum {
+    SOC2_LOGICAL_ACCESS = 0,
+    SOC2_ACCESS_PROVISIONING,
+    SOC2_EXTERNAL_ACCESS,
+    SOC2_TRANSMISSION,
+    SOC2_MONITORING,
+    SOC2_INCIDENT_RESPONSE,
+    SOC2_CHANGE_MANAGEMENT,
+    SOC2_RECOVERY,
+    SOC2_CONFIDENTIALITY,
+    SOC2_CONTROL_COUNT
+} soc2_control_id_t;
+
+static const char *const logical_access_patterns[] = {
+    "rbac: enabled",
+    "role_based_access: true",
+    "least_privilege: true",
+    "access_control: enabled",
+    NULL
+};
+
+static const char *const access_provisioning_patterns[] = {
+    "access_termination: automated",
+    "offboarding: enabled",
+    "account_lifecycle: managed",
+    "access_review: enabled",
+    NULL
+};
+
+static const char *const external_access_patterns[] = {
+    "mfa_enabled: true",
+    "require_mfa: true",
+    "mfa: enforced",
+    "vpn_required: true",
+    NULL
+};
+
+static const char *const transmission_patterns[] = {
+    "tls: enabled",
+    "ssl_enabled: true",
+    "https_only: true",
+    "enforce_ssl: true",
+    "tls_version: 1.2",
+    "tls_version: 1.3",
+    NULL
+};
+
+static const char *const monitoring_patterns[] = {
+    "monitoring: enabled",
+    "alerting: enabled",
+    "siem_enabled: true",
+    "audit_log: enabled",
+    NULL
+};
+
+static const char *const incident_response_patterns[] = {
+    "incident_response: enabled",
+    "incident_response_plan: true",
+    "on_call: enabled",
+    NULL
+};
+
+static const char *const change_management_patterns[] = {
+    "change_management: enabled",
+    "change_approval: required",
+    "code_review: required",
+    NULL
+};
+
+static const char *const recovery_patterns[] = {
+    "backup: enabled",
+    "backup_enabled: true",
+    "automated_backup: true",
+    "disaster_recovery: enabled",
+    NULL
+};
+
+static const char *const confidentiality_patterns[] = {
+    "encryption: enabled",
+    "encrypt_at_rest: true",
+    "encrypted: true",
+    "kms_key_id:",
+    "data_classification: enabled",
+    NULL
+};
+
+static const char *const *const soc2_patterns[SOC2_CONTROL_COUNT] = {
+    [SOC2_LOGICAL_ACCESS]      = logical_access_patterns,
+    [SOC2_ACCESS_PROVISIONING] = access_provisioning_patterns,
+    [SOC2_EXTERNAL_ACCESS]     = external_access_patterns,
+    [SOC2_TRANSMISSION]        = transmission_patterns,
+    [SOC2_MONITORING]          = monitoring_patterns,
+    [SOC2_INCIDENT_RESPONSE]   = incident_response_patterns,
+    [SOC2_CHANGE_MANAGEMENT]   = change_management_patterns,
+    [SOC2_RECOVERY]            = recovery_patterns,
+    [SOC2_CONFIDENTIALITY]     = confidentiality_patterns,
+};
+
+static const control_info_t soc2_controls[SOC2_CONTROL_COUNT] = {
+    [SOC2_LOGICAL_ACCESS] = {
+        "CC6.1", "Logical Access Security", "HIGH",
+        "Role-based access control is enforced",
+        "Role-based access control is NOT enforced",
+        "Restrict access to information assets with role-based, least-privilege access control"
+    },
+    [SOC2_ACCESS_PROVISIONING] = {
+        "CC6.2", "User Registration and Removal", "MEDIUM",
+        "Access provisioning and removal are managed",
+        "Access provisioning and removal are NOT managed",
+        "Automate account deprovisioning and review user access regularly"
+    },
+    [SOC2_EXTERNAL_ACCESS] = {
+        "CC6.6", "Access From Outside System Boundaries", "CRITICAL",
+        "Remote access requires multi-factor authentication",
+        "Remote access does NOT require multi-factor authentication",
+        "Require MFA or a VPN for every access from outside the system boundary"
+    },
+    [SOC2_TRANSMISSION] = {
+        "CC6.7", "Transmission of Information", "HIGH",
+        "Data in transit is encrypted",
+        "Data in transit is NOT encrypted",
+        "Enable TLS 1.2 or higher for all data transmission"
+    },
+    [SOC2_MONITORING] = {
+        "CC7.2", "System Monitoring", "HIGH",
+        "System components are monitored for anomalies",
+        "System components are NOT monitored",
+        "Enable monitoring and alerting on system components and security events"
+    },
+    [SOC2_INCIDENT_RESPONSE] = {
+        "CC7.4", "Incident Response", "MEDIUM",
+        "An incident response process is configured",
+        "No incident response process is configured",
+        "Define and enable an incident response plan with on-call ownership"
+    },
+    [SOC2_CHANGE_MANAGEMENT] = {
+        "CC8.1", "Change Management", "MEDIUM",
+        "Changes require review and approval",
+        "Changes do NOT require review and approval",
+        "Require review and approval for changes to infrastructure and software"
+    },
+    [SOC2_RECOVERY] = {
+        "A1.2", "Backup and Recovery", "HIGH",
+        "Backup and recovery are configured",
+        "Backup and recovery are NOT configured",
+        "Establish automated backups and a tested disaster recovery plan"
+    },
+    [SOC2_CONFIDENTIALITY] = {
+        "C1.1", "Protection of Confidential Information", "HIGH",
+        "Confidential information is encrypted at rest",
+        "Confidential information is NOT encrypted at rest",
+        "Classify confidential data and encrypt it at rest"
+    },
+};
+
+const framework_definition_t soc2_framework_definition = {
+    "soc2", "SOC 2", soc2_controls, soc2_patterns, SOC2_CONTROL_COUNT
+};
@@ -0,0 +1,413 @@
+#define _POSIX_C_SOURCE 200809L
+#include "complyd.h"
+#include "frameworks/framework.h"
+#include "parsers/file_parsers.h"
+#include "runtime/arena.h"
+#include "runtime/task_runtime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <unistd.h>
+
+struct complyd_context {
+    rule_set_t *rules;              // NULL = built-in HIPAA checks (fast path)
+    const char *framework_name;     // Name reported when results have no split
+    char *error_message;
+    int thread_count;
+    size_t arena_block_size;
+
+    // Scratch arenas not in use by a scan; a scan takes one and gives it
+    // back rewound, so steady-state scanning allocates nothing but results
+    pthread_mutex_t lock;
+    arena_t **spare_arenas;
+    size_t spare_count;
+    size_t spare_capacity;
+};
+
+const char* complyd_version(void) {
+    return COMPLYD_VERSION;
+}
+
+// ==== Context ====
+
+static void context_fail(complyd_context_t *context, const char *format, ...) {
+    if (context->error_message) return;
+
+    char message[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    context->error_message = strdup(message);
+}
+
+static int rules_have_framework(const rule_set_t *rules, const char *name) {
+    for (size_t i = 0; i < rules->framework_count; i++) {
+        if (strcmp(rules->frameworks[i].name, name) == 0) return 1;
+    }
+    return 0;
+}
+
+// Compile the selected frameworks and rules files into one rule set
+static int context_load_rules(complyd_context_t *context, const complyd_options_t *options) {
+    rule_set_t *rules = rule_set_create();
+    if (!rules) {
+        context_fail(context, "Out of memory");
+        return 0;
+    }
+
+    const char *list = options->frameworks;
+    if (!list && options->rules_file_count == 0) {
+        list = hipaa_framework_definition.key;
+    }
+
+    while (list && *list && !rules->error_message) {
+        size_t length = strcspn(list, ",");
+        char key[64];
+        const framework_definition_t *definition = NULL;
+        if (length > 0 && length < sizeof(key)) {
+            memcpy(key, list, length);
+            key[length] = '\0';
+            definition = framework_find(key);
+        }
+        if (!definition) {
+            context_fail(context, "unknown framework '%.*s'", (int)length, list);
+            rule_set_free(rules);
+            return 0;
+        }
+
+        if (!rules_have_framework(rules, definition->name)) {
+            rule_set_add_definition(rules, definition);
+        }
+
+        list += length;
+        if (*list == ',') list++;
+    }
+
+    for (size_t i = 0; i < options->rules_file_count && !rules->error_message; i++) {
+        rule_set_add_file(rules, options->rules_files[i]);
+    }
+
+    if (!rules->error_message && rules->framework_count == 0) {
+        context_fail(context, "no frameworks selected");
+        rule_set_free(rules);
+        return 0;
+    }
+    if (!rules->error_message) {
+        rule_set_compile(rules);
+    }
+    if (rules->error_message) {
+        context_fail(context, "%s", rules->error_message);
+        rule_set_free(rules);
+        return 0;
+    }
+
+    // HIPAA on its own keeps the built-in checks and their index fast path
+    if (rules->framework_count == 1 && options->rules_file_count == 0 &&
+        strcmp(rules->frameworks[0].name, hipaa_framework_definition.name) == 0) {
+        rule_set_free(rules);
+        rules = NULL;
+    }
+
+    context->rules = rules;
+    context->framework_name = rules ? rules->frameworks[0].name : hipaa_framework_definition.name;
+    return 1;
+}
+
+// Create a context with the rules of options (NULL = defaults)
+complyd_context_t* complyd_context_create(const complyd_options_t *options) {
+    complyd_options_t defaults;
+    if (!options) {
+        memset(&defaults, 0, sizeof(defaults));
+        options = &defaults;
+    }
+
+    complyd_context_t *context = calloc(1, sizeof(complyd_context_t));
+    if (!context) return NULL;
+
+    pthread_mutex_init(&context->lock, NULL);
+    context->arena_block_size = options->arena_block_size;
+    context->thread_count = options->thread_count;
+    if (context->thread_count <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        context->thread_count = cpus > 0 ? (int)cpus : 1;
+    }
+
+    context_load_rules(context, options);
+    return context;
+}
+
+const char* complyd_context_error(const complyd_context_t *context) {
+    return context ? context->error_message : "No context";
+}
+
+// Free a context (no scan may still be running on it)
+void complyd_context_free(complyd_context_t *context) {
+    if (!context) return;
+
+    for (size_t i = 0; i < context->spare_count; i++) {
+        arena_destroy(context->spare_arenas[i]);
+    }
+    free(context->spare_arenas);
+    pthread_mutex_destroy(&context->lock);
+    rule_set_free(context->rules);
+    free(context->error_message);
+    free(context);
+}
+
+static arena_t* context_take_arena(complyd_context_t *context) {
+    arena_t *arena = NULL;
+    pthread_mutex_lock(&context->lock);
+    if (context->spare_count > 0) {
+        arena = context->spare_arenas[--context->spare_count];
+    }
+    pthread_mutex_unlock(&context->lock);
+    return arena ? arena : arena_create(context->arena_block_size);
+}
+
+static void context_give_arena(complyd_context_t *context, arena_t *arena) {
+    arena_reset(arena);
+
+    pthread_mutex_lock(&context->lock);
+    if (context->spare_count == context->spare_capacity) {
+        size_t capacity = context->spare_capacity ? context->spare_capacity * 2 : 8;
+        arena_t **grown = realloc(context->spare_arenas, capacity * sizeof(arena_t*));
+        if (grown) {
+            context->spare_arenas = grown;
+            context->spare_capacity = capacity;
+        }
+    }
+    if (context->spare_count < context->spare_capacity) {
+        context->spare_arenas[context->spare_count++] = arena;
+        arena = NULL;
+    }
+    pthread_mutex_unlock(&context->lock);
+
+    arena_destroy(arena);
+}
+
+// ==== Results ====
+
+static complyd_result_t* result_error(const char *message) {
+    size_t length = strlen(message);
+    complyd_result_t *result = calloc(1, sizeof(complyd_result_t) + length + 1);
+    if (!result) return NULL;
+
+    char *copy = (char *)(result + 1);
+    memcpy(copy, message, length + 1);
+    result->error_message = copy;
+    return result;
+}
+
+// Copy a scan result out of its arena into one heap block
+// Only pointers are copied: the strings belong to the context's rules.
+static complyd_result_t* result_copy(const complyd_context_t *context, const scan_result_t *scan) {
+    size_t framework_count = scan->framework_count ? scan->framework_count : 1;
+    complyd_result_t *result = calloc(1, sizeof(complyd_result_t) +
+                                         scan->result_count * sizeof(complyd_check_t) +
+                                         framework_count * sizeof(complyd_framework_verdict_t));
+    if (!result) return NULL;
+
+    complyd_check_t *checks = (complyd_check_t *)(result + 1);
+    complyd_framework_verdict_t *frameworks =
+        (complyd_framework_verdict_t *)(checks + scan->result_count);
+
+    for (size_t f = 0; f < framework_count; f++) {
+        const framework_result_t *split = scan->framework_count ? &scan->frameworks[f] : NULL;
+        size_t first = split ? split->first_result : 0;
+        size_t count = split ? split->result_count : scan->result_count;
+
+        complyd_framework_verdict_t *verdict = &frameworks[f];
+        verdict->name = split ? split->name : context->framework_name;
+        verdict->passed_count = split ? split->passed_count : scan->passed_count;
+        verdict->check_count = count;
+        verdict->score = count ? (double)verdict->passed_count / count * 100.0 : 0.0;
+        verdict->compliant = verdict->score >= COMPLIANCE_THRESHOLD;
+
+        for (size_t i = first; i < first + count; i++) {
+            const check_result_t *check = &scan->results[i];
+            checks[i].control_id = check->control_id;
+            checks[i].control_name = check->control_name;
+            checks[i].framework = verdict->name;
+            checks[i].severity = check->severity;
+            checks[i].details = check->details;
+            checks[i].remediation = check->remediation;
+            checks[i].passed = check->passed;
+        }
+    }
+
+    result->ok = 1;
+    result->compliant = scan_result_compliant(scan);
+    result->score = scan_result_score(scan);
+    result->passed_count = scan->passed_count;
+    result->check_count = scan->result_count;
+    result->checks = checks;
+    result->frameworks = frameworks;
+    result->framework_count = framework_count;
+    return result;
+}
+
+void complyd_result_free(complyd_result_t *result) {
+    free(result);
+}
+
+// ==== Scanning ====
+
+static file_type_t document_file_type(const complyd_document_t *document) {
+    switch (document->format) {
+        case COMPLYD_FORMAT_TEXT:     return FILE_TYPE_TEXT;
+        case COMPLYD_FORMAT_YAML:     return FILE_TYPE_YAML;
+        case COMPLYD_FORMAT_JSON:     return FILE_TYPE_JSON;
+        case COMPLYD_FORMAT_MARKDOWN: return FILE_TYPE_MD;
+        case COMPLYD_FORMAT_PDF:      return FILE_TYPE_PDF;
+        case COMPLYD_FORMAT_AUTO:
+        default:
+            break;
+    }
+
+    if (document->name && strrchr(document->name, '.')) {
+        file_type_t type = detect_file_type(document->name);
+        if (type != FILE_TYPE_UNKNOWN) return type;
+    }
+
+    // No telling extension: sniff the first non-blank byte
+    const char *data = document->data;
+    size_t i = 0;
+    while (i < document->length && strchr(" \t\r\n", data[i])) i++;
+    if (document->length - i >= 5 && memcmp(data + i, "%PDF-", 5) == 0) return FILE_TYPE_PDF;
+    if (i < document->length && (data[i] == '{' || data[i] == '[')) return FILE_TYPE_JSON;
+    return FILE_TYPE_TEXT;
+}
+
+// Parse and scan one document in a scratch arena
+static complyd_result_t* scan_in_arena(complyd_context_t *context, arena_t *arena,
+                                       const complyd_document_t *document) {
+    file_type_t file_type = document_file_type(document);
+
+    arena_mark_t mark = arena_mark(arena);
+    parse_result_t *parse_result = parse_buffer(document->data, document->length,
+                                                file_type, arena);
+
+    complyd_result_t *result;
+    if (!parse_result || !parse_result->success) {
+        result = result_error(parse_result && parse_result->error_message
+                              ? parse_result->error_message : "Unknown error");
+    } else {
+        if (file_type_has_index(file_type)) {
+            parse_result_build_index(parse_result);
+        }
+
+        scan_result_t *scan_result = rule_set_scan(context->rules, parse_result->config,
+                                                   parse_result->content,
+                                                   parse_result->content_length, arena);
+        result = scan_result ? result_copy(context, scan_result) : result_error("Scan failed");
+        free_scan_result(scan_result);
+    }
+
+    free_parse_result(parse_result);
+    arena_rewind(arena, mark);
+    return result;
+}
+
+complyd_result_t* complyd_scan_document(complyd_context_t *context,
+                                        const complyd_document_t *document) {
+    if (!context || context->error_message || !document) {
+        return NULL;
+    }
+    if (!document->data && document->length > 0) {
+        return result_error("No document data");
+    }
+
+    complyd_document_t empty;
+    if (!document->data) {
+        empty = *document;
+        empty.data = "";
+        document = &empty;
+    }
+
+    arena_t *arena = context_take_arena(context);
+    if (!arena) return NULL;
+
+    complyd_result_t *result = scan_in_arena(context, arena, document);
+    context_give_arena(context, arena);
+    return result;
+}
+
+complyd_result_t* complyd_scan_buffer(complyd_context_t *context, const void *data,
+                                      size_t length, complyd_format_t format) {
+    complyd_document_t document = { NULL, data, length, format };
+    return complyd_scan_document(context, &document);
+}
+
+typedef struct {
+    complyd_context_t *context;
+    const complyd_document_t *document;
+    complyd_result_t **result;
+} scan_task_t;
+
+static void scan_task(void *arg) {
+    scan_task_t *task = arg;
+    *task->result = complyd_scan_document(task->context, task->document);
+}
+
+// Scan a batch of documents, one task per document on a work-stealing runtime
+// Called from inside a runtime (a task of the caller's own), the documents
+// are spawned into that one instead of starting more threads. The workers
+// also split multi-page PDFs by page, so even a single document gets the
+// context's thread_count.
+int complyd_scan_many(complyd_context_t *context, const complyd_document_t *documents,
+                      size_t count, complyd_result_t **results) {
+    if (!results) return 0;
+    memset(results, 0, count * sizeof(complyd_result_t*));
+    if (!context || context->error_message || (!documents && count > 0)) {
+        return 0;
+    }
+
+    int thread_count = context->thread_count;
+    task_runtime_t *runtime = NULL;
+    int owned = 0;
+    if (thread_count >= 2 && count > 0) {
+        runtime = task_runtime_current();
+        if (!runtime) {
+            runtime = task_runtime_create(thread_count);
+            owned = runtime != NULL;
+        }
+    }
+
+    scan_task_t *tasks = runtime ? malloc(count * sizeof(scan_task_t)) : NULL;
+    if (tasks) {
+        task_group_t group;
+        task_group_init(&group);
+        for (size_t i = 0; i < count; i++) {
+            tasks[i].context = context;
+            tasks[i].document = &documents[i];
+            tasks[i].result = &results[i];
+            task_runtime_spawn(runtime, &group, scan_task, &tasks[i]);
+        }
+        task_group_wait(runtime, &group);
+        free(tasks);
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            results[i] = complyd_scan_document(context, &documents[i]);
+        }
+    }
+
+    if (owned) {
+        task_runtime_destroy(runtime);
+    }
+
+    int ok = 1;
+    for (size_t i = 0; i < count; i++) {
+        ok = ok && results[i] != NULL;
+    }
+    if (!ok) {
+        for (size_t i = 0; i < count; i++) {
+            complyd_result_free(results[i]);
+            results[i] = NULL;
+        }
+    }
+    return ok;
+}
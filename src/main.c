@@ -5,23 +5,27 @@
 #include "grc_scanner.h"
 #include "frameworks/hipaa.h"
 #include "parsers/file_parsers.h"
-
-// ANSI color codes for terminal output
-#define COLOR_RESET   "\033[0m"
-#define COLOR_RED     "\033[31m"
-#define COLOR_GREEN   "\033[32m"
-#define COLOR_YELLOW  "\033[33m"
-#define COLOR_BLUE    "\033[34m"
-#define COLOR_MAGENTA "\033[35m"
-#define COLOR_CYAN    "\033[36m"
-#define COLOR_BOLD    "\033[1m"
+#include "parsers/archive_reader.h"
+#include "batch/batch_scan.h"
+#include "cache/result_cache.h"
+#include "watch/watch.h"
+#include "serve/scan_server.h"
+#include "report/reporter.h"
+#include "runtime/scan_stats.h"
+#include <sys/stat.h>
+#include <signal.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
 
 // Print a horizontal line
 void print_line(char c, int length) {
-    for (int i = 0; i < length; i++) {
-        printf("%c", c);
-    }
-    printf("\n");
+    char line[256];
+    if (length < 0) length = 0;
+    if ((size_t)length >= sizeof(line)) length = (int)sizeof(line) - 1;
+    memset(line, c, (size_t)length);
+    line[length] = '\n';
+    fwrite(line, 1, (size_t)length + 1, stdout);
 }
 
 // Print a box header
@@ -57,16 +61,58 @@ void print_check_result(const check_result_t *result) {
 
 // Print usage information
 void print_usage(const char *program_name) {
-    printf("Usage: %s <config-file>\n\n", program_name);
+    printf("Usage: %s [options] <config-file|directory|->...\n\n", program_name);
+    printf("Options:\n");
+    printf("  -j, --jobs N   Scan files with N worker threads (default: CPU count)\n");
+    printf("  --framework L  Check the compiled-in frameworks in the comma-separated\n");
+    printf("                 list L (hipaa, soc2, pci-dss, iso27001; default: hipaa)\n");
+    printf("  -r, --rules F  Check the controls defined in YAML rules file F\n");
+    printf("                 Both options can be repeated and combined; every\n");
+    printf("                 framework is checked in the same pass over each file\n");
+    printf("  --list-frameworks\n");
+    printf("                 List the compiled-in frameworks and exit\n");
+    printf("  --cache DIR    Reuse verdicts of unchanged files from the result cache\n");
+    printf("                 in DIR (created if missing)\n");
+    printf("  --cache-limit N\n");
+    printf("                 Keep at most N cached verdicts, evicting the least\n");
+    printf("                 recently used (default: %d)\n", RESULT_CACHE_DEFAULT_MAX_ENTRIES);
+    printf("  -w, --watch    Keep running after the scan and rescan files as they\n");
+    printf("                 change, printing verdicts that changed\n");
+    printf("  --debounce MS  Wait for MS milliseconds without writes before\n");
+    printf("                 rescanning in watch mode (default: %d)\n", WATCH_DEFAULT_DEBOUNCE_MS);
+    printf("  --serve SOCKET Run as a daemon answering scan requests on the Unix\n");
+    printf("                 socket SOCKET (no paths are given)\n");
+    printf("  -f, --format F Report format: text (default), ndjson (one JSON object\n");
+    printf("                 per file, then a summary) or sarif (SARIF 2.1.0)\n");
+    printf("  --stats        Print time, bytes and operations per pipeline stage and\n");
+    printf("                 file format, verdicts per check and arena allocations\n");
+    printf("                 to stderr when done\n");
+    printf("  --stats-file F Write the same statistics to F in the Prometheus text\n");
+    printf("                 format (for the node exporter's textfile collector)\n");
+    printf("  -h, --help     Show this help message\n\n");
+    printf("A single file is scanned with a detailed report. Several files or\n");
+    printf("directories (searched recursively) are scanned as one batch with an\n");
+    printf("aggregated summary. Use - to stream a text document from stdin.\n\n");
     printf("Supported file formats:\n");
     printf("  - Markdown (.md, .markdown)\n");
     printf("  - JSON (.json)\n");
     printf("  - PDF (.pdf)\n");
-    printf("  - Text/YAML (.txt, .yaml, .yml, .conf, .config)\n\n");
+    printf("  - Text/YAML (.txt, .yaml, .yml, .conf, .config)\n");
+    printf("  - Archives of the above (.tar, .tar.gz, .tgz, .zip), scanned per member\n\n");
     printf("Example:\n");
     printf("  %s config.json\n", program_name);
     printf("  %s security-policy.md\n", program_name);
     printf("  %s compliance-doc.pdf\n", program_name);
+    printf("  %s -j 8 configs/ policies/\n", program_name);
+    printf("  %s release-bundle.tar.gz\n", program_name);
+    printf("  %s --rules org-controls.yaml configs/\n", program_name);
+    printf("  %s --framework hipaa,soc2,pci-dss configs/\n", program_name);
+    printf("  %s --cache ~/.cache/complyd configs/\n", program_name);
+    printf("  %s --format sarif configs/ > complyd.sarif\n", program_name);
+    printf("  %s --stats -j 8 configs/\n", program_name);
+    printf("  %s --watch configs/\n", program_name);
+    printf("  %s --serve /run/complyd.sock\n", program_name);
+    printf("  zcat audit-export.log.gz | %s -\n", program_name);
 }
 
 // Print banner
@@ -83,46 +129,434 @@ void print_banner(void) {
     printf("%s                    Complyd Scanner v1.0%s\n\n", COLOR_BOLD, COLOR_RESET);
 }
 
-int main(int argc, char *argv[]) {
-    print_banner();
+// Collect the files of a batch scan; NULL (after printing why) if there are none
+batch_t* build_batch(char **paths, int path_count,
+                     const rule_set_t *framework, result_cache_t *cache) {
+    batch_t *batch = batch_create();
+    if (!batch) {
+        fprintf(stderr, "%sError: Out of memory%s\n", COLOR_RED, COLOR_RESET);
+        return NULL;
+    }
+    batch->framework = framework;
+    batch->cache = cache;
     
-    // Check command line arguments
-    if (argc < 2) {
-        print_usage(argv[0]);
+    for (int i = 0; i < path_count; i++) {
+        if (!batch_add_path(batch, paths[i])) {
+            fprintf(stderr, "%sWarning: could not read all of %s%s\n",
+                    COLOR_YELLOW, paths[i], COLOR_RESET);
+        }
+    }
+    
+    if (batch->file_count == 0) {
+        fprintf(stderr, "%sError: No supported files found%s\n", COLOR_RED, COLOR_RESET);
+        batch_free(batch);
+        return NULL;
+    }
+    
+    return batch;
+}
+
+// Scan a built batch, reporting each file as it finishes and then the summary
+// Returns the process exit code (0 if every file passed)
+int run_batch_report(batch_t *batch, int thread_count, result_cache_t *cache,
+                     reporter_t *reporter) {
+    if ((size_t)thread_count > batch->file_count) {
+        thread_count = (int)batch->file_count;
+    }
+    
+    reporter_begin(reporter, batch->file_count, thread_count);
+    
+    batch->on_file_done = reporter_file_done;
+    batch->on_file_done_context = reporter;
+    batch_run(batch, thread_count);
+    batch->on_file_done = NULL;
+    batch->on_file_done_context = NULL;
+    
+    reporter_end(reporter, batch, thread_count, cache);
+    
+    return batch->failed_files == 0 && batch->error_files == 0 ? 0 : 1;
+}
+
+// Scan several files/directories in one process and print an aggregated summary
+int scan_batch(char **paths, int path_count, int thread_count,
+               const rule_set_t *framework, result_cache_t *cache,
+               reporter_t *reporter) {
+    batch_t *batch = build_batch(paths, path_count, framework, cache);
+    if (!batch) return 1;
+    
+    int exit_code = run_batch_report(batch, thread_count, cache, reporter);
+    batch_free(batch);
+    return exit_code;
+}
+
+// ==== Long-running modes ====
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void handle_stop_signal(int signal_number) {
+    (void)signal_number;
+    stop_requested = 1;
+}
+
+// Ctrl-C and SIGTERM end watch and serve mode cleanly
+void install_stop_handlers(void) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+}
+
+// Report a verdict that changed while watching; context is the reporter
+void report_watch_update(const batch_file_result_t *file, watch_change_t change,
+                         double elapsed_seconds, void *context) {
+    reporter_update(context, file, change, elapsed_seconds);
+}
+
+// Stream stdin through the matcher and report it as a single text document
+int report_stdin(const rule_set_t *framework, reporter_t *reporter) {
+    batch_t *batch = batch_create();
+    batch_file_result_t file;
+    memset(&file, 0, sizeof(file));
+    file.path = strdup("-");
+    if (!batch || !file.path) {
+        fprintf(stderr, "%sError: Out of memory%s\n", COLOR_RED, COLOR_RESET);
+        batch_free(batch);
+        free(file.path);
+        return 1;
+    }
+    
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    file.file_type = FILE_TYPE_TEXT;
+    scan_span_t span = scan_stats_begin();
+    file.scan_result = rule_set_scan_stream(framework, stdin, &file.content_length);
+    scan_stats_end(span, SCAN_STAGE_SCAN, FILE_TYPE_TEXT, file.content_length);
+    scan_stats_count_checks(file.scan_result);
+    if (file.scan_result) {
+        file.parsed = 1;
+    } else {
+        file.error_message = strdup("Scan failed");
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    
+    reporter_begin(reporter, 1, 1);
+    reporter_file(reporter, &file);
+    batch_put_file(batch, &file);
+    batch_tally(batch);
+    batch->elapsed_seconds = (double)(end.tv_sec - start.tv_sec) +
+                             (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+    reporter_end(reporter, batch, 1, NULL);
+    
+    int exit_code = batch->failed_files == 0 && batch->error_files == 0 ? 0 : 1;
+    batch_free(batch);
+    return exit_code;
+}
+
+// Scan a batch, then keep it up to date as files change until interrupted
+int watch_batch(char **paths, int path_count, int thread_count, int debounce_ms,
+                const rule_set_t *framework, result_cache_t *cache,
+                reporter_t *reporter) {
+    batch_t *batch = build_batch(paths, path_count, framework, cache);
+    if (!batch) return 1;
+    
+    run_batch_report(batch, thread_count, cache, reporter);
+    install_stop_handlers();
+    
+    int text = reporter->format == REPORT_FORMAT_TEXT;
+    if (text) {
+        printf("%sWatching %zu files for changes (Ctrl-C to stop)%s\n\n",
+               COLOR_BOLD, batch->file_count, COLOR_RESET);
+        fflush(stdout);
+    }
+    
+    watch_options_t options = {
+        .debounce_ms = debounce_ms,
+        .thread_count = thread_count,
+        .report = report_watch_update,
+        .context = reporter,
+        .stop = &stop_requested
+    };
+    if (!watch_run(batch, paths, path_count, &options)) {
+        fprintf(stderr, "%sError: cannot watch for changes: %s%s\n",
+                COLOR_RED, strerror(errno), COLOR_RESET);
+        batch_free(batch);
+        return 1;
+    }
+    
+    int all_passed = batch->failed_files == 0 && batch->error_files == 0;
+    if (text) {
+        printf("\n%sStopped watching:%s %zu files, %s%zu passed%s, %s%zu failed%s, %s%zu errors%s\n",
+               COLOR_BOLD, COLOR_RESET, batch->file_count,
+               COLOR_GREEN, batch->passed_files, COLOR_RESET,
+               COLOR_RED, batch->failed_files, COLOR_RESET,
+               COLOR_YELLOW, batch->error_files, COLOR_RESET);
+    }
+    
+    batch_free(batch);
+    return all_passed ? 0 : 1;
+}
+
+// Answer scan requests on a Unix socket until interrupted
+int serve_requests(const char *socket_path, const rule_set_t *framework,
+                   result_cache_t *cache) {
+    install_stop_handlers();
+    
+    printf("%sListening on %s (Ctrl-C to stop)%s\n", COLOR_BOLD, socket_path, COLOR_RESET);
+    fflush(stdout);
+    
+    scan_server_options_t options = {
+        .socket_path = socket_path,
+        .framework = framework,
+        .cache = cache,
+        .max_connections = 0,
+        .stop = &stop_requested
+    };
+    scan_server_stats_t stats;
+    if (!scan_server_run(&options, &stats)) {
+        fprintf(stderr, "%sError: cannot listen on %s: %s%s\n",
+                COLOR_RED, socket_path, strerror(errno), COLOR_RESET);
+        return 1;
+    }
+    
+    printf("\n%sStopped serving:%s %llu requests (%llu failed) on %llu connections",
+           COLOR_BOLD, COLOR_RESET, (unsigned long long)stats.requests,
+           (unsigned long long)stats.errors, (unsigned long long)stats.connections);
+    if (stats.rejected > 0) {
+        printf(", %llu refused", (unsigned long long)stats.rejected);
+    }
+    printf("\n");
+    if (cache) {
+        result_cache_stats_t cache_stats;
+        result_cache_get_stats(cache, &cache_stats);
+        printf("%sCache:%s %llu of %llu requests answered from the cache\n",
+               COLOR_BOLD, COLOR_RESET, (unsigned long long)cache_stats.hits,
+               (unsigned long long)cache_stats.lookups);
+    }
+    return 0;
+}
+
+// Print per-check results and the compliance summary for one document
+// Returns the process exit code (0 if the document passed)
+int print_scan_report(const char *filename, const char *file_type_str,
+                      const scan_result_t *scan_result) {
+    // Every single-document scan ends here, cached or not
+    scan_stats_count_checks(scan_result);
+    scan_span_t span = scan_stats_begin();
+    
+    // Display results, grouped by framework when there are several
+    print_box_header("SCAN RESULTS");
+    
+    if (scan_result->framework_count == 0) {
+        for (size_t i = 0; i < scan_result->result_count; i++) {
+            print_check_result(&scan_result->results[i]);
+        }
+    }
+    for (size_t f = 0; f < scan_result->framework_count; f++) {
+        const framework_result_t *framework = &scan_result->frameworks[f];
+        printf("\n%s%s%s\n", COLOR_BOLD, framework->name, COLOR_RESET);
+        for (size_t i = 0; i < framework->result_count; i++) {
+            print_check_result(&scan_result->results[framework->first_result + i]);
+        }
+    }
+    
+    // Print summary
+    print_box_header("COMPLIANCE SUMMARY");
+    
+    double compliance_score = scan_result_score(scan_result);
+    int compliant = scan_result_compliant(scan_result);
+    
+    printf("\n");
+    printf("  File:            %s%s%s\n", COLOR_BOLD, filename, COLOR_RESET);
+    printf("  File Type:       %s%s%s\n", COLOR_BOLD, file_type_str, COLOR_RESET);
+    printf("  Total Checks:    %s%zu%s\n", COLOR_BOLD, scan_result->result_count, COLOR_RESET);
+    printf("  %sPassed:%s          %s%zu%s\n", 
+           COLOR_GREEN, COLOR_RESET, COLOR_BOLD, scan_result->passed_count, COLOR_RESET);
+    printf("  %sFailed:%s          %s%zu%s\n", 
+           COLOR_RED, COLOR_RESET, COLOR_BOLD, scan_result->failed_count, COLOR_RESET);
+    printf("  Compliance Score: %s%.1f%%%s\n", 
+           compliant ? COLOR_GREEN : COLOR_RED,
+           compliance_score, COLOR_RESET);
+    
+    for (size_t f = 0; f < scan_result->framework_count; f++) {
+        const framework_result_t *framework = &scan_result->frameworks[f];
+        double score = framework_result_score(framework);
+        printf("    %s%5.1f%%%s  %zu/%zu  %s\n",
+               score >= COMPLIANCE_THRESHOLD ? COLOR_GREEN : COLOR_RED, score, COLOR_RESET,
+               framework->passed_count, framework->result_count, framework->name);
+    }
+    
+    printf("\n");
+    
+    const char *requirements = scan_result->framework_count > 0
+                               ? "the requirements of every selected framework"
+                               : "HIPAA compliance requirements";
+    if (compliant) {
+        printf("  %s✓ PASSED - Configuration meets %s%s\n",
+               COLOR_GREEN, requirements, COLOR_RESET);
+    } else {
+        printf("  %s✗ FAILED - Configuration does not meet %s%s\n",
+               COLOR_RED, requirements, COLOR_RESET);
+        printf("  %sPlease review and remediate the failed checks above%s\n",
+               COLOR_YELLOW, COLOR_RESET);
+    }
+    
+    print_line('=', 80);
+    printf("\n");
+    fflush(stdout);
+    scan_stats_end(span, SCAN_STAGE_REPORT, detect_file_type(filename), 0);
+    
+    return compliant ? 0 : 1;
+}
+
+// Title of the checks box - generic once other frameworks are selected
+const char* checks_title(const rule_set_t *framework, int streaming) {
+    if (framework && framework->framework_count > 1) {
+        return streaming ? "RUNNING COMPLIANCE CHECKS (STREAMING)" : "RUNNING COMPLIANCE CHECKS";
+    }
+    return streaming ? "RUNNING HIPAA COMPLIANCE CHECKS (STREAMING)" : "RUNNING HIPAA COMPLIANCE CHECKS";
+}
+
+// Scan a large text document or stdin ("-") in fixed-size chunks, or a large
+// PDF one content stream at a time
+// Nothing is parsed or previewed; memory use stays bounded by the chunk size
+// (for PDFs, the reader's window plus the largest content stream).
+int scan_streamed_file(const char *filename, const rule_set_t *framework) {
+    int use_stdin = strcmp(filename, "-") == 0;
+    const char *display_name = use_stdin ? "<stdin>" : filename;
+    file_type_t file_type = use_stdin ? FILE_TYPE_TEXT : detect_file_type(filename);
+    const char *file_type_str = report_file_type_name(file_type);
+    
+    printf("%sScanning file:%s %s\n", COLOR_BOLD, COLOR_RESET, display_name);
+    printf("%sFile type:%s %s\n", COLOR_BOLD, COLOR_RESET, file_type_str);
+    
+    FILE *input = use_stdin ? stdin : fopen(filename, "rb");
+    if (!input) {
+        fprintf(stderr, "%sError parsing file:%s Failed to read file\n", COLOR_RED, COLOR_RESET);
+        return 1;
+    }
+    
+    print_box_header(checks_title(framework, 1));
+    
+    size_t bytes_scanned = 0;
+    pdf_stream_stats_t pdf_stats;
+    scan_span_t span = scan_stats_begin();
+    scan_result_t *scan_result = batch_stream_scan(framework, file_type, input, &bytes_scanned,
+                                                   &pdf_stats);
+    scan_stats_end(span, SCAN_STAGE_SCAN, file_type, bytes_scanned);
+    if (!use_stdin) {
+        fclose(input);
+    }
+    
+    if (!scan_result) {
+        fprintf(stderr, "%sError: Scan failed%s\n", COLOR_RED, COLOR_RESET);
         return 1;
     }
     
-    const char *filename = argv[1];
+    if (file_type == FILE_TYPE_PDF) {
+        printf("%s✓ Streamed %zu content streams (%zu bytes of text) through a %d KB window%s\n",
+               COLOR_GREEN, pdf_stats.content_streams, bytes_scanned,
+               PDF_STREAM_WINDOW_SIZE / 1024, COLOR_RESET);
+        printf("  Skipped %zu image, font and other streams; %llu bytes seeked over\n",
+               pdf_stats.skipped_streams, (unsigned long long)pdf_stats.bytes_skipped);
+    } else {
+        printf("%s✓ Streamed %zu bytes in %d KB chunks%s\n", COLOR_GREEN, bytes_scanned,
+               SCAN_STREAM_CHUNK_SIZE / 1024, COLOR_RESET);
+    }
     
+    int exit_code = print_scan_report(display_name, file_type_str, scan_result);
+    free_scan_result(scan_result);
+    return exit_code;
+}
+
+// Scan a single file with the detailed report
+typedef struct {
+    const char *filename;
+    arena_t *arena;
+    parse_result_t *result;
+} parse_task_t;
+
+static void parse_task(void *arg) {
+    parse_task_t *task = arg;
+    task->result = parse_file(task->filename, task->arena);
+}
+
+// PDF pages are only extracted in parallel on a runtime - give a lone PDF
+// one worker per CPU for the length of the parse
+static parse_result_t* parse_single_file(const char *filename, file_type_t file_type,
+                                         arena_t *arena) {
+    int cpus = batch_default_thread_count();
+    task_runtime_t *runtime = file_type == FILE_TYPE_PDF && cpus > 1
+                              ? task_runtime_create(cpus) : NULL;
+    if (!runtime) {
+        return parse_file(filename, arena);
+    }
+    
+    parse_task_t task = { filename, arena, NULL };
+    task_group_t group;
+    task_group_init(&group);
+    task_runtime_spawn(runtime, &group, parse_task, &task);
+    task_group_wait(runtime, &group);
+    task_runtime_destroy(runtime);
+    return task.result;
+}
+
+int scan_single_file(const char *filename, const rule_set_t *framework,
+                     result_cache_t *cache) {
     // Detect and display file type
     file_type_t file_type = detect_file_type(filename);
-    const char *file_type_str = "Unknown";
+    const char *file_type_str = report_file_type_name(file_type);
     
-    switch (file_type) {
-        case FILE_TYPE_MD: file_type_str = "Markdown"; break;
-        case FILE_TYPE_JSON: file_type_str = "JSON"; break;
-        case FILE_TYPE_PDF: file_type_str = "PDF"; break;
-        case FILE_TYPE_YAML: file_type_str = "YAML"; break;
-        case FILE_TYPE_TEXT: file_type_str = "Text"; break;
-        default: file_type_str = "Unknown"; break;
+    // Huge documents are not worth a full parse and preview
+    struct stat st;
+    if (strcmp(filename, "-") == 0 ||
+        (stat(filename, &st) == 0 && batch_streams_file(file_type, (size_t)st.st_size))) {
+        return scan_streamed_file(filename, framework);
     }
     
     printf("%sScanning file:%s %s\n", COLOR_BOLD, COLOR_RESET, filename);
     printf("%sFile type:%s %s\n", COLOR_BOLD, COLOR_RESET, file_type_str);
     
-    // Parse the file
+    // Stage throughput is measured against the input size
+    uint64_t file_size = stat(filename, &st) == 0 ? (uint64_t)st.st_size : 0;
+    
+    // An unchanged file is answered from the cache without parsing
+    scan_span_t span = scan_stats_begin();
+    result_cache_key_t cache_key;
+    int keyed = cache && result_cache_key_file(filename, file_type, &cache_key);
+    if (keyed) {
+        size_t content_length = 0;
+        scan_result_t *cached = result_cache_lookup(cache, &cache_key, &content_length);
+        scan_stats_end(span, SCAN_STAGE_CACHE, file_type, file_size);
+        if (cached) {
+            print_box_header(checks_title(framework, 0));
+            printf("%s✓ Unchanged since the last scan - result taken from the cache (%zu bytes)%s\n",
+                   COLOR_GREEN, content_length, COLOR_RESET);
+            
+            int exit_code = print_scan_report(filename, file_type_str, cached);
+            free_scan_result(cached);
+            return exit_code;
+        }
+    }
+    
+    // Parse the file - everything the scan allocates goes into one arena
     print_box_header("PARSING CONFIGURATION FILE");
     
-    parse_result_t *parse_result = parse_file(filename);
+    arena_t *arena = arena_create(0);
+    span = scan_stats_begin();
+    parse_result_t *parse_result = arena ? parse_single_file(filename, file_type, arena) : NULL;
+    scan_stats_end(span, SCAN_STAGE_PARSE, file_type, file_size);
     
     if (!parse_result || !parse_result->success) {
         fprintf(stderr, "%sError parsing file:%s %s\n", 
                 COLOR_RED, COLOR_RESET, 
                 parse_result && parse_result->error_message ? parse_result->error_message : "Unknown error");
         
-        if (parse_result) {
-            free_parse_result(parse_result);
-        }
+        scan_stats_add_arena(arena);
+        arena_destroy(arena);
         return 1;
     }
     
@@ -142,60 +576,395 @@ int main(int argc, char *argv[]) {
     print_line('-', 80);
     
     // Run HIPAA compliance checks
-    print_box_header("RUNNING HIPAA COMPLIANCE CHECKS");
+    print_box_header(checks_title(framework, 0));
+    
+    // Configuration formats are indexed so checks resolve by key lookup
+    if (file_type_has_index(file_type)) {
+        span = scan_stats_begin();
+        parse_result_build_index(parse_result);
+        scan_stats_end(span, SCAN_STAGE_INDEX, file_type, parse_result->content_length);
+    }
     
-    scan_result_t *scan_result = hipaa_scan_config(parse_result->content);
+    span = scan_stats_begin();
+    scan_result_t *scan_result = rule_set_scan(framework, parse_result->config,
+                                                      parse_result->content,
+                                                      parse_result->content_length, arena);
+    scan_stats_end(span, SCAN_STAGE_SCAN, file_type, parse_result->content_length);
     
-    if (!scan_result) {
-        fprintf(stderr, "%sError: Scan failed%s\n", COLOR_RED, COLOR_RESET);
-        free_parse_result(parse_result);
+    if (!scan_result || parse_result_truncated(parse_result)) {
+        fprintf(stderr, "%sError: %s%s\n", COLOR_RED,
+                scan_result ? FILE_TRUNCATED_ERROR : "Scan failed", COLOR_RESET);
+        scan_stats_add_arena(arena);
+        arena_destroy(arena);
         return 1;
     }
     
-    // Display results
-    print_box_header("SCAN RESULTS");
+    if (keyed) {
+        span = scan_stats_begin();
+        result_cache_store(cache, &cache_key, scan_result, parse_result->content_length);
+        scan_stats_end(span, SCAN_STAGE_CACHE, file_type, 0);
+    }
     
-    for (size_t i = 0; i < scan_result->result_count; i++) {
-        print_check_result(scan_result->results[i]);
+    int exit_code = print_scan_report(filename, file_type_str, scan_result);
+    
+    // Cleanup
+    scan_stats_add_arena(arena);
+    arena_destroy(arena);
+    
+    return exit_code;
+}
+
+// A framework selected on the command line: compiled-in or a rules file
+typedef struct {
+    const framework_definition_t *definition;
+    const char *rules_file;
+} rule_source_t;
+
+// Add the frameworks named in a comma-separated list, skipping repeats
+// Returns 0 (after printing why) for an unknown name.
+int select_frameworks(const char *list, rule_source_t *sources, int *source_count) {
+    const char *name = list;
+    while (*name) {
+        size_t length = strcspn(name, ",");
+        char key[64];
+        const framework_definition_t *definition = NULL;
+        if (length > 0 && length < sizeof(key)) {
+            memcpy(key, name, length);
+            key[length] = '\0';
+            definition = framework_find(key);
+        }
+        if (!definition) {
+            fprintf(stderr, "%sError: unknown framework '%.*s' (see --list-frameworks)%s\n",
+                    COLOR_RED, (int)length, name, COLOR_RESET);
+            return 0;
+        }
+        
+        int selected = 0;
+        for (int i = 0; i < *source_count; i++) {
+            selected = selected || sources[i].definition == definition;
+        }
+        if (!selected) {
+            sources[(*source_count)++].definition = definition;
+        }
+        
+        name += length;
+        if (*name == ',') name++;
+    }
+    return 1;
+}
+
+// Compile the selected frameworks into one rule set
+// NULL without an error when only the built-in HIPAA checks are wanted,
+// which keep their dedicated fast path.
+rule_set_t* build_rule_set(const rule_source_t *sources, int source_count, int *failed) {
+    *failed = 0;
+    if (source_count == 0 ||
+        (source_count == 1 && sources[0].definition == &hipaa_framework_definition)) {
+        return NULL;
     }
     
-    // Print summary
-    print_box_header("COMPLIANCE SUMMARY");
+    rule_set_t *rules = rule_set_create();
+    if (!rules) {
+        fprintf(stderr, "%sError loading rules:%s Out of memory\n", COLOR_RED, COLOR_RESET);
+        *failed = 1;
+        return NULL;
+    }
     
-    double compliance_score = scan_result->result_count > 0 
-        ? (double)scan_result->passed_count / scan_result->result_count * 100.0 
-        : 0.0;
+    for (int i = 0; i < source_count && !rules->error_message; i++) {
+        if (sources[i].definition) {
+            rule_set_add_definition(rules, sources[i].definition);
+        } else {
+            rule_set_add_file(rules, sources[i].rules_file);
+        }
+    }
     
-    printf("\n");
-    printf("  File:            %s%s%s\n", COLOR_BOLD, filename, COLOR_RESET);
-    printf("  File Type:       %s%s%s\n", COLOR_BOLD, file_type_str, COLOR_RESET);
-    printf("  Total Checks:    %s%zu%s\n", COLOR_BOLD, scan_result->result_count, COLOR_RESET);
-    printf("  %sPassed:%s          %s%zu%s\n", 
-           COLOR_GREEN, COLOR_RESET, COLOR_BOLD, scan_result->passed_count, COLOR_RESET);
-    printf("  %sFailed:%s          %s%zu%s\n", 
-           COLOR_RED, COLOR_RESET, COLOR_BOLD, scan_result->failed_count, COLOR_RESET);
-    printf("  Compliance Score: %s%.1f%%%s\n", 
-           compliance_score >= 80.0 ? COLOR_GREEN : COLOR_RED,
-           compliance_score, COLOR_RESET);
+    if (!rules->error_message) {
+        rule_set_compile(rules);
+    }
+    if (rules->error_message) {
+        fprintf(stderr, "%sError loading rules:%s %s\n", COLOR_RED, COLOR_RESET,
+                rules->error_message);
+        rule_set_free(rules);
+        *failed = 1;
+        return NULL;
+    }
+    return rules;
+}
+
+// Value of a numeric option; returns 0 unless the whole string is a decimal
+// integer from 1 to max (no sign, spaces, suffix or overflow)
+static long parse_positive(const char *text, long max) {
+    if (*text < '0' || *text > '9') {
+        return 0;
+    }
     
-    printf("\n");
+    char *end;
+    errno = 0;
+    long value = strtol(text, &end, 10);
+    if (*end != '\0' || errno != 0 || value < 1 || value > max) {
+        return 0;
+    }
+    return value;
+}
+
+int main(int argc, char *argv[]) {
+    // Parse command line arguments
+    int thread_count = 0;
+    int path_count = 0;
+    int source_count = 0;
+    const char *cache_dir = NULL;
+    size_t cache_limit = 0;
+    int watch = 0;
+    const char *socket_path = NULL;
+    int debounce_ms = 0;
+    report_format_t format = REPORT_FORMAT_TEXT;
+    int stats = 0;
+    const char *stats_file = NULL;
+    char **paths = calloc(argc > 1 ? (size_t)argc : 1, sizeof(char*));
+    rule_source_t *sources = calloc((size_t)argc + 4, sizeof(rule_source_t));
+    if (!paths || !sources) {
+        fprintf(stderr, "%sError: Out of memory%s\n", COLOR_RED, COLOR_RESET);
+        free(paths);
+        free(sources);
+        return 1;
+    }
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_banner();
+            print_usage(argv[0]);
+            free(sources);
+            free(paths);
+            return 0;
+        } else if (strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) {
+            if (i + 1 >= argc || parse_positive(argv[i + 1], INT_MAX) < 1) {
+                fprintf(stderr, "%sError: %s requires a positive thread count%s\n",
+                        COLOR_RED, argv[i], COLOR_RESET);
+                free(sources);
+                free(paths);
+                return 1;
+            }
+            thread_count = (int)parse_positive(argv[++i], INT_MAX);
+        } else if (strncmp(argv[i], "-j", 2) == 0) {
+            thread_count = (int)parse_positive(argv[i] + 2, INT_MAX);
+            if (thread_count < 1) {
+                fprintf(stderr, "%sError: -j requires a positive thread count%s\n",
+                        COLOR_RED, COLOR_RESET);
+                free(sources);
+                free(paths);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--rules") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%sError: %s requires a rules file%s\n",
+                        COLOR_RED, argv[i], COLOR_RESET);
+                free(sources);
+                free(paths);
+                return 1;
+            }
+            sources[source_count++].rules_file = argv[++i];
+        } else if (strcmp(argv[i], "--framework") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%sError: %s requires a list of frameworks%s\n",
+                        COLOR_RED, argv[i], COLOR_RESET);
+                free(sources);
+                free(paths);
+                return 1;
+            }
+            if (!select_frameworks(argv[++i], sources, &source_count)) {
+                free(sources);
+                free(paths);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--list-frameworks") == 0) {
+            for (size_t f = 0; framework_at(f); f++) {
+                printf("%-10s %s (%zu controls)\n", framework_at(f)->key, framework_at(f)->name,
+                       framework_at(f)->control_count);
+            }
+            free(sources);
+            free(paths);
+            return 0;
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%sError: %s requires a directory%s\n",
+                        COLOR_RED, argv[i], COLOR_RESET);
+                free(sources);
+                free(paths);
+                return 1;
+            }
+            cache_dir = argv[++i];
+        } else if (strcmp(argv[i], "--cache-limit") == 0) {
+            if (i + 1 >= argc || parse_positive(argv[i + 1], LONG_MAX) < 1) {
+                fprintf(stderr, "%sError: %s requires a positive entry count%s\n",
+                        COLOR_RED, argv[i], COLOR_RESET);
+                free(sources);
+                free(paths);
+                return 1;
+            }
+            cache_limit = (size_t)parse_positive(argv[++i], LONG_MAX);
+        } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--watch") == 0) {
+            watch = 1;
+        } else if (strcmp(argv[i], "--serve") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%sError: %s requires a socket path%s\n",
+                        COLOR_RED, argv[i], COLOR_RESET);
+                free(sources);
+                free(paths);
+                return 1;
+            }
+            socket_path = argv[++i];
+        } else if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--format") == 0) {
+            if (i + 1 >= argc || !report_format_from_name(argv[i + 1], &format)) {
+                fprintf(stderr, "%sError: %s requires one of text, ndjson or sarif%s\n",
+                        COLOR_RED, argv[i], COLOR_RESET);
+                free(sources);
+                free(paths);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            stats = 1;
+        } else if (strcmp(argv[i], "--stats-file") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%sError: %s requires a file path%s\n",
+                        COLOR_RED, argv[i], COLOR_RESET);
+                free(sources);
+                free(paths);
+                return 1;
+            }
+            stats_file = argv[++i];
+        } else if (strcmp(argv[i], "--debounce") == 0) {
+            if (i + 1 >= argc || parse_positive(argv[i + 1], INT_MAX) < 1) {
+                fprintf(stderr, "%sError: %s requires a positive number of milliseconds%s\n",
+                        COLOR_RED, argv[i], COLOR_RESET);
+                free(sources);
+                free(paths);
+                return 1;
+            }
+            debounce_ms = (int)parse_positive(argv[++i], INT_MAX);
+        } else {
+            paths[path_count++] = argv[i];
+        }
+    }
+    
+    // Statistics cover everything from here on, rule loading included
+    struct timespec run_start;
+    clock_gettime(CLOCK_MONOTONIC, &run_start);
+    if (stats || stats_file) {
+        scan_stats_enable();
+    }
+    
+    // Machine-readable formats keep stdout free of anything else
+    int text = format == REPORT_FORMAT_TEXT;
+    if (text) {
+        print_banner();
+    }
+    
+    if ((path_count == 0) == (socket_path == NULL) || (socket_path && watch)) {
+        print_usage(argv[0]);
+        free(sources);
+        free(paths);
+        return 1;
+    }
+    
+    if ((socket_path && !text) || (watch && format == REPORT_FORMAT_SARIF)) {
+        fprintf(stderr, "%sError: --format %s cannot be used with %s%s\n", COLOR_RED,
+                format == REPORT_FORMAT_SARIF ? "sarif" : "ndjson",
+                socket_path ? "--serve" : "--watch", COLOR_RESET);
+        free(sources);
+        free(paths);
+        return 1;
+    }
+    
+    for (int i = 0; watch && i < path_count; i++) {
+        if (strcmp(paths[i], "-") == 0) {
+            fprintf(stderr, "%sError: stdin cannot be watched%s\n", COLOR_RED, COLOR_RESET);
+            free(sources);
+            free(paths);
+            return 1;
+        }
+    }
+    
+    // Compile every selected framework into one rule set, once for every file
+    int rules_failed;
+    rule_set_t *framework = build_rule_set(sources, source_count, &rules_failed);
+    free(sources);
+    if (rules_failed) {
+        free(paths);
+        return 1;
+    }
+    for (size_t f = 0; text && framework && f < framework->framework_count; f++) {
+        printf("%sRules:%s %s (%zu controls)\n", COLOR_BOLD, COLOR_RESET,
+               framework->frameworks[f].name, framework->frameworks[f].control_count);
+    }
+    
+    result_cache_t *cache = NULL;
+    if (cache_dir) {
+        cache = result_cache_open(cache_dir, cache_limit, framework);
+        if (!cache || result_cache_error(cache)) {
+            fprintf(stderr, "%sError opening cache:%s %s\n", COLOR_RED, COLOR_RESET,
+                    result_cache_error(cache));
+            result_cache_close(cache);
+            rule_set_free(framework);
+            free(paths);
+            return 1;
+        }
+    }
     
-    if (compliance_score >= 80.0) {
-        printf("  %s✓ PASSED - Configuration meets HIPAA compliance requirements%s\n",
-               COLOR_GREEN, COLOR_RESET);
+    reporter_t *reporter = NULL;
+    if (!socket_path) {
+        reporter = reporter_create(format, stdout, framework);
+        if (!reporter) {
+            fprintf(stderr, "%sError: Out of memory%s\n", COLOR_RED, COLOR_RESET);
+            result_cache_close(cache);
+            rule_set_free(framework);
+            free(paths);
+            return 1;
+        }
+    }
+    
+    // One regular file without -j keeps the detailed single-file report;
+    // other formats report it like a batch of one, as do archives, which
+    // report one record per member
+    struct stat st;
+    int exit_code;
+    int jobs = thread_count > 0 ? thread_count : batch_default_thread_count();
+    if (socket_path) {
+        exit_code = serve_requests(socket_path, framework, cache);
+    } else if (watch) {
+        exit_code = watch_batch(paths, path_count, jobs, debounce_ms, framework, cache, reporter);
+    } else if (path_count == 1 && strcmp(paths[0], "-") == 0 && !text) {
+        exit_code = report_stdin(framework, reporter);
+    } else if (path_count == 1 && thread_count == 0 && text &&
+        (stat(paths[0], &st) != 0 || !S_ISDIR(st.st_mode)) &&
+        archive_format_of(paths[0]) == ARCHIVE_NONE) {
+        exit_code = scan_single_file(paths[0], framework, cache);
     } else {
-        printf("  %s✗ FAILED - Configuration does not meet HIPAA compliance requirements%s\n",
-               COLOR_RED, COLOR_RESET);
-        printf("  %sPlease review and remediate the failed checks above%s\n",
-               COLOR_YELLOW, COLOR_RESET);
+        exit_code = scan_batch(paths, path_count, jobs, framework, cache, reporter);
     }
+    reporter_free(reporter);
     
-    print_line('=', 80);
-    printf("\n");
+    // A cache that cannot be saved only costs the next run its hits
+    if (cache && !result_cache_close(cache)) {
+        fprintf(stderr, "%sWarning: result cache not saved%s\n", COLOR_YELLOW, COLOR_RESET);
+    }
     
-    // Cleanup
-    free_scan_result(scan_result);
-    free_parse_result(parse_result);
+    // Per-check rows name controls of the rule set - report before it goes
+    if (stats || stats_file) {
+        struct timespec run_end;
+        clock_gettime(CLOCK_MONOTONIC, &run_end);
+        double elapsed = (double)(run_end.tv_sec - run_start.tv_sec) +
+                         (double)(run_end.tv_nsec - run_start.tv_nsec) / 1e9;
+        if (stats) {
+            scan_stats_print(stderr, elapsed);
+        }
+        if (stats_file && !scan_stats_write_prometheus(stats_file, elapsed)) {
+            fprintf(stderr, "%sWarning: cannot write statistics to %s: %s%s\n",
+                    COLOR_YELLOW, stats_file, strerror(errno), COLOR_RESET);
+        }
+    }
     
-    return compliance_score >= 80.0 ? 0 : 1;
+    rule_set_free(framework);
+    free(paths);
+    return exit_code;
 }
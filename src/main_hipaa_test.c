@@ -119,7 +119,7 @@ int main(int argc, char *argv[]) {
     // Scan the configuration
     print_box_header("RUNNING HIPAA COMPLIANCE CHECKS");
     
-    scan_result_t *scan_result = hipaa_scan_config(config_data);
+    scan_result_t *scan_result = hipaa_scan_config(config_data, NULL);
     
     if (!scan_result) {
         fprintf(stderr, "%sError: Scan failed%s\n", COLOR_RED, COLOR_RESET);
@@ -131,7 +131,7 @@ int main(int argc, char *argv[]) {
     print_box_header("SCAN RESULTS");
     
     for (size_t i = 0; i < scan_result->result_count; i++) {
-        print_check_result(scan_result->results[i]);
+        print_check_result(&scan_result->results[i]);
     }
     
     // Print summary
@@ -0,0 +1,278 @@
+#define _POSIX_C_SOURCE 200809L
+#include "matcher/literal_search.h"
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LITERAL_SEARCH_X86 1
+#endif
+
+// ==================== Anchor Selection ====================
+// Approximate byte frequency in configuration text (higher = more common).
+// Filtering on the two rarest needle bytes instead of literally the first
+// and last one keeps candidate confirmations rare for needles such as
+// "encryption: enabled", whose first and last bytes are both very common.
+static const uint8_t byte_frequency[256] = {
+    ['\n'] = 200, [' '] = 250, ['"'] = 150, [':'] = 180, ['_'] = 170,
+    [','] = 120, ['.'] = 130, ['-'] = 140, ['/'] = 90, ['#'] = 60,
+    ['{'] = 80, ['}'] = 80, ['['] = 50, [']'] = 50, ['='] = 70,
+    ['0'] = 110, ['1'] = 110, ['2'] = 100, ['3'] = 90, ['4'] = 80,
+    ['5'] = 80, ['6'] = 70, ['7'] = 70, ['8'] = 70, ['9'] = 70,
+    ['e'] = 245, ['t'] = 235, ['a'] = 230, ['o'] = 225, ['i'] = 225,
+    ['n'] = 225, ['s'] = 220, ['r'] = 220, ['h'] = 160, ['l'] = 200,
+    ['d'] = 190, ['c'] = 185, ['u'] = 180, ['m'] = 170, ['f'] = 150,
+    ['p'] = 160, ['g'] = 150, ['w'] = 120, ['y'] = 130, ['b'] = 140,
+    ['v'] = 120, ['k'] = 110, ['x'] = 60, ['j'] = 40, ['q'] = 30,
+    ['z'] = 30, ['E'] = 60, ['T'] = 60, ['A'] = 60, ['S'] = 60,
+};
+
+typedef struct {
+    size_t first;   // Offset of the rarest needle byte
+    size_t second;  // Offset of the next rarest byte, different position
+} search_anchors_t;
+
+static search_anchors_t select_anchors(const char *needle, size_t needle_len) {
+    search_anchors_t anchors = { 0, needle_len - 1 };
+    size_t best = 0;
+
+    for (size_t i = 1; i < needle_len; i++) {
+        if (byte_frequency[(unsigned char)needle[i]] <
+            byte_frequency[(unsigned char)needle[best]]) {
+            best = i;
+        }
+    }
+
+    size_t next = best == 0 ? 1 : 0;
+    for (size_t i = 0; i < needle_len; i++) {
+        if (i == best) continue;
+        // Prefer a different byte value so the two compares filter independently
+        int i_same = needle[i] == needle[best];
+        int next_same = needle[next] == needle[best];
+        if ((next_same && !i_same) ||
+            (i_same == next_same &&
+             byte_frequency[(unsigned char)needle[i]] <
+             byte_frequency[(unsigned char)needle[next]])) {
+            next = i;
+        }
+    }
+
+    anchors.first = best < next ? best : next;
+    anchors.second = best < next ? next : best;
+    return anchors;
+}
+
+// ==================== Scalar Kernel ====================
+// memchr to the next first-byte candidate, then check the last byte before
+// paying for the full comparison
+static const char* search_scalar(const char *haystack, size_t haystack_len,
+                                 const char *needle, size_t needle_len) {
+    if (needle_len == 0) return haystack;
+    if (needle_len > haystack_len) return NULL;
+
+    const char *p = haystack;
+    const char *last_start = haystack + (haystack_len - needle_len);
+    const char first = needle[0];
+    const char last = needle[needle_len - 1];
+
+    while (p <= last_start) {
+        p = memchr(p, first, (size_t)(last_start - p) + 1);
+        if (!p) return NULL;
+
+        if (p[needle_len - 1] == last &&
+            memcmp(p + 1, needle + 1, needle_len > 2 ? needle_len - 2 : 0) == 0) {
+            return p;
+        }
+        p++;
+    }
+
+    return NULL;
+}
+
+// Confirm every candidate flagged in an anchor match mask
+static inline const char* confirm_candidates(const char *block, uint64_t mask,
+                                             const char *needle, size_t needle_len) {
+    while (mask) {
+        int bit = __builtin_ctzll(mask);
+        if (memcmp(block + bit, needle, needle_len) == 0) {
+            return block + bit;
+        }
+        mask &= mask - 1;
+    }
+    return NULL;
+}
+
+#ifdef LITERAL_SEARCH_X86
+
+// ==================== 128-bit Kernel ====================
+__attribute__((target("sse2")))
+static const char* search_sse2(const char *haystack, size_t haystack_len,
+                               const char *needle, size_t needle_len) {
+    if (needle_len < 3 || needle_len > haystack_len) {
+        return search_scalar(haystack, haystack_len, needle, needle_len);
+    }
+
+    search_anchors_t anchors = select_anchors(needle, needle_len);
+    const __m128i first = _mm_set1_epi8(needle[anchors.first]);
+    const __m128i second = _mm_set1_epi8(needle[anchors.second]);
+    size_t i = 0;
+
+    for (; i + needle_len + 16 <= haystack_len + 1; i += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i *)(haystack + i + anchors.first));
+        __m128i block_second = _mm_loadu_si128((const __m128i *)(haystack + i + anchors.second));
+        __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                                   _mm_cmpeq_epi8(second, block_second));
+        uint64_t mask = (uint32_t)_mm_movemask_epi8(eq);
+
+        if (mask) {
+            const char *hit = confirm_candidates(haystack + i, mask, needle, needle_len);
+            if (hit) return hit;
+        }
+    }
+
+    return search_scalar(haystack + i, haystack_len - i, needle, needle_len);
+}
+
+// ==================== 256-bit Kernel ====================
+__attribute__((target("avx2")))
+static const char* search_avx2(const char *haystack, size_t haystack_len,
+                               const char *needle, size_t needle_len) {
+    if (needle_len < 3 || needle_len > haystack_len) {
+        return search_scalar(haystack, haystack_len, needle, needle_len);
+    }
+
+    search_anchors_t anchors = select_anchors(needle, needle_len);
+    const __m256i first = _mm256_set1_epi8(needle[anchors.first]);
+    const __m256i second = _mm256_set1_epi8(needle[anchors.second]);
+    size_t i = 0;
+
+    for (; i + needle_len + 32 <= haystack_len + 1; i += 32) {
+        __m256i block_first = _mm256_loadu_si256((const __m256i *)(haystack + i + anchors.first));
+        __m256i block_second = _mm256_loadu_si256((const __m256i *)(haystack + i + anchors.second));
+        __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first),
+                                      _mm256_cmpeq_epi8(second, block_second));
+        uint64_t mask = (uint32_t)_mm256_movemask_epi8(eq);
+
+        if (mask) {
+            const char *hit = confirm_candidates(haystack + i, mask, needle, needle_len);
+            if (hit) return hit;
+        }
+    }
+
+    return search_scalar(haystack + i, haystack_len - i, needle, needle_len);
+}
+
+// ==================== 512-bit Kernel ====================
+__attribute__((target("avx512f,avx512bw")))
+static const char* search_avx512(const char *haystack, size_t haystack_len,
+                                 const char *needle, size_t needle_len) {
+    if (needle_len < 3 || needle_len > haystack_len) {
+        return search_scalar(haystack, haystack_len, needle, needle_len);
+    }
+
+    search_anchors_t anchors = select_anchors(needle, needle_len);
+    const __m512i first = _mm512_set1_epi8(needle[anchors.first]);
+    const __m512i second = _mm512_set1_epi8(needle[anchors.second]);
+    size_t i = 0;
+
+    for (; i + needle_len + 64 <= haystack_len + 1; i += 64) {
+        __m512i block_first = _mm512_loadu_si512((const void *)(haystack + i + anchors.first));
+        __m512i block_second = _mm512_loadu_si512((const void *)(haystack + i + anchors.second));
+        uint64_t mask = _mm512_cmpeq_epi8_mask(first, block_first) &
+                        _mm512_cmpeq_epi8_mask(second, block_second);
+
+        if (mask) {
+            const char *hit = confirm_candidates(haystack + i, mask, needle, needle_len);
+            if (hit) return hit;
+        }
+    }
+
+    return search_scalar(haystack + i, haystack_len - i, needle, needle_len);
+}
+
+#endif // LITERAL_SEARCH_X86
+
+// ==================== Runtime Dispatch ====================
+
+static literal_search_fn active_kernel = search_scalar;
+static literal_search_level_t active_level = LITERAL_SEARCH_SCALAR;
+static pthread_once_t dispatch_once = PTHREAD_ONCE_INIT;
+
+// Whether the running CPU supports a kernel level
+static int level_supported(literal_search_level_t level) {
+    switch (level) {
+        case LITERAL_SEARCH_SCALAR:
+            return 1;
+#ifdef LITERAL_SEARCH_X86
+        case LITERAL_SEARCH_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case LITERAL_SEARCH_AVX2:
+            return __builtin_cpu_supports("avx2");
+        case LITERAL_SEARCH_AVX512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+        default:
+            return 0;
+    }
+}
+
+// Pick the widest supported kernel (runs once per process)
+static void select_kernel(void) {
+#ifdef LITERAL_SEARCH_X86
+    __builtin_cpu_init();
+#endif
+    for (int level = LITERAL_SEARCH_LEVEL_COUNT - 1; level > LITERAL_SEARCH_SCALAR; level--) {
+        literal_search_fn kernel = literal_search_kernel((literal_search_level_t)level);
+        if (kernel) {
+            active_kernel = kernel;
+            active_level = (literal_search_level_t)level;
+            return;
+        }
+    }
+}
+
+// Kernel for a given level, or NULL if the CPU cannot run it
+literal_search_fn literal_search_kernel(literal_search_level_t level) {
+    if (!level_supported(level)) {
+        return NULL;
+    }
+
+    switch (level) {
+        case LITERAL_SEARCH_SCALAR: return search_scalar;
+#ifdef LITERAL_SEARCH_X86
+        case LITERAL_SEARCH_SSE2: return search_sse2;
+        case LITERAL_SEARCH_AVX2: return search_avx2;
+        case LITERAL_SEARCH_AVX512: return search_avx512;
+#endif
+        default: return NULL;
+    }
+}
+
+// Level selected for this process
+literal_search_level_t literal_search_active_level(void) {
+    pthread_once(&dispatch_once, select_kernel);
+    return active_level;
+}
+
+// Human-readable kernel name
+const char* literal_search_level_name(literal_search_level_t level) {
+    switch (level) {
+        case LITERAL_SEARCH_SCALAR: return "scalar";
+        case LITERAL_SEARCH_SSE2: return "sse2";
+        case LITERAL_SEARCH_AVX2: return "avx2";
+        case LITERAL_SEARCH_AVX512: return "avx512";
+        default: return "unknown";
+    }
+}
+
+// Find the first occurrence of needle in haystack
+const char* literal_search(const char *haystack, size_t haystack_len,
+                           const char *needle, size_t needle_len) {
+    if (!haystack || !needle) {
+        return NULL;
+    }
+
+    pthread_once(&dispatch_once, select_kernel);
+    return active_kernel(haystack, haystack_len, needle, needle_len);
+}
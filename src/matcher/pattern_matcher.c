@@ -0,0 +1,348 @@
+#define _POSIX_C_SOURCE 200809L
+#include "matcher/pattern_matcher.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+// Aho-Corasick automaton over byte equivalence classes
+//
+// Bytes that never occur in any pattern share class 0, so each node only
+// needs one transition per distinct pattern byte. After compilation the
+// goto/failure functions are folded into a dense DFA table, making the scan
+// loop a single table lookup per input byte. Table entries hold the row
+// offset of the target node (node * class_count) and are stored negated when
+// the target node emits matches, so the common no-match path needs no extra
+// memory access.
+
+typedef struct {
+    char *bytes;
+    size_t length;
+    unsigned int id;
+} matcher_pattern_t;
+
+typedef struct {
+    unsigned int id;
+    int32_t next;           // Next output entry for the same node, -1 = end
+} matcher_output_t;
+
+struct pattern_matcher {
+    // Build-time pattern list
+    matcher_pattern_t *patterns;
+    size_t pattern_count;
+    size_t pattern_capacity;
+    size_t id_count;
+    size_t distinct_ids;
+    size_t max_pattern_length;
+
+    // Compiled automaton
+    int compiled;
+    uint8_t byte_class[256];
+    size_t class_count;
+    size_t node_count;
+    int32_t *delta;         // node_count * class_count transitions
+    int32_t *node_output;   // Head of each node's output chain, -1 = none
+    matcher_output_t *outputs;
+};
+
+// Create an empty matcher
+pattern_matcher_t* matcher_create(void) {
+    pattern_matcher_t *matcher = calloc(1, sizeof(pattern_matcher_t));
+    if (!matcher) {
+        return NULL;
+    }
+
+    matcher->pattern_capacity = 16;
+    matcher->patterns = calloc(matcher->pattern_capacity, sizeof(matcher_pattern_t));
+    if (!matcher->patterns) {
+        free(matcher);
+        return NULL;
+    }
+
+    return matcher;
+}
+
+// Add a literal pattern reported under the given id
+int matcher_add_pattern(pattern_matcher_t *matcher, const char *pattern,
+                        size_t length, unsigned int id) {
+    if (!matcher || !pattern || length == 0 || matcher->compiled) {
+        return 0;
+    }
+
+    if (matcher->pattern_count >= matcher->pattern_capacity) {
+        size_t new_capacity = matcher->pattern_capacity * 2;
+        matcher_pattern_t *grown = realloc(matcher->patterns,
+                                           new_capacity * sizeof(matcher_pattern_t));
+        if (!grown) {
+            return 0;
+        }
+        matcher->patterns = grown;
+        matcher->pattern_capacity = new_capacity;
+    }
+
+    char *copy = malloc(length);
+    if (!copy) {
+        return 0;
+    }
+    memcpy(copy, pattern, length);
+
+    matcher_pattern_t *entry = &matcher->patterns[matcher->pattern_count++];
+    entry->bytes = copy;
+    entry->length = length;
+    entry->id = id;
+
+    if ((size_t)id + 1 > matcher->id_count) {
+        matcher->id_count = (size_t)id + 1;
+    }
+    if (length > matcher->max_pattern_length) {
+        matcher->max_pattern_length = length;
+    }
+
+    return 1;
+}
+
+// Release the build-time pattern copies
+static void free_patterns(pattern_matcher_t *matcher) {
+    for (size_t i = 0; i < matcher->pattern_count; i++) {
+        free(matcher->patterns[i].bytes);
+    }
+    free(matcher->patterns);
+    matcher->patterns = NULL;
+}
+
+// Build the trie, failure links and dense transition table
+int matcher_compile(pattern_matcher_t *matcher) {
+    if (!matcher || matcher->compiled || matcher->pattern_count == 0) {
+        return 0;
+    }
+
+    // Count the distinct ids so a scan can stop once all of them matched
+    uint64_t *seen = calloc(MATCHER_BITSET_WORDS(matcher->id_count), sizeof(uint64_t));
+    if (!seen) {
+        return 0;
+    }
+    size_t distinct_ids = 0;
+    for (size_t i = 0; i < matcher->pattern_count; i++) {
+        unsigned int id = matcher->patterns[i].id;
+        if (!MATCHER_BIT_IS_SET(seen, id)) {
+            seen[id / 64] |= (uint64_t)1 << (id % 64);
+            distinct_ids++;
+        }
+    }
+    free(seen);
+
+    // Assign byte equivalence classes
+    memset(matcher->byte_class, 0, sizeof(matcher->byte_class));
+    size_t class_count = 1;
+    size_t max_nodes = 1;
+    for (size_t i = 0; i < matcher->pattern_count; i++) {
+        const matcher_pattern_t *p = &matcher->patterns[i];
+        for (size_t j = 0; j < p->length; j++) {
+            unsigned char c = (unsigned char)p->bytes[j];
+            if (matcher->byte_class[c] == 0) {
+                matcher->byte_class[c] = (uint8_t)class_count++;
+            }
+        }
+        max_nodes += p->length;
+    }
+
+    if (max_nodes > (size_t)INT32_MAX / class_count) {
+        return 0;
+    }
+
+    int32_t *delta = malloc(max_nodes * class_count * sizeof(int32_t));
+    int32_t *node_output = malloc(max_nodes * sizeof(int32_t));
+    int32_t *fail = calloc(max_nodes, sizeof(int32_t));
+    int32_t *queue = malloc(max_nodes * sizeof(int32_t));
+    matcher_output_t *outputs = malloc(matcher->pattern_count * sizeof(matcher_output_t));
+
+    if (!delta || !node_output || !fail || !queue || !outputs) {
+        free(delta);
+        free(node_output);
+        free(fail);
+        free(queue);
+        free(outputs);
+        return 0;
+    }
+
+    memset(delta, 0xff, max_nodes * class_count * sizeof(int32_t));
+    memset(node_output, 0xff, max_nodes * sizeof(int32_t));
+
+    // Insert patterns into the trie (delta holds child node ids for now)
+    size_t node_count = 1;
+    for (size_t i = 0; i < matcher->pattern_count; i++) {
+        const matcher_pattern_t *p = &matcher->patterns[i];
+        int32_t node = 0;
+
+        for (size_t j = 0; j < p->length; j++) {
+            size_t slot = (size_t)node * class_count +
+                          matcher->byte_class[(unsigned char)p->bytes[j]];
+            if (delta[slot] < 0) {
+                delta[slot] = (int32_t)node_count++;
+            }
+            node = delta[slot];
+        }
+
+        outputs[i].id = p->id;
+        outputs[i].next = node_output[node];
+        node_output[node] = (int32_t)i;
+    }
+
+    // Breadth-first pass: compute failure links, complete the DFA and chain
+    // each node's outputs onto those of its failure node
+    size_t head = 0;
+    size_t tail = 0;
+
+    for (size_t c = 0; c < class_count; c++) {
+        if (delta[c] < 0) {
+            delta[c] = 0;
+        } else {
+            fail[delta[c]] = 0;
+            queue[tail++] = delta[c];
+        }
+    }
+
+    while (head < tail) {
+        int32_t u = queue[head++];
+
+        for (size_t c = 0; c < class_count; c++) {
+            size_t slot = (size_t)u * class_count + c;
+            int32_t fallback = delta[(size_t)fail[u] * class_count + c];
+
+            if (delta[slot] < 0) {
+                delta[slot] = fallback;
+                continue;
+            }
+
+            int32_t v = delta[slot];
+            fail[v] = fallback;
+
+            if (node_output[v] < 0) {
+                node_output[v] = node_output[fallback];
+            } else {
+                int32_t last = node_output[v];
+                while (outputs[last].next >= 0) {
+                    last = outputs[last].next;
+                }
+                outputs[last].next = node_output[fallback];
+            }
+
+            queue[tail++] = v;
+        }
+    }
+
+    // Convert node ids to row offsets and flag nodes that emit matches
+    for (size_t i = 0; i < node_count * class_count; i++) {
+        int32_t target = delta[i];
+        int32_t row = target * (int32_t)class_count;
+        delta[i] = node_output[target] >= 0 ? -row : row;
+    }
+
+    free(fail);
+    free(queue);
+
+    int32_t *shrunk = realloc(delta, node_count * class_count * sizeof(int32_t));
+    if (shrunk) {
+        delta = shrunk;
+    }
+
+    matcher->delta = delta;
+    matcher->node_output = node_output;
+    matcher->outputs = outputs;
+    matcher->node_count = node_count;
+    matcher->class_count = class_count;
+    matcher->distinct_ids = distinct_ids;
+    matcher->compiled = 1;
+
+    free_patterns(matcher);
+    return 1;
+}
+
+// Free matcher and all automaton tables
+void matcher_free(pattern_matcher_t *matcher) {
+    if (!matcher) return;
+
+    if (matcher->patterns) {
+        free_patterns(matcher);
+    }
+    free(matcher->delta);
+    free(matcher->node_output);
+    free(matcher->outputs);
+    free(matcher);
+}
+
+// Number of ids (highest id + 1) reported by this matcher
+size_t matcher_id_count(const pattern_matcher_t *matcher) {
+    return matcher ? matcher->id_count : 0;
+}
+
+// Length of the longest pattern, i.e. the overlap needed between chunks
+size_t matcher_max_pattern_length(const pattern_matcher_t *matcher) {
+    return matcher ? matcher->max_pattern_length : 0;
+}
+
+// Reset scan state to the automaton root
+// The hit bitset passed to matcher_feed() must be zeroed at the same time.
+void matcher_state_init(const pattern_matcher_t *matcher, matcher_state_t *state) {
+    if (!state) return;
+
+    state->row = 0;
+    state->remaining = matcher ? matcher->distinct_ids : 0;
+}
+
+// Feed the next chunk of input, carrying automaton state across calls
+// Returns 1 once every id has matched (further input cannot change the hits).
+int matcher_feed(const pattern_matcher_t *matcher, matcher_state_t *state,
+                 const char *data, size_t length, uint64_t *hits) {
+    if (!matcher || !matcher->compiled || !state || !hits) {
+        return 0;
+    }
+    if (state->remaining == 0) {
+        return 1;
+    }
+    if (!data) {
+        return 0;
+    }
+
+    const int32_t *delta = matcher->delta;
+    const uint8_t *byte_class = matcher->byte_class;
+    const unsigned char *p = (const unsigned char *)data;
+    const unsigned char *end = p + length;
+    int32_t row = (int32_t)state->row;
+
+    while (p < end) {
+        int32_t next = delta[row + byte_class[*p++]];
+
+        if (next >= 0) {
+            row = next;
+            continue;
+        }
+
+        // Target node emits matches - record every id on its output chain
+        row = -next;
+        int32_t out = matcher->node_output[row / (int32_t)matcher->class_count];
+        while (out >= 0) {
+            unsigned int id = matcher->outputs[out].id;
+            uint64_t bit = (uint64_t)1 << (id % 64);
+
+            if (!(hits[id / 64] & bit)) {
+                hits[id / 64] |= bit;
+                if (--state->remaining == 0) {
+                    state->row = (uint32_t)row;
+                    return 1;
+                }
+            }
+            out = matcher->outputs[out].next;
+        }
+    }
+
+    state->row = (uint32_t)row;
+    return 0;
+}
+
+// Scan a complete buffer in one pass
+void matcher_scan(const pattern_matcher_t *matcher, const char *data,
+                  size_t length, uint64_t *hits) {
+    matcher_state_t state;
+    matcher_state_init(matcher, &state);
+    matcher_feed(matcher, &state, data, length, hits);
+}
@@ -0,0 +1,650 @@
+#define _POSIX_C_SOURCE 200809L
+#include "parsers/archive_reader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#define TAR_BLOCK_SIZE 512
+#define TAR_MAX_EXTENDED_HEADER (64 * 1024)   // GNU long names and pax headers
+#define ARCHIVE_NAME_MAX 4096
+#define ARCHIVE_IO_CHUNK (256 * 1024)
+#define ZIP_EOCD_SIZE 22
+#define ZIP_MAX_COMMENT 65535
+#define ZIP_MAX_CENTRAL_DIRECTORY ((uint64_t)256 * 1024 * 1024)
+
+struct archive_reader {
+    archive_format_t format;
+    const char *error;
+    char name[ARCHIVE_NAME_MAX];
+
+    // Tar: one pass through the (possibly gzip-compressed) stream
+    gzFile gz;
+    uint64_t file_size;      // Size on disk, bounds seeks in plain tar files
+    char *scratch;           // Skipped data of compressed tarballs
+    uint64_t remaining;      // Unread data of the current member
+    uint64_t padding;        // Block padding after it
+    int started;
+
+    // Zip: central directory in memory, members read at their offsets
+    FILE *file;
+    unsigned char *directory;
+    size_t directory_length;
+    size_t directory_pos;
+    uint64_t entries_left;
+    uint64_t local_offset;   // Local header of the current member
+    uint64_t compressed_size;
+    uint64_t size;
+    uint32_t crc;
+    uint16_t method;
+    uint16_t flags;
+};
+
+// ==================== Names ====================
+
+static archive_format_t format_of_name(const char *name, size_t length) {
+    static const struct {
+        const char *suffix;
+        archive_format_t format;
+    } suffixes[] = {
+        { ".tar", ARCHIVE_TAR },
+        { ".tar.gz", ARCHIVE_TAR },
+        { ".tgz", ARCHIVE_TAR },
+        { ".zip", ARCHIVE_ZIP },
+    };
+
+    for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++) {
+        size_t suffix_length = strlen(suffixes[i].suffix);
+        if (length > suffix_length &&
+            strncasecmp(name + length - suffix_length, suffixes[i].suffix, suffix_length) == 0) {
+            return suffixes[i].format;
+        }
+    }
+    return ARCHIVE_NONE;
+}
+
+archive_format_t archive_format_of(const char *filename) {
+    return filename ? format_of_name(filename, strlen(filename)) : ARCHIVE_NONE;
+}
+
+size_t archive_member_prefix(const char *path) {
+    if (!path) return 0;
+
+    const char *p = path;
+    while ((p = strstr(p, ARCHIVE_MEMBER_SEPARATOR)) != NULL) {
+        if (format_of_name(path, (size_t)(p - path)) != ARCHIVE_NONE) {
+            return (size_t)(p - path);
+        }
+        p++;
+    }
+    return 0;
+}
+
+// Store a member name without leading "./" and "/"
+static void set_name(archive_reader_t *reader, const char *name, size_t length) {
+    for (;;) {
+        if (length > 0 && name[0] == '/') {
+            name++;
+            length--;
+        } else if (length > 1 && name[0] == '.' && name[1] == '/') {
+            name += 2;
+            length -= 2;
+        } else {
+            break;
+        }
+    }
+    if (length >= sizeof(reader->name)) length = sizeof(reader->name) - 1;
+    memcpy(reader->name, name, length);
+    reader->name[length] = '\0';
+}
+
+static int fail(archive_reader_t *reader, const char *message) {
+    reader->error = message;
+    return -1;
+}
+
+// ==================== Tar ====================
+
+// Octal field, or base-256 when the high bit of the first byte is set
+static int tar_number(const unsigned char *field, size_t length, uint64_t *value) {
+    uint64_t v = 0;
+    if (field[0] & 0x80) {
+        // The first byte's low bits only fit when the field is short
+        uint64_t high = field[0] & 0x7f;
+        if ((length - 1) * 8 >= 64) {
+            if (high != 0) return 0;
+        } else {
+            v = high;
+        }
+        for (size_t i = 1; i < length; i++) {
+            if (v >> 56) return 0;
+            v = (v << 8) | field[i];
+        }
+        *value = v;
+        return 1;
+    }
+
+    size_t i = 0;
+    while (i < length && field[i] == ' ') i++;
+    for (; i < length && field[i] >= '0' && field[i] <= '7'; i++) {
+        if (v >> 60) return 0;
+        v = (v << 3) | (uint64_t)(field[i] - '0');
+    }
+    *value = v;
+    return 1;
+}
+
+static int tar_checksum_ok(const unsigned char *header) {
+    uint64_t stored;
+    if (!tar_number(header + 148, 8, &stored)) return 0;
+
+    uint64_t unsigned_sum = 0;
+    int64_t signed_sum = 0;
+    for (size_t i = 0; i < TAR_BLOCK_SIZE; i++) {
+        unsigned char c = i >= 148 && i < 156 ? ' ' : header[i];
+        unsigned_sum += c;
+        signed_sum += (signed char)c;
+    }
+    return stored == unsigned_sum || (int64_t)stored == signed_sum;
+}
+
+// Skip length bytes; 0 if the input ends first
+// zlib seeks past the end of a file without complaint, so plain tar files
+// are checked against their size and compressed ones are read through.
+static int tar_skip(archive_reader_t *reader, uint64_t length) {
+    if (length == 0) return 1;
+    if (length > (uint64_t)LONG_MAX) return 0;
+
+    if (gzdirect(reader->gz)) {
+        z_off_t offset = gztell(reader->gz);
+        if (offset < 0 || (uint64_t)offset + length > reader->file_size) return 0;
+        return gzseek(reader->gz, (z_off_t)length, SEEK_CUR) >= 0;
+    }
+
+    if (!reader->scratch && !(reader->scratch = malloc(ARCHIVE_IO_CHUNK))) return 0;
+    while (length > 0) {
+        unsigned chunk = length > ARCHIVE_IO_CHUNK ? ARCHIVE_IO_CHUNK : (unsigned)length;
+        int n = gzread(reader->gz, reader->scratch, chunk);
+        if (n <= 0) return 0;
+        length -= (uint64_t)n;
+    }
+    return 1;
+}
+
+// Read exactly length bytes
+static int tar_read(archive_reader_t *reader, void *data, uint64_t length) {
+    char *out = data;
+    while (length > 0) {
+        unsigned chunk = length > ARCHIVE_IO_CHUNK ? ARCHIVE_IO_CHUNK : (unsigned)length;
+        int n = gzread(reader->gz, out, chunk);
+        if (n <= 0) return 0;
+        out += n;
+        length -= (uint64_t)n;
+    }
+    return 1;
+}
+
+// Data of a GNU long name or pax header, NUL-terminated (caller frees)
+static char* tar_read_extended(archive_reader_t *reader, uint64_t size) {
+    if (size > TAR_MAX_EXTENDED_HEADER) return NULL;
+
+    char *data = malloc((size_t)size + 1);
+    if (!data) return NULL;
+    if (!tar_read(reader, data, size)) {
+        free(data);
+        return NULL;
+    }
+    data[size] = '\0';
+    reader->remaining = 0;
+    return data;
+}
+
+// Apply the "path" and "size" records of a pax header
+static void tar_apply_pax(const char *data, size_t length, char **path, uint64_t *size,
+                          int *has_size) {
+    size_t pos = 0;
+    while (pos < length) {
+        uint64_t record_length = 0;
+        size_t p = pos;
+        while (p < length && data[p] >= '0' && data[p] <= '9') {
+            record_length = record_length * 10 + (uint64_t)(data[p] - '0');
+            p++;
+        }
+        if (record_length == 0 || record_length > length - pos || p >= length || data[p] != ' ') {
+            return;
+        }
+
+        const char *key = data + p + 1;
+        const char *end = data + pos + record_length - 1;   // The record's '\n'
+        const char *equals = memchr(key, '=', (size_t)(end - key));
+        if (equals) {
+            const char *value = equals + 1;
+            size_t key_length = (size_t)(equals - key);
+            if (key_length == 4 && memcmp(key, "path", 4) == 0) {
+                free(*path);
+                *path = strndup(value, (size_t)(end - value));
+            } else if (key_length == 4 && memcmp(key, "size", 4) == 0) {
+                uint64_t v = 0;
+                for (const char *c = value; c < end && *c >= '0' && *c <= '9'; c++) {
+                    v = v * 10 + (uint64_t)(*c - '0');
+                }
+                *size = v;
+                *has_size = 1;
+            }
+        }
+        pos += (size_t)record_length;
+    }
+}
+
+static int tar_next(archive_reader_t *reader, archive_member_t *member) {
+    if (!tar_skip(reader, reader->remaining + reader->padding)) {
+        return fail(reader, "Truncated tar archive");
+    }
+    reader->remaining = reader->padding = 0;
+
+    char *long_name = NULL;
+    uint64_t pax_size = 0;
+    int has_pax_size = 0;
+
+    for (;;) {
+        unsigned char header[TAR_BLOCK_SIZE];
+        int n = gzread(reader->gz, header, TAR_BLOCK_SIZE);
+        int gz_status = Z_OK;
+        gzerror(reader->gz, &gz_status);
+        if (n == 0 && gz_status != Z_OK) {
+            // zlib ends a truncated stream like a complete one
+            free(long_name);
+            return fail(reader, "Truncated compressed archive");
+        }
+        if (n == 0) {
+            // Archives end with zero blocks; running out after a header
+            // means the rest was cut off
+            free(long_name);
+            return fail(reader, reader->started ? "Truncated tar archive" : "Empty archive");
+        }
+        if (n != TAR_BLOCK_SIZE) {
+            free(long_name);
+            return fail(reader, n < 0 ? "Corrupt compressed archive" : "Truncated tar archive");
+        }
+
+        size_t zeros = 0;
+        while (zeros < TAR_BLOCK_SIZE && header[zeros] == 0) zeros++;
+        if (zeros == TAR_BLOCK_SIZE) {
+            free(long_name);
+            return 0;  // End-of-archive marker
+        }
+
+        uint64_t size;
+        if (!tar_checksum_ok(header) || !tar_number(header + 124, 12, &size)) {
+            free(long_name);
+            return fail(reader, reader->started ? "Corrupt tar header" : "Not a tar archive");
+        }
+        reader->started = 1;
+        reader->remaining = size;
+        reader->padding = (TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+
+        char type = (char)header[156];
+        if (type == 'L' || type == 'x') {
+            // Applies to the next header
+            char *data = tar_read_extended(reader, size);
+            if (!data) {
+                free(long_name);
+                return fail(reader, "Corrupt tar extended header");
+            }
+            if (type == 'L') {
+                free(long_name);
+                long_name = data;
+            } else {
+                tar_apply_pax(data, (size_t)size, &long_name, &pax_size, &has_pax_size);
+                free(data);
+            }
+        } else if (type == '0' || type == '\0' || type == '7') {
+            if (long_name) {
+                set_name(reader, long_name, strlen(long_name));
+                free(long_name);
+            } else {
+                // ustar splits long paths into prefix and name
+                char path[256 + 1];
+                size_t length = 0;
+                const char *prefix = (const char *)header + 345;
+                if (memcmp(header + 257, "ustar", 5) == 0 && prefix[0]) {
+                    length = strnlen(prefix, 155);
+                    memcpy(path, prefix, length);
+                    path[length++] = '/';
+                }
+                size_t name_length = strnlen((const char *)header, 100);
+                memcpy(path + length, header, name_length);
+                set_name(reader, path, length + name_length);
+            }
+            if (has_pax_size) {
+                reader->remaining = pax_size;
+                reader->padding = (TAR_BLOCK_SIZE - pax_size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+            }
+
+            member->name = reader->name;
+            member->size = reader->remaining;
+            return 1;
+        } else {
+            // Directories, links, devices and global pax headers
+            free(long_name);
+            long_name = NULL;
+            has_pax_size = 0;
+        }
+
+        if (!tar_skip(reader, reader->remaining + reader->padding)) {
+            free(long_name);
+            return fail(reader, "Truncated tar archive");
+        }
+        reader->remaining = reader->padding = 0;
+    }
+}
+
+static int tar_read_member(archive_reader_t *reader, char *data, const char **error) {
+    uint64_t size = reader->remaining;
+    if (!tar_read(reader, data, size)) {
+        *error = "Truncated archive member";
+        reader->remaining = 0;
+        return 0;
+    }
+    reader->remaining = 0;
+    return 1;
+}
+
+// ==================== Zip ====================
+
+static uint16_t le16(const unsigned char *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t le32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t le64(const unsigned char *p) {
+    return (uint64_t)le32(p) | ((uint64_t)le32(p + 4) << 32);
+}
+
+static int read_at(FILE *file, uint64_t offset, void *data, size_t length) {
+    if (offset > (uint64_t)INT64_MAX || fseeko(file, (off_t)offset, SEEK_SET) != 0) return 0;
+    return fread(data, 1, length, file) == length;
+}
+
+// Locate and load the central directory
+static int zip_open(archive_reader_t *reader) {
+    if (fseeko(reader->file, 0, SEEK_END) != 0) return 0;
+    off_t file_size = ftello(reader->file);
+    if (file_size < ZIP_EOCD_SIZE) return 0;
+
+    size_t tail_length = (uint64_t)file_size < ZIP_EOCD_SIZE + ZIP_MAX_COMMENT
+                         ? (size_t)file_size : ZIP_EOCD_SIZE + ZIP_MAX_COMMENT;
+    uint64_t tail_offset = (uint64_t)file_size - tail_length;
+    unsigned char *tail = malloc(tail_length);
+    if (!tail || !read_at(reader->file, tail_offset, tail, tail_length)) {
+        free(tail);
+        return 0;
+    }
+
+    // End of central directory record, searched from the end past the comment
+    size_t eocd = tail_length - ZIP_EOCD_SIZE + 1;
+    while (eocd-- > 0 && memcmp(tail + eocd, "PK\5\6", 4) != 0) {}
+    if (eocd == (size_t)-1) {
+        free(tail);
+        return 0;
+    }
+
+    uint64_t entries = le16(tail + eocd + 10);
+    uint64_t directory_size = le32(tail + eocd + 12);
+    uint64_t directory_offset = le32(tail + eocd + 16);
+
+    // Zip64 end of central directory, found through its locator
+    if ((entries == 0xffff || directory_size == 0xffffffffu || directory_offset == 0xffffffffu) &&
+        eocd >= 20 && memcmp(tail + eocd - 20, "PK\6\7", 4) == 0) {
+        unsigned char record[56];
+        if (!read_at(reader->file, le64(tail + eocd - 20 + 8), record, sizeof(record)) ||
+            memcmp(record, "PK\6\6", 4) != 0) {
+            free(tail);
+            return 0;
+        }
+        entries = le64(record + 32);
+        directory_size = le64(record + 40);
+        directory_offset = le64(record + 48);
+    }
+    free(tail);
+
+    if (directory_size > ZIP_MAX_CENTRAL_DIRECTORY ||
+        directory_offset + directory_size > (uint64_t)file_size) {
+        return 0;
+    }
+
+    reader->directory = malloc(directory_size ? (size_t)directory_size : 1);
+    if (!reader->directory ||
+        !read_at(reader->file, directory_offset, reader->directory, (size_t)directory_size)) {
+        return 0;
+    }
+    reader->directory_length = (size_t)directory_size;
+    reader->entries_left = entries;
+    return 1;
+}
+
+static int zip_next(archive_reader_t *reader, archive_member_t *member) {
+    while (reader->entries_left > 0) {
+        const unsigned char *entry = reader->directory + reader->directory_pos;
+        size_t available = reader->directory_length - reader->directory_pos;
+        if (available < 46 || memcmp(entry, "PK\1\2", 4) != 0) {
+            return fail(reader, "Corrupt zip central directory");
+        }
+
+        size_t name_length = le16(entry + 28);
+        size_t extra_length = le16(entry + 30);
+        size_t comment_length = le16(entry + 32);
+        size_t entry_length = 46 + name_length + extra_length + comment_length;
+        if (entry_length > available) {
+            return fail(reader, "Corrupt zip central directory");
+        }
+        reader->directory_pos += entry_length;
+        reader->entries_left--;
+
+        reader->flags = le16(entry + 8);
+        reader->method = le16(entry + 10);
+        reader->crc = le32(entry + 16);
+        reader->compressed_size = le32(entry + 20);
+        reader->size = le32(entry + 24);
+        reader->local_offset = le32(entry + 42);
+
+        // Zip64 extended information holds the fields saturated above
+        const unsigned char *extra = entry + 46 + name_length;
+        const unsigned char *extra_end = extra + extra_length;
+        while (extra + 4 <= extra_end) {
+            uint16_t id = le16(extra);
+            uint16_t length = le16(extra + 2);
+            const unsigned char *field = extra + 4;
+            if (field + length > extra_end) break;
+            if (id == 0x0001) {
+                const unsigned char *end = field + length;
+                if (reader->size == 0xffffffffu && field + 8 <= end) {
+                    reader->size = le64(field);
+                    field += 8;
+                }
+                if (reader->compressed_size == 0xffffffffu && field + 8 <= end) {
+                    reader->compressed_size = le64(field);
+                    field += 8;
+                }
+                if (reader->local_offset == 0xffffffffu && field + 8 <= end) {
+                    reader->local_offset = le64(field);
+                }
+            }
+            extra = field + length;
+        }
+
+        // Directories and symbolic links
+        const char *name = (const char *)entry + 46;
+        uint32_t mode = le32(entry + 38) >> 16;
+        if (name_length == 0 || name[name_length - 1] == '/' || (mode & 0170000) == 0120000) {
+            continue;
+        }
+
+        set_name(reader, name, name_length);
+        member->name = reader->name;
+        member->size = reader->size;
+        return 1;
+    }
+    return 0;
+}
+
+static int zip_read_member(archive_reader_t *reader, char *data, const char **error) {
+    unsigned char header[30];
+    if (!read_at(reader->file, reader->local_offset, header, sizeof(header)) ||
+        memcmp(header, "PK\3\4", 4) != 0) {
+        *error = "Corrupt zip local header";
+        return 0;
+    }
+    if (reader->flags & 1) {
+        *error = "Encrypted archive member";
+        return 0;
+    }
+    if (reader->method != 0 && reader->method != 8) {
+        *error = "Unsupported compression method";
+        return 0;
+    }
+
+    uint64_t data_offset = reader->local_offset + 30 + le16(header + 26) + le16(header + 28);
+    if (data_offset > (uint64_t)INT64_MAX || fseeko(reader->file, (off_t)data_offset, SEEK_SET) != 0) {
+        *error = "Truncated archive member";
+        return 0;
+    }
+
+    size_t produced = 0;
+    if (reader->method == 0) {
+        if (reader->compressed_size != reader->size ||
+            fread(data, 1, (size_t)reader->size, reader->file) != reader->size) {
+            *error = "Truncated archive member";
+            return 0;
+        }
+        produced = (size_t)reader->size;
+    } else {
+        unsigned char *chunk = malloc(ARCHIVE_IO_CHUNK);
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        if (!chunk || inflateInit2(&zs, -15) != Z_OK) {
+            free(chunk);
+            *error = "Out of memory";
+            return 0;
+        }
+
+        // Output is capped at the declared size, which guards against bombs
+        uint64_t left = reader->compressed_size;
+        int status = Z_OK;
+        while (status == Z_OK && produced < reader->size) {
+            if (zs.avail_in == 0) {
+                size_t want = left > ARCHIVE_IO_CHUNK ? ARCHIVE_IO_CHUNK : (size_t)left;
+                size_t got = want ? fread(chunk, 1, want, reader->file) : 0;
+                if (got == 0) break;
+                left -= got;
+                zs.next_in = chunk;
+                zs.avail_in = (uInt)got;
+            }
+            size_t room = (size_t)reader->size - produced;
+            zs.next_out = (Bytef *)data + produced;
+            zs.avail_out = room > 0x40000000u ? 0x40000000u : (uInt)room;
+            uInt before = zs.avail_out;
+            status = inflate(&zs, Z_NO_FLUSH);
+            produced += before - zs.avail_out;
+            if (status == Z_BUF_ERROR) status = Z_OK;
+        }
+        inflateEnd(&zs);
+        free(chunk);
+    }
+
+    // Members are capped at ARCHIVE_MAX_MEMBER_SIZE, well within uInt
+    if (produced != reader->size ||
+        crc32(crc32(0L, Z_NULL, 0), (const Bytef *)data, (uInt)produced) != reader->crc) {
+        *error = "Corrupt archive member (CRC mismatch)";
+        return 0;
+    }
+    return 1;
+}
+
+// ==================== Reader ====================
+
+archive_reader_t* archive_open(const char *filename, archive_format_t format,
+                               const char **error) {
+    archive_reader_t *reader = calloc(1, sizeof(archive_reader_t));
+    if (!reader) {
+        *error = "Out of memory";
+        return NULL;
+    }
+    reader->format = format;
+
+    if (format == ARCHIVE_TAR) {
+        struct stat st;
+        reader->gz = stat(filename, &st) == 0 ? gzopen(filename, "rb") : NULL;
+        if (reader->gz) {
+            reader->file_size = (uint64_t)st.st_size;
+            gzbuffer(reader->gz, ARCHIVE_IO_CHUNK);
+            return reader;
+        }
+        *error = "Failed to read archive";
+    } else if (format == ARCHIVE_ZIP) {
+        reader->file = fopen(filename, "rb");
+        if (reader->file && zip_open(reader)) {
+            return reader;
+        }
+        *error = reader->file ? "Not a zip archive" : "Failed to read archive";
+    } else {
+        *error = "Unsupported archive format";
+    }
+
+    archive_close(reader);
+    return NULL;
+}
+
+int archive_next(archive_reader_t *reader, archive_member_t *member) {
+    if (!reader || !member) return -1;
+    if (reader->error) return -1;
+    return reader->format == ARCHIVE_TAR ? tar_next(reader, member) : zip_next(reader, member);
+}
+
+const char* archive_error(const archive_reader_t *reader) {
+    return reader && reader->error ? reader->error : "Unknown error";
+}
+
+int archive_read_member(archive_reader_t *reader, file_buffer_t *buffer, const char **error) {
+    memset(buffer, 0, sizeof(*buffer));
+    uint64_t size = reader->format == ARCHIVE_TAR ? reader->remaining : reader->size;
+    if (size > ARCHIVE_MAX_MEMBER_SIZE) {
+        *error = "Archive member too large to scan";
+        return 0;
+    }
+
+    char *data = malloc((size_t)size + 1);
+    if (!data) {
+        *error = "Out of memory";
+        return 0;
+    }
+
+    int ok = reader->format == ARCHIVE_TAR ? tar_read_member(reader, data, error)
+                                           : zip_read_member(reader, data, error);
+    if (!ok) {
+        free(data);
+        return 0;
+    }
+
+    data[size] = '\0';
+    buffer->data = data;
+    buffer->length = (size_t)size;
+    return 1;
+}
+
+void archive_close(archive_reader_t *reader) {
+    if (!reader) return;
+
+    if (reader->gz) gzclose(reader->gz);
+    if (reader->file) fclose(reader->file);
+    free(reader->scratch);
+    free(reader->directory);
+    free(reader);
+}
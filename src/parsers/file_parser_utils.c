@@ -1,9 +1,50 @@
 #define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
 #include "parsers/file_parsers.h"
+#include "parsers/archive_reader.h"
+#include "runtime/scan_stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Read exactly length bytes (or until EOF) from a descriptor
+static size_t read_fully(int fd, char *buffer, size_t length) {
+    size_t total = 0;
+    while (total < length) {
+        ssize_t n = read(fd, buffer + total, length - total);
+        if (n < 0) {
+            return total;
+        }
+        if (n == 0) {
+            break;
+        }
+        total += (size_t)n;
+    }
+    return total;
+}
+
+// Read a regular file of file_size bytes into the heap or an arena
+static char* read_file_descriptor(int fd, size_t file_size, arena_t *arena, size_t *length) {
+    char *buffer = arena ? arena_alloc(arena, file_size + 1) : malloc(file_size + 1);
+    if (!buffer) {
+        return NULL;
+    }
+    
+    size_t bytes_read = read_fully(fd, buffer, file_size);
+    buffer[bytes_read] = '\0';
+    *length = bytes_read;
+    
+    return buffer;
+}
 
 // Read entire file contents into memory
 char* read_file_contents(const char *filename, size_t *length) {
@@ -11,36 +52,230 @@ char* read_file_contents(const char *filename, size_t *length) {
         return NULL;
     }
     
-    FILE *fp = fopen(filename, "rb");
-    if (!fp) {
+    scan_span_t span = scan_stats_begin();
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
         return NULL;
     }
     
     // Get file size
-    fseek(fp, 0, SEEK_END);
-    long file_size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-    
-    if (file_size < 0) {
-        fclose(fp);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
         return NULL;
     }
     
-    // Allocate buffer
-    char *buffer = malloc(file_size + 1);
-    if (!buffer) {
-        fclose(fp);
-        return NULL;
+    char *buffer = read_file_descriptor(fd, (size_t)st.st_size, NULL, length);
+    close(fd);
+    scan_stats_end(span, SCAN_STAGE_READ, detect_file_type(filename), buffer ? *length : 0);
+    return buffer;
+}
+
+// ==================== Mapping Guard ====================
+
+// A file truncated while it is mapped (an editor rewriting it in watch mode,
+// say) raises SIGBUS on the next read of a page past its new end - on any
+// thread, possibly deep in a parser or matcher. The handler replaces such a
+// page with zeros and marks the mapping, so the read carries on and the scan
+// of that file is failed once it is done (release_file_buffer(),
+// parse_result_truncated()). Faults outside our mappings keep their previous
+// disposition.
+
+#define FILE_MAP_SLOTS 64
+
+typedef struct {
+    _Atomic uintptr_t start;    // 0 = free slot
+    _Atomic size_t length;
+    atomic_int truncated;
+} mapped_file_t;
+
+static mapped_file_t mapped_files[FILE_MAP_SLOTS];
+static struct sigaction previous_sigbus;
+static size_t guard_page_size;
+static pthread_once_t map_guard_once = PTHREAD_ONCE_INIT;
+
+static void map_guard_handler(int signal_number, siginfo_t *info, void *context) {
+    uintptr_t address = (uintptr_t)info->si_addr;
+    for (size_t i = 0; i < FILE_MAP_SLOTS; i++) {
+        uintptr_t start = atomic_load(&mapped_files[i].start);
+        if (start && address >= start && address - start < atomic_load(&mapped_files[i].length)) {
+            // mmap is not on the async-signal-safe list but is a plain system
+            // call; the retried read then sees zeros
+            void *page = (void *)(address & ~(uintptr_t)(guard_page_size - 1));
+            if (mmap(page, guard_page_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED) {
+                atomic_store(&mapped_files[i].truncated, 1);
+                return;
+            }
+            break;
+        }
+    }
+
+    // Not ours: fault again (or re-send a signal from kill()) under the
+    // previous disposition
+    (void)context;
+    sigaction(SIGBUS, &previous_sigbus, NULL);
+    if (info->si_code <= 0) {
+        raise(signal_number);
+    }
+}
+
+static void install_map_guard(void) {
+    guard_page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = map_guard_handler;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGBUS, &action, &previous_sigbus);
+}
+
+// Claim a slot for a new mapping; 0 if all are taken (the file is read instead)
+static int map_guard_add(void *data, size_t length) {
+    pthread_once(&map_guard_once, install_map_guard);
+
+    for (size_t i = 0; i < FILE_MAP_SLOTS; i++) {
+        uintptr_t expected = 0;
+        if (atomic_compare_exchange_strong(&mapped_files[i].start, &expected, (uintptr_t)data)) {
+            atomic_store(&mapped_files[i].truncated, 0);
+            atomic_store(&mapped_files[i].length, length);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static mapped_file_t* map_guard_find(const void *data) {
+    for (size_t i = 0; i < FILE_MAP_SLOTS; i++) {
+        if (atomic_load(&mapped_files[i].start) == (uintptr_t)data) {
+            return &mapped_files[i];
+        }
+    }
+    return NULL;
+}
+
+// Whether the file behind a mapping shrank while it was read
+static int mapping_truncated(const void *data) {
+    mapped_file_t *slot = map_guard_find(data);
+    return slot && atomic_load(&slot->truncated);
+}
+
+// Unmap a file mapping; returns 0 if the file shrank while it was mapped
+static int unmap_file(void *data, size_t length) {
+    int intact = 1;
+    mapped_file_t *slot = map_guard_find(data);
+    if (slot) {
+        intact = !atomic_load(&slot->truncated);
+        atomic_store(&slot->length, 0);
+        atomic_store(&slot->start, 0);
     }
+    munmap(data, length);
+    return intact;
+}
+
+// Load a file for parsing without copying it when possible
+// Large files are mapped privately and prefaulted for a sequential read. The
+// mapping is writable because parsers rewrite the buffer in place (private,
+// so the file is never changed). It is only used when the file does not end
+// on a page boundary: the zero-filled tail of the last page then provides the
+// NUL terminator callers rely on. Everything else is read into the heap, or
+// into arena when one is given.
+static int open_file_buffer(const char *filename, file_buffer_t *buffer, arena_t *arena) {
+    memset(buffer, 0, sizeof(*buffer));
     
-    // Read file
-    size_t bytes_read = fread(buffer, 1, file_size, fp);
-    fclose(fp);
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
     
-    buffer[bytes_read] = '\0';
-    *length = bytes_read;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return 0;
+    }
     
-    return buffer;
+    size_t file_size = (size_t)st.st_size;
+    long page_size = sysconf(_SC_PAGESIZE);
+    
+    if (file_size >= FILE_MAP_MIN_SIZE && page_size > 0 && file_size % (size_t)page_size != 0) {
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        flags |= MAP_POPULATE;
+#endif
+        void *mapping = mmap(NULL, file_size, PROT_READ | PROT_WRITE, flags, fd, 0);
+        if (mapping != MAP_FAILED && !map_guard_add(mapping, file_size)) {
+            munmap(mapping, file_size);
+            mapping = MAP_FAILED;
+        }
+        
+        if (mapping != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+            madvise(mapping, file_size, MADV_SEQUENTIAL);
+#endif
+            close(fd);
+            buffer->data = mapping;
+            buffer->length = file_size;
+            buffer->mapped_length = file_size;
+            return 1;
+        }
+    }
+    
+    buffer->data = read_file_descriptor(fd, file_size, arena, &buffer->length);
+    buffer->arena = buffer->data ? arena : NULL;
+    close(fd);
+    return buffer->data != NULL;
+}
+
+int load_file_buffer(const char *filename, file_buffer_t *buffer, arena_t *arena) {
+    if (!filename || !buffer) {
+        return 0;
+    }
+    
+    scan_span_t span = scan_stats_begin();
+    int loaded = open_file_buffer(filename, buffer, arena);
+    scan_stats_end(span, SCAN_STAGE_READ, detect_file_type(filename), loaded ? buffer->length : 0);
+    return loaded;
+}
+
+// In-memory input (e.g. received over a socket): copy data into a writable,
+// NUL-terminated buffer in the heap or arena, as the parsers expect
+int copy_file_buffer(const char *data, size_t length, file_buffer_t *buffer, arena_t *arena) {
+    if (!buffer || (!data && length > 0) || length == SIZE_MAX) {
+        return 0;
+    }
+    
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->data = arena ? arena_alloc(arena, length + 1) : malloc(length + 1);
+    if (!buffer->data) {
+        return 0;
+    }
+    
+    if (length > 0) {
+        memcpy(buffer->data, data, length);
+    }
+    buffer->data[length] = '\0';
+    buffer->length = length;
+    buffer->arena = arena;
+    return 1;
+}
+
+// Release a buffer from load_file_buffer(); returns 0 if the file was
+// truncated while it was mapped, so what was read from it is not its content
+int release_file_buffer(file_buffer_t *buffer) {
+    if (!buffer || !buffer->data) {
+        return 1;
+    }
+    
+    int intact = 1;
+    if (buffer->mapped_length > 0) {
+        intact = unmap_file(buffer->data, buffer->mapped_length);
+    } else if (!buffer->arena) {
+        free(buffer->data);
+    }
+    
+    memset(buffer, 0, sizeof(*buffer));
+    return intact;
 }
 
 // Detect file type from filename extension
@@ -80,66 +315,227 @@ file_type_t detect_file_type(const char *filename) {
     return FILE_TYPE_UNKNOWN;
 }
 
+// Check whether a file has an extension one of the parsers (or the archive
+// reader) handles
+// Used when collecting files from directories; explicit paths are always
+// scanned (files without an extension are treated as text).
+int is_supported_file(const char *filename) {
+    if (!filename) {
+        return 0;
+    }
+    
+    const char *base = strrchr(filename, '/');
+    base = base ? base + 1 : filename;
+    
+    return strrchr(base, '.') != NULL &&
+           (detect_file_type(base) != FILE_TYPE_UNKNOWN || archive_format_of(base) != ARCHIVE_NONE);
+}
+
 // Parse file based on detected type
-parse_result_t* parse_file(const char *filename) {
+parse_result_t* parse_file(const char *filename, arena_t *arena) {
     if (!filename) {
         return NULL;
     }
     
+    // An archive holds many documents; batch scans read it member by member
+    if (archive_format_of(filename) != ARCHIVE_NONE) {
+        parse_result_t *result = parse_result_create(arena);
+        return result ? parse_result_fail(result, "Archives are scanned per member in batch mode")
+                      : NULL;
+    }
+    
     file_type_t type = detect_file_type(filename);
     
     switch (type) {
         case FILE_TYPE_MD:
-            return parse_md_file(filename);
+            return parse_md_file(filename, arena);
         
         case FILE_TYPE_JSON:
-            return parse_json_file(filename);
+            return parse_json_file(filename, arena);
         
         case FILE_TYPE_PDF:
-            return parse_pdf_file(filename);
+            return parse_pdf_file(filename, arena);
         
         case FILE_TYPE_TEXT:
         case FILE_TYPE_YAML:
         case FILE_TYPE_UNKNOWN:
         default: {
-            // For text/unknown files, just read the content as-is
-            parse_result_t *result = calloc(1, sizeof(parse_result_t));
+            // For text/unknown files the content needs no transformation, so
+            // the result borrows the file buffer (mapping) as-is
+            parse_result_t *result = parse_result_create(arena);
             if (!result) {
                 return NULL;
             }
             
-            size_t length = 0;
-            char *content = read_file_contents(filename, &length);
-            
-            if (!content) {
-                result->success = 0;
-                result->error_message = strdup("Failed to read file");
-                return result;
+            file_buffer_t buffer;
+            if (!load_file_buffer(filename, &buffer, arena)) {
+                return parse_result_fail(result, "Failed to read file");
             }
             
-            result->content = content;
-            result->content_length = length;
-            result->success = 1;
-            result->error_message = NULL;
+            if (!parse_result_take_buffer(result, &buffer)) {
+                return parse_result_fail(result, "Memory allocation failed");
+            }
+            return result;
+        }
+    }
+}
+
+// Parse content that is already in memory as a document of the given type
+parse_result_t* parse_buffer(const char *data, size_t length, file_type_t type, arena_t *arena) {
+    file_buffer_t buffer;
+    if (!copy_file_buffer(data, length, &buffer, arena)) {
+        parse_result_t *result = parse_result_create(arena);
+        return result ? parse_result_fail(result, "Memory allocation failed") : NULL;
+    }
+    
+    return parse_loaded_buffer(&buffer, type, arena);
+}
+
+// Parse a loaded buffer (e.g. an archive member) as a document of the given
+// type; takes the buffer over like the per-format parsers
+parse_result_t* parse_loaded_buffer(file_buffer_t *buffer, file_type_t type, arena_t *arena) {
+    switch (type) {
+        case FILE_TYPE_MD:
+            return parse_md_buffer(buffer, arena);
+        
+        case FILE_TYPE_JSON:
+            return parse_json_buffer(buffer, arena);
+        
+        case FILE_TYPE_PDF:
+            return parse_pdf_buffer(buffer, arena);
+        
+        case FILE_TYPE_TEXT:
+        case FILE_TYPE_YAML:
+        case FILE_TYPE_UNKNOWN:
+        default: {
+            parse_result_t *result = parse_result_create(arena);
+            if (!result) {
+                release_file_buffer(buffer);
+                return NULL;
+            }
             
+            if (!parse_result_take_buffer(result, buffer)) {
+                return parse_result_fail(result, "Memory allocation failed");
+            }
             return result;
         }
     }
 }
 
+// ==================== Result Helpers ====================
+
+// Empty result, allocated from arena when one is given
+parse_result_t* parse_result_create(arena_t *arena) {
+    parse_result_t *result = arena ? arena_calloc(arena, 1, sizeof(parse_result_t))
+                                   : calloc(1, sizeof(parse_result_t));
+    if (result) {
+        result->arena = arena;
+    }
+    return result;
+}
+
+// Mark a result as failed, returns it for the caller to hand back
+parse_result_t* parse_result_fail(parse_result_t *result, const char *message) {
+    result->success = 0;
+    result->error_message = result->arena ? arena_strdup(result->arena, message)
+                                          : strdup(message);
+    return result;
+}
+
+static void unmap_content(void *data, size_t size) {
+    unmap_file(data, size);
+}
+
+static void free_content(void *data, size_t size) {
+    (void)size;
+    free(data);
+}
+
+// Make a loaded file buffer the result content
+// A mapping stays a mapping; for arena results it is unmapped (a heap buffer
+// freed) on rewind. Returns 0 (buffer released) if the cleanup could not be
+// registered.
+int parse_result_take_buffer(parse_result_t *result, file_buffer_t *buffer) {
+    if (result->arena && !buffer->arena &&
+        !arena_add_cleanup(result->arena, buffer->mapped_length > 0 ? unmap_content : free_content,
+                           buffer->data, buffer->mapped_length)) {
+        release_file_buffer(buffer);
+        return 0;
+    }
+    
+    result->content = buffer->data;
+    result->content_length = buffer->length;
+    result->mapped_length = buffer->mapped_length;
+    if (result->arena) {
+        result->content_owner = PARSE_CONTENT_ARENA;
+    } else {
+        result->content_owner = buffer->mapped_length > 0 ? PARSE_CONTENT_MAPPED
+                                                          : PARSE_CONTENT_HEAP;
+    }
+    result->success = 1;
+    result->error_message = NULL;
+    return 1;
+}
+
+// Make a malloc'd buffer the result content
+// Buffers grown with realloc (flattened JSON, PDF text) stay on the heap; an
+// arena result frees them on rewind. Returns 0 (content freed) on failure.
+int parse_result_take_heap(parse_result_t *result, char *content, size_t length) {
+    if (result->arena && !arena_add_cleanup(result->arena, free_content, content, 0)) {
+        free(content);
+        return 0;
+    }
+    
+    result->content = content;
+    result->content_length = length;
+    result->content_owner = result->arena ? PARSE_CONTENT_ARENA : PARSE_CONTENT_HEAP;
+    result->success = 1;
+    result->error_message = NULL;
+    return 1;
+}
+
+// Build the key/value index of a successfully parsed file
+int parse_result_build_index(parse_result_t *result) {
+    if (!result || !result->success || !result->content) {
+        return 0;
+    }
+    
+    if (!result->config) {
+        result->config = config_from_text(result->content, result->content_length, result->arena);
+    }
+    return result->config != NULL;
+}
+
+// Whether the content is a file mapping whose file shrank while it was read
+// (the missing part read as zeros); check after scanning the content
+int parse_result_truncated(const parse_result_t *result) {
+    return result && result->mapped_length > 0 && mapping_truncated(result->content);
+}
+
+// Configuration formats whose content is mostly key/value lines
+int file_type_has_index(file_type_t type) {
+    return type == FILE_TYPE_JSON || type == FILE_TYPE_YAML || type == FILE_TYPE_TEXT;
+}
+
 // Free parse result structure
+// Arena results are released by rewinding their arena
 void free_parse_result(parse_result_t *result) {
-    if (!result) {
+    if (!result || result->arena) {
         return;
     }
     
     if (result->content) {
-        free(result->content);
+        if (result->content_owner == PARSE_CONTENT_MAPPED) {
+            unmap_file(result->content, result->mapped_length);
+        } else {
+            free(result->content);
+        }
     }
     
     if (result->error_message) {
         free(result->error_message);
     }
     
+    scanner_free_config(result->config);
     free(result);
 }
@@ -0,0 +1,274 @@
+#define _POSIX_C_SOURCE 200809L
+#include "parsers/json_index.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JSON_INDEX_X86 1
+#endif
+
+// Character classes of one 64-byte block, bit i = byte i
+typedef struct {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t bracket;       // { } [ ]
+    uint64_t separator;     // : ,
+    uint64_t space;         // space, tab, CR, LF
+} json_block_masks_t;
+
+typedef void (*json_classify_fn)(const char *block, json_block_masks_t *masks);
+
+// ==================== Scalar Kernel ====================
+
+enum {
+    CLASS_QUOTE = 1,
+    CLASS_BACKSLASH = 2,
+    CLASS_BRACKET = 4,
+    CLASS_SEPARATOR = 8,
+    CLASS_SPACE = 16
+};
+
+static const uint8_t json_byte_class[256] = {
+    ['"'] = CLASS_QUOTE, ['\\'] = CLASS_BACKSLASH,
+    ['{'] = CLASS_BRACKET, ['}'] = CLASS_BRACKET, ['['] = CLASS_BRACKET, [']'] = CLASS_BRACKET,
+    [':'] = CLASS_SEPARATOR, [','] = CLASS_SEPARATOR,
+    [' '] = CLASS_SPACE, ['\t'] = CLASS_SPACE, ['\n'] = CLASS_SPACE, ['\r'] = CLASS_SPACE,
+};
+
+static void classify_scalar(const char *block, json_block_masks_t *masks) {
+    memset(masks, 0, sizeof(*masks));
+    for (int i = 0; i < 64; i++) {
+        uint8_t cls = json_byte_class[(unsigned char)block[i]];
+        uint64_t bit = (uint64_t)1 << i;
+        if (cls & CLASS_QUOTE) masks->quote |= bit;
+        if (cls & CLASS_BACKSLASH) masks->backslash |= bit;
+        if (cls & CLASS_BRACKET) masks->bracket |= bit;
+        if (cls & CLASS_SEPARATOR) masks->separator |= bit;
+        if (cls & CLASS_SPACE) masks->space |= bit;
+    }
+}
+
+#ifdef JSON_INDEX_X86
+
+// OR-ing 0x20 folds '[' onto '{' and ']' onto '}', so four compares find
+// all brackets plus separators.
+
+// ==================== 128-bit Kernel ====================
+__attribute__((target("sse2")))
+static void classify_sse2(const char *block, json_block_masks_t *masks) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i fold = _mm_set1_epi8(0x20);
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+
+    memset(masks, 0, sizeof(*masks));
+    for (int i = 0; i < 4; i++) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(block + i * 16));
+        __m128i folded = _mm_or_si128(v, fold);
+        int shift = i * 16;
+
+        masks->quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)) << shift;
+        masks->backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash)) << shift;
+        masks->bracket |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close))) << shift;
+        masks->separator |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma))) << shift;
+        masks->space |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                         _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)))) << shift;
+    }
+}
+
+// ==================== 256-bit Kernel ====================
+__attribute__((target("avx2")))
+static void classify_avx2(const char *block, json_block_masks_t *masks) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i open = _mm256_set1_epi8('{');
+    const __m256i close = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i fold = _mm256_set1_epi8(0x20);
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+
+    memset(masks, 0, sizeof(*masks));
+    for (int i = 0; i < 2; i++) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(block + i * 32));
+        __m256i folded = _mm256_or_si256(v, fold);
+        int shift = i * 32;
+
+        masks->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)) << shift;
+        masks->backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, backslash)) << shift;
+        masks->bracket |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, open), _mm256_cmpeq_epi8(folded, close))) << shift;
+        masks->separator |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, colon), _mm256_cmpeq_epi8(v, comma))) << shift;
+        masks->space |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+                            _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)))) << shift;
+    }
+}
+
+// ==================== 512-bit Kernel ====================
+__attribute__((target("avx512f,avx512bw")))
+static void classify_avx512(const char *block, json_block_masks_t *masks) {
+    __m512i v = _mm512_loadu_si512((const void *)block);
+    __m512i folded = _mm512_or_si512(v, _mm512_set1_epi8(0x20));
+
+    masks->quote = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"'));
+    masks->backslash = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\'));
+    masks->bracket = _mm512_cmpeq_epi8_mask(folded, _mm512_set1_epi8('{')) |
+                     _mm512_cmpeq_epi8_mask(folded, _mm512_set1_epi8('}'));
+    masks->separator = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(':')) |
+                       _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(','));
+    masks->space = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(' ')) |
+                   _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\t')) |
+                   _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\n')) |
+                   _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\r'));
+}
+
+#endif // JSON_INDEX_X86
+
+// ==================== Runtime Dispatch ====================
+
+static json_classify_fn active_classify = classify_scalar;
+static const char *active_kernel_name = "scalar";
+static pthread_once_t dispatch_once = PTHREAD_ONCE_INIT;
+
+// Pick the widest supported kernel (runs once per process)
+static void select_kernel(void) {
+#ifdef JSON_INDEX_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        active_classify = classify_avx512;
+        active_kernel_name = "avx512";
+    } else if (__builtin_cpu_supports("avx2")) {
+        active_classify = classify_avx2;
+        active_kernel_name = "avx2";
+    } else if (__builtin_cpu_supports("sse2")) {
+        active_classify = classify_sse2;
+        active_kernel_name = "sse2";
+    }
+#endif
+}
+
+const char* json_index_kernel_name(void) {
+    pthread_once(&dispatch_once, select_kernel);
+    return active_kernel_name;
+}
+
+// ==================== Stage 1 ====================
+
+// Bits of backslash runs' odd positions: the bytes those backslashes escape
+static inline uint64_t find_escaped(uint64_t backslash, uint64_t *escaped_carry) {
+    const uint64_t even_bits = 0x5555555555555555ULL;
+
+    backslash &= ~*escaped_carry;  // An escaped backslash escapes nothing
+    uint64_t follows_escape = (backslash << 1) | *escaped_carry;
+    uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+    uint64_t sequences_starting_on_even_bits;
+    *escaped_carry = __builtin_add_overflow(odd_sequence_starts, backslash,
+                                            &sequences_starting_on_even_bits);
+    uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+    return (even_bits ^ invert_mask) & follows_escape;
+}
+
+// Bit i = XOR of bits 0..i (1 from an opening quote up to its closing quote)
+static inline uint64_t prefix_xor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// Turn one block's masks into structural positions
+static size_t index_block(json_index_t *index, const json_block_masks_t *masks,
+                          size_t base, size_t *out) {
+    uint64_t quote = masks->quote & ~find_escaped(masks->backslash, &index->escaped);
+    uint64_t in_string = prefix_xor(quote) ^ index->in_string;
+    index->in_string = (uint64_t)((int64_t)in_string >> 63);
+
+    // Numbers and literals: runs of anything else outside strings
+    uint64_t scalar = ~(masks->bracket | masks->separator | masks->space | quote) & ~in_string;
+    uint64_t follows_scalar = (scalar << 1) | index->scalar;
+    index->scalar = scalar >> 63;
+
+    uint64_t structural = quote | (masks->bracket & ~in_string) | (scalar & ~follows_scalar);
+
+    size_t count = 0;
+    while (structural) {
+        out[count++] = base + (size_t)__builtin_ctzll(structural);
+        structural &= structural - 1;
+    }
+    return count;
+}
+
+// Prepare an index over a document (nothing is classified yet)
+int json_index_init(json_index_t *index, const char *data, size_t length) {
+    if (!index || (!data && length > 0)) {
+        return 0;
+    }
+
+    pthread_once(&dispatch_once, select_kernel);
+
+    memset(index, 0, sizeof(*index));
+    index->data = data;
+    index->length = length;
+    index->positions = malloc(JSON_INDEX_WINDOW * sizeof(size_t));
+    return index->positions != NULL;
+}
+
+// Classify the next window; loops past windows without structurals (long strings)
+int json_index_refill(json_index_t *index) {
+    index->count = 0;
+    index->cursor = 0;
+
+    while (index->count == 0 && index->indexed < index->length) {
+        size_t end = index->indexed + JSON_INDEX_WINDOW;
+        if (end > index->length) end = index->length;
+
+        json_block_masks_t masks;
+        while (index->indexed + 64 <= end) {
+            active_classify(index->data + index->indexed, &masks);
+            index->count += index_block(index, &masks, index->indexed,
+                                        index->positions + index->count);
+            index->indexed += 64;
+        }
+
+        // Final partial block, padded with whitespace
+        if (index->indexed < end) {
+            char block[64];
+            memset(block, ' ', sizeof(block));
+            memcpy(block, index->data + index->indexed, end - index->indexed);
+            active_classify(block, &masks);
+            index->count += index_block(index, &masks, index->indexed,
+                                        index->positions + index->count);
+            index->indexed = end;
+        }
+    }
+
+    return index->count > 0;
+}
+
+void json_index_free(json_index_t *index) {
+    if (!index) return;
+    free(index->positions);
+    index->positions = NULL;
+    index->count = 0;
+    index->cursor = 0;
+}
@@ -1,181 +1,350 @@
 #define _POSIX_C_SOURCE 200809L
 #include "parsers/file_parsers.h"
+#include "parsers/json_index.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
 
-// Simple JSON to key-value text converter
-// Converts JSON format like {"key": "value"} to key: value format
-static void json_to_text_recursive(const char *json, size_t *pos, char **output, size_t *out_pos, size_t *out_size, int depth) {
-    size_t len = strlen(json);
+// ==================== JSON Flattener ====================
+// JSON is flattened into one "path: value" line per scalar, with nested keys
+// joined by '.' and array elements indexed, e.g.
+//   {"db": {"replicas": [{"tls": true}]}}  ->  db.replicas[0].tls: true
+// A vectorized structural index (parsers/json_index.h) finds the quotes,
+// brackets and value starts; the flattener only visits those positions and
+// copies everything between them in bulk. Containers are tracked on an
+// explicit stack, so deep nesting cannot overflow the C stack. Malformed
+// input is skipped over rather than rejected.
+
+// Growable text buffer, always with room for a terminating NUL
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+} text_buffer_t;
+
+static int text_reserve(text_buffer_t *buffer, size_t extra) {
+    if (buffer->length + extra < buffer->capacity) {
+        return 1;
+    }
     
-    while (*pos < len) {
-        char c = json[*pos];
-        
-        // Skip whitespace
-        if (isspace(c)) {
-            (*pos)++;
-            continue;
+    size_t capacity = buffer->capacity ? buffer->capacity : 64;
+    while (buffer->length + extra >= capacity) {
+        if (capacity > SIZE_MAX / 2) {
+            return 0;
         }
-        
-        // Handle object start - recurse into nested objects
-        if (c == '{') {
-            (*pos)++;
-            json_to_text_recursive(json, pos, output, out_pos, out_size, depth + 1);
-            continue;
+        capacity *= 2;
+    }
+    
+    char *grown = realloc(buffer->data, capacity);
+    if (!grown) {
+        return 0;
+    }
+    buffer->data = grown;
+    buffer->capacity = capacity;
+    return 1;
+}
+
+static int text_append(text_buffer_t *buffer, const char *text, size_t length) {
+    if (!text_reserve(buffer, length)) {
+        return 0;
+    }
+    memcpy(buffer->data + buffer->length, text, length);
+    buffer->length += length;
+    return 1;
+}
+
+// One open object or array
+typedef struct {
+    int is_array;
+    int expect_key;         // Objects: the next string is a key
+    size_t path_length;     // Length of the container's own path
+    size_t child_count;
+} json_frame_t;
+
+// Append a string body, decoding escapes
+// Escaped line breaks and tabs become spaces so every value stays on one
+// line; \u escapes outside ASCII are kept verbatim.
+static int json_append_string(text_buffer_t *buffer, const char *text, size_t length) {
+    const char *end = text + length;
+    
+    while (text < end) {
+        const char *escape = memchr(text, '\\', (size_t)(end - text));
+        if (!escape) {
+            return text_append(buffer, text, (size_t)(end - text));
         }
-        
-        // Handle object end
-        if (c == '}') {
-            (*pos)++;
-            if (depth > 0) {
-                return;  // Return from nested object
-            }
-            continue;  // Continue at top level
+        if (!text_append(buffer, text, (size_t)(escape - text))) {
+            return 0;
         }
+        text = escape;
         
-        // Handle array start
-        if (c == '[') {
-            (*pos)++;
-            // Skip array contents for now (simplified)
-            int bracket_count = 1;
-            while (*pos < len && bracket_count > 0) {
-                if (json[*pos] == '[') bracket_count++;
-                if (json[*pos] == ']') bracket_count--;
-                (*pos)++;
-            }
-            continue;
+        if (text + 1 >= end) {
+            return 1;  // Dangling backslash
         }
         
-        // Handle comma
-        if (c == ',') {
-            (*pos)++;
-            continue;
+        char decoded;
+        switch (text[1]) {
+            case 'n': case 'r': case 't': case 'b': case 'f':
+                decoded = ' ';
+                break;
+            case 'u':
+                if (end - text >= 6 && text[2] == '0' && text[3] == '0' &&
+                    isxdigit((unsigned char)text[4]) && isxdigit((unsigned char)text[5])) {
+                    char hex[3] = { text[4], text[5], '\0' };
+                    decoded = (char)strtol(hex, NULL, 16);
+                    if (decoded < 0x20) decoded = ' ';
+                    if (!text_append(buffer, &decoded, 1)) {
+                        return 0;
+                    }
+                    text += 6;
+                    continue;
+                }
+                if (!text_append(buffer, text, 2)) {
+                    return 0;
+                }
+                text += 2;
+                continue;
+            default:
+                decoded = text[1];  // \" \\ \/
+                break;
         }
+        if (!text_append(buffer, &decoded, 1)) {
+            return 0;
+        }
+        text += 2;
+    }
+    
+    return 1;
+}
+
+// Write "path: " (or nothing for a top-level scalar)
+static int json_emit_path(text_buffer_t *output, const text_buffer_t *path) {
+    if (path->length == 0) {
+        return 1;
+    }
+    return text_append(output, path->data, path->length) &&
+           text_append(output, ": ", 2);
+}
+
+// Write one "path: value" line; escapes are decoded only when present
+static int json_emit_value(text_buffer_t *output, const text_buffer_t *path,
+                           const char *value, size_t length, int is_string) {
+    if (is_string && memchr(value, '\\', length)) {
+        return json_emit_path(output, path) &&
+               json_append_string(output, value, length) &&
+               text_append(output, "\n", 1);
+    }
+    
+    if (!text_reserve(output, path->length + length + 3)) {
+        return 0;
+    }
+    
+    char *out = output->data + output->length;
+    if (path->length > 0) {
+        memcpy(out, path->data, path->length);
+        out += path->length;
+        *out++ = ':';
+        *out++ = ' ';
+    }
+    memcpy(out, value, length);
+    out += length;
+    *out++ = '\n';
+    output->length = (size_t)(out - output->data);
+    return 1;
+}
+
+// Point the path at the next element of the enclosing container
+static int json_begin_value(json_frame_t *top, text_buffer_t *path) {
+    if (!top || !top->is_array) {
+        return 1;
+    }
+    
+    char index[32];
+    int n = snprintf(index, sizeof(index), "[%zu]", top->child_count++);
+    path->length = top->path_length;
+    return text_append(path, index, (size_t)n);
+}
+
+// A value of the enclosing container is complete - back to its own path
+static void json_end_value(json_frame_t *top, text_buffer_t *path) {
+    if (!top) {
+        path->length = 0;
+        return;
+    }
+    path->length = top->path_length;
+    if (!top->is_array) {
+        top->expect_key = 1;
+    }
+}
+
+// Flatten a JSON document into output; returns 0 when out of memory
+static int json_flatten(const char *json, size_t length, text_buffer_t *output) {
+    json_index_t index;
+    if (!json_index_init(&index, json, length)) {
+        return 0;
+    }
+    
+    text_buffer_t path = {0};
+    json_frame_t *stack = NULL;
+    size_t depth = 0;
+    size_t stack_capacity = 0;
+    size_t pos;
+    int ok = 1;
+    
+    while (ok && (pos = json_index_next(&index)) < length) {
+        char c = json[pos];
+        json_frame_t *top = depth > 0 ? &stack[depth - 1] : NULL;
         
-        // Handle string (key or value)
-        if (c == '"') {
-            (*pos)++;
-            size_t start = *pos;
+        // Object or array start
+        if (c == '{' || c == '[') {
+            if (!json_begin_value(top, &path)) {
+                ok = 0;
+                break;
+            }
             
-            // Find end of string
-            while (*pos < len && json[*pos] != '"') {
-                if (json[*pos] == '\\') {
-                    (*pos)++;  // Skip escaped character
+            if (depth == stack_capacity) {
+                size_t capacity = stack_capacity ? stack_capacity * 2 : 32;
+                json_frame_t *grown = realloc(stack, capacity * sizeof(json_frame_t));
+                if (!grown) {
+                    ok = 0;
+                    break;
                 }
-                (*pos)++;
+                stack = grown;
+                stack_capacity = capacity;
             }
             
-            size_t str_len = *pos - start;
-            
-            // Ensure buffer is large enough
-            while (*out_pos + str_len + 10 >= *out_size) {
-                *out_size *= 2;
-                *output = realloc(*output, *out_size);
+            json_frame_t *frame = &stack[depth++];
+            frame->is_array = c == '[';
+            frame->expect_key = c == '{';
+            frame->path_length = path.length;
+            frame->child_count = 0;
+            continue;
+        }
+        
+        // Object or array end
+        if (c == '}' || c == ']') {
+            if (!top) {
+                continue;
             }
             
-            // Copy string content
-            memcpy(*output + *out_pos, json + start, str_len);
-            *out_pos += str_len;
-            
-            if (*pos < len) (*pos)++;  // Skip closing quote
+            json_frame_t frame = *top;
+            depth--;
+            path.length = frame.path_length;
             
-            // Skip whitespace
-            while (*pos < len && isspace(json[*pos])) {
-                (*pos)++;
-            }
-            
-            // Check if this is a key (followed by colon)
-            if (*pos < len && json[*pos] == ':') {
-                (*pos)++;
-                // Add colon and space  
-                (*output)[(*out_pos)++] = ':';
-                (*output)[(*out_pos)++] = ' ';
-                
-                // Skip whitespace after colon
-                while (*pos < len && isspace(json[*pos])) {
-                    (*pos)++;
-                }
-            } else {
-                // This is a value, add newline
-                (*output)[(*out_pos)++] = '\n';
+            // Keep empty containers as evidence, e.g. "allowed_cidrs: []"
+            if (frame.child_count == 0 && path.length > 0) {
+                ok = json_emit_path(output, &path) &&
+                     text_append(output, frame.is_array ? "[]\n" : "{}\n", 3);
             }
             
+            json_end_value(depth > 0 ? &stack[depth - 1] : NULL, &path);
             continue;
         }
         
-        // Handle boolean/number values
-        if (isalnum(c) || c == '-' || c == '.') {
-            size_t start = *pos;
-            while (*pos < len && (isalnum(json[*pos]) || json[*pos] == '-' || json[*pos] == '.')) {
-                (*pos)++;
-            }
-            
-            size_t val_len = *pos - start;
+        // Strings end at the next structural position, their closing quote
+        if (c == '"') {
+            size_t close = json_index_next(&index);
             
-            // Ensure buffer is large enough
-            while (*out_pos + val_len + 10 >= *out_size) {
-                *out_size *= 2;
-                *output = realloc(*output, *out_size);
+            // Object key
+            if (top && !top->is_array && top->expect_key) {
+                path.length = top->path_length;
+                if ((path.length > 0 && !text_append(&path, ".", 1)) ||
+                    !json_append_string(&path, json + pos + 1, close - pos - 1)) {
+                    ok = 0;
+                    break;
+                }
+                top->expect_key = 0;
+                top->child_count++;
+                continue;
             }
             
-            // Copy value
-            memcpy(*output + *out_pos, json + start, val_len);
-            *out_pos += val_len;
-            (*output)[(*out_pos)++] = '\n';
-            
+            // String value
+            if (!json_begin_value(top, &path) ||
+                !json_emit_value(output, &path, json + pos + 1, close - pos - 1, 1)) {
+                ok = 0;
+                break;
+            }
+            json_end_value(top, &path);
             continue;
         }
         
-        // Skip other characters
-        (*pos)++;
+        // Number, boolean or null - runs until the next structural position
+        // or separator, minus trailing whitespace
+        size_t end = json_index_peek(&index);
+        const char *token_end = json + pos;
+        while (token_end < json + end && *token_end != ',' && *token_end != ':' &&
+               !isspace((unsigned char)*token_end)) {
+            token_end++;
+        }
+        
+        if (!json_begin_value(top, &path) ||
+            !json_emit_value(output, &path, json + pos, (size_t)(token_end - (json + pos)), 0)) {
+            ok = 0;
+            break;
+        }
+        json_end_value(top, &path);
+    }
+    
+    json_index_free(&index);
+    free(path.data);
+    free(stack);
+    
+    if (ok && text_reserve(output, 1)) {
+        output->data[output->length] = '\0';
+        return 1;
     }
+    return 0;
 }
 
 // Parse JSON file and convert to key-value format
-parse_result_t* parse_json_file(const char *filename) {
+parse_result_t* parse_json_file(const char *filename, arena_t *arena) {
     if (!filename) {
         return NULL;
     }
     
-    parse_result_t *result = calloc(1, sizeof(parse_result_t));
+    // Read the file
+    file_buffer_t input;
+    if (!load_file_buffer(filename, &input, arena)) {
+        parse_result_t *result = parse_result_create(arena);
+        return result ? parse_result_fail(result, "Failed to read JSON file") : NULL;
+    }
+    
+    return parse_json_buffer(&input, arena);
+}
+
+// Flatten a loaded JSON document; the buffer is released either way
+parse_result_t* parse_json_buffer(file_buffer_t *buffer, arena_t *arena) {
+    file_buffer_t input = *buffer;
+    memset(buffer, 0, sizeof(*buffer));
+    
+    parse_result_t *result = parse_result_create(arena);
     if (!result) {
+        release_file_buffer(&input);
         return NULL;
     }
     
-    // Read the file
-    size_t file_length = 0;
-    char *file_content = read_file_contents(filename, &file_length);
+    const char *file_content = input.data;
+    size_t file_length = input.length;
     
-    if (!file_content) {
-        result->success = 0;
-        result->error_message = strdup("Failed to read JSON file");
-        return result;
+    // Flattened output is usually a little larger than the input (paths
+    // are repeated per value) - start there and grow as needed
+    text_buffer_t output = {0};
+    if (!text_reserve(&output, file_length + file_length / 2 + 64) ||
+        !json_flatten(file_content, file_length, &output)) {
+        free(output.data);
+        release_file_buffer(&input);
+        return parse_result_fail(result, "Memory allocation failed");
     }
     
-    // Allocate output buffer
-    size_t out_size = file_length * 2;  // Start with 2x the input size
-    char *output = malloc(out_size);
-    if (!output) {
-        free(file_content);
-        result->success = 0;
-        result->error_message = strdup("Memory allocation failed");
-        return result;
+    if (!release_file_buffer(&input)) {
+        free(output.data);
+        return parse_result_fail(result, FILE_TRUNCATED_ERROR);
     }
     
-    // Parse JSON and convert to text format
-    size_t pos = 0;
-    size_t out_pos = 0;
-    json_to_text_recursive(file_content, &pos, &output, &out_pos, &out_size, 0);
-    
-    output[out_pos] = '\0';
-    
-    result->content = output;
-    result->content_length = out_pos;
-    result->success = 1;
-    result->error_message = NULL;
+    if (!parse_result_take_heap(result, output.data, output.length)) {
+        return parse_result_fail(result, "Memory allocation failed");
+    }
     
-    free(file_content);
     return result;
 }
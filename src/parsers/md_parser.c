@@ -5,138 +5,204 @@
 #include <string.h>
 #include <ctype.h>
 
-// Parse Markdown file - extract content and convert to plain text
-parse_result_t* parse_md_file(const char *filename) {
-    if (!filename) {
-        return NULL;
-    }
-    
-    parse_result_t *result = calloc(1, sizeof(parse_result_t));
-    if (!result) {
-        return NULL;
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// For Markdown, we'll do simple processing:
+// 1. Remove markdown headers (#, ##, etc.) but keep the text
+// 2. Remove markdown formatting (**, *, _, etc.)
+// 3. Remove code block markers (```)
+// 4. Keep the essential configuration text
+//
+// The normalizer only ever deletes bytes, so it rewrites the file buffer in
+// place (output position <= input position). Outside code blocks it jumps
+// from one markup byte to the next and moves the plain runs in between with
+// a single memmove; inside code blocks it moves whole lines found with
+// memchr. Runs before the first deletion are not touched at all.
+
+// Byte classes for the normalizer state machine
+enum {
+    MD_PLAIN = 0,
+    MD_NEWLINE,
+    MD_EMPHASIS,        // *
+    MD_UNDERSCORE,      // _ (emphasis unless inside a word)
+    MD_BACKTICK         // `
+};
+
+static const unsigned char md_byte_class[256] = {
+    ['\n'] = MD_NEWLINE,
+    ['*'] = MD_EMPHASIS,
+    ['_'] = MD_UNDERSCORE,
+    ['`'] = MD_BACKTICK,
+};
+
+// Length of the run of MD_PLAIN bytes starting at text
+static size_t plain_run_length(const char *text, size_t length) {
+    size_t pos = 0;
+
+#if defined(__SSE2__)
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i underscore = _mm_set1_epi8('_');
+    const __m128i backtick = _mm_set1_epi8('`');
+
+    while (pos + 16 <= length) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(text + pos));
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, newline), _mm_cmpeq_epi8(v, star)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, underscore), _mm_cmpeq_epi8(v, backtick)));
+        int mask = _mm_movemask_epi8(special);
+        if (mask) {
+            return pos + (size_t)__builtin_ctz((unsigned)mask);
+        }
+        pos += 16;
     }
-    
-    // Read the file
-    size_t file_length = 0;
-    char *file_content = read_file_contents(filename, &file_length);
-    
-    if (!file_content) {
-        result->success = 0;
-        result->error_message = strdup("Failed to read MD file");
-        return result;
+#endif
+
+    while (pos < length && md_byte_class[(unsigned char)text[pos]] == MD_PLAIN) {
+        pos++;
     }
-    
-    // For Markdown, we'll do simple processing:
-    // 1. Remove markdown headers (#, ##, etc.) but keep the text
-    // 2. Remove markdown formatting (**, *, _, etc.)
-    // 3. Remove code block markers (```)
-    // 4. Keep the essential configuration text
-    
-    char *processed = malloc(file_length + 1);
-    if (!processed) {
-        free(file_content);
-        result->success = 0;
-        result->error_message = strdup("Memory allocation failed");
-        return result;
+    return pos;
+}
+
+// Append text[in_pos, in_pos + count) at out_pos, moving only if needed
+static void move_run(char *text, size_t out_pos, size_t in_pos, size_t count) {
+    if (out_pos != in_pos && count > 0) {
+        memmove(text + out_pos, text + in_pos, count);
     }
-    
+}
+
+// Normalize Markdown in place, returns the new length
+// text[length] must be writable; the result is NUL-terminated there or earlier.
+static size_t normalize_markdown(char *text, size_t length) {
     size_t out_pos = 0;
     size_t in_pos = 0;
     int in_code_block = 0;
     int at_line_start = 1;
-    
-    while (in_pos < file_length) {
-        char c = file_content[in_pos];
-        
-        // Handle code blocks
-        if (at_line_start && in_pos + 2 < file_length &&
-            file_content[in_pos] == '`' &&
-            file_content[in_pos + 1] == '`' &&
-            file_content[in_pos + 2] == '`') {
-            in_code_block = !in_code_block;
-            in_pos += 3;
-            // Skip to end of line
-            while (in_pos < file_length && file_content[in_pos] != '\n') {
-                in_pos++;
+
+    while (in_pos < length) {
+        if (at_line_start) {
+            // Handle code blocks: drop the fence line
+            if (in_pos + 2 < length &&
+                text[in_pos] == '`' && text[in_pos + 1] == '`' && text[in_pos + 2] == '`') {
+                in_code_block = !in_code_block;
+                const char *newline = memchr(text + in_pos + 3, '\n', length - in_pos - 3);
+                in_pos = newline ? (size_t)(newline - text) + 1 : length;
+                continue;
             }
-            if (in_pos < file_length) {
-                in_pos++;
+
+            // Remove markdown headers: skip all # characters and following spaces
+            if (!in_code_block && text[in_pos] == '#') {
+                while (in_pos < length && (text[in_pos] == '#' || text[in_pos] == ' ')) {
+                    in_pos++;
+                }
+                at_line_start = 0;
+                continue;
             }
-            at_line_start = 1;
-            continue;
         }
-        
-        // If in code block, copy as-is
+
+        // If in code block, copy the rest of the line as-is
         if (in_code_block) {
-            processed[out_pos++] = c;
-            at_line_start = (c == '\n');
-            in_pos++;
+            const char *newline = memchr(text + in_pos, '\n', length - in_pos);
+            size_t line_end = newline ? (size_t)(newline - text) + 1 : length;
+            move_run(text, out_pos, in_pos, line_end - in_pos);
+            out_pos += line_end - in_pos;
+            in_pos = line_end;
+            at_line_start = 1;
             continue;
         }
-        
-        // Remove markdown headers
-        if (at_line_start && c == '#') {
-            // Skip all # characters and following spaces
-            while (in_pos < file_length && 
-                   (file_content[in_pos] == '#' || file_content[in_pos] == ' ')) {
-                in_pos++;
-            }
+
+        // Copy regular characters up to the next markup byte
+        size_t run = plain_run_length(text + in_pos, length - in_pos);
+        if (run > 0) {
+            move_run(text, out_pos, in_pos, run);
+            out_pos += run;
+            in_pos += run;
             at_line_start = 0;
             continue;
         }
-        
-        // Remove bold/italic markers (but not underscores in words)
-        if (c == '*') {
-            // Skip one or two asterisks
-            in_pos++;
-            if (in_pos < file_length && file_content[in_pos] == '*') {
-                in_pos++;
-            }
-            continue;
-        }
-        
-        // Handle underscore - only remove if it's a markdown emphasis marker
-        // (at word boundary), not if it's part of a word like mfa_enabled
-        if (c == '_') {
-            // Check if it's emphasis (not surrounded by alphanumeric)
-            int prev_alnum = (in_pos > 0 && isalnum(file_content[in_pos - 1]));
-            int next_alnum = (in_pos + 1 < file_length && isalnum(file_content[in_pos + 1]));
-            
-            if (prev_alnum && next_alnum) {
-                // It's part of a word like mfa_enabled, keep it
-                processed[out_pos++] = c;
-                at_line_start = 0;
+
+        switch (md_byte_class[(unsigned char)text[in_pos]]) {
+            case MD_NEWLINE:
+                text[out_pos++] = '\n';
                 in_pos++;
-                continue;
-            } else {
-                // It's markdown emphasis, skip it
+                at_line_start = 1;
+                break;
+
+            case MD_EMPHASIS:
+                // Remove bold/italic markers: skip one or two asterisks
                 in_pos++;
-                if (in_pos < file_length && file_content[in_pos] == '_') {
+                if (in_pos < length && text[in_pos] == '*') {
                     in_pos++;
                 }
-                continue;
+                break;
+
+            case MD_UNDERSCORE: {
+                // Keep underscores inside words like mfa_enabled. The byte
+                // before in_pos is either untouched or was copied onto itself.
+                int prev_alnum = (in_pos > 0 && isalnum((unsigned char)text[in_pos - 1]));
+                int next_alnum = (in_pos + 1 < length && isalnum((unsigned char)text[in_pos + 1]));
+
+                if (prev_alnum && next_alnum) {
+                    text[out_pos++] = '_';
+                    in_pos++;
+                    at_line_start = 0;
+                } else {
+                    // It's markdown emphasis, skip it
+                    in_pos++;
+                    if (in_pos < length && text[in_pos] == '_') {
+                        in_pos++;
+                    }
+                }
+                break;
             }
+
+            case MD_BACKTICK:
+            default:
+                // Remove inline code markers
+                in_pos++;
+                break;
         }
-        
-        // Remove inline code markers
-        if (c == '`') {
-            in_pos++;
-            continue;
-        }
-        
-        // Copy regular character
-        processed[out_pos++] = c;
-        at_line_start = (c == '\n');
-        in_pos++;
     }
-    
-    processed[out_pos] = '\0';
-    
-    result->content = processed;
-    result->content_length = out_pos;
-    result->success = 1;
-    result->error_message = NULL;
-    
-    free(file_content);
+
+    text[out_pos] = '\0';
+    return out_pos;
+}
+
+// Parse Markdown file - extract content and convert to plain text
+parse_result_t* parse_md_file(const char *filename, arena_t *arena) {
+    if (!filename) {
+        return NULL;
+    }
+
+    // Read the file
+    file_buffer_t input;
+    if (!load_file_buffer(filename, &input, arena)) {
+        parse_result_t *result = parse_result_create(arena);
+        return result ? parse_result_fail(result, "Failed to read MD file") : NULL;
+    }
+
+    return parse_md_buffer(&input, arena);
+}
+
+// Normalize a loaded Markdown document; the buffer becomes the content
+parse_result_t* parse_md_buffer(file_buffer_t *buffer, arena_t *arena) {
+    file_buffer_t input = *buffer;
+    memset(buffer, 0, sizeof(*buffer));
+
+    parse_result_t *result = parse_result_create(arena);
+    if (!result) {
+        release_file_buffer(&input);
+        return NULL;
+    }
+
+    // The file buffer is writable (heap, arena or private mapping), so it
+    // becomes the result content
+    input.length = normalize_markdown(input.data, input.length);
+    if (!parse_result_take_buffer(result, &input)) {
+        return parse_result_fail(result, "Memory allocation failed");
+    }
+
     return result;
 }
@@ -0,0 +1,1549 @@
+#define _POSIX_C_SOURCE 200809L
+#include "parsers/pdf_document.h"
+#include "matcher/literal_search.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <zlib.h>
+
+// Limits against malformed or hostile files
+#define PDF_MAX_OBJECTS (16u * 1024 * 1024)
+#define PDF_MAX_XREF_SECTIONS 256
+#define PDF_MAX_TREE_DEPTH 64
+
+// Where an object lives
+typedef struct {
+    uint8_t type;           // 0 = free/unknown, 1 = at offset, 2 = in object stream
+    uint32_t index;         // Index inside the object stream (type 2)
+    size_t offset;          // File offset (type 1) or object stream number (type 2)
+} pdf_xref_entry_t;
+
+// A decoded object stream
+typedef struct {
+    uint32_t number;
+    char *data;
+    size_t length;
+    size_t *offsets;        // Object offsets inside data, by index
+    uint32_t *numbers;      // Object numbers, by index
+    size_t count;
+} pdf_object_stream_t;
+
+struct pdf_document {
+    const char *data;
+    size_t length;
+
+    pdf_xref_entry_t *entries;
+    size_t entry_count;     // Highest object number + 1
+    size_t entry_capacity;
+    uint32_t root;          // Catalog object number (0 = unknown)
+    int rebuilt;
+
+    pdf_object_stream_t *object_streams;
+    size_t object_stream_count;
+    int sealed;             // Open finished - lookups must not modify the document
+
+    // Page content stream object numbers: page i uses
+    // contents[content_start[i] .. content_start[i + 1])
+    uint32_t *contents;
+    size_t content_count;
+    size_t content_capacity;
+    size_t *content_start;
+    size_t page_count;
+    size_t page_capacity;
+};
+
+// A byte range of the file (or of a decoded object stream)
+typedef struct {
+    const char *start;
+    const char *end;
+} pdf_span_t;
+
+// ==================== Lexer ====================
+
+static int is_pdf_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\0';
+}
+
+static int is_pdf_delimiter(char c) {
+    return c == '(' || c == ')' || c == '<' || c == '>' || c == '[' || c == ']' ||
+           c == '{' || c == '}' || c == '/' || c == '%';
+}
+
+// Skip whitespace and comments
+static const char* skip_space(const char *p, const char *end) {
+    while (p < end) {
+        if (is_pdf_space(*p)) {
+            p++;
+        } else if (*p == '%') {
+            while (p < end && *p != '\n' && *p != '\r') p++;
+        } else {
+            break;
+        }
+    }
+    return p;
+}
+
+// Skip a regular token (number, keyword, name body)
+static const char* skip_token(const char *p, const char *end) {
+    while (p < end && !is_pdf_space(*p) && !is_pdf_delimiter(*p)) p++;
+    return p;
+}
+
+// Parse a non-negative integer token
+static const char* parse_uint(const char *p, const char *end, size_t *value) {
+    const char *start = p;
+    size_t v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (v > (SIZE_MAX - 9) / 10) return NULL;
+        v = v * 10 + (size_t)(*p - '0');
+        p++;
+    }
+    if (p == start) return NULL;
+    *value = v;
+    return p;
+}
+
+// "N G R" starting at p? Returns the end of the reference or NULL
+static const char* match_reference(const char *p, const char *end, size_t *number) {
+    size_t num, gen;
+    const char *q = parse_uint(p, end, &num);
+    if (!q || q >= end || !is_pdf_space(*q)) return NULL;
+    q = skip_space(q, end);
+    q = parse_uint(q, end, &gen);
+    if (!q) return NULL;
+    q = skip_space(q, end);
+    if (q >= end || *q != 'R' || (q + 1 < end && !is_pdf_space(q[1]) && !is_pdf_delimiter(q[1]))) {
+        return NULL;
+    }
+    *number = num;
+    return q + 1;
+}
+
+// Skip one complete value (dictionary, array, string, name, reference, ...)
+static const char* skip_value(const char *p, const char *end) {
+    p = skip_space(p, end);
+    if (p >= end) return end;
+
+    if (*p == '(') {
+        int depth = 0;
+        while (p < end) {
+            if (*p == '\\') {
+                p += 2;
+                continue;
+            }
+            if (*p == '(') depth++;
+            if (*p == ')' && --depth == 0) return p + 1;
+            p++;
+        }
+        return end;
+    }
+
+    if (*p == '<' && p + 1 < end && p[1] != '<') {
+        const char *close = memchr(p, '>', (size_t)(end - p));
+        return close ? close + 1 : end;
+    }
+
+    if ((*p == '<' && p + 1 < end && p[1] == '<') || *p == '[') {
+        // Nested containers: track depth, skipping strings wholesale
+        int depth = 0;
+        while (p < end) {
+            if (*p == '(' || (*p == '<' && (p + 1 >= end || p[1] != '<'))) {
+                p = skip_value(p, end);
+                continue;
+            }
+            if (*p == '%') {
+                p = skip_space(p, end);
+                continue;
+            }
+            if (*p == '<' && p + 1 < end && p[1] == '<') {
+                depth++;
+                p += 2;
+            } else if (*p == '>' && p + 1 < end && p[1] == '>') {
+                p += 2;
+                if (--depth == 0) return p;
+            } else if (*p == '[') {
+                depth++;
+                p++;
+            } else if (*p == ']') {
+                p++;
+                if (--depth == 0) return p;
+            } else {
+                p++;
+            }
+        }
+        return end;
+    }
+
+    if (*p == '/') {
+        return skip_token(p + 1, end);
+    }
+
+    size_t number;
+    const char *ref_end = match_reference(p, end, &number);
+    if (ref_end) return ref_end;
+
+    const char *q = skip_token(p, end);
+    return q > p ? q : p + 1;
+}
+
+// Span of a name token without the slash equals name?
+static int span_is_name(pdf_span_t value, const char *name) {
+    size_t n = strlen(name);
+    const char *p = skip_space(value.start, value.end);
+    if (p >= value.end || *p != '/') return 0;
+    const char *q = skip_token(p + 1, value.end);
+    return (size_t)(q - (p + 1)) == n && memcmp(p + 1, name, n) == 0;
+}
+
+// Look up a key in the dictionary starting at dict.start ("<<")
+static int dict_get(pdf_span_t dict, const char *key, pdf_span_t *value) {
+    const char *p = skip_space(dict.start, dict.end);
+    if (p + 1 >= dict.end || p[0] != '<' || p[1] != '<') return 0;
+    p += 2;
+
+    size_t key_len = strlen(key);
+    while (1) {
+        p = skip_space(p, dict.end);
+        if (p >= dict.end || *p == '>') return 0;
+        if (*p != '/') {
+            p = skip_value(p, dict.end);  // Malformed entry
+            continue;
+        }
+
+        const char *name = p + 1;
+        const char *name_end = skip_token(name, dict.end);
+        const char *value_start = skip_space(name_end, dict.end);
+        const char *value_end = skip_value(value_start, dict.end);
+
+        if ((size_t)(name_end - name) == key_len && memcmp(name, key, key_len) == 0) {
+            value->start = value_start;
+            value->end = value_end;
+            return 1;
+        }
+        p = value_end;
+    }
+}
+
+static int span_uint(pdf_span_t value, size_t *out) {
+    const char *p = skip_space(value.start, value.end);
+    return parse_uint(p, value.end, out) != NULL;
+}
+
+static int span_reference(pdf_span_t value, size_t *number) {
+    const char *p = skip_space(value.start, value.end);
+    return match_reference(p, value.end, number) != NULL;
+}
+
+// ==================== Xref Entries ====================
+
+static int ensure_entries(pdf_document_t *doc, size_t count) {
+    if (count <= doc->entry_count) return 1;
+    if (count > PDF_MAX_OBJECTS) return 0;
+
+    if (count > doc->entry_capacity) {
+        size_t capacity = doc->entry_capacity ? doc->entry_capacity : 256;
+        while (capacity < count) capacity *= 2;
+        pdf_xref_entry_t *grown = realloc(doc->entries, capacity * sizeof(pdf_xref_entry_t));
+        if (!grown) return 0;
+        doc->entries = grown;
+        doc->entry_capacity = capacity;
+    }
+    memset(doc->entries + doc->entry_count, 0, (count - doc->entry_count) * sizeof(pdf_xref_entry_t));
+    doc->entry_count = count;
+    return 1;
+}
+
+// Record an entry unless a newer xref section already defined the object
+static void set_entry(pdf_document_t *doc, size_t number, uint8_t type,
+                      size_t offset, uint32_t index, int overwrite) {
+    if (number == 0 || !ensure_entries(doc, number + 1)) return;
+    if (doc->entries[number].type != 0 && !overwrite) return;
+    doc->entries[number].type = type;
+    doc->entries[number].offset = offset;
+    doc->entries[number].index = index;
+}
+
+// ==================== Objects ====================
+
+static pdf_object_stream_t* load_object_stream(pdf_document_t *doc, size_t number);
+
+// Body of an object: the span right after "N G obj"
+static int object_body(const pdf_document_t *doc, size_t number, pdf_span_t *body) {
+    if (number >= doc->entry_count) return 0;
+    const pdf_xref_entry_t *entry = &doc->entries[number];
+    const char *end = doc->data + doc->length;
+
+    if (entry->type == 1) {
+        if (entry->offset >= doc->length) return 0;
+        const char *p = doc->data + entry->offset;
+        size_t num, gen;
+        p = parse_uint(skip_space(p, end), end, &num);
+        if (!p || num != number) return 0;
+        p = parse_uint(skip_space(p, end), end, &gen);
+        if (!p) return 0;
+        p = skip_space(p, end);
+        if (end - p < 3 || memcmp(p, "obj", 3) != 0) return 0;
+        body->start = p + 3;
+        body->end = end;
+        return 1;
+    }
+
+    if (entry->type == 2 && !doc->sealed) {
+        // Object streams are decoded on first use (document open only)
+        pdf_object_stream_t *stream = load_object_stream((pdf_document_t *)doc, entry->offset);
+        if (!stream || entry->index >= stream->count || stream->numbers[entry->index] != number) {
+            return 0;
+        }
+        body->start = stream->data + stream->offsets[entry->index];
+        body->end = stream->data + stream->length;
+        return 1;
+    }
+
+    return 0;
+}
+
+// Follow a reference, if the value is one
+static int resolve(const pdf_document_t *doc, pdf_span_t value, pdf_span_t *out) {
+    size_t number;
+    if (span_reference(value, &number)) {
+        return object_body(doc, number, out);
+    }
+    *out = value;
+    return 1;
+}
+
+// Raw bytes between "stream" and "endstream" of a stream object
+static int stream_raw(const pdf_document_t *doc, pdf_span_t body, pdf_span_t *dict,
+                      const char **data, size_t *length) {
+    const char *p = skip_space(body.start, body.end);
+    dict->start = p;
+    dict->end = skip_value(p, body.end);
+    dict->end = dict->end > body.end ? body.end : dict->end;
+
+    p = skip_space(dict->end, body.end);
+    if (body.end - p < 6 || memcmp(p, "stream", 6) != 0) return 0;
+    p += 6;
+    if (p < body.end && *p == '\r') p++;
+    if (p < body.end && *p == '\n') p++;
+
+    size_t declared = 0;
+    pdf_span_t length_value, resolved;
+    if (dict_get(*dict, "Length", &length_value) && resolve(doc, length_value, &resolved) &&
+        span_uint(resolved, &declared) && declared <= (size_t)(body.end - p)) {
+        const char *after = skip_space(p + declared, body.end);
+        if (body.end - after >= 9 && memcmp(after, "endstream", 9) == 0) {
+            *data = p;
+            *length = declared;
+            return 1;
+        }
+    }
+
+    // Missing or wrong /Length - fall back to the endstream keyword
+    const char *close = literal_search(p, (size_t)(body.end - p), "endstream", 9);
+    if (!close) return 0;
+    const char *stream_end = close;
+    if (stream_end > p && stream_end[-1] == '\n') stream_end--;
+    if (stream_end > p && stream_end[-1] == '\r') stream_end--;
+    *data = p;
+    *length = (size_t)(stream_end - p);
+    return 1;
+}
+
+// ==================== Stream Filters ====================
+
+// Inflate a zlib (or raw deflate) stream
+static char* flate_decode(const char *data, size_t length, size_t *out_length) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        if (inflateInit2(&zs, attempt == 0 ? 15 : -15) != Z_OK) return NULL;
+
+        size_t capacity = length * 4 + 1024;
+        if (capacity > PDF_MAX_STREAM_SIZE) capacity = PDF_MAX_STREAM_SIZE;
+        char *out = malloc(capacity + 1);
+        if (!out) {
+            inflateEnd(&zs);
+            return NULL;
+        }
+
+        zs.next_in = (Bytef *)data;
+        size_t consumed = 0;
+        size_t produced = 0;
+        int status = Z_OK;
+
+        while (status == Z_OK) {
+            if (produced == capacity) {
+                if (capacity >= PDF_MAX_STREAM_SIZE) break;
+                size_t grown_capacity = capacity * 2 > PDF_MAX_STREAM_SIZE ? PDF_MAX_STREAM_SIZE
+                                                                           : capacity * 2;
+                char *grown = realloc(out, grown_capacity + 1);
+                if (!grown) break;
+                out = grown;
+                capacity = grown_capacity;
+            }
+
+            uInt in_chunk = (uInt)((length - consumed) > 0x40000000u ? 0x40000000u : (length - consumed));
+            uInt out_chunk = (uInt)((capacity - produced) > 0x40000000u ? 0x40000000u : (capacity - produced));
+            zs.next_in = (Bytef *)(data + consumed);
+            zs.avail_in = in_chunk;
+            zs.next_out = (Bytef *)(out + produced);
+            zs.avail_out = out_chunk;
+
+            status = inflate(&zs, Z_NO_FLUSH);
+            consumed += in_chunk - zs.avail_in;
+            produced += out_chunk - zs.avail_out;
+
+            if (status == Z_BUF_ERROR && zs.avail_out > 0) break;  // Input exhausted
+            if (status == Z_BUF_ERROR) status = Z_OK;
+        }
+        inflateEnd(&zs);
+
+        // A bad header on the first attempt means the stream may be raw deflate
+        if (produced == 0 && status == Z_DATA_ERROR && attempt == 0) {
+            free(out);
+            continue;
+        }
+
+        // Keep whatever decoded before a corrupt tail
+        out[produced] = '\0';
+        *out_length = produced;
+        return out;
+    }
+    return NULL;
+}
+
+// Undo PNG row predictors (/Predictor 10-15) in place
+static void png_unpredict(unsigned char *data, size_t *length, size_t columns,
+                          size_t colors, size_t bits) {
+    size_t bpp = (colors * bits + 7) / 8;
+    size_t row_length = (columns * colors * bits + 7) / 8;
+    if (bpp == 0 || row_length == 0) return;
+
+    size_t rows = *length / (row_length + 1);
+    unsigned char *out = data;
+    const unsigned char *prev = NULL;
+
+    for (size_t r = 0; r < rows; r++) {
+        const unsigned char *in = data + r * (row_length + 1);
+        unsigned char filter = in[0];
+        in++;
+
+        // out trails in by r + 1 bytes, so a row never overwrites its own input
+        for (size_t i = 0; i < row_length; i++) {
+            unsigned int left = i >= bpp ? out[i - bpp] : 0;
+            unsigned int up = prev ? prev[i] : 0;
+            unsigned int up_left = prev && i >= bpp ? prev[i - bpp] : 0;
+            unsigned int value = in[i];
+
+            switch (filter) {
+                case 1: value += left; break;
+                case 2: value += up; break;
+                case 3: value += (left + up) / 2; break;
+                case 4: {
+                    int p = (int)left + (int)up - (int)up_left;
+                    int pa = abs(p - (int)left), pb = abs(p - (int)up), pc = abs(p - (int)up_left);
+                    value += (pa <= pb && pa <= pc) ? left : (pb <= pc ? up : up_left);
+                    break;
+                }
+                default: break;
+            }
+            out[i] = (unsigned char)value;
+        }
+
+        prev = out;
+        out += row_length;
+    }
+
+    *length = (size_t)(out - data);
+}
+
+// Number of FlateDecode filters in a /Filter name or array, -1 if any other
+// filter is used
+static int count_flate_filters(pdf_span_t filters) {
+    int flate_count = 0;
+    const char *p = skip_space(filters.start, filters.end);
+    const char *end = p < filters.end && *p == '[' ? skip_value(p, filters.end) : filters.end;
+    if (p < end && *p == '[') p++;
+
+    while ((p = skip_space(p, end)) < end && *p == '/') {
+        pdf_span_t name = { p, end };
+        if (!span_is_name(name, "FlateDecode") && !span_is_name(name, "Fl")) {
+            return -1;  // Image codecs and other filters carry no text
+        }
+        flate_count++;
+        p = skip_token(p + 1, end);
+    }
+    return flate_count;
+}
+
+// Inflate already decoded data count more times (chained FlateDecode);
+// takes ownership of decoded
+static char* flate_decode_again(char *decoded, size_t *length, int count) {
+    for (int i = 0; decoded && i < count; i++) {
+        size_t next_length;
+        char *next = flate_decode(decoded, *length, &next_length);
+        free(decoded);
+        decoded = next;
+        *length = next_length;
+    }
+    return decoded;
+}
+
+// Undo the PNG predictor of a /DecodeParms dictionary, if it names one
+static void apply_predictor(pdf_span_t parms, char *decoded, size_t *length) {
+    pdf_span_t predictor_value;
+    size_t predictor = 0;
+    if (!dict_get(parms, "Predictor", &predictor_value) ||
+        !span_uint(predictor_value, &predictor) || predictor < 10) {
+        return;
+    }
+
+    size_t columns = 1, colors = 1, bits = 8;
+    pdf_span_t v;
+    if (dict_get(parms, "Columns", &v)) span_uint(v, &columns);
+    if (dict_get(parms, "Colors", &v)) span_uint(v, &colors);
+    if (dict_get(parms, "BitsPerComponent", &v)) span_uint(v, &bits);
+    if (columns > 0 && columns < 1u << 20 && colors > 0 && colors < 64 && bits > 0 && bits <= 16) {
+        png_unpredict((unsigned char *)decoded, length, columns, colors, bits);
+        decoded[*length] = '\0';
+    }
+}
+
+// Decode a stream's filters; only FlateDecode (possibly chained) is supported
+static char* decode_stream(const pdf_document_t *doc, pdf_span_t dict,
+                           const char *raw, size_t raw_length, size_t *out_length) {
+    pdf_span_t filter_value, filters;
+    int flate_count = 0;
+
+    if (dict_get(dict, "Filter", &filter_value) && resolve(doc, filter_value, &filters)) {
+        flate_count = count_flate_filters(filters);
+        if (flate_count < 0) return NULL;
+    }
+
+    if (flate_count == 0) {
+        char *copy = malloc(raw_length + 1);
+        if (!copy) return NULL;
+        memcpy(copy, raw, raw_length);
+        copy[raw_length] = '\0';
+        *out_length = raw_length;
+        return copy;
+    }
+
+    char *decoded = flate_decode(raw, raw_length, out_length);
+    decoded = flate_decode_again(decoded, out_length, flate_count - 1);
+    if (!decoded) return NULL;
+
+    pdf_span_t parms_value, parms;
+    if (dict_get(dict, "DecodeParms", &parms_value) && resolve(doc, parms_value, &parms)) {
+        apply_predictor(parms, decoded, out_length);
+    }
+
+    return decoded;
+}
+
+// Decode the stream of an object (caller frees)
+static char* object_stream_data(const pdf_document_t *doc, pdf_span_t body,
+                                 pdf_span_t *dict, size_t *length) {
+    const char *raw;
+    size_t raw_length;
+    if (!stream_raw(doc, body, dict, &raw, &raw_length)) return NULL;
+    return decode_stream(doc, *dict, raw, raw_length, length);
+}
+
+// ==================== Object Streams ====================
+
+static pdf_object_stream_t* load_object_stream(pdf_document_t *doc, size_t number) {
+    for (size_t i = 0; i < doc->object_stream_count; i++) {
+        if (doc->object_streams[i].number == number) {
+            return doc->object_streams[i].data ? &doc->object_streams[i] : NULL;
+        }
+    }
+
+    pdf_object_stream_t *grown = realloc(doc->object_streams,
+                                         (doc->object_stream_count + 1) * sizeof(pdf_object_stream_t));
+    if (!grown) return NULL;
+    doc->object_streams = grown;
+    pdf_object_stream_t *stream = &doc->object_streams[doc->object_stream_count++];
+    memset(stream, 0, sizeof(*stream));
+    stream->number = (uint32_t)number;
+
+    // Object streams always live directly in the file
+    pdf_span_t body, dict;
+    if (number >= doc->entry_count || doc->entries[number].type != 1 ||
+        !object_body(doc, number, &body)) {
+        return NULL;
+    }
+
+    size_t length;
+    char *data = object_stream_data(doc, body, &dict, &length);
+    if (!data) return NULL;
+
+    pdf_span_t v;
+    size_t count = 0, first = 0;
+    if (!dict_get(dict, "N", &v) || !span_uint(v, &count) ||
+        !dict_get(dict, "First", &v) || !span_uint(v, &first) ||
+        first > length || count > length / 2 + 1) {
+        free(data);
+        return NULL;
+    }
+
+    stream->offsets = calloc(count ? count : 1, sizeof(size_t));
+    stream->numbers = calloc(count ? count : 1, sizeof(uint32_t));
+    if (!stream->offsets || !stream->numbers) {
+        free(stream->offsets);
+        free(stream->numbers);
+        stream->offsets = NULL;
+        stream->numbers = NULL;
+        free(data);
+        return NULL;
+    }
+
+    // Header: pairs of "object-number offset"
+    const char *p = data;
+    const char *header_end = data + first;
+    size_t parsed = 0;
+    while (parsed < count) {
+        size_t obj, offset;
+        p = parse_uint(skip_space(p, header_end), header_end, &obj);
+        if (!p) break;
+        p = parse_uint(skip_space(p, header_end), header_end, &offset);
+        if (!p || first + offset > length) break;
+        stream->numbers[parsed] = (uint32_t)obj;
+        stream->offsets[parsed] = first + offset;
+        parsed++;
+    }
+
+    stream->data = data;
+    stream->length = length;
+    stream->count = parsed;
+    return stream;
+}
+
+// ==================== Cross-Reference Sections ====================
+
+// Classic "xref" table starting at p; returns the trailer dictionary
+static int read_xref_table(pdf_document_t *doc, const char *p, pdf_span_t *trailer) {
+    const char *end = doc->data + doc->length;
+    p = skip_space(p + 4, end);
+
+    while (p < end && *p >= '0' && *p <= '9') {
+        size_t start, count;
+        p = parse_uint(p, end, &start);
+        if (!p) return 0;
+        p = parse_uint(skip_space(p, end), end, &count);
+        if (!p || count > PDF_MAX_OBJECTS || start > PDF_MAX_OBJECTS) return 0;
+
+        for (size_t i = 0; i < count; i++) {
+            size_t offset, gen;
+            p = parse_uint(skip_space(p, end), end, &offset);
+            if (!p) return 0;
+            p = parse_uint(skip_space(p, end), end, &gen);
+            if (!p) return 0;
+            p = skip_space(p, end);
+            if (p >= end) return 0;
+            if (*p == 'n' && offset > 0) {
+                set_entry(doc, start + i, 1, offset, 0, 0);
+            }
+            p++;
+        }
+        p = skip_space(p, end);
+    }
+
+    if (end - p < 7 || memcmp(p, "trailer", 7) != 0) return 0;
+    trailer->start = skip_space(p + 7, end);
+    trailer->end = end;
+    return 1;
+}
+
+// Read a big-endian field of an xref stream entry
+static size_t read_field(const unsigned char *p, size_t width) {
+    size_t value = 0;
+    for (size_t i = 0; i < width; i++) value = (value << 8) | p[i];
+    return value;
+}
+
+// Xref stream object at p; its dictionary doubles as the trailer
+static int read_xref_stream(pdf_document_t *doc, const char *p, pdf_span_t *trailer) {
+    const char *end = doc->data + doc->length;
+    size_t num, gen;
+    p = parse_uint(skip_space(p, end), end, &num);
+    if (!p) return 0;
+    p = parse_uint(skip_space(p, end), end, &gen);
+    if (!p) return 0;
+    p = skip_space(p, end);
+    if (end - p < 3 || memcmp(p, "obj", 3) != 0) return 0;
+
+    pdf_span_t body = { p + 3, end }, dict, v;
+    size_t length;
+    char *data = object_stream_data(doc, body, &dict, &length);
+    if (!data) return 0;
+
+    if (!dict_get(dict, "Type", &v) || !span_is_name(v, "XRef") || !dict_get(dict, "W", &v)) {
+        free(data);
+        return 0;
+    }
+
+    // /W [type offset generation] field widths
+    size_t widths[3] = { 0, 0, 0 };
+    const char *w = skip_space(v.start, v.end);
+    if (w < v.end && *w == '[') w++;
+    for (int i = 0; i < 3; i++) {
+        w = parse_uint(skip_space(w, v.end), v.end, &widths[i]);
+        if (!w || widths[i] > 8) {
+            free(data);
+            return 0;
+        }
+    }
+    size_t entry_size = widths[0] + widths[1] + widths[2];
+
+    size_t size = 0;
+    if (dict_get(dict, "Size", &v)) span_uint(v, &size);
+
+    // /Index [start count ...], default [0 Size]
+    size_t ranges[2 * 64];
+    size_t range_count = 0;
+    if (dict_get(dict, "Index", &v)) {
+        const char *q = skip_space(v.start, v.end);
+        if (q < v.end && *q == '[') q++;
+        while (range_count < 64) {
+            size_t start, count;
+            q = parse_uint(skip_space(q, v.end), v.end, &start);
+            if (!q) break;
+            q = parse_uint(skip_space(q, v.end), v.end, &count);
+            if (!q) break;
+            ranges[2 * range_count] = start;
+            ranges[2 * range_count + 1] = count;
+            range_count++;
+        }
+    } else {
+        ranges[0] = 0;
+        ranges[1] = size;
+        range_count = 1;
+    }
+
+    const unsigned char *entry = (const unsigned char *)data;
+    const unsigned char *entries_end = entry + length;
+    for (size_t r = 0; r < range_count && entry_size > 0; r++) {
+        for (size_t i = 0; i < ranges[2 * r + 1] && entry + entry_size <= entries_end; i++) {
+            size_t type = widths[0] ? read_field(entry, widths[0]) : 1;
+            size_t field2 = read_field(entry + widths[0], widths[1]);
+            size_t field3 = read_field(entry + widths[0] + widths[1], widths[2]);
+            size_t number = ranges[2 * r] + i;
+
+            if (type == 1 && field2 > 0) {
+                set_entry(doc, number, 1, field2, 0, 0);
+            } else if (type == 2) {
+                set_entry(doc, number, 2, field2, (uint32_t)field3, 0);
+            }
+            entry += entry_size;
+        }
+    }
+
+    free(data);
+    *trailer = dict;
+    return 1;
+}
+
+// Offset after the last "startxref"
+static int find_startxref(const pdf_document_t *doc, size_t *offset) {
+    size_t window = doc->length < 2048 ? doc->length : 2048;
+    const char *tail = doc->data + doc->length - window;
+    const char *found = NULL;
+    const char *p = tail;
+
+    while ((p = literal_search(p, (size_t)(doc->data + doc->length - p), "startxref", 9)) != NULL) {
+        found = p;
+        p += 9;
+    }
+    if (!found) return 0;
+
+    const char *end = doc->data + doc->length;
+    return parse_uint(skip_space(found + 9, end), end, offset) != NULL;
+}
+
+// Walk the xref chain from startxref through /Prev (newest section first)
+static int load_xref(pdf_document_t *doc) {
+    size_t offset;
+    if (!find_startxref(doc, &offset)) return 0;
+
+    const char *end = doc->data + doc->length;
+    for (int section = 0; section < PDF_MAX_XREF_SECTIONS; section++) {
+        if (offset >= doc->length) return 0;
+
+        const char *p = skip_space(doc->data + offset, end);
+        pdf_span_t trailer, v;
+        int ok = (end - p >= 4 && memcmp(p, "xref", 4) == 0)
+                 ? read_xref_table(doc, p, &trailer)
+                 : read_xref_stream(doc, p, &trailer);
+        if (!ok) return 0;
+
+        size_t number;
+        if (doc->root == 0 && dict_get(trailer, "Root", &v) && span_reference(v, &number)) {
+            doc->root = (uint32_t)number;
+        }
+
+        // Hybrid files list compressed objects in a separate xref stream
+        size_t stream_offset;
+        if (dict_get(trailer, "XRefStm", &v) && span_uint(v, &stream_offset) &&
+            stream_offset < doc->length) {
+            pdf_span_t ignored;
+            read_xref_stream(doc, doc->data + stream_offset, &ignored);
+        }
+
+        if (!dict_get(trailer, "Prev", &v) || !span_uint(v, &offset)) break;
+    }
+
+    return doc->root != 0;
+}
+
+// Damaged xref: find every "N G obj" in the file (later definitions win)
+// Start of the "N G " in front of an "obj" keyword found at keyword, or NULL
+// if it is not an object header; data is where the text may be walked back to
+static const char* object_header_start(const char *data, const char *keyword,
+                                       const char *end) {
+    const char *p = keyword + 3;
+    if (keyword == data || (p < end && !is_pdf_space(*p) && !is_pdf_delimiter(*p))) return NULL;
+    if (!is_pdf_space(keyword[-1])) return NULL;  // Also rejects "endobj"
+
+    // Walk back over "N G "
+    const char *q = keyword;
+    while (q > data && is_pdf_space(q[-1])) q--;
+    const char *gen_end = q;
+    while (q > data && q[-1] >= '0' && q[-1] <= '9') q--;
+    if (q == gen_end || q == data || !is_pdf_space(q[-1])) return NULL;
+    while (q > data && is_pdf_space(q[-1])) q--;
+    const char *num_end = q;
+    while (q > data && q[-1] >= '0' && q[-1] <= '9') q--;
+    return q == num_end ? NULL : q;
+}
+
+static int rebuild_xref(pdf_document_t *doc) {
+    const char *data = doc->data;
+    const char *end = data + doc->length;
+    const char *p = data;
+
+    if (doc->entries) {
+        memset(doc->entries, 0, doc->entry_count * sizeof(pdf_xref_entry_t));
+    }
+    doc->root = 0;
+
+    while ((p = literal_search(p, (size_t)(end - p), "obj", 3)) != NULL) {
+        const char *q = object_header_start(data, p, end);
+        p += 3;
+
+        size_t number;
+        if (!q || !parse_uint(q, end, &number)) continue;
+        set_entry(doc, number, 1, (size_t)(q - data), 0, 1);
+    }
+
+    // Register objects packed in object streams, and find the catalog
+    for (size_t number = 1; number < doc->entry_count; number++) {
+        pdf_span_t body, dict, v;
+        if (doc->entries[number].type != 1 || !object_body(doc, number, &body)) continue;
+
+        dict.start = skip_space(body.start, body.end);
+        dict.end = body.end;
+        if (!dict_get(dict, "Type", &v)) continue;
+
+        if (span_is_name(v, "Catalog") && doc->root == 0) {
+            doc->root = (uint32_t)number;
+        } else if (span_is_name(v, "ObjStm")) {
+            pdf_object_stream_t *stream = load_object_stream(doc, number);
+            for (size_t i = 0; stream && i < stream->count; i++) {
+                set_entry(doc, stream->numbers[i], 2, number, (uint32_t)i, 0);
+            }
+        }
+    }
+
+    // The catalog may itself be compressed
+    for (size_t number = 1; doc->root == 0 && number < doc->entry_count; number++) {
+        pdf_span_t body, dict, v;
+        if (doc->entries[number].type != 2 || !object_body(doc, number, &body)) continue;
+        dict.start = skip_space(body.start, body.end);
+        dict.end = body.end;
+        if (dict_get(dict, "Type", &v) && span_is_name(v, "Catalog")) {
+            doc->root = (uint32_t)number;
+        }
+    }
+
+    doc->rebuilt = 1;
+    return 1;
+}
+
+// ==================== Page Tree ====================
+
+static int add_content(pdf_document_t *doc, size_t number) {
+    if (doc->content_count == doc->content_capacity) {
+        size_t capacity = doc->content_capacity ? doc->content_capacity * 2 : 64;
+        uint32_t *grown = realloc(doc->contents, capacity * sizeof(uint32_t));
+        if (!grown) return 0;
+        doc->contents = grown;
+        doc->content_capacity = capacity;
+    }
+    doc->contents[doc->content_count++] = (uint32_t)number;
+    return 1;
+}
+
+// Record a page and its content stream references
+static int add_page(pdf_document_t *doc, pdf_span_t page) {
+    if (doc->page_count + 2 > doc->page_capacity) {
+        size_t capacity = doc->page_capacity ? doc->page_capacity * 2 : 64;
+        size_t *grown = realloc(doc->content_start, capacity * sizeof(size_t));
+        if (!grown) return 0;
+        doc->content_start = grown;
+        doc->page_capacity = capacity;
+    }
+    doc->content_start[doc->page_count] = doc->content_count;
+
+    pdf_span_t value, contents;
+    if (dict_get(page, "Contents", &value) && resolve(doc, value, &contents)) {
+        size_t number;
+        if (span_reference(value, &number) && *skip_space(contents.start, contents.end) != '[') {
+            // Direct reference to a single stream
+            if (!add_content(doc, number)) return 0;
+        } else {
+            const char *p = skip_space(contents.start, contents.end);
+            const char *end = skip_value(p, contents.end);
+            if (p < end && *p == '[') p++;
+            while ((p = skip_space(p, end)) < end && *p != ']') {
+                const char *next = match_reference(p, end, &number);
+                if (!next) break;
+                if (!add_content(doc, number)) return 0;
+                p = next;
+            }
+        }
+    }
+
+    doc->page_count++;
+    doc->content_start[doc->page_count] = doc->content_count;
+    return 1;
+}
+
+// Depth-first walk of /Kids from the catalog's /Pages
+static int load_page_tree(pdf_document_t *doc) {
+    pdf_span_t catalog, value;
+    size_t pages_root;
+    if (!object_body(doc, doc->root, &catalog)) return 0;
+    catalog.start = skip_space(catalog.start, catalog.end);
+    if (!dict_get(catalog, "Pages", &value) || !span_reference(value, &pages_root)) return 0;
+
+    unsigned char *visited = calloc(doc->entry_count ? doc->entry_count : 1, 1);
+    if (!visited) return 0;
+
+    // Explicit stack of remaining kids per level
+    pdf_span_t stack[PDF_MAX_TREE_DEPTH];
+    size_t depth = 0;
+    int ok = 1;
+
+    size_t number = pages_root;
+    int have_node = 1;
+    while (ok) {
+        if (have_node && number < doc->entry_count && !visited[number]) {
+            visited[number] = 1;
+
+            pdf_span_t node, type, kids_value, kids;
+            if (object_body(doc, number, &node)) {
+                node.start = skip_space(node.start, node.end);
+                int is_page = dict_get(node, "Type", &type) ? span_is_name(type, "Page")
+                                                            : !dict_get(node, "Kids", &kids_value);
+                if (is_page) {
+                    ok = add_page(doc, node);
+                } else if (dict_get(node, "Kids", &kids_value) && resolve(doc, kids_value, &kids) &&
+                           depth < PDF_MAX_TREE_DEPTH) {
+                    const char *p = skip_space(kids.start, kids.end);
+                    if (p < kids.end && *p == '[') {
+                        stack[depth].start = p + 1;
+                        stack[depth].end = skip_value(p, kids.end);
+                        depth++;
+                    }
+                }
+            }
+        }
+        have_node = 0;
+
+        // Next kid reference from the innermost unfinished /Kids array
+        while (depth > 0) {
+            pdf_span_t *kids = &stack[depth - 1];
+            const char *p = skip_space(kids->start, kids->end);
+            const char *next = p < kids->end && *p != ']' ? match_reference(p, kids->end, &number)
+                                                          : NULL;
+            if (next) {
+                kids->start = next;
+                have_node = 1;
+                break;
+            }
+            depth--;
+        }
+        if (!have_node) break;
+    }
+
+    free(visited);
+    return ok && doc->page_count > 0;
+}
+
+// Last resort: every /Type /Page object, in object number order
+static int collect_page_objects(pdf_document_t *doc) {
+    for (size_t number = 1; number < doc->entry_count; number++) {
+        pdf_span_t body, v;
+        if (doc->entries[number].type == 0 || !object_body(doc, number, &body)) continue;
+        body.start = skip_space(body.start, body.end);
+        if (dict_get(body, "Type", &v) && span_is_name(v, "Page") && !add_page(doc, body)) {
+            return 0;
+        }
+    }
+    return doc->page_count > 0;
+}
+
+// ==================== Document ====================
+
+static void reset_pages(pdf_document_t *doc) {
+    doc->page_count = 0;
+    doc->content_count = 0;
+}
+
+// Open a PDF held in memory; NULL if no page could be located
+pdf_document_t* pdf_document_open(const char *data, size_t length) {
+    if (!data || length < 8 || memcmp(data, "%PDF-", 5) != 0) {
+        return NULL;
+    }
+
+    pdf_document_t *doc = calloc(1, sizeof(pdf_document_t));
+    if (!doc) return NULL;
+    doc->data = data;
+    doc->length = length;
+
+    if (!load_xref(doc) || !load_page_tree(doc)) {
+        reset_pages(doc);
+        rebuild_xref(doc);
+        if (!(doc->root && load_page_tree(doc))) {
+            reset_pages(doc);
+            collect_page_objects(doc);
+        }
+    }
+
+    if (doc->page_count == 0) {
+        pdf_document_close(doc);
+        return NULL;
+    }
+
+    // Object streams were only needed to find the pages
+    for (size_t i = 0; i < doc->object_stream_count; i++) {
+        free(doc->object_streams[i].data);
+        free(doc->object_streams[i].offsets);
+        free(doc->object_streams[i].numbers);
+    }
+    free(doc->object_streams);
+    doc->object_streams = NULL;
+    doc->object_stream_count = 0;
+
+    // From here on page content may be decoded from several threads; a
+    // /Length stored in an object stream falls back to the endstream scan
+    doc->sealed = 1;
+
+    return doc;
+}
+
+void pdf_document_close(pdf_document_t *doc) {
+    if (!doc) return;
+
+    for (size_t i = 0; i < doc->object_stream_count; i++) {
+        free(doc->object_streams[i].data);
+        free(doc->object_streams[i].offsets);
+        free(doc->object_streams[i].numbers);
+    }
+    free(doc->object_streams);
+    free(doc->entries);
+    free(doc->contents);
+    free(doc->content_start);
+    free(doc);
+}
+
+size_t pdf_document_page_count(const pdf_document_t *doc) {
+    return doc ? doc->page_count : 0;
+}
+
+int pdf_document_was_rebuilt(const pdf_document_t *doc) {
+    return doc ? doc->rebuilt : 0;
+}
+
+// Decode and concatenate a page's content streams
+char* pdf_document_page_content(const pdf_document_t *doc, size_t page, size_t *length) {
+    if (!doc || page >= doc->page_count || !length) {
+        return NULL;
+    }
+
+    size_t capacity = 4096;
+    size_t used = 0;
+    char *content = malloc(capacity);
+    if (!content) return NULL;
+
+    for (size_t i = doc->content_start[page]; i < doc->content_start[page + 1]; i++) {
+        size_t number = doc->contents[i];
+
+        // Streams are never inside object streams, so this stays read-only
+        pdf_span_t body, dict;
+        if (number >= doc->entry_count || doc->entries[number].type != 1 ||
+            !object_body(doc, number, &body)) {
+            continue;
+        }
+
+        size_t stream_length;
+        char *stream = object_stream_data(doc, body, &dict, &stream_length);
+        if (!stream) continue;
+
+        // Streams of one page are joined with whitespace between them
+        if (used + stream_length + 2 > capacity) {
+            while (used + stream_length + 2 > capacity) capacity *= 2;
+            char *grown = realloc(content, capacity);
+            if (!grown) {
+                free(stream);
+                free(content);
+                return NULL;
+            }
+            content = grown;
+        }
+        memcpy(content + used, stream, stream_length);
+        used += stream_length;
+        content[used++] = '\n';
+        free(stream);
+    }
+
+    content[used] = '\0';
+    *length = used;
+    return content;
+}
+
+// ==================== Streaming Reader ====================
+
+// Bytes kept when a window holds no object header, enough for "N G obj"
+#define PDF_STREAM_OVERLAP 64
+// Bytes wanted ahead of an object header or stream data before parsing it
+#define PDF_STREAM_LOOKAHEAD 4096
+
+typedef struct {
+    FILE *input;            // NULL when reading from memory
+    char *buffer;           // Window of PDF_STREAM_WINDOW_SIZE bytes (file input)
+    const char *data;       // buffer, or the whole memory input
+    size_t pos;             // Next unread byte of data
+    size_t end;             // End of valid data
+    int eof;
+    int error;
+    pdf_stream_stats_t stats;
+} pdf_stream_reader_t;
+
+// Decoded content of one stream, inflated incrementally as it is read
+typedef struct {
+    z_stream zs;
+    int inflating;          // 0 = unfiltered, copied as is
+    int window_bits;        // 15 = zlib, -15 = raw deflate
+    int done;
+    uint64_t fed;           // Raw bytes fed so far
+    char *data;
+    size_t length;
+    size_t capacity;
+} content_sink_t;
+
+// Make at least want bytes available from pos, moving the unread rest of the
+// window to its front; fewer are available only at the end of the input
+static void reader_fill(pdf_stream_reader_t *r, size_t want) {
+    if (!r->input || r->eof || r->end - r->pos >= want) return;
+
+    memmove(r->buffer, r->buffer + r->pos, r->end - r->pos);
+    r->end -= r->pos;
+    r->pos = 0;
+
+    while (r->end < PDF_STREAM_WINDOW_SIZE && r->end < want) {
+        size_t n = fread(r->buffer + r->end, 1, PDF_STREAM_WINDOW_SIZE - r->end, r->input);
+        r->end += n;
+        r->stats.bytes_read += n;
+        if (n == 0) {
+            if (ferror(r->input)) r->error = 1;
+            r->eof = 1;
+            break;
+        }
+    }
+}
+
+// Read more input after what the window holds (no-op once it is full)
+static void reader_more(pdf_stream_reader_t *r) {
+    reader_fill(r, r->end - r->pos + 1);
+}
+
+// Skip n bytes, seeking over what the window does not hold
+static void reader_skip(pdf_stream_reader_t *r, uint64_t n) {
+    size_t available = r->end - r->pos;
+    if (n <= available) {
+        r->pos += (size_t)n;
+        return;
+    }
+
+    n -= available;
+    r->pos = r->end;
+    if (!r->input || r->eof) return;
+    r->pos = r->end = 0;
+
+    if (n > PDF_STREAM_WINDOW_SIZE && (off_t)n > 0 && fseeko(r->input, (off_t)n, SEEK_CUR) == 0) {
+        r->stats.bytes_skipped += n;
+        return;
+    }
+
+    // Not seekable (a pipe) - read through
+    while (n > 0) {
+        size_t chunk = n > PDF_STREAM_WINDOW_SIZE ? PDF_STREAM_WINDOW_SIZE : (size_t)n;
+        size_t got = fread(r->buffer, 1, chunk, r->input);
+        r->stats.bytes_read += got;
+        n -= got;
+        if (got < chunk) {
+            if (ferror(r->input)) r->error = 1;
+            r->eof = 1;
+            break;
+        }
+    }
+}
+
+// 1 if "endstream" follows length bytes of stream data at pos, or if that
+// cannot be checked without reading the stream (a pipe)
+static int reader_endstream_at(pdf_stream_reader_t *r, uint64_t length) {
+    char tail[32];
+    const char *p;
+    size_t tail_length;
+    if (r->input && length + sizeof(tail) <= PDF_STREAM_WINDOW_SIZE) {
+        reader_fill(r, (size_t)length + sizeof(tail));
+    }
+    size_t available = r->end - r->pos;
+
+    if (length + sizeof(tail) <= available || !r->input || r->eof) {
+        if (length > available) return 0;
+        p = r->data + r->pos + length;
+        tail_length = available - (size_t)length < sizeof(tail) ? available - (size_t)length
+                                                                 : sizeof(tail);
+    } else {
+        off_t here = ftello(r->input);
+        off_t target = here - (off_t)available + (off_t)length;
+        if (here < 0 || target < 0 || fseeko(r->input, target, SEEK_SET) != 0) return 1;
+        tail_length = fread(tail, 1, sizeof(tail), r->input);
+        if (fseeko(r->input, here, SEEK_SET) != 0) r->error = 1;
+        p = tail;
+    }
+
+    const char *keyword = skip_space(p, p + tail_length);
+    return (size_t)(p + tail_length - keyword) >= 9 && memcmp(keyword, "endstream", 9) == 0;
+}
+
+static int sink_init(content_sink_t *sink, int inflating) {
+    memset(sink, 0, sizeof(*sink));
+    sink->inflating = inflating;
+    sink->window_bits = 15;
+    if (inflating && inflateInit2(&sink->zs, sink->window_bits) != Z_OK) return 0;
+
+    sink->capacity = 64 * 1024;
+    sink->data = malloc(sink->capacity + 1);
+    if (!sink->data) {
+        if (inflating) inflateEnd(&sink->zs);
+        return 0;
+    }
+    return 1;
+}
+
+// Room for at least one more byte; 0 once PDF_MAX_STREAM_SIZE is reached
+static int sink_room(content_sink_t *sink) {
+    if (sink->length < sink->capacity) return 1;
+    if (sink->capacity >= PDF_MAX_STREAM_SIZE) return 0;
+
+    size_t capacity = sink->capacity * 2 > PDF_MAX_STREAM_SIZE ? PDF_MAX_STREAM_SIZE
+                                                               : sink->capacity * 2;
+    char *grown = realloc(sink->data, capacity + 1);
+    if (!grown) return 0;
+    sink->data = grown;
+    sink->capacity = capacity;
+    return 1;
+}
+
+static void sink_feed(content_sink_t *sink, const char *data, size_t length) {
+    if (sink->done || length == 0) return;
+
+    if (!sink->inflating) {
+        while (length > 0 && sink_room(sink)) {
+            size_t chunk = sink->capacity - sink->length < length ? sink->capacity - sink->length
+                                                                  : length;
+            memcpy(sink->data + sink->length, data, chunk);
+            sink->length += chunk;
+            data += chunk;
+            length -= chunk;
+        }
+        if (length > 0) sink->done = 1;
+        return;
+    }
+
+    // Chunks come from the window, so they always fit in a uInt
+    int first = sink->fed == 0;
+    sink->fed += length;
+    sink->zs.next_in = (Bytef *)data;
+    sink->zs.avail_in = (uInt)length;
+
+    while (sink->zs.avail_in > 0) {
+        if (!sink_room(sink)) {
+            sink->done = 1;
+            break;
+        }
+        size_t room = sink->capacity - sink->length;
+        uInt out_chunk = (uInt)(room > 0x40000000u ? 0x40000000u : room);
+        sink->zs.next_out = (Bytef *)(sink->data + sink->length);
+        sink->zs.avail_out = out_chunk;
+
+        int status = inflate(&sink->zs, Z_NO_FLUSH);
+        sink->length += out_chunk - sink->zs.avail_out;
+
+        // A bad header means the stream may be raw deflate
+        if (status == Z_DATA_ERROR && first && sink->length == 0 && sink->window_bits > 0) {
+            inflateEnd(&sink->zs);
+            sink->window_bits = -15;
+            if (inflateInit2(&sink->zs, sink->window_bits) != Z_OK) {
+                sink->inflating = 0;
+                sink->done = 1;
+                return;
+            }
+            sink->zs.next_in = (Bytef *)data;
+            sink->zs.avail_in = (uInt)length;
+            continue;
+        }
+
+        // Keep whatever decoded before the end or a corrupt tail
+        if (status != Z_OK && !(status == Z_BUF_ERROR && sink->zs.avail_out == 0)) {
+            sink->done = 1;
+            break;
+        }
+    }
+}
+
+static void sink_free(content_sink_t *sink) {
+    if (sink->inflating) inflateEnd(&sink->zs);
+    free(sink->data);
+}
+
+// Can a stream with this dictionary show text? Sets the number of
+// FlateDecode filters; /Filter and /DecodeParms must be direct objects since
+// nothing else of the file is at hand
+static int is_content_stream(pdf_span_t dict, int *flate_count) {
+    static const char *const skipped_types[] = {
+        "XRef", "ObjStm", "Metadata", "EmbeddedFile", NULL
+    };
+    pdf_span_t value;
+    size_t number;
+
+    // Form XObjects hold content like pages; images, fonts and the rest do not
+    if (dict_get(dict, "Subtype", &value) && !span_is_name(value, "Form")) return 0;
+    if (dict_get(dict, "Type", &value)) {
+        for (size_t i = 0; skipped_types[i]; i++) {
+            if (span_is_name(value, skipped_types[i])) return 0;
+        }
+    }
+    if (dict_get(dict, "Length1", &value) || dict_get(dict, "Length2", &value) ||
+        dict_get(dict, "Length3", &value) || dict_get(dict, "N", &value)) {
+        return 0;  // Font programs, ICC profiles and object streams
+    }
+
+    *flate_count = 0;
+    if (dict_get(dict, "Filter", &value)) {
+        if (span_reference(value, &number)) return 0;
+        *flate_count = count_flate_filters(value);
+        if (*flate_count < 0) return 0;
+    }
+    if (dict_get(dict, "DecodeParms", &value) && span_reference(value, &number)) return 0;
+    return 1;
+}
+
+// Hand the stream data at pos to sink (or drop it when sink is NULL): length
+// bytes when known, otherwise everything up to the endstream keyword
+static void reader_stream_data(pdf_stream_reader_t *r, int known, uint64_t length,
+                               content_sink_t *sink) {
+    while (known && length > 0) {
+        if (r->pos == r->end) reader_fill(r, 1);
+        if (r->pos == r->end) return;
+
+        size_t available = r->end - r->pos;
+        size_t chunk = length < available ? (size_t)length : available;
+        if (sink) sink_feed(sink, r->data + r->pos, chunk);
+        r->pos += chunk;
+        length -= chunk;
+    }
+
+    while (!known) {
+        const char *start = r->data + r->pos;
+        size_t available = r->end - r->pos;
+        const char *close = literal_search(start, available, "endstream", 9);
+
+        if (close) {
+            const char *stream_end = close;
+            if (stream_end > start && stream_end[-1] == '\n') stream_end--;
+            if (stream_end > start && stream_end[-1] == '\r') stream_end--;
+            if (sink) sink_feed(sink, start, (size_t)(stream_end - start));
+            r->pos += (size_t)(close - start) + 9;
+            return;
+        }
+
+        if (!r->input || r->eof) {
+            if (sink) sink_feed(sink, start, available);
+            r->pos = r->end;
+            return;
+        }
+
+        // Keep a possibly split keyword for the next window
+        if (available > 8) {
+            if (sink) sink_feed(sink, start, available - 8);
+            r->pos += available - 8;
+        }
+        reader_more(r);
+    }
+}
+
+// Decode the stream at pos and pass it on; 0 if on_content asked to stop
+static int reader_content(pdf_stream_reader_t *r, pdf_span_t parms, int flate_count,
+                          int known, uint64_t length, pdf_content_fn on_content, void *context) {
+    content_sink_t sink;
+    if (!sink_init(&sink, flate_count > 0)) {
+        reader_stream_data(r, known, length, NULL);
+        return 1;
+    }
+
+    reader_fill(r, PDF_STREAM_LOOKAHEAD);
+    reader_stream_data(r, known, length, &sink);
+
+    size_t decoded_length = sink.length;
+    char *decoded = sink.data;
+    sink.data = NULL;
+    sink_free(&sink);
+
+    decoded = flate_decode_again(decoded, &decoded_length, flate_count - 1);
+    if (!decoded) return 1;
+    decoded[decoded_length] = '\0';
+
+    if (parms.end > parms.start) apply_predictor(parms, decoded, &decoded_length);
+
+    r->stats.content_streams++;
+    int keep_going = on_content(decoded, decoded_length, context);
+    free(decoded);
+    return keep_going;
+}
+
+static int stream_objects(pdf_stream_reader_t *r, pdf_content_fn on_content, void *context) {
+    while (!r->error) {
+        reader_fill(r, PDF_STREAM_LOOKAHEAD);
+        const char *window = r->data + r->pos;
+        const char *end = r->data + r->end;
+        size_t available = r->end - r->pos;
+        if (available == 0) break;
+
+        const char *keyword = literal_search(window, available, "obj", 3);
+        if (!keyword) {
+            if (!r->input || r->eof) break;
+            if (available > PDF_STREAM_OVERLAP) r->pos = r->end - PDF_STREAM_OVERLAP;
+            reader_more(r);
+            continue;
+        }
+
+        const char *header = object_header_start(window, keyword, end);
+        const char *p = skip_space(keyword + 3, end);
+        if (!header || (p + 1 < end && (p[0] != '<' || p[1] != '<'))) {
+            r->pos = (size_t)(keyword + 3 - r->data);
+            continue;
+        }
+
+        // The dictionary and the stream keyword must be in the window; read
+        // more once if they are not, give up on huge dictionaries
+        const char *dict_end = p + 1 < end ? skip_value(p, end) : end;
+        if ((size_t)(end - dict_end) < 16 && r->input && !r->eof) {
+            r->pos = (size_t)(header - r->data);
+            if (r->end - r->pos < PDF_STREAM_WINDOW_SIZE) {
+                reader_more(r);
+            } else {
+                r->pos = (size_t)(keyword + 3 - r->data);
+            }
+            continue;
+        }
+
+        pdf_span_t dict = { p, dict_end };
+        const char *q = skip_space(dict_end, end);
+        if (end - q < 6 || memcmp(q, "stream", 6) != 0) {
+            r->pos = (size_t)(keyword + 3 - r->data);
+            continue;
+        }
+        q += 6;
+        if (q < end && *q == '\r') q++;
+        if (q < end && *q == '\n') q++;
+
+        // Classify before moving on, the dictionary leaves the window then
+        int flate_count = 0;
+        int content = is_content_stream(dict, &flate_count);
+        size_t declared = 0, number;
+        pdf_span_t length_value;
+        int known = dict_get(dict, "Length", &length_value) &&
+                    !span_reference(length_value, &number) && span_uint(length_value, &declared);
+
+        // The window moves while the data is read; keep a copy of the
+        // predictor parameters
+        char parms[256];
+        pdf_span_t parms_span = { parms, parms }, parms_value;
+        if (content && flate_count > 0 && dict_get(dict, "DecodeParms", &parms_value) &&
+            (size_t)(parms_value.end - parms_value.start) < sizeof(parms)) {
+            memcpy(parms, parms_value.start, (size_t)(parms_value.end - parms_value.start));
+            parms_span.end = parms + (parms_value.end - parms_value.start);
+        }
+
+        r->pos = (size_t)(q - r->data);
+        if (known && !reader_endstream_at(r, declared)) known = 0;
+
+        if (!content) {
+            r->stats.skipped_streams++;
+            if (known) {
+                reader_skip(r, declared);
+            } else {
+                reader_stream_data(r, 0, 0, NULL);
+            }
+            continue;
+        }
+
+        if (!reader_content(r, parms_span, flate_count, known, declared, on_content, context)) {
+            break;
+        }
+    }
+
+    return !r->error;
+}
+
+int pdf_stream_file(FILE *input, pdf_content_fn on_content, void *context,
+                    pdf_stream_stats_t *stats) {
+    if (stats) memset(stats, 0, sizeof(*stats));
+    if (!input || !on_content) return 0;
+
+    pdf_stream_reader_t reader;
+    memset(&reader, 0, sizeof(reader));
+    reader.input = input;
+    reader.buffer = malloc(PDF_STREAM_WINDOW_SIZE);
+    if (!reader.buffer) return 0;
+    reader.data = reader.buffer;
+
+    int ok = stream_objects(&reader, on_content, context);
+
+    free(reader.buffer);
+    if (stats) *stats = reader.stats;
+    return ok;
+}
+
+int pdf_stream_buffer(const char *data, size_t length, pdf_content_fn on_content,
+                      void *context, pdf_stream_stats_t *stats) {
+    if (stats) memset(stats, 0, sizeof(*stats));
+    if (!data || !on_content) return 0;
+
+    pdf_stream_reader_t reader;
+    memset(&reader, 0, sizeof(reader));
+    reader.data = data;
+    reader.end = length;
+    reader.eof = 1;
+    reader.stats.bytes_read = length;
+
+    int ok = stream_objects(&reader, on_content, context);
+
+    if (stats) *stats = reader.stats;
+    return ok;
+}
@@ -1,21 +1,117 @@
 #define _POSIX_C_SOURCE 200809L
 #include "parsers/file_parsers.h"
+#include "parsers/pdf_document.h"
+#include "runtime/task_runtime.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
 // Simple PDF text extraction
-// This is a basic implementation that extracts text from PDF stream objects
+// Pages and their content streams are located through the PDF object index
+// (parsers/pdf_document.h) and only those streams are decoded; text is then
+// taken from the string operands inside BT/ET blocks. Fonts with custom
+// encodings and no ToUnicode map are not translated.
 // For production use, consider using a library like poppler or mupdf
 
-static int is_text_char(unsigned char c) {
-    return (c >= 32 && c < 127) || c == '\n' || c == '\r' || c == '\t';
+// Separate two pieces of text; a line break replaces a pending space
+static void append_separator(char *text, size_t *text_pos, char separator) {
+    if (*text_pos == 0 || text[*text_pos-1] == '\n') {
+        return;
+    }
+    if (text[*text_pos-1] == ' ') {
+        if (separator == '\n') {
+            text[*text_pos-1] = '\n';
+        }
+        return;
+    }
+    text[(*text_pos)++] = separator;
+}
+
+// Decode a literal string "(...)" starting at stream[i]; returns the index after it
+static size_t read_literal_string(const char *stream, size_t stream_len, size_t i,
+                                  char *text, size_t *text_pos, int keep) {
+    int depth = 0;
+    
+    for (; i < stream_len; i++) {
+        char c = stream[i];
+        
+        if (c == '\\' && i+1 < stream_len) {
+            i++;
+            char out;
+            switch (stream[i]) {
+                case 'n': out = '\n'; break;
+                case 'r': out = '\r'; break;
+                case 't': out = '\t'; break;
+                case 'b': case 'f': out = ' '; break;
+                case '\r': case '\n': continue;  // Line continuation
+                default:
+                    if (stream[i] >= '0' && stream[i] <= '7') {
+                        // Octal escape, up to three digits
+                        int value = 0;
+                        int digits = 0;
+                        while (digits < 3 && i < stream_len && stream[i] >= '0' && stream[i] <= '7') {
+                            value = value * 8 + (stream[i] - '0');
+                            i++;
+                            digits++;
+                        }
+                        i--;
+                        out = (char)value;
+                    } else {
+                        out = stream[i];  // \( \) \\ and unknown escapes
+                    }
+                    break;
+            }
+            if (keep) text[(*text_pos)++] = out;
+            continue;
+        }
+        
+        if (c == '(') {
+            if (depth++ == 0) continue;
+        } else if (c == ')') {
+            if (--depth == 0) return i + 1;
+        }
+        if (keep) text[(*text_pos)++] = c;
+    }
+    
+    return stream_len;
+}
+
+// Decode a hex string "<...>" starting at stream[i] if it is plain ASCII
+static size_t read_hex_string(const char *stream, size_t stream_len, size_t i,
+                              char *text, size_t *text_pos, int keep) {
+    size_t start = *text_pos;
+    int high = -1;
+    int printable = 1;
+    
+    for (i++; i < stream_len && stream[i] != '>'; i++) {
+        int c = (unsigned char)stream[i];
+        int nibble = isdigit(c) ? c - '0' : isxdigit(c) ? (tolower(c) - 'a' + 10) : -1;
+        if (nibble < 0) continue;
+        if (high < 0) {
+            high = nibble;
+            continue;
+        }
+        int byte = high * 16 + nibble;
+        high = -1;
+        if (byte < 0x20 || byte > 0x7e) printable = 0;
+        if (keep) text[(*text_pos)++] = (char)byte;
+    }
+    
+    // Two-byte glyph ids of embedded fonts are meaningless without a CMap
+    if (!printable) {
+        *text_pos = start;
+    }
+    return i < stream_len ? i + 1 : stream_len;
 }
 
 // Extract text from PDF content stream
+// Strings shown inside BT/ET blocks are collected; TJ kerning wider than a
+// word gap and line-moving operators (T*, Td/TD with a vertical offset, ',
+// ") become spaces and line breaks. Inline images are skipped.
 static char* extract_text_from_stream(const char *stream, size_t stream_len) {
-    size_t text_size = stream_len + 1;
+    // Output never exceeds the input: every byte yields at most one character
+    size_t text_size = stream_len + 2;
     char *text = malloc(text_size);
     if (!text) {
         return NULL;
@@ -23,123 +119,339 @@ static char* extract_text_from_stream(const char *stream, size_t stream_len) {
     
     size_t text_pos = 0;
     int in_text_block = 0;
-    int in_parentheses = 0;
+    int array_depth = 0;
+    double operands[2] = {0.0, 0.0};
     
-    for (size_t i = 0; i < stream_len - 1; i++) {
-        // Look for text showing operators: BT (Begin Text), ET (End Text)
-        if (stream[i] == 'B' && stream[i+1] == 'T' && 
-            (i == 0 || isspace(stream[i-1])) &&
-            (i+2 >= stream_len || isspace(stream[i+2]))) {
-            in_text_block = 1;
-            i += 1;
+    size_t i = 0;
+    while (i < stream_len) {
+        char c = stream[i];
+        
+        if (isspace((unsigned char)c) || c == '\0') {
+            i++;
             continue;
         }
         
-        if (stream[i] == 'E' && stream[i+1] == 'T' &&
-            (i == 0 || isspace(stream[i-1])) &&
-            (i+2 >= stream_len || isspace(stream[i+2]))) {
-            in_text_block = 0;
-            i += 1;
+        // Comments
+        if (c == '%') {
+            while (i < stream_len && stream[i] != '\n' && stream[i] != '\r') i++;
             continue;
         }
         
-        if (!in_text_block) {
+        // Strings
+        if (c == '(') {
+            i = read_literal_string(stream, stream_len, i, text, &text_pos, in_text_block);
+            continue;
+        }
+        if (c == '<' && i+1 < stream_len && stream[i+1] != '<') {
+            i = read_hex_string(stream, stream_len, i, text, &text_pos, in_text_block);
+            continue;
+        }
+        
+        // Arrays (TJ operands) and dictionaries (marked content properties)
+        if (c == '[' || c == ']' || c == '{' || c == '}' || c == '<' || c == '>') {
+            if (c == '[') array_depth++;
+            if (c == ']' && array_depth > 0) array_depth--;
+            i++;
+            continue;
+        }
+        
+        // Names
+        if (c == '/') {
+            i++;
+            while (i < stream_len && !isspace((unsigned char)stream[i]) && !strchr("()<>[]{}/%", stream[i])) i++;
             continue;
         }
         
-        // Look for text in parentheses: (text)
-        if (stream[i] == '(' && (i == 0 || stream[i-1] != '\\')) {
-            in_parentheses = 1;
+        // Regular token: number or operator
+        size_t start = i;
+        while (i < stream_len && !isspace((unsigned char)stream[i]) && !strchr("()<>[]{}/%", stream[i])) i++;
+        if (i == start) {
+            i++;
             continue;
         }
         
-        if (stream[i] == ')' && (i == 0 || stream[i-1] != '\\')) {
-            in_parentheses = 0;
-            if (text_pos > 0 && text[text_pos-1] != '\n') {
-                text[text_pos++] = ' ';
+        size_t token_len = i - start;
+        const char *token = stream + start;
+        
+        if (isdigit((unsigned char)token[0]) || token[0] == '-' || token[0] == '+' || token[0] == '.') {
+            char number[32];
+            size_t n = token_len < sizeof(number) - 1 ? token_len : sizeof(number) - 1;
+            memcpy(number, token, n);
+            number[n] = '\0';
+            operands[0] = operands[1];
+            operands[1] = strtod(number, NULL);
+            
+            // Kerning wider than about a fifth of an em separates words
+            if (in_text_block && array_depth > 0 && operands[1] < -200.0) {
+                append_separator(text, &text_pos, ' ');
             }
             continue;
         }
         
-        if (in_parentheses) {
-            // Handle escape sequences
-            if (stream[i] == '\\' && i+1 < stream_len) {
-                i++;
-                switch (stream[i]) {
-                    case 'n': text[text_pos++] = '\n'; break;
-                    case 'r': text[text_pos++] = '\r'; break;
-                    case 't': text[text_pos++] = '\t'; break;
-                    case '(': text[text_pos++] = '('; break;
-                    case ')': text[text_pos++] = ')'; break;
-                    case '\\': text[text_pos++] = '\\'; break;
-                    default: text[text_pos++] = stream[i]; break;
+        if (token_len == 2 && memcmp(token, "BT", 2) == 0) {
+            in_text_block = 1;
+        } else if (token_len == 2 && memcmp(token, "ET", 2) == 0) {
+            // Each text block ends a line
+            in_text_block = 0;
+            append_separator(text, &text_pos, '\n');
+        } else if (!in_text_block) {
+            // Inline image data may contain anything - skip to EI
+            if (token_len == 2 && memcmp(token, "ID", 2) == 0) {
+                while (i + 2 < stream_len &&
+                       !(isspace((unsigned char)stream[i]) && stream[i+1] == 'E' && stream[i+2] == 'I' &&
+                         (i + 3 >= stream_len || isspace((unsigned char)stream[i+3])))) {
+                    i++;
                 }
-            } else {
-                text[text_pos++] = stream[i];
+                i += 3;
             }
+        } else if ((token_len == 2 && (memcmp(token, "Tj", 2) == 0 || memcmp(token, "TJ", 2) == 0)) ||
+                   (token_len == 2 && memcmp(token, "Tm", 2) == 0)) {
+            append_separator(text, &text_pos, ' ');
+        } else if ((token_len == 2 && memcmp(token, "T*", 2) == 0) ||
+                   (token_len == 1 && (token[0] == '\'' || token[0] == '"'))) {
+            append_separator(text, &text_pos, '\n');
+        } else if (token_len == 2 && (memcmp(token, "Td", 2) == 0 || memcmp(token, "TD", 2) == 0)) {
+            append_separator(text, &text_pos, operands[1] != 0.0 ? '\n' : ' ');
+        }
+        
+        operands[0] = operands[1] = 0.0;
+    }
+    
+    text[text_pos] = '\0';
+    return text;
+}
+
+// One page's worth of extraction work
+typedef struct {
+    const pdf_document_t *document;
+    size_t page;
+    char *text;
+} pdf_page_task_t;
+
+static void extract_page_task(void *arg) {
+    pdf_page_task_t *task = arg;
+    size_t content_length = 0;
+    char *content = pdf_document_page_content(task->document, task->page, &content_length);
+    if (!content) {
+        return;
+    }
+    
+    task->text = extract_text_from_stream(content, content_length);
+    free(content);
+}
+
+// Extract the text of every page, in page order
+// Pages are inflated and tokenized as independent tasks on the runtime the
+// caller runs on (the batch scanner, complyd_scan_many(), the single-file
+// CLI scan); outside of one they are extracted on the calling thread, so
+// daemon connections and library calls never start threads of their own.
+// The page texts are stitched back together in page order, into arena when
+// one is given (page tasks may run on other workers, so only the final text
+// comes from the arena).
+static char* extract_document_text(const pdf_document_t *document, arena_t *arena) {
+    size_t page_count = pdf_document_page_count(document);
+    pdf_page_task_t *tasks = calloc(page_count, sizeof(pdf_page_task_t));
+    if (!tasks) {
+        return NULL;
+    }
+    
+    for (size_t page = 0; page < page_count; page++) {
+        tasks[page].document = document;
+        tasks[page].page = page;
+    }
+    
+    task_runtime_t *runtime = task_runtime_current();
+    if (runtime && task_runtime_worker_count(runtime) > 1 && page_count > 1) {
+        task_group_t group;
+        task_group_init(&group);
+        for (size_t page = 0; page < page_count; page++) {
+            task_runtime_spawn(runtime, &group, extract_page_task, &tasks[page]);
+        }
+        task_group_wait(runtime, &group);
+    } else {
+        for (size_t page = 0; page < page_count; page++) {
+            extract_page_task(&tasks[page]);
+        }
+    }
+    
+    // Stitch the pages together
+    size_t text_size = 1;
+    for (size_t page = 0; page < page_count; page++) {
+        if (tasks[page].text) {
+            text_size += strlen(tasks[page].text) + 1;
+        }
+    }
+    
+    char *text = arena ? arena_alloc(arena, text_size) : malloc(text_size);
+    size_t text_pos = 0;
+    for (size_t page = 0; page < page_count; page++) {
+        char *page_text = tasks[page].text;
+        if (!page_text) {
+            continue;
         }
         
-        // Reallocate if needed
-        if (text_pos >= text_size - 1) {
-            text_size *= 2;
-            char *new_text = realloc(text, text_size);
-            if (!new_text) {
-                free(text);
-                return NULL;
+        if (text) {
+            size_t page_len = strlen(page_text);
+            memcpy(text + text_pos, page_text, page_len);
+            text_pos += page_len;
+            if (page_len > 0 && text[text_pos-1] != '\n') {
+                text[text_pos++] = '\n';
             }
-            text = new_text;
         }
+        free(page_text);
     }
+    free(tasks);
     
-    text[text_pos] = '\0';
+    if (text) {
+        text[text_pos] = '\0';
+    }
     return text;
 }
 
+// Streamed extraction: where pdf_stream_file() output goes
+typedef struct {
+    parse_text_fn on_text;
+    void *context;
+} pdf_stream_text_t;
+
+// Content stream -> text, one object at a time
+static int stream_content_text(const char *content, size_t length, void *context) {
+    pdf_stream_text_t *stream = context;
+    char *text = extract_text_from_stream(content, length);
+    if (!text) {
+        return 1;
+    }
+    
+    size_t text_length = strlen(text);
+    int keep_going = text_length == 0 || stream->on_text(text, text_length, stream->context);
+    free(text);
+    return keep_going;
+}
+
+// Extract text from a PDF read front to back, never holding more than the
+// reader's window and one content stream
+int parse_pdf_stream(FILE *input, parse_text_fn on_text, void *context,
+                     pdf_stream_stats_t *stats) {
+    if (!input || !on_text) {
+        return 0;
+    }
+    
+    pdf_stream_text_t stream = { on_text, context };
+    return pdf_stream_file(input, stream_content_text, &stream, stats);
+}
+
+// Text collected from the streamed fallback
+typedef struct {
+    char *text;
+    size_t length;
+    size_t capacity;
+} pdf_text_buffer_t;
+
+static int collect_text(const char *text, size_t length, void *context) {
+    pdf_text_buffer_t *buffer = context;
+    if (buffer->length + length + 2 > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+        while (buffer->length + length + 2 > capacity) capacity *= 2;
+        char *grown = realloc(buffer->text, capacity);
+        if (!grown) {
+            return 0;
+        }
+        buffer->text = grown;
+        buffer->capacity = capacity;
+    }
+    
+    memcpy(buffer->text + buffer->length, text, length);
+    buffer->length += length;
+    if (text[length-1] != '\n') {
+        buffer->text[buffer->length++] = '\n';
+    }
+    buffer->text[buffer->length] = '\0';
+    return 1;
+}
+
+// Text of a PDF whose pages could not be located: decode every content-like
+// stream in file order, or take strings from the raw bytes if there are none
+static char* extract_unindexed_text(const char *data, size_t length) {
+    pdf_text_buffer_t buffer = { NULL, 0, 0 };
+    pdf_stream_text_t stream = { collect_text, &buffer };
+    pdf_stream_stats_t stats;
+    pdf_stream_buffer(data, length, stream_content_text, &stream, &stats);
+    
+    if (stats.content_streams == 0) {
+        free(buffer.text);
+        return extract_text_from_stream(data, length);
+    }
+    return buffer.text ? buffer.text : calloc(1, 1);
+}
+
 // Parse PDF file and extract text content
-parse_result_t* parse_pdf_file(const char *filename) {
+parse_result_t* parse_pdf_file(const char *filename, arena_t *arena) {
     if (!filename) {
         return NULL;
     }
     
-    parse_result_t *result = calloc(1, sizeof(parse_result_t));
-    if (!result) {
-        return NULL;
+    // Read the file
+    file_buffer_t input;
+    if (!load_file_buffer(filename, &input, arena)) {
+        parse_result_t *result = parse_result_create(arena);
+        return result ? parse_result_fail(result, "Failed to read PDF file") : NULL;
     }
     
-    // Read the file
-    size_t file_length = 0;
-    char *file_content = read_file_contents(filename, &file_length);
+    return parse_pdf_buffer(&input, arena);
+}
+
+// Parse a loaded PDF; the buffer is released either way
+parse_result_t* parse_pdf_buffer(file_buffer_t *buffer, arena_t *arena) {
+    file_buffer_t input = *buffer;
+    memset(buffer, 0, sizeof(*buffer));
     
-    if (!file_content) {
-        result->success = 0;
-        result->error_message = strdup("Failed to read PDF file");
-        return result;
+    parse_result_t *result = parse_result_create(arena);
+    if (!result) {
+        release_file_buffer(&input);
+        return NULL;
     }
     
+    const char *file_content = input.data;
+    size_t file_length = input.length;
+    
     // Check PDF header
     if (file_length < 5 || memcmp(file_content, "%PDF-", 5) != 0) {
-        free(file_content);
-        result->success = 0;
-        result->error_message = strdup("Invalid PDF file format");
-        return result;
+        release_file_buffer(&input);
+        return parse_result_fail(result, "Invalid PDF file format");
     }
     
-    // Extract text from the PDF
-    // Look for stream objects and extract text
-    char *extracted_text = extract_text_from_stream(file_content, file_length);
+    // Extract text from the page content streams
+    char *extracted_text;
+    int text_in_arena = 0;
+    pdf_document_t *document = pdf_document_open(file_content, file_length);
+    if (document) {
+        extracted_text = extract_document_text(document, arena);
+        text_in_arena = arena != NULL;
+        pdf_document_close(document);
+    } else {
+        // No page could be located - fall back to reading the objects in order
+        extracted_text = extract_unindexed_text(file_content, file_length);
+    }
     
-    free(file_content);
+    if (!release_file_buffer(&input)) {
+        if (!text_in_arena) free(extracted_text);
+        return parse_result_fail(result, FILE_TRUNCATED_ERROR);
+    }
     
     if (!extracted_text) {
-        result->success = 0;
-        result->error_message = strdup("Failed to extract text from PDF");
-        return result;
+        return parse_result_fail(result, "Failed to extract text from PDF");
     }
     
-    result->content = extracted_text;
-    result->content_length = strlen(extracted_text);
-    result->success = 1;
-    result->error_message = NULL;
+    size_t text_length = strlen(extracted_text);
+    if (text_in_arena) {
+        result->content = extracted_text;
+        result->content_length = text_length;
+        result->content_owner = PARSE_CONTENT_ARENA;
+        result->success = 1;
+        result->error_message = NULL;
+    } else if (!parse_result_take_heap(result, extracted_text, text_length)) {
+        return parse_result_fail(result, "Memory allocation failed");
+    }
     
     return result;
 }
@@ -0,0 +1,116 @@
+#define _POSIX_C_SOURCE 200809L
+#include "report/reporter.h"
+
+// ==================== NDJSON Reporter ====================
+// One JSON object per line:
+//   {"type":"file","path":"a.yaml","file_type":"YAML","status":"fail","score":87.5,
+//    "passed":7,"total":8,"cached":false,"failed":[{"id":"164.312(b)",...}]}
+//   {"type":"summary","files":2,"passed":1,"failed":1,"errors":0,...}
+// Watch mode adds "type":"update" records carrying a "change" field. With
+// several frameworks, file records also carry a "frameworks" list:
+//   "frameworks":[{"name":"SOC 2","status":"pass","score":88.9,"passed":8,"total":9},...]
+
+// Fields shared by file and update records (without braces)
+static void ndjson_file_fields(report_writer_t *writer, const batch_file_result_t *file) {
+    report_puts(writer, "\"path\":");
+    report_json_string(writer, file->path);
+    report_printf(writer, ",\"file_type\":\"%s\"", report_file_type_name(file->file_type));
+
+    if (!file->parsed) {
+        report_puts(writer, ",\"status\":\"error\",\"error\":");
+        report_json_string(writer, file->error_message ? file->error_message : "Unknown error");
+        return;
+    }
+
+    const scan_result_t *scan_result = file->scan_result;
+    report_printf(writer, ",\"status\":\"%s\",\"score\":%.1f,\"passed\":%zu,\"total\":%zu,"
+                  "\"cached\":%s,\"failed\":[",
+                  scan_result_compliant(scan_result) ? "pass" : "fail", scan_result_score(scan_result),
+                  scan_result->passed_count, scan_result->result_count,
+                  file->cached ? "true" : "false");
+
+    int first = 1;
+    for (size_t i = 0; i < scan_result->result_count; i++) {
+        const check_result_t *result = &scan_result->results[i];
+        if (result->passed) continue;
+
+        report_puts(writer, first ? "{\"id\":" : ",{\"id\":");
+        report_json_string(writer, result->control_id);
+        report_puts(writer, ",\"name\":");
+        report_json_string(writer, result->control_name);
+        report_puts(writer, ",\"severity\":");
+        report_json_string(writer, result->severity);
+        report_puts(writer, "}");
+        first = 0;
+    }
+    report_puts(writer, "]");
+
+    if (scan_result->framework_count > 0) {
+        report_puts(writer, ",\"frameworks\":[");
+        for (size_t f = 0; f < scan_result->framework_count; f++) {
+            const framework_result_t *framework = &scan_result->frameworks[f];
+            double score = framework_result_score(framework);
+            report_puts(writer, f == 0 ? "{\"name\":" : ",{\"name\":");
+            report_json_string(writer, framework->name);
+            report_printf(writer, ",\"status\":\"%s\",\"score\":%.1f,\"passed\":%zu,\"total\":%zu}",
+                          score >= COMPLIANCE_THRESHOLD ? "pass" : "fail", score,
+                          framework->passed_count, framework->result_count);
+        }
+        report_puts(writer, "]");
+    }
+}
+
+static void ndjson_file(reporter_t *reporter, const batch_file_result_t *file) {
+    report_puts(&reporter->writer, "{\"type\":\"file\",");
+    ndjson_file_fields(&reporter->writer, file);
+    report_puts(&reporter->writer, "}\n");
+}
+
+static void ndjson_update(reporter_t *reporter, const batch_file_result_t *file,
+                          watch_change_t change, double elapsed_seconds) {
+    report_writer_t *writer = &reporter->writer;
+    const char *change_name = change == WATCH_FILE_ADDED ? "added" :
+                              change == WATCH_FILE_REMOVED ? "removed" : "changed";
+
+    report_printf(writer, "{\"type\":\"update\",\"change\":\"%s\",\"elapsed_ms\":%.1f,",
+                  change_name, elapsed_seconds * 1000.0);
+    if (change == WATCH_FILE_REMOVED) {
+        report_puts(writer, "\"path\":");
+        report_json_string(writer, file->path);
+    } else {
+        ndjson_file_fields(writer, file);
+    }
+    report_puts(writer, "}\n");
+}
+
+static void ndjson_end(reporter_t *reporter, const batch_t *batch, int thread_count,
+                       result_cache_t *cache) {
+    report_writer_t *writer = &reporter->writer;
+
+    report_printf(writer, "{\"type\":\"summary\",\"files\":%zu,\"passed\":%zu,\"failed\":%zu,"
+                  "\"errors\":%zu,\"cached\":%zu,\"threads\":%d,\"elapsed_seconds\":%.3f",
+                  batch->file_count, batch->passed_files, batch->failed_files,
+                  batch->error_files, batch->cached_files, thread_count,
+                  batch->elapsed_seconds);
+
+    if (cache) {
+        result_cache_stats_t stats;
+        result_cache_get_stats(cache, &stats);
+        report_printf(writer, ",\"cache\":{\"lookups\":%llu,\"hits\":%llu,\"stores\":%llu,"
+                      "\"evictions\":%llu,\"entries\":%zu}",
+                      (unsigned long long)stats.lookups, (unsigned long long)stats.hits,
+                      (unsigned long long)stats.stores, (unsigned long long)stats.evictions,
+                      stats.entries);
+    }
+
+    report_printf(writer, ",\"pass\":%s}\n",
+                  batch->failed_files == 0 && batch->error_files == 0 ? "true" : "false");
+}
+
+const reporter_ops_t ndjson_reporter_ops = {
+    .begin = NULL,
+    .file = ndjson_file,
+    .update = ndjson_update,
+    .end = ndjson_end,
+    .destroy = NULL
+};
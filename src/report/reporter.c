@@ -0,0 +1,239 @@
+#define _POSIX_C_SOURCE 200809L
+#include "report/reporter.h"
+#include "runtime/scan_stats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// ==== Buffered writer ====
+
+void report_flush(report_writer_t *writer) {
+    if (!writer->output) return;
+
+    if (writer->length > 0) {
+        fwrite(writer->data, 1, writer->length, writer->output);
+        writer->length = 0;
+    }
+    fflush(writer->output);
+    writer->last_flush = monotonic_seconds();
+}
+
+// Room for length more bytes in a writer that collects in memory
+static int report_grow(report_writer_t *writer, size_t length) {
+    size_t capacity = writer->capacity ? writer->capacity : 4096;
+    while (capacity < writer->length + length) {
+        capacity *= 2;
+    }
+
+    char *grown = realloc(writer->data, capacity);
+    if (!grown) return 0;
+    writer->data = grown;
+    writer->capacity = capacity;
+    return 1;
+}
+
+void report_write(report_writer_t *writer, const char *data, size_t length) {
+    if (!writer->output && writer->length + length > writer->capacity &&
+        !report_grow(writer, length)) {
+        return;
+    }
+
+    if (writer->length + length > writer->capacity) {
+        report_flush(writer);
+        if (length > writer->capacity) {
+            fwrite(data, 1, length, writer->output);
+            return;
+        }
+    }
+    memcpy(writer->data + writer->length, data, length);
+    writer->length += length;
+}
+
+void report_puts(report_writer_t *writer, const char *text) {
+    report_write(writer, text, strlen(text));
+}
+
+void report_printf(report_writer_t *writer, const char *format, ...) {
+    char line[1024];
+    va_list args;
+
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length < 0) return;
+
+    if ((size_t)length < sizeof(line)) {
+        report_write(writer, line, (size_t)length);
+        return;
+    }
+
+    // Rare long line (a long path or message)
+    char *long_line = malloc((size_t)length + 1);
+    if (!long_line) return;
+    va_start(args, format);
+    vsnprintf(long_line, (size_t)length + 1, format, args);
+    va_end(args);
+    report_write(writer, long_line, (size_t)length);
+    free(long_line);
+}
+
+void report_repeat(report_writer_t *writer, char c, size_t count) {
+    char run[128];
+    memset(run, c, sizeof(run));
+    while (count > 0) {
+        size_t n = count < sizeof(run) ? count : sizeof(run);
+        report_write(writer, run, n);
+        count -= n;
+    }
+}
+
+void report_json_string(report_writer_t *writer, const char *text) {
+    static const char hex[] = "0123456789abcdef";
+
+    report_write(writer, "\"", 1);
+    const char *run = text;
+    for (const char *p = text; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        report_write(writer, run, (size_t)(p - run));
+        run = p + 1;
+        if (c == '"' || c == '\\') {
+            char escaped[2] = { '\\', (char)c };
+            report_write(writer, escaped, 2);
+        } else {
+            char escaped[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf] };
+            report_write(writer, escaped, 6);
+        }
+    }
+    report_write(writer, run, strlen(run));
+    report_write(writer, "\"", 1);
+}
+
+// ==== Reporter ====
+
+int report_format_from_name(const char *name, report_format_t *format) {
+    if (strcmp(name, "text") == 0) {
+        *format = REPORT_FORMAT_TEXT;
+    } else if (strcmp(name, "ndjson") == 0) {
+        *format = REPORT_FORMAT_NDJSON;
+    } else if (strcmp(name, "sarif") == 0) {
+        *format = REPORT_FORMAT_SARIF;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+const char* report_file_type_name(file_type_t file_type) {
+    switch (file_type) {
+        case FILE_TYPE_MD: return "Markdown";
+        case FILE_TYPE_JSON: return "JSON";
+        case FILE_TYPE_PDF: return "PDF";
+        case FILE_TYPE_YAML: return "YAML";
+        case FILE_TYPE_TEXT: return "Text";
+        default: return "Unknown";
+    }
+}
+
+reporter_t* reporter_create(report_format_t format, FILE *output,
+                            const rule_set_t *framework) {
+    reporter_t *reporter = calloc(1, sizeof(reporter_t));
+    if (!reporter) return NULL;
+
+    reporter->writer.data = malloc(REPORT_BUFFER_SIZE);
+    if (!reporter->writer.data) {
+        free(reporter);
+        return NULL;
+    }
+    reporter->writer.output = output;
+    reporter->writer.capacity = REPORT_BUFFER_SIZE;
+    reporter->writer.last_flush = monotonic_seconds();
+
+    reporter->format = format;
+    reporter->framework = framework;
+    switch (format) {
+        case REPORT_FORMAT_NDJSON: reporter->ops = &ndjson_reporter_ops; break;
+        case REPORT_FORMAT_SARIF: reporter->ops = &sarif_reporter_ops; break;
+        case REPORT_FORMAT_TEXT:
+        default: reporter->ops = &text_reporter_ops; break;
+    }
+
+    pthread_mutex_init(&reporter->lock, NULL);
+    return reporter;
+}
+
+void reporter_free(reporter_t *reporter) {
+    if (!reporter) return;
+
+    report_flush(&reporter->writer);
+    if (reporter->ops->destroy) {
+        reporter->ops->destroy(reporter);
+    }
+    pthread_mutex_destroy(&reporter->lock);
+    free(reporter->writer.data);
+    free(reporter);
+}
+
+void reporter_begin(reporter_t *reporter, size_t file_count, int thread_count) {
+    pthread_mutex_lock(&reporter->lock);
+    scan_span_t span = scan_stats_begin();
+    if (reporter->ops->begin) {
+        reporter->ops->begin(reporter, file_count, thread_count);
+    }
+    report_flush(&reporter->writer);
+    scan_stats_end(span, SCAN_STAGE_REPORT, FILE_TYPE_UNKNOWN, 0);
+    pthread_mutex_unlock(&reporter->lock);
+}
+
+void reporter_file(reporter_t *reporter, const batch_file_result_t *file) {
+    pthread_mutex_lock(&reporter->lock);
+    scan_span_t span = scan_stats_begin();
+    if (reporter->ops->file) {
+        reporter->ops->file(reporter, file);
+    }
+    reporter->file_count++;
+
+    // Slow scans still show up promptly; fast ones share a write
+    if (monotonic_seconds() - reporter->writer.last_flush >= REPORT_FLUSH_INTERVAL) {
+        report_flush(&reporter->writer);
+    }
+    scan_stats_end(span, SCAN_STAGE_REPORT, file->file_type, 0);
+    pthread_mutex_unlock(&reporter->lock);
+}
+
+// Updates are rare and awaited - write each one out right away
+void reporter_update(reporter_t *reporter, const batch_file_result_t *file,
+                     watch_change_t change, double elapsed_seconds) {
+    pthread_mutex_lock(&reporter->lock);
+    scan_span_t span = scan_stats_begin();
+    if (reporter->ops->update) {
+        reporter->ops->update(reporter, file, change, elapsed_seconds);
+    }
+    report_flush(&reporter->writer);
+    scan_stats_end(span, SCAN_STAGE_REPORT, file->file_type, 0);
+    pthread_mutex_unlock(&reporter->lock);
+}
+
+void reporter_end(reporter_t *reporter, const batch_t *batch, int thread_count,
+                  result_cache_t *cache) {
+    pthread_mutex_lock(&reporter->lock);
+    scan_span_t span = scan_stats_begin();
+    if (reporter->ops->end) {
+        reporter->ops->end(reporter, batch, thread_count, cache);
+    }
+    report_flush(&reporter->writer);
+    scan_stats_end(span, SCAN_STAGE_REPORT, FILE_TYPE_UNKNOWN, 0);
+    pthread_mutex_unlock(&reporter->lock);
+}
+
+void reporter_file_done(const batch_file_result_t *file, void *context) {
+    reporter_file(context, file);
+}
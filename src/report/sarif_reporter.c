@@ -0,0 +1,182 @@
+#define _POSIX_C_SOURCE 200809L
+#include "report/reporter.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ==================== SARIF Reporter ====================
+// A SARIF 2.1.0 log with one run. The rules (controls) are written up front,
+// then each failed check becomes a result as soon as its file is scanned.
+// Files that could not be scanned are listed as tool execution
+// notifications, which come after the results and are collected until then.
+
+#define SARIF_SCHEMA "https://json.schemastore.org/sarif-2.1.0.json"
+
+typedef struct {
+    int first_result;
+    report_writer_t notifications;      // Collected in memory (no output stream)
+} sarif_state_t;
+
+static const char* sarif_level(const char *severity) {
+    if (strcmp(severity, "CRITICAL") == 0 || strcmp(severity, "HIGH") == 0) return "error";
+    if (strcmp(severity, "MEDIUM") == 0) return "warning";
+    return "note";
+}
+
+// Artifact URI: the path with everything outside the unreserved characters
+// (and '/') percent-encoded
+static void sarif_uri(report_writer_t *writer, const char *path) {
+    static const char hex[] = "0123456789ABCDEF";
+
+    report_write(writer, "\"", 1);
+    for (const unsigned char *p = (const unsigned char *)path; *p; p++) {
+        unsigned char c = *p;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+            c == '-' || c == '.' || c == '_' || c == '~' || c == '/') {
+            report_write(writer, (const char *)p, 1);
+        } else {
+            char escaped[3] = { '%', hex[c >> 4], hex[c & 0xf] };
+            report_write(writer, escaped, 3);
+        }
+    }
+    report_write(writer, "\"", 1);
+}
+
+static void sarif_location(report_writer_t *writer, const char *path) {
+    report_puts(writer, "\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":");
+    sarif_uri(writer, path);
+    report_puts(writer, "}}}]");
+}
+
+static void sarif_rule(report_writer_t *writer, const control_info_t *info, const char *framework,
+                       int first) {
+    report_puts(writer, first ? "\n        {\"id\":" : ",\n        {\"id\":");
+    report_json_string(writer, info->id);
+    report_puts(writer, ",\"name\":");
+    report_json_string(writer, info->name);
+    report_puts(writer, ",\"shortDescription\":{\"text\":");
+    report_json_string(writer, info->name);
+    report_puts(writer, "}");
+    if (info->remediation) {
+        report_puts(writer, ",\"help\":{\"text\":");
+        report_json_string(writer, info->remediation);
+        report_puts(writer, "}");
+    }
+    report_printf(writer, ",\"defaultConfiguration\":{\"level\":\"%s\"},\"properties\":{\"severity\":",
+                  sarif_level(info->severity));
+    report_json_string(writer, info->severity);
+    report_puts(writer, ",\"framework\":");
+    report_json_string(writer, framework);
+    report_puts(writer, "}}");
+}
+
+static void sarif_begin(reporter_t *reporter, size_t file_count, int thread_count) {
+    (void)file_count;
+    (void)thread_count;
+
+    sarif_state_t *state = calloc(1, sizeof(sarif_state_t));
+    if (state) {
+        state->first_result = 1;
+    }
+    reporter->state = state;
+
+    report_writer_t *writer = &reporter->writer;
+    report_puts(writer, "{\n  \"$schema\": \"" SARIF_SCHEMA "\",\n  \"version\": \"2.1.0\",\n"
+                "  \"runs\": [{\n    \"tool\": {\"driver\": {\"name\": \"complyd-scan\", "
+                "\"version\": \"1.0\", \"rules\": [");
+
+    const rule_set_t *rules = reporter->framework;
+    if (rules) {
+        for (size_t f = 0; f < rules->framework_count; f++) {
+            const rule_framework_t *framework = &rules->frameworks[f];
+            for (size_t i = framework->first_control;
+                 i < framework->first_control + framework->control_count; i++) {
+                sarif_rule(writer, &rules->controls[i].info, framework->name, i == 0);
+            }
+        }
+    } else {
+        for (size_t i = 0; i < HIPAA_CHECK_COUNT; i++) {
+            sarif_rule(writer, hipaa_check_info((hipaa_check_id_t)i),
+                       hipaa_framework_definition.name, i == 0);
+        }
+    }
+
+    report_puts(writer, "\n    ]}},\n    \"results\": [");
+}
+
+static void sarif_file(reporter_t *reporter, const batch_file_result_t *file) {
+    report_writer_t *writer = &reporter->writer;
+    sarif_state_t *state = reporter->state;
+    if (!state) return;
+
+    if (!file->parsed) {
+        report_writer_t *notes = &state->notifications;
+        report_puts(notes, notes->length ? ",\n        " : "\n        ");
+        report_puts(notes, "{\"level\":\"error\",\"message\":{\"text\":");
+        report_json_string(notes, file->error_message ? file->error_message : "Unknown error");
+        report_puts(notes, "},");
+        sarif_location(notes, file->path);
+        report_puts(notes, "}");
+        return;
+    }
+
+    const scan_result_t *scan_result = file->scan_result;
+    size_t rule_count = reporter->framework ? reporter->framework->control_count
+                                            : HIPAA_CHECK_COUNT;
+    for (size_t i = 0; i < scan_result->result_count; i++) {
+        const check_result_t *result = &scan_result->results[i];
+        if (result->passed) continue;
+
+        report_puts(writer, state->first_result ? "\n      {\"ruleId\":" : ",\n      {\"ruleId\":");
+        state->first_result = 0;
+        report_json_string(writer, result->control_id);
+        if (scan_result->result_count == rule_count) {
+            report_printf(writer, ",\"ruleIndex\":%zu", i);
+        }
+        report_printf(writer, ",\"level\":\"%s\",\"message\":{\"text\":",
+                      sarif_level(result->severity));
+        report_json_string(writer, result->details ? result->details : result->control_name);
+        report_puts(writer, "},");
+        sarif_location(writer, file->path);
+        if (result->evidence) {
+            report_puts(writer, ",\"properties\":{\"evidence\":");
+            report_json_string(writer, result->evidence);
+            report_puts(writer, "}");
+        }
+        report_puts(writer, "}");
+    }
+}
+
+static void sarif_end(reporter_t *reporter, const batch_t *batch, int thread_count,
+                      result_cache_t *cache) {
+    (void)batch;
+    (void)thread_count;
+    (void)cache;
+
+    report_writer_t *writer = &reporter->writer;
+    sarif_state_t *state = reporter->state;
+
+    report_puts(writer, "\n    ],\n    \"invocations\": [{\"executionSuccessful\": true");
+    if (state && state->notifications.length > 0) {
+        report_puts(writer, ", \"toolExecutionNotifications\": [");
+        report_write(writer, state->notifications.data, state->notifications.length);
+        report_puts(writer, "\n      ]");
+    }
+    report_puts(writer, "}]\n  }]\n}\n");
+}
+
+static void sarif_destroy(reporter_t *reporter) {
+    sarif_state_t *state = reporter->state;
+    if (state) {
+        free(state->notifications.data);
+        free(state);
+    }
+    reporter->state = NULL;
+}
+
+const reporter_ops_t sarif_reporter_ops = {
+    .begin = sarif_begin,
+    .file = sarif_file,
+    .update = NULL,
+    .end = sarif_end,
+    .destroy = sarif_destroy
+};
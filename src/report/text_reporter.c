@@ -0,0 +1,167 @@
+#define _POSIX_C_SOURCE 200809L
+#include "report/reporter.h"
+#include <string.h>
+#include <time.h>
+
+// ==================== Text Reporter ====================
+// The colored terminal report: one verdict line per file, followed by the
+// failed checks, and the aggregated summary box.
+
+static void text_box_header(report_writer_t *writer, const char *title) {
+    report_puts(writer, "\n");
+    report_repeat(writer, '=', 80);
+    report_printf(writer, "\n%s%s%s%s\n", COLOR_BOLD, COLOR_CYAN, title, COLOR_RESET);
+    report_repeat(writer, '=', 80);
+    report_puts(writer, "\n");
+}
+
+static void text_failed_checks(report_writer_t *writer, const scan_result_t *scan_result,
+                               size_t first, size_t count, const char *indent) {
+    for (size_t i = first; i < first + count; i++) {
+        const check_result_t *result = &scan_result->results[i];
+        if (!result->passed) {
+            report_printf(writer, "%s%s✗%s %s - %s (%s)\n", indent, COLOR_RED, COLOR_RESET,
+                          result->control_id, result->control_name, result->severity);
+        }
+    }
+}
+
+// Verdict line and failed checks of one file
+static void text_file_verdict(report_writer_t *writer, const batch_file_result_t *file) {
+    if (!file->parsed) {
+        report_printf(writer, "%s[ERROR]%s %s: %s\n", COLOR_RED, COLOR_RESET, file->path,
+                      file->error_message ? file->error_message : "Unknown error");
+        return;
+    }
+
+    const scan_result_t *scan_result = file->scan_result;
+    double score = scan_result_score(scan_result);
+    int passed = scan_result_compliant(scan_result);
+
+    report_printf(writer, "%s[%s]%s %5.1f%%  %zu/%zu  %s%s\n",
+                  passed ? COLOR_GREEN : COLOR_RED, passed ? "PASS" : "FAIL", COLOR_RESET,
+                  score, scan_result->passed_count, scan_result->result_count, file->path,
+                  file->cached ? "  (cached)" : "");
+
+    if (scan_result->framework_count == 0) {
+        text_failed_checks(writer, scan_result, 0, scan_result->result_count, "        ");
+        return;
+    }
+
+    // One line per framework, each followed by its failed checks
+    for (size_t f = 0; f < scan_result->framework_count; f++) {
+        const framework_result_t *framework = &scan_result->frameworks[f];
+        double framework_score = framework_result_score(framework);
+        int framework_passed = framework_score >= COMPLIANCE_THRESHOLD;
+
+        report_printf(writer, "        %s%s%s %5.1f%%  %zu/%zu  %s\n",
+                      framework_passed ? COLOR_GREEN : COLOR_RED,
+                      framework_passed ? "pass" : "fail", COLOR_RESET, framework_score,
+                      framework->passed_count, framework->result_count, framework->name);
+        text_failed_checks(writer, scan_result, framework->first_result,
+                           framework->result_count, "            ");
+    }
+}
+
+static void text_begin(reporter_t *reporter, size_t file_count, int thread_count) {
+    report_writer_t *writer = &reporter->writer;
+
+    report_printf(writer, "%sScanning %zu files with %d thread%s%s\n", COLOR_BOLD,
+                  file_count, thread_count, thread_count == 1 ? "" : "s", COLOR_RESET);
+    text_box_header(writer, "SCAN RESULTS");
+}
+
+static void text_file(reporter_t *reporter, const batch_file_result_t *file) {
+    text_file_verdict(&reporter->writer, file);
+}
+
+// A verdict that changed while watching, prefixed with the time of day
+static void text_update(reporter_t *reporter, const batch_file_result_t *file,
+                        watch_change_t change, double elapsed_seconds) {
+    report_writer_t *writer = &reporter->writer;
+
+    char stamp[16];
+    time_t now = time(NULL);
+    struct tm local;
+    localtime_r(&now, &local);
+    strftime(stamp, sizeof(stamp), "%H:%M:%S", &local);
+
+    report_printf(writer, "%s[%s]%s ", COLOR_BLUE, stamp, COLOR_RESET);
+    if (change == WATCH_FILE_REMOVED) {
+        report_printf(writer, "%s[GONE]%s %s\n", COLOR_YELLOW, COLOR_RESET, file->path);
+    } else {
+        text_file_verdict(writer, file);
+        report_printf(writer, "           %s%s in %.0f ms%s\n", COLOR_MAGENTA,
+                      change == WATCH_FILE_ADDED ? "new file, scanned" : "verdict changed",
+                      elapsed_seconds * 1000.0, COLOR_RESET);
+    }
+}
+
+static void text_end(reporter_t *reporter, const batch_t *batch, int thread_count,
+                     result_cache_t *cache) {
+    report_writer_t *writer = &reporter->writer;
+
+    text_box_header(writer, "BATCH SUMMARY");
+
+    report_puts(writer, "\n");
+    report_printf(writer, "  Files Scanned:   %s%zu%s\n", COLOR_BOLD, batch->file_count, COLOR_RESET);
+    report_printf(writer, "  %sPassed:%s          %s%zu%s\n",
+                  COLOR_GREEN, COLOR_RESET, COLOR_BOLD, batch->passed_files, COLOR_RESET);
+    report_printf(writer, "  %sFailed:%s          %s%zu%s\n",
+                  COLOR_RED, COLOR_RESET, COLOR_BOLD, batch->failed_files, COLOR_RESET);
+    report_printf(writer, "  %sErrors:%s          %s%zu%s\n",
+                  COLOR_YELLOW, COLOR_RESET, COLOR_BOLD, batch->error_files, COLOR_RESET);
+    report_printf(writer, "  Threads:         %s%d%s\n", COLOR_BOLD, thread_count, COLOR_RESET);
+    report_printf(writer, "  Elapsed:         %s%.3f s%s\n",
+                  COLOR_BOLD, batch->elapsed_seconds, COLOR_RESET);
+
+    if (cache) {
+        result_cache_stats_t stats;
+        result_cache_get_stats(cache, &stats);
+
+        double hit_rate = stats.lookups > 0 ? (double)stats.hits / stats.lookups * 100.0 : 0.0;
+        report_printf(writer, "  Cache:           %s%llu/%llu hits (%.1f%%)%s, %llu stored, "
+                      "%llu evicted, %zu entries\n",
+                      COLOR_BOLD, (unsigned long long)stats.hits,
+                      (unsigned long long)stats.lookups, hit_rate, COLOR_RESET,
+                      (unsigned long long)stats.stores, (unsigned long long)stats.evictions,
+                      stats.entries);
+    }
+
+    if (batch->worker_count > 0) {
+        report_printf(writer, "\n  %sWorker  Tasks     Steals    Busy (s)   Idle (s)%s\n",
+                      COLOR_BOLD, COLOR_RESET);
+        for (int i = 0; i < batch->worker_count; i++) {
+            const task_worker_stats_t *stats = &batch->worker_stats[i];
+            report_printf(writer, "  %-6d  %-8llu  %-8llu  %-9.3f  %-9.3f\n", i,
+                          (unsigned long long)stats->tasks_executed,
+                          (unsigned long long)stats->steals,
+                          stats->busy_seconds, stats->idle_seconds);
+        }
+    }
+
+    report_puts(writer, "\n");
+
+    const char *requirements = reporter->framework && reporter->framework->framework_count > 1
+                               ? "the requirements of every selected framework"
+                               : "HIPAA compliance requirements";
+    if (batch->failed_files == 0 && batch->error_files == 0) {
+        report_printf(writer, "  %s✓ PASSED - All files meet %s%s\n",
+                      COLOR_GREEN, requirements, COLOR_RESET);
+    } else {
+        report_printf(writer, "  %s✗ FAILED - %zu of %zu files do not meet %s%s\n", COLOR_RED,
+                      batch->failed_files + batch->error_files, batch->file_count,
+                      requirements, COLOR_RESET);
+    }
+
+    report_repeat(writer, '=', 80);
+    report_puts(writer, "\n\n");
+}
+
+const reporter_ops_t text_reporter_ops = {
+    .begin = text_begin,
+    .file = text_file,
+    .update = text_update,
+    .end = text_end,
+    .destroy = NULL
+};
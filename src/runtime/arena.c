@@ -0,0 +1,196 @@
+#define _POSIX_C_SOURCE 200809L
+#include "runtime/arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define ARENA_ALIGN 16
+
+struct arena_block {
+    arena_block_t *prev;        // Older block (or next spare)
+    size_t size;                // Usable bytes in data
+    size_t used;
+    max_align_t data[];
+};
+
+struct arena_cleanup {
+    arena_cleanup_t *next;
+    arena_cleanup_fn fn;
+    void *data;
+    size_t size;
+};
+
+static size_t align_size(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+// Create an empty arena; the first block is allocated on first use
+arena_t* arena_create(size_t block_size) {
+    arena_t *arena = calloc(1, sizeof(arena_t));
+    if (!arena) return NULL;
+
+    arena->block_size = align_size(block_size ? block_size : ARENA_DEFAULT_BLOCK_SIZE);
+    return arena;
+}
+
+// Make room for size bytes in a fresh block
+// Allocations larger than a standard block get a block of their own, which
+// is freed rather than kept when the arena is rewound.
+static int arena_grow(arena_t *arena, size_t size) {
+    arena_block_t *block;
+
+    if (size <= arena->block_size && arena->spare) {
+        block = arena->spare;
+        arena->spare = block->prev;
+    } else {
+        size_t block_size = size > arena->block_size ? size : arena->block_size;
+        block = malloc(sizeof(arena_block_t) + block_size);
+        if (!block) return 0;
+        block->size = block_size;
+        arena->blocks_created++;
+    }
+
+    block->used = 0;
+    block->prev = arena->current;
+    arena->current = block;
+    return 1;
+}
+
+void* arena_alloc(arena_t *arena, size_t size) {
+    if (!arena || size > SIZE_MAX - ARENA_ALIGN) return NULL;
+
+    size = align_size(size ? size : 1);
+    arena_block_t *block = arena->current;
+    if (!block || block->size - block->used < size) {
+        if (!arena_grow(arena, size)) return NULL;
+        block = arena->current;
+    }
+
+    void *data = (char *)block->data + block->used;
+    block->used += size;
+    arena->allocations++;
+
+    arena->bytes_allocated += size;
+    if (arena->bytes_allocated > arena->peak_bytes) {
+        arena->peak_bytes = arena->bytes_allocated;
+    }
+    return data;
+}
+
+void* arena_calloc(arena_t *arena, size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;
+
+    void *data = arena_alloc(arena, count * size);
+    if (data) {
+        memset(data, 0, count * size);
+    }
+    return data;
+}
+
+char* arena_strdup(arena_t *arena, const char *text) {
+    if (!text) return NULL;
+
+    size_t length = strlen(text);
+    char *copy = arena_alloc(arena, length + 1);
+    if (copy) {
+        memcpy(copy, text, length + 1);
+    }
+    return copy;
+}
+
+void* arena_realloc(arena_t *arena, void *data, size_t old_size, size_t new_size) {
+    if (!data) {
+        return arena_alloc(arena, new_size);
+    }
+    if (!arena || new_size > SIZE_MAX - ARENA_ALIGN) return NULL;
+
+    // The newest allocation can be resized where it is
+    arena_block_t *block = arena->current;
+    size_t old_aligned = align_size(old_size ? old_size : 1);
+    size_t new_aligned = align_size(new_size ? new_size : 1);
+    if (block && (char *)data + old_aligned == (char *)block->data + block->used &&
+        block->size - (block->used - old_aligned) >= new_aligned) {
+        block->used = block->used - old_aligned + new_aligned;
+        arena->bytes_allocated = arena->bytes_allocated - old_aligned + new_aligned;
+        if (arena->bytes_allocated > arena->peak_bytes) {
+            arena->peak_bytes = arena->bytes_allocated;
+        }
+        return data;
+    }
+
+    void *moved = arena_alloc(arena, new_size);
+    if (moved) {
+        memcpy(moved, data, old_size < new_size ? old_size : new_size);
+    }
+    return moved;
+}
+
+// The cleanup record lives in the arena itself
+int arena_add_cleanup(arena_t *arena, arena_cleanup_fn fn, void *data, size_t size) {
+    arena_cleanup_t *cleanup = arena_alloc(arena, sizeof(arena_cleanup_t));
+    if (!cleanup) return 0;
+
+    cleanup->fn = fn;
+    cleanup->data = data;
+    cleanup->size = size;
+    cleanup->next = arena->cleanups;
+    arena->cleanups = cleanup;
+    return 1;
+}
+
+arena_mark_t arena_mark(const arena_t *arena) {
+    arena_mark_t mark = {0};
+    if (arena) {
+        mark.block = arena->current;
+        mark.used = arena->current ? arena->current->used : 0;
+        mark.cleanups = arena->cleanups;
+        mark.bytes_allocated = arena->bytes_allocated;
+    }
+    return mark;
+}
+
+// Release everything allocated since mark
+void arena_rewind(arena_t *arena, arena_mark_t mark) {
+    if (!arena) return;
+
+    // Cleanup records sit in the blocks released below - run them first
+    while (arena->cleanups != mark.cleanups) {
+        arena_cleanup_t *cleanup = arena->cleanups;
+        arena->cleanups = cleanup->next;
+        cleanup->fn(cleanup->data, cleanup->size);
+    }
+
+    while (arena->current != mark.block) {
+        arena_block_t *block = arena->current;
+        arena->current = block->prev;
+        if (block->size == arena->block_size) {
+            block->prev = arena->spare;
+            arena->spare = block;
+        } else {
+            free(block);
+        }
+    }
+
+    if (arena->current) {
+        arena->current->used = mark.used;
+    }
+    arena->bytes_allocated = mark.bytes_allocated;
+}
+
+void arena_reset(arena_t *arena) {
+    arena_mark_t empty = {0};
+    arena_rewind(arena, empty);
+}
+
+void arena_destroy(arena_t *arena) {
+    if (!arena) return;
+
+    arena_reset(arena);
+    while (arena->spare) {
+        arena_block_t *block = arena->spare;
+        arena->spare = block->prev;
+        free(block);
+    }
+    free(arena);
+}
@@ -0,0 +1,267 @@
+#define _POSIX_C_SOURCE 200809L
+#include "runtime/scan_stats.h"
+#include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+// Counter rows per file_type_t value
+#define STATS_TYPE_COUNT (FILE_TYPE_TEXT + 1)
+
+typedef struct {
+    atomic_uint_fast64_t operations;
+    atomic_uint_fast64_t bytes;
+    atomic_uint_fast64_t ns;
+} stage_counter_t;
+
+// Result index -> control; the id is set by the first scan that reports it
+typedef struct {
+    _Atomic(const char *) control_id;
+    atomic_uint_fast64_t passed;
+    atomic_uint_fast64_t failed;
+} check_counter_t;
+
+static atomic_int stats_enabled;
+static stage_counter_t stage_counters[SCAN_STAGE_COUNT][STATS_TYPE_COUNT];
+static check_counter_t check_counters[SCAN_STATS_MAX_CHECKS];
+static atomic_uint_fast64_t checks_passed;
+static atomic_uint_fast64_t checks_failed;
+static atomic_uint_fast64_t arena_allocations;
+static atomic_uint_fast64_t arena_blocks;
+static atomic_uint_fast64_t arena_peak_bytes;
+
+// Read time of the calling thread, excluded from the spans around it
+static _Thread_local uint64_t thread_read_ns;
+
+static const char *const stage_names[SCAN_STAGE_COUNT] = {
+    "read", "cache", "parse", "index", "scan", "report"
+};
+
+static const char *const type_names[STATS_TYPE_COUNT] = {
+    "other", "markdown", "json", "pdf", "yaml", "text"
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t load(atomic_uint_fast64_t *counter) {
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+static void add(atomic_uint_fast64_t *counter, uint64_t value) {
+    atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
+
+const char* scan_stage_name(scan_stage_t stage) {
+    return stage < SCAN_STAGE_COUNT ? stage_names[stage] : "unknown";
+}
+
+void scan_stats_enable(void) {
+    atomic_store(&stats_enabled, 1);
+}
+
+int scan_stats_enabled(void) {
+    return atomic_load_explicit(&stats_enabled, memory_order_relaxed);
+}
+
+// ==================== Recording ====================
+
+scan_span_t scan_stats_begin(void) {
+    scan_span_t span = { 0, 0 };
+    if (scan_stats_enabled()) {
+        span.start_ns = monotonic_ns();
+        span.read_ns = thread_read_ns;
+    }
+    return span;
+}
+
+void scan_stats_end(scan_span_t span, scan_stage_t stage, file_type_t type, uint64_t bytes) {
+    if (span.start_ns == 0 || stage >= SCAN_STAGE_COUNT) return;
+
+    uint64_t elapsed = monotonic_ns() - span.start_ns;
+    if (stage == SCAN_STAGE_READ) {
+        thread_read_ns += elapsed;
+    } else {
+        uint64_t nested_read = thread_read_ns - span.read_ns;
+        elapsed = elapsed > nested_read ? elapsed - nested_read : 0;
+    }
+
+    stage_counter_t *counter = &stage_counters[stage][(unsigned)type < STATS_TYPE_COUNT ? type : 0];
+    add(&counter->operations, 1);
+    add(&counter->bytes, bytes);
+    add(&counter->ns, elapsed);
+}
+
+void scan_stats_count_checks(const scan_result_t *result) {
+    if (!result || !scan_stats_enabled()) return;
+
+    add(&checks_passed, result->passed_count);
+    add(&checks_failed, result->failed_count);
+
+    size_t count = result->result_count < SCAN_STATS_MAX_CHECKS
+                   ? result->result_count : SCAN_STATS_MAX_CHECKS;
+    for (size_t i = 0; i < count; i++) {
+        check_counter_t *check = &check_counters[i];
+        const char *expected = NULL;
+        if (!atomic_load_explicit(&check->control_id, memory_order_relaxed)) {
+            atomic_compare_exchange_strong(&check->control_id, &expected,
+                                           result->results[i].control_id);
+        }
+        add(result->results[i].passed ? &check->passed : &check->failed, 1);
+    }
+}
+
+void scan_stats_add_arena(const arena_t *arena) {
+    if (!arena || !scan_stats_enabled()) return;
+
+    add(&arena_allocations, arena->allocations);
+    add(&arena_blocks, arena->blocks_created);
+
+    uint64_t peak = load(&arena_peak_bytes);
+    while (arena->peak_bytes > peak &&
+           !atomic_compare_exchange_weak(&arena_peak_bytes, &peak, arena->peak_bytes)) {
+    }
+}
+
+// ==================== Output ====================
+
+static double megabytes_per_second(uint64_t bytes, uint64_t ns) {
+    return ns > 0 ? (double)bytes / (1024.0 * 1024.0) / ((double)ns / 1e9) : 0.0;
+}
+
+void scan_stats_print(FILE *output, double elapsed_seconds) {
+    fprintf(output, "\nPipeline statistics (%.3f s elapsed; stage times are summed over threads)\n\n",
+            elapsed_seconds);
+    fprintf(output, "  %-8s %-9s %10s %14s %11s %10s\n",
+            "Stage", "Format", "Ops", "Bytes", "Time (s)", "MB/s");
+
+    for (int stage = 0; stage < SCAN_STAGE_COUNT; stage++) {
+        for (int type = 0; type < STATS_TYPE_COUNT; type++) {
+            stage_counter_t *counter = &stage_counters[stage][type];
+            uint64_t operations = load(&counter->operations);
+            if (operations == 0) continue;
+
+            uint64_t bytes = load(&counter->bytes);
+            uint64_t ns = load(&counter->ns);
+            fprintf(output, "  %-8s %-9s %10llu %14llu %11.3f %10.1f\n",
+                    stage_names[stage], type_names[type], (unsigned long long)operations,
+                    (unsigned long long)bytes, (double)ns / 1e9,
+                    megabytes_per_second(bytes, ns));
+        }
+    }
+
+    uint64_t passed = load(&checks_passed);
+    uint64_t failed = load(&checks_failed);
+    if (passed + failed > 0) {
+        fprintf(output, "\n  %-28s %10s %10s\n", "Check", "Passed", "Failed");
+        for (int i = 0; i < SCAN_STATS_MAX_CHECKS; i++) {
+            const char *control_id = atomic_load(&check_counters[i].control_id);
+            if (!control_id) break;
+            fprintf(output, "  %-28s %10llu %10llu\n", control_id,
+                    (unsigned long long)load(&check_counters[i].passed),
+                    (unsigned long long)load(&check_counters[i].failed));
+        }
+        fprintf(output, "  %-28s %10llu %10llu\n", "(all checks)",
+                (unsigned long long)passed, (unsigned long long)failed);
+    }
+
+    fprintf(output, "\n  Arena allocations: %llu in %llu blocks, peak %.1f KB per arena\n",
+            (unsigned long long)load(&arena_allocations),
+            (unsigned long long)load(&arena_blocks),
+            (double)load(&arena_peak_bytes) / 1024.0);
+}
+
+// Label value with backslash, quote and newline escaped
+static void write_label(FILE *output, const char *value) {
+    for (const char *p = value; *p; p++) {
+        switch (*p) {
+            case '\\': fputs("\\\\", output); break;
+            case '"':  fputs("\\\"", output); break;
+            case '\n': fputs("\\n", output); break;
+            default:   fputc(*p, output); break;
+        }
+    }
+}
+
+static void write_header(FILE *output, const char *name, const char *help) {
+    fprintf(output, "# HELP %s %s\n# TYPE %s gauge\n", name, help, name);
+}
+
+// One series per stage and format that saw any work
+static void write_stage_metric(FILE *output, const char *name, const char *help, int field) {
+    write_header(output, name, help);
+    for (int stage = 0; stage < SCAN_STAGE_COUNT; stage++) {
+        for (int type = 0; type < STATS_TYPE_COUNT; type++) {
+            stage_counter_t *counter = &stage_counters[stage][type];
+            if (load(&counter->operations) == 0) continue;
+
+            fprintf(output, "%s{stage=\"%s\",format=\"%s\"} ", name, stage_names[stage],
+                    type_names[type]);
+            switch (field) {
+                case 0:  fprintf(output, "%.9f\n", (double)load(&counter->ns) / 1e9); break;
+                case 1:  fprintf(output, "%llu\n", (unsigned long long)load(&counter->bytes)); break;
+                default: fprintf(output, "%llu\n", (unsigned long long)load(&counter->operations)); break;
+            }
+        }
+    }
+}
+
+int scan_stats_write_prometheus(const char *path, double elapsed_seconds) {
+    // Written beside the target and renamed, so the collector never reads a
+    // partial file (it only picks up *.prom names)
+    char temp_path[4096];
+    int n = snprintf(temp_path, sizeof(temp_path), "%s.%ld.tmp", path, (long)getpid());
+    if (n < 0 || (size_t)n >= sizeof(temp_path)) {
+        errno = ENAMETOOLONG;
+        return 0;
+    }
+
+    FILE *output = fopen(temp_path, "w");
+    if (!output) return 0;
+
+    write_stage_metric(output, "complyd_stage_seconds",
+                       "Time spent in a pipeline stage in the last run, summed over threads.", 0);
+    write_stage_metric(output, "complyd_stage_bytes",
+                       "Bytes processed by a pipeline stage in the last run.", 1);
+    write_stage_metric(output, "complyd_stage_operations",
+                       "Files or reports handled by a pipeline stage in the last run.", 2);
+
+    write_header(output, "complyd_check_results", "Verdicts of a check in the last run.");
+    for (int i = 0; i < SCAN_STATS_MAX_CHECKS; i++) {
+        const char *control_id = atomic_load(&check_counters[i].control_id);
+        if (!control_id) break;
+        for (int failed = 0; failed <= 1; failed++) {
+            fputs("complyd_check_results{control=\"", output);
+            write_label(output, control_id);
+            fprintf(output, "\",result=\"%s\"} %llu\n", failed ? "fail" : "pass",
+                    (unsigned long long)load(failed ? &check_counters[i].failed
+                                                    : &check_counters[i].passed));
+        }
+    }
+
+    write_header(output, "complyd_arena_allocations", "Arena allocations in the last run.");
+    fprintf(output, "complyd_arena_allocations %llu\n", (unsigned long long)load(&arena_allocations));
+    write_header(output, "complyd_arena_blocks", "Blocks allocated by arenas in the last run.");
+    fprintf(output, "complyd_arena_blocks %llu\n", (unsigned long long)load(&arena_blocks));
+    write_header(output, "complyd_arena_peak_bytes", "Largest arena high-water mark in the last run.");
+    fprintf(output, "complyd_arena_peak_bytes %llu\n", (unsigned long long)load(&arena_peak_bytes));
+
+    write_header(output, "complyd_run_seconds", "Wall-clock duration of the last run.");
+    fprintf(output, "complyd_run_seconds %.6f\n", elapsed_seconds);
+    write_header(output, "complyd_last_run_timestamp_seconds", "Unix time the last run finished.");
+    fprintf(output, "complyd_last_run_timestamp_seconds %lld\n", (long long)time(NULL));
+
+    int ok = !ferror(output);
+    if (fclose(output) != 0) ok = 0;
+    if (!ok || rename(temp_path, path) != 0) {
+        int saved = errno;
+        remove(temp_path);
+        errno = saved;
+        return 0;
+    }
+    return 1;
+}
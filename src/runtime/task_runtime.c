@@ -0,0 +1,572 @@
+#define _POSIX_C_SOURCE 200809L
+#include "runtime/task_runtime.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+// Failed find rounds (each followed by sched_yield) before a worker sleeps
+#define SPIN_ROUNDS 64
+
+// Deepest nesting at which a waiting task may still run unrelated tasks;
+// beyond it a waiter only runs tasks spawned at its own depth or deeper, never
+// work queued by an outer level, bounding stack growth
+#define MAX_HELP_DEPTH 8
+
+#define INITIAL_DEQUE_CAPACITY 256
+
+typedef struct {
+    task_fn fn;
+    void *arg;
+    task_group_t *group;
+    int depth;                      // Nesting depth of the spawner
+} task_t;
+
+// Circular task buffer; replaced (never freed while running) when it grows
+typedef struct task_array {
+    int64_t capacity;               // Power of two
+    struct task_array *retired;     // Previous, smaller buffer
+    _Atomic(task_t*) slots[];
+} task_array_t;
+
+// Chase-Lev work-stealing deque
+typedef struct {
+    _Alignas(64) _Atomic int64_t top;       // Stealers take from here
+    _Alignas(64) _Atomic int64_t bottom;    // Owner pushes/pops here
+    _Atomic(task_array_t*) array;
+} task_deque_t;
+
+typedef struct {
+    task_deque_t deque;
+    task_runtime_t *runtime;
+    pthread_t thread;
+    uint32_t rng;                   // xorshift state for victim selection
+    atomic_uint_fast64_t tasks_executed;
+    atomic_uint_fast64_t steals;
+    atomic_uint_fast64_t steal_attempts;
+    atomic_uint_fast64_t busy_ns;
+    atomic_uint_fast64_t idle_ns;
+} task_worker_t;
+
+struct task_runtime {
+    task_worker_t *workers;
+    int worker_count;
+    int threads_started;
+
+    // Tasks spawned from threads that are not workers
+    pthread_mutex_t inject_lock;
+    task_t **inject;
+    size_t inject_head;
+    atomic_size_t inject_count;
+    size_t inject_capacity;
+
+    // Sleeping idle workers
+    pthread_mutex_t sleep_lock;
+    pthread_cond_t wake;
+    atomic_int sleepers;
+    atomic_size_t queued;           // Tasks spawned but not yet taken
+    atomic_int shutdown;
+
+    // Creator thread's previous binding, restored on destroy
+    task_runtime_t *prev_runtime;
+    int prev_worker;
+};
+
+static _Thread_local task_runtime_t *tls_runtime = NULL;
+static _Thread_local int tls_worker = -1;
+static _Thread_local int tls_depth = 0;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// ==================== Deque ====================
+
+static task_array_t* task_array_create(int64_t capacity) {
+    task_array_t *array = calloc(1, sizeof(task_array_t) +
+                                    (size_t)capacity * sizeof(_Atomic(task_t*)));
+    if (!array) return NULL;
+    array->capacity = capacity;
+    return array;
+}
+
+static int deque_init(task_deque_t *deque) {
+    task_array_t *array = task_array_create(INITIAL_DEQUE_CAPACITY);
+    if (!array) return 0;
+
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    atomic_init(&deque->array, array);
+    return 1;
+}
+
+static void deque_destroy(task_deque_t *deque) {
+    task_array_t *array = atomic_load(&deque->array);
+    while (array) {
+        task_array_t *retired = array->retired;
+        free(array);
+        array = retired;
+    }
+}
+
+// Owner only: push a task at the bottom
+static int deque_push(task_deque_t *deque, task_t *task) {
+    int64_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    task_array_t *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+
+    if (b - t > array->capacity - 1) {
+        task_array_t *grown = task_array_create(array->capacity * 2);
+        if (!grown) return 0;
+
+        for (int64_t i = t; i < b; i++) {
+            task_t *moved = atomic_load_explicit(&array->slots[i & (array->capacity - 1)],
+                                                 memory_order_relaxed);
+            atomic_store_explicit(&grown->slots[i & (grown->capacity - 1)], moved,
+                                  memory_order_relaxed);
+        }
+
+        // Stealers may still be reading the old buffer - keep it alive
+        grown->retired = array;
+        atomic_store_explicit(&deque->array, grown, memory_order_release);
+        array = grown;
+    }
+
+    atomic_store_explicit(&array->slots[b & (array->capacity - 1)], task,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    return 1;
+}
+
+// Owner only: pop the most recently pushed task
+static task_t* deque_take(task_deque_t *deque) {
+    int64_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    task_array_t *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    task_t *task = NULL;
+    if (t <= b) {
+        task = atomic_load_explicit(&array->slots[b & (array->capacity - 1)],
+                                    memory_order_relaxed);
+        if (t == b) {
+            // Last task - race against stealers for it
+            if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1,
+                                                         memory_order_seq_cst,
+                                                         memory_order_relaxed)) {
+                task = NULL;
+            }
+            atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    }
+
+    return task;
+}
+
+// Any thread: steal the oldest task from the top
+static task_t* deque_steal(task_deque_t *deque) {
+    int64_t t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if (t >= b) return NULL;
+
+    task_array_t *array = atomic_load_explicit(&deque->array, memory_order_acquire);
+    task_t *task = atomic_load_explicit(&array->slots[t & (array->capacity - 1)],
+                                        memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return NULL;
+    }
+
+    return task;
+}
+
+// ==================== Scheduling ====================
+
+// Wake sleepers if there are any
+static void wake_workers(task_runtime_t *runtime, int all) {
+    if (atomic_load(&runtime->sleepers) == 0) return;
+
+    pthread_mutex_lock(&runtime->sleep_lock);
+    if (all) {
+        pthread_cond_broadcast(&runtime->wake);
+    } else {
+        pthread_cond_signal(&runtime->wake);
+    }
+    pthread_mutex_unlock(&runtime->sleep_lock);
+}
+
+static int inject_push(task_runtime_t *runtime, task_t *task) {
+    pthread_mutex_lock(&runtime->inject_lock);
+
+    size_t count = atomic_load(&runtime->inject_count);
+    if (count == runtime->inject_capacity) {
+        size_t new_capacity = runtime->inject_capacity ? runtime->inject_capacity * 2 : 64;
+        task_t **grown = malloc(new_capacity * sizeof(task_t*));
+        if (!grown) {
+            pthread_mutex_unlock(&runtime->inject_lock);
+            return 0;
+        }
+        for (size_t i = 0; i < count; i++) {
+            grown[i] = runtime->inject[(runtime->inject_head + i) % runtime->inject_capacity];
+        }
+        free(runtime->inject);
+        runtime->inject = grown;
+        runtime->inject_head = 0;
+        runtime->inject_capacity = new_capacity;
+    }
+
+    size_t slot = (runtime->inject_head + count) % runtime->inject_capacity;
+    runtime->inject[slot] = task;
+    atomic_store(&runtime->inject_count, count + 1);
+
+    pthread_mutex_unlock(&runtime->inject_lock);
+    return 1;
+}
+
+static task_t* inject_pop(task_runtime_t *runtime) {
+    task_t *task = NULL;
+
+    pthread_mutex_lock(&runtime->inject_lock);
+    if (atomic_load(&runtime->inject_count) > 0) {
+        task = runtime->inject[runtime->inject_head];
+        runtime->inject_head = (runtime->inject_head + 1) % runtime->inject_capacity;
+        atomic_fetch_sub(&runtime->inject_count, 1);
+    }
+    pthread_mutex_unlock(&runtime->inject_lock);
+
+    return task;
+}
+
+// Own deque first, then tasks from outside threads, then steal
+static task_t* find_task(task_runtime_t *runtime, int self) {
+    task_t *task = NULL;
+
+    if (self >= 0) {
+        task = deque_take(&runtime->workers[self].deque);
+    }
+    if (!task && atomic_load_explicit(&runtime->inject_count, memory_order_relaxed) > 0) {
+        task = inject_pop(runtime);
+    }
+
+    if (!task && runtime->worker_count > 1) {
+        uint32_t start = 0;
+        if (self >= 0) {
+            uint32_t x = runtime->workers[self].rng;
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            runtime->workers[self].rng = x;
+            start = x;
+        }
+        for (int i = 0; i < runtime->worker_count && !task; i++) {
+            int victim = (int)((start + (uint32_t)i) % (uint32_t)runtime->worker_count);
+            if (victim == self) continue;
+            if (atomic_load_explicit(&runtime->workers[victim].deque.top, memory_order_relaxed) >=
+                atomic_load_explicit(&runtime->workers[victim].deque.bottom, memory_order_relaxed)) {
+                continue;
+            }
+
+            task = deque_steal(&runtime->workers[victim].deque);
+            if (self >= 0) {
+                atomic_fetch_add_explicit(&runtime->workers[self].steal_attempts, 1,
+                                          memory_order_relaxed);
+                if (task) {
+                    atomic_fetch_add_explicit(&runtime->workers[self].steals, 1,
+                                              memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    if (task) {
+        atomic_fetch_sub(&runtime->queued, 1);
+    }
+    return task;
+}
+
+// Execute a task and signal its group
+static void run_task(task_runtime_t *runtime, int self, task_t *task) {
+    int top_level = tls_depth == 0;
+    uint64_t start = top_level ? now_ns() : 0;
+
+    tls_depth++;
+    task->fn(task->arg);
+    tls_depth--;
+
+    if (self >= 0) {
+        task_worker_t *worker = &runtime->workers[self];
+        atomic_fetch_add_explicit(&worker->tasks_executed, 1, memory_order_relaxed);
+        if (top_level) {
+            atomic_fetch_add_explicit(&worker->busy_ns, now_ns() - start, memory_order_relaxed);
+        }
+    }
+
+    task_group_t *group = task->group;
+    free(task);
+
+    if (group && atomic_fetch_sub(&group->pending, 1) == 1) {
+        wake_workers(runtime, 1);
+    }
+}
+
+// Sleep until work is queued, the group completes or the runtime shuts down
+static void idle_sleep(task_runtime_t *runtime, task_group_t *group) {
+    pthread_mutex_lock(&runtime->sleep_lock);
+    atomic_fetch_add(&runtime->sleepers, 1);
+
+    while (!atomic_load(&runtime->shutdown) &&
+           atomic_load(&runtime->queued) == 0 &&
+           !(group && atomic_load(&group->pending) == 0)) {
+        pthread_cond_wait(&runtime->wake, &runtime->sleep_lock);
+    }
+
+    atomic_fetch_sub(&runtime->sleepers, 1);
+    pthread_mutex_unlock(&runtime->sleep_lock);
+}
+
+// Find a task, spinning briefly and then sleeping while there is none
+// Returns NULL on shutdown or once the group (if any) has completed.
+static task_t* wait_for_task(task_runtime_t *runtime, int self, task_group_t *group) {
+    task_t *task = find_task(runtime, self);
+    if (task) return task;
+
+    uint64_t idle_start = now_ns();
+    int spins = 0;
+
+    for (;;) {
+        if (atomic_load(&runtime->shutdown) ||
+            (group && atomic_load(&group->pending) == 0)) {
+            break;
+        }
+
+        task = find_task(runtime, self);
+        if (task) break;
+
+        if (spins++ < SPIN_ROUNDS) {
+            sched_yield();
+        } else {
+            idle_sleep(runtime, group);
+            spins = 0;
+        }
+    }
+
+    if (self >= 0 && tls_depth == 0) {
+        atomic_fetch_add_explicit(&runtime->workers[self].idle_ns, now_ns() - idle_start,
+                                  memory_order_relaxed);
+    }
+    return task;
+}
+
+static void* worker_main(void *arg) {
+    task_worker_t *worker = arg;
+    task_runtime_t *runtime = worker->runtime;
+    int self = (int)(worker - runtime->workers);
+
+    tls_runtime = runtime;
+    tls_worker = self;
+
+    while (!atomic_load(&runtime->shutdown)) {
+        task_t *task = wait_for_task(runtime, self, NULL);
+        if (task) {
+            run_task(runtime, self, task);
+        }
+    }
+
+    return NULL;
+}
+
+// ==================== Public API ====================
+
+// Create a runtime with worker_count workers; the caller is worker 0
+task_runtime_t* task_runtime_create(int worker_count) {
+    if (worker_count < 1) worker_count = 1;
+
+    task_runtime_t *runtime = calloc(1, sizeof(task_runtime_t));
+    if (!runtime) return NULL;
+
+    runtime->workers = calloc((size_t)worker_count, sizeof(task_worker_t));
+    if (!runtime->workers) {
+        free(runtime);
+        return NULL;
+    }
+
+    runtime->worker_count = worker_count;
+    for (int i = 0; i < worker_count; i++) {
+        if (!deque_init(&runtime->workers[i].deque)) {
+            for (int j = 0; j < i; j++) deque_destroy(&runtime->workers[j].deque);
+            free(runtime->workers);
+            free(runtime);
+            return NULL;
+        }
+        runtime->workers[i].runtime = runtime;
+        runtime->workers[i].rng = 0x9e3779b9u * (uint32_t)(i + 1);
+    }
+
+    pthread_mutex_init(&runtime->inject_lock, NULL);
+    pthread_mutex_init(&runtime->sleep_lock, NULL);
+    pthread_cond_init(&runtime->wake, NULL);
+    atomic_init(&runtime->sleepers, 0);
+    atomic_init(&runtime->queued, 0);
+    atomic_init(&runtime->shutdown, 0);
+    atomic_init(&runtime->inject_count, 0);
+
+    runtime->prev_runtime = tls_runtime;
+    runtime->prev_worker = tls_worker;
+    tls_runtime = runtime;
+    tls_worker = 0;
+
+    for (int i = 1; i < worker_count; i++) {
+        if (pthread_create(&runtime->workers[i].thread, NULL, worker_main,
+                           &runtime->workers[i]) != 0) {
+            task_runtime_destroy(runtime);
+            return NULL;
+        }
+        runtime->threads_started++;
+    }
+
+    return runtime;
+}
+
+// Stop all workers and free the runtime (every group must have been waited on)
+void task_runtime_destroy(task_runtime_t *runtime) {
+    if (!runtime) return;
+
+    atomic_store(&runtime->shutdown, 1);
+    pthread_mutex_lock(&runtime->sleep_lock);
+    pthread_cond_broadcast(&runtime->wake);
+    pthread_mutex_unlock(&runtime->sleep_lock);
+
+    for (int i = 1; i <= runtime->threads_started; i++) {
+        pthread_join(runtime->workers[i].thread, NULL);
+    }
+
+    for (int i = 0; i < runtime->worker_count; i++) {
+        deque_destroy(&runtime->workers[i].deque);
+    }
+
+    if (tls_runtime == runtime) {
+        tls_runtime = runtime->prev_runtime;
+        tls_worker = runtime->prev_worker;
+    }
+
+    pthread_mutex_destroy(&runtime->inject_lock);
+    pthread_mutex_destroy(&runtime->sleep_lock);
+    pthread_cond_destroy(&runtime->wake);
+    free(runtime->inject);
+    free(runtime->workers);
+    free(runtime);
+}
+
+int task_runtime_worker_count(const task_runtime_t *runtime) {
+    return runtime ? runtime->worker_count : 0;
+}
+
+void task_group_init(task_group_t *group) {
+    if (!group) return;
+    atomic_init(&group->pending, 0);
+}
+
+// Queue a task; it runs inline if it cannot be queued
+int task_runtime_spawn(task_runtime_t *runtime, task_group_t *group, task_fn fn, void *arg) {
+    if (!runtime || !fn) return 0;
+
+    task_t *task = malloc(sizeof(task_t));
+    if (!task) {
+        fn(arg);
+        return 1;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    task->group = group;
+    task->depth = tls_depth;
+
+    if (group) {
+        atomic_fetch_add(&group->pending, 1);
+    }
+    atomic_fetch_add(&runtime->queued, 1);
+
+    int queued;
+    if (tls_runtime == runtime && tls_worker >= 0) {
+        queued = deque_push(&runtime->workers[tls_worker].deque, task);
+    } else {
+        queued = inject_push(runtime, task);
+    }
+
+    if (!queued) {
+        atomic_fetch_sub(&runtime->queued, 1);
+        run_task(runtime, tls_runtime == runtime ? tls_worker : -1, task);
+        return 1;
+    }
+
+    wake_workers(runtime, 0);
+    return 1;
+}
+
+// Run tasks until every task in the group has completed
+void task_group_wait(task_runtime_t *runtime, task_group_t *group) {
+    if (!runtime || !group) return;
+
+    int self = tls_runtime == runtime ? tls_worker : -1;
+
+    while (atomic_load(&group->pending) > 0) {
+        task_t *task;
+
+        if (tls_depth >= MAX_HELP_DEPTH) {
+            // Too deeply nested to pick up unrelated work - only run tasks
+            // spawned at this depth or deeper, otherwise wait for thieves to
+            // finish our children. Everything newer than them on our deque
+            // was spawned at this depth or deeper, so a task of an outer
+            // level at the bottom means none of ours is left here; it goes
+            // back into the slot it just left (the push cannot fail).
+            task = self >= 0 ? deque_take(&runtime->workers[self].deque) : NULL;
+            if (task && task->depth < tls_depth &&
+                deque_push(&runtime->workers[self].deque, task)) {
+                task = NULL;
+            }
+            if (task) {
+                atomic_fetch_sub(&runtime->queued, 1);
+            } else {
+                sched_yield();
+                continue;
+            }
+        } else {
+            task = wait_for_task(runtime, self, group);
+            if (!task) continue;
+        }
+
+        run_task(runtime, self, task);
+    }
+}
+
+task_runtime_t* task_runtime_current(void) {
+    return tls_runtime;
+}
+
+int task_runtime_current_worker(void) {
+    return tls_runtime ? tls_worker : -1;
+}
+
+// Snapshot of one worker's counters
+void task_runtime_worker_stats(const task_runtime_t *runtime, int worker,
+                               task_worker_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!runtime || worker < 0 || worker >= runtime->worker_count) return;
+
+    task_worker_t *w = &runtime->workers[worker];
+    stats->tasks_executed = atomic_load_explicit(&w->tasks_executed, memory_order_relaxed);
+    stats->steals = atomic_load_explicit(&w->steals, memory_order_relaxed);
+    stats->steal_attempts = atomic_load_explicit(&w->steal_attempts, memory_order_relaxed);
+    stats->busy_seconds = (double)atomic_load_explicit(&w->busy_ns, memory_order_relaxed) / 1e9;
+    stats->idle_seconds = (double)atomic_load_explicit(&w->idle_ns, memory_order_relaxed) / 1e9;
+}
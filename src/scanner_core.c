@@ -2,90 +2,304 @@
 #include "grc_scanner.h"
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <stdio.h>
+#include <ctype.h>
 
-// Load configuration from file (basic implementation)
+// ==================== Line Parsing ====================
+
+static int is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Trim blanks from both ends of [*start, *end)
+static void trim_span(const char **start, const char **end) {
+    while (*start < *end && is_blank(**start)) (*start)++;
+    while (*end > *start && is_blank(*(*end - 1))) (*end)--;
+}
+
+// Remove one pair of matching surrounding quotes
+static void strip_quotes(const char **start, const char **end) {
+    if (*end - *start >= 2 && (**start == '"' || **start == '\'') && *(*end - 1) == **start) {
+        (*start)++;
+        (*end)--;
+    }
+}
+
+// Split one line into key and value, returns 0 if it is not a key/value line
+static int split_line(const char *line, const char *line_end,
+                      const char **key, const char **key_end,
+                      const char **value, const char **value_end) {
+    trim_span(&line, &line_end);
+
+    // YAML list items ("- key: value")
+    while (line_end - line >= 2 && line[0] == '-' && is_blank(line[1])) {
+        line += 2;
+        trim_span(&line, &line_end);
+    }
+
+    if (line == line_end || *line == '#') {
+        return 0;
+    }
+
+    const char *sep = line;
+    while (sep < line_end && *sep != ':' && *sep != '=') sep++;
+    if (sep == line_end) {
+        return 0;
+    }
+
+    *key = line;
+    *key_end = sep;
+    trim_span(key, key_end);
+    strip_quotes(key, key_end);
+    if (*key == *key_end) {
+        return 0;
+    }
+    for (const char *p = *key; p < *key_end; p++) {
+        if (is_blank(*p)) return 0;
+    }
+
+    *value = sep + 1;
+    *value_end = line_end;
+    trim_span(value, value_end);
+
+    // Quoted values end at the closing quote, anything after it (a comment,
+    // a trailing comma) is dropped
+    if (*value < *value_end && (**value == '"' || **value == '\'')) {
+        const char *close = memchr(*value + 1, **value, (size_t)(*value_end - *value - 1));
+        if (close) {
+            (*value)++;
+            *value_end = close;
+            return 1;
+        }
+    }
+
+    // Inline comments ("value  # note")
+    for (const char *p = *value; p + 1 < *value_end; p++) {
+        if (is_blank(*p) && p[1] == '#') {
+            *value_end = p;
+            break;
+        }
+    }
+    if (*value_end > *value && *(*value_end - 1) == ',') {
+        (*value_end)--;
+    }
+    trim_span(value, value_end);
+    return 1;
+}
+
+// ==================== Hash Index ====================
+
+static uint32_t hash_name(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        hash ^= (uint32_t)tolower(*p);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int build_index(config_t *config) {
+    size_t slot_count = 16;
+    while (slot_count < config->count * 2) slot_count *= 2;
+
+    config->slots = config->arena ? arena_calloc(config->arena, slot_count, sizeof(uint32_t))
+                                  : calloc(slot_count, sizeof(uint32_t));
+    if (!config->slots) {
+        return 0;
+    }
+    config->slot_count = slot_count;
+
+    for (size_t i = 0; i < config->count; i++) {
+        config_item_t *item = &config->items[i];
+        size_t slot = hash_name(item->name) & (slot_count - 1);
+
+        while (config->slots[slot] &&
+               strcasecmp(config->items[config->slots[slot] - 1].name, item->name) != 0) {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+
+        // Chain items sharing a name, newest first
+        item->next = config->slots[slot];
+        config->slots[slot] = (uint32_t)(i + 1);
+    }
+
+    return 1;
+}
+
+// Build the key/value index for parsed content
+config_t* config_from_text(const char *text, size_t length, arena_t *arena) {
+    if (!text) return NULL;
+
+    config_t *config = arena ? arena_calloc(arena, 1, sizeof(config_t)) : calloc(1, sizeof(config_t));
+    if (!config) return NULL;
+    config->arena = arena;
+
+    // Every key and value is a piece of a line minus its separator, so the
+    // document size (plus a terminator) bounds the string storage
+    config->capacity = 16;
+    if (arena) {
+        config->strings = arena_alloc(arena, length + 2);
+        config->items = arena_alloc(arena, config->capacity * sizeof(config_item_t));
+    } else {
+        config->strings = malloc(length + 2);
+        config->items = malloc(config->capacity * sizeof(config_item_t));
+    }
+    if (!config->strings || !config->items) {
+        scanner_free_config(config);
+        return NULL;
+    }
+
+    char *out = config->strings;
+    const char *end = text + length;
+    const char *line = text;
+
+    while (line < end) {
+        const char *newline = memchr(line, '\n', (size_t)(end - line));
+        const char *line_end = newline ? newline : end;
+
+        const char *key, *key_end, *value, *value_end;
+        if (split_line(line, line_end, &key, &key_end, &value, &value_end)) {
+            if (config->count == UINT32_MAX - 1) {
+                break;  // Slots hold 32-bit item numbers
+            }
+            if (config->count == config->capacity) {
+                size_t new_capacity = config->capacity * 2;
+                config_item_t *items = arena
+                    ? arena_realloc(arena, config->items, config->capacity * sizeof(config_item_t),
+                                    new_capacity * sizeof(config_item_t))
+                    : realloc(config->items, new_capacity * sizeof(config_item_t));
+                if (!items) {
+                    scanner_free_config(config);
+                    return NULL;
+                }
+                config->items = items;
+                config->capacity = new_capacity;
+            }
+
+            config_item_t *item = &config->items[config->count++];
+            size_t key_len = (size_t)(key_end - key);
+            size_t value_len = (size_t)(value_end - value);
+
+            item->key = out;
+            memcpy(out, key, key_len);
+            out[key_len] = '\0';
+            out += key_len + 1;
+
+            item->value = out;
+            memcpy(out, value, value_len);
+            out[value_len] = '\0';
+            out += value_len + 1;
+
+            const char *dot = strrchr(item->key, '.');
+            item->name = (dot && dot[1]) ? dot + 1 : item->key;
+            item->next = 0;
+        }
+
+        line = line_end + 1;
+    }
+
+    if (!build_index(config)) {
+        scanner_free_config(config);
+        return NULL;
+    }
+
+    return config;
+}
+
+// Look up the items named name
+const config_item_t* config_lookup(const config_t *config, const char *name) {
+    if (!config || !name || !config->slots) return NULL;
+
+    size_t mask = config->slot_count - 1;
+    size_t slot = hash_name(name) & mask;
+
+    while (config->slots[slot]) {
+        const config_item_t *item = &config->items[config->slots[slot] - 1];
+        if (strcasecmp(item->name, name) == 0) {
+            return item;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return NULL;
+}
+
+// Next item with the same name
+const config_item_t* config_next(const config_t *config, const config_item_t *item) {
+    if (!config || !item || !item->next) return NULL;
+    return &config->items[item->next - 1];
+}
+
+// ==================== Files ====================
+
+// Load configuration from file
 config_t* scanner_load_config(const char *filepath) {
     if (!filepath) return NULL;
-    
-    FILE *fp = fopen(filepath, "r");
+
+    FILE *fp = fopen(filepath, "rb");
     if (!fp) return NULL;
-    
-    config_t *config = calloc(1, sizeof(config_t));
-    if (!config) {
-        fclose(fp);
-        return NULL;
-    }
-    
-    config->capacity = 10;
-    config->items = calloc(config->capacity, sizeof(config_item_t));
-    config->count = 0;
-    
-    char line[1024];
-    while (fgets(line, sizeof(line), fp)) {
-        // Skip comments and empty lines
-        if (line[0] == '#' || line[0] == '\n') continue;
-        
-        // Parse key: value
-        char *colon = strchr(line, ':');
-        if (colon) {
-            *colon = '\0';
-            char *key = line;
-            char *value = colon + 1;
-            
-            // Trim whitespace
-            while (*value == ' ') value++;
-            char *end = value + strlen(value) - 1;
-            while (end > value && (*end == '\n' || *end == ' ')) *end-- = '\0';
-            
-            // Add to config
-            if (config->count >= config->capacity) {
-                config->capacity *= 2;
-                config->items = realloc(config->items, 
-                                      config->capacity * sizeof(config_item_t));
+
+    size_t capacity = 4096;
+    size_t length = 0;
+    char *text = malloc(capacity);
+    size_t n;
+
+    while (text && (n = fread(text + length, 1, capacity - length, fp)) > 0) {
+        length += n;
+        if (length == capacity) {
+            char *grown = realloc(text, capacity * 2);
+            if (!grown) {
+                free(text);
+                text = NULL;
+                break;
             }
-            
-            config->items[config->count].key = strdup(key);
-            config->items[config->count].value = strdup(value);
-            config->count++;
+            text = grown;
+            capacity *= 2;
         }
     }
-    
+
+    int failed = !text || ferror(fp);
     fclose(fp);
+    if (failed) {
+        free(text);
+        return NULL;
+    }
+
+    config_t *config = config_from_text(text, length, NULL);
+    free(text);
     return config;
 }
 
-// Free configuration
+// Free configuration (arena-backed ones go with their arena)
 void scanner_free_config(config_t *config) {
-    if (!config) return;
-    
-    for (size_t i = 0; i < config->count; i++) {
-        free(config->items[i].key);
-        free(config->items[i].value);
-    }
+    if (!config || config->arena) return;
+
     free(config->items);
+    free(config->strings);
+    free(config->slots);
     free(config);
 }
 
 // Convert config to string
 char* config_to_string(const config_t *config) {
     if (!config) return NULL;
-    
+
     size_t total_size = 0;
     for (size_t i = 0; i < config->count; i++) {
-        total_size += strlen(config->items[i].key) + 
+        total_size += strlen(config->items[i].key) +
                      strlen(config->items[i].value) + 3; // ": \n"
     }
-    
+
     char *result = calloc(total_size + 1, 1);
     if (!result) return NULL;
-    
+
     char *ptr = result;
     for (size_t i = 0; i < config->count; i++) {
-        ptr += sprintf(ptr, "%s: %s\n", 
-                      config->items[i].key, 
+        ptr += sprintf(ptr, "%s: %s\n",
+                      config->items[i].key,
                       config->items[i].value);
     }
-    
+
     return result;
-}
\ No newline at end of file
+}
@@ -0,0 +1,574 @@
+#define _POSIX_C_SOURCE 200809L
+#include "serve/scan_server.h"
+#include "parsers/file_parsers.h"
+#include "runtime/arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define SERVE_READ_BUFFER_SIZE (64 * 1024)
+#define SERVE_LISTEN_BACKLOG 128
+
+typedef struct {
+    const scan_server_options_t *options;
+    int max_connections;
+
+    pthread_mutex_t lock;
+    pthread_cond_t idle;        // Signalled when a connection ends
+    int *client_fds;            // Per connection slot, -1 when free
+    int active;
+
+    // Arenas of finished connections, reused by the next ones
+    arena_t **spare_arenas;
+    int spare_count;
+
+    scan_server_stats_t stats;
+} scan_server_t;
+
+typedef struct {
+    scan_server_t *server;
+    int fd;
+    int slot;
+} connection_t;
+
+// Growable response line
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+} response_t;
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// ==== Responses ====
+
+static int response_reserve(response_t *response, size_t extra) {
+    if (response->length + extra < response->capacity) {
+        return 1;
+    }
+
+    size_t capacity = response->capacity ? response->capacity : 256;
+    while (response->length + extra >= capacity) {
+        capacity *= 2;
+    }
+
+    char *grown = realloc(response->data, capacity);
+    if (!grown) return 0;
+    response->data = grown;
+    response->capacity = capacity;
+    return 1;
+}
+
+static void response_printf(response_t *response, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    int needed = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+
+    if (needed > 0 && response_reserve(response, (size_t)needed + 1)) {
+        vsnprintf(response->data + response->length, (size_t)needed + 1, format, args);
+        response->length += (size_t)needed;
+    }
+    va_end(args);
+}
+
+// Quoted JSON string
+static void response_string(response_t *response, const char *text) {
+    if (!response_reserve(response, strlen(text) * 6 + 3)) return;
+
+    char *out = response->data + response->length;
+    *out++ = '"';
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            *out++ = '\\';
+            *out++ = (char)*p;
+        } else if (*p < 0x20) {
+            out += sprintf(out, "\\u%04x", *p);
+        } else {
+            *out++ = (char)*p;
+        }
+    }
+    *out++ = '"';
+    response->length = (size_t)(out - response->data);
+}
+
+static void response_error(response_t *response, const char *message) {
+    response->length = 0;
+    response_printf(response, "{\"ok\":false,\"error\":");
+    response_string(response, message);
+    response_printf(response, "}");
+}
+
+static void response_verdict(response_t *response, const scan_result_t *result,
+                             int cached, double seconds) {
+    response->length = 0;
+    response_printf(response, "{\"ok\":true,\"pass\":%s,\"score\":%.1f,\"passed\":%zu,"
+                    "\"total\":%zu,\"failed\":[",
+                    scan_result_compliant(result) ? "true" : "false",
+                    scan_result_score(result), result->passed_count, result->result_count);
+
+    int first = 1;
+    for (size_t i = 0; i < result->result_count; i++) {
+        if (!result->results[i].passed) {
+            if (!first) response_printf(response, ",");
+            response_string(response, result->results[i].control_id);
+            first = 0;
+        }
+    }
+
+    response_printf(response, "]");
+
+    // Verdict per framework when several were checked
+    if (result->framework_count > 0) {
+        response_printf(response, ",\"frameworks\":[");
+        for (size_t f = 0; f < result->framework_count; f++) {
+            double score = framework_result_score(&result->frameworks[f]);
+            response_printf(response, f == 0 ? "{\"name\":" : ",{\"name\":");
+            response_string(response, result->frameworks[f].name);
+            response_printf(response, ",\"pass\":%s,\"score\":%.1f}",
+                            score >= COMPLIANCE_THRESHOLD ? "true" : "false", score);
+        }
+        response_printf(response, "]");
+    }
+
+    response_printf(response, ",\"cached\":%s,\"us\":%.0f}",
+                    cached ? "true" : "false", seconds * 1e6);
+}
+
+// ==== Scanning ====
+
+// Scan a file (path set) or in-memory content into a response line
+// Returns 1 if the request was answered with a verdict.
+static int serve_scan(const scan_server_t *server, arena_t *arena, const char *path,
+                      const char *data, size_t length, file_type_t file_type,
+                      response_t *response) {
+    const rule_set_t *framework = server->options->framework;
+    result_cache_t *cache = server->options->cache;
+    double start = monotonic_seconds();
+
+    // Identical content (from any client, or an earlier batch run) needs no parse
+    result_cache_key_t key;
+    int keyed = 0;
+    if (cache) {
+        if (path) {
+            keyed = result_cache_key_file(path, file_type, &key);
+        } else {
+            key.content_hash = result_cache_hash(data, length, 0);
+            key.length = length;
+            key.file_type = (uint32_t)file_type;
+            keyed = 1;
+        }
+    }
+
+    if (keyed) {
+        size_t content_length;
+        scan_result_t *cached = result_cache_lookup(cache, &key, &content_length);
+        if (cached) {
+            response_verdict(response, cached, 1, monotonic_seconds() - start);
+            free_scan_result(cached);
+            return 1;
+        }
+    }
+
+    arena_mark_t mark = arena_mark(arena);
+    parse_result_t *parse_result = path ? parse_file(path, arena)
+                                        : parse_buffer(data, length, file_type, arena);
+
+    if (!parse_result || !parse_result->success) {
+        response_error(response, parse_result && parse_result->error_message
+                                 ? parse_result->error_message : "Unknown error");
+        free_parse_result(parse_result);
+        arena_rewind(arena, mark);
+        return 0;
+    }
+
+    if (file_type_has_index(file_type)) {
+        parse_result_build_index(parse_result);
+    }
+
+    scan_result_t *result = rule_set_scan(framework, parse_result->config,
+                                                 parse_result->content,
+                                                 parse_result->content_length, arena);
+    int ok = result != NULL && !parse_result_truncated(parse_result);
+    if (ok) {
+        if (keyed) {
+            result_cache_store(cache, &key, result, parse_result->content_length);
+        }
+        response_verdict(response, result, 0, monotonic_seconds() - start);
+    } else {
+        response_error(response, result ? FILE_TRUNCATED_ERROR : "Scan failed");
+    }
+
+    free_parse_result(parse_result);
+    arena_rewind(arena, mark);
+    return ok;
+}
+
+// File type named by a DATA request ("json", "md", ...)
+static file_type_t request_file_type(const char *type) {
+    char name[32];
+    snprintf(name, sizeof(name), ".%s", type);
+    file_type_t file_type = detect_file_type(name);
+    return file_type == FILE_TYPE_UNKNOWN ? FILE_TYPE_TEXT : file_type;
+}
+
+// ==== Connections ====
+
+static int send_fully(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+    return 1;
+}
+
+static int send_response(int fd, response_t *response) {
+    if (!response_reserve(response, 1)) return 0;
+    response->data[response->length++] = '\n';
+    return send_fully(fd, response->data, response->length);
+}
+
+// Buffered request input
+typedef struct {
+    char *data;
+    size_t start;               // First unconsumed byte
+    size_t length;              // Bytes read so far
+    size_t capacity;
+} request_buffer_t;
+
+// Read until at least need unconsumed bytes are buffered; 0 on EOF or error
+static int request_fill(int fd, request_buffer_t *input, size_t need) {
+    if (input->start > 0 && input->capacity - input->start < need) {
+        memmove(input->data, input->data + input->start, input->length - input->start);
+        input->length -= input->start;
+        input->start = 0;
+    }
+
+    if (input->capacity - input->start < need + 1) {
+        size_t capacity = input->capacity;
+        while (capacity - input->start < need + 1) {
+            capacity *= 2;
+        }
+        char *grown = realloc(input->data, capacity);
+        if (!grown) return 0;
+        input->data = grown;
+        input->capacity = capacity;
+    }
+
+    while (input->length - input->start < need) {
+        ssize_t n = read(fd, input->data + input->length, input->capacity - input->length - 1);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        input->length += (size_t)n;
+    }
+    return 1;
+}
+
+// Next request line (NUL-terminated in place, without the newline); NULL on
+// EOF, error or an overlong line
+static char* request_line(int fd, request_buffer_t *input) {
+    size_t scanned = 0;
+
+    for (;;) {
+        char *begin = input->data + input->start;
+        size_t available = input->length - input->start;
+        char *newline = memchr(begin + scanned, '\n', available - scanned);
+        if (newline) {
+            *newline = '\0';
+            if (newline > begin && newline[-1] == '\r') newline[-1] = '\0';
+            input->start += (size_t)(newline - begin) + 1;
+            return begin;
+        }
+
+        if (available > SERVE_MAX_LINE_LENGTH) return NULL;
+        scanned = available;
+        if (!request_fill(fd, input, available + 1)) return NULL;
+    }
+}
+
+static arena_t* take_arena(scan_server_t *server) {
+    arena_t *arena = NULL;
+    pthread_mutex_lock(&server->lock);
+    if (server->spare_count > 0) {
+        arena = server->spare_arenas[--server->spare_count];
+    }
+    pthread_mutex_unlock(&server->lock);
+    return arena ? arena : arena_create(0);
+}
+
+static void connection_finish(connection_t *connection, arena_t *arena,
+                              uint64_t requests, uint64_t errors) {
+    scan_server_t *server = connection->server;
+
+    pthread_mutex_lock(&server->lock);
+    if (arena) {
+        arena_reset(arena);
+        server->spare_arenas[server->spare_count++] = arena;
+    }
+    server->client_fds[connection->slot] = -1;
+    server->stats.requests += requests;
+    server->stats.errors += errors;
+    server->active--;
+    pthread_cond_signal(&server->idle);
+    pthread_mutex_unlock(&server->lock);
+
+    close(connection->fd);
+    free(connection);
+}
+
+// Serve the requests of one client until it disconnects
+static void* connection_main(void *arg) {
+    connection_t *connection = arg;
+    scan_server_t *server = connection->server;
+    int fd = connection->fd;
+
+    arena_t *arena = take_arena(server);
+    request_buffer_t input = { malloc(SERVE_READ_BUFFER_SIZE), 0, 0, SERVE_READ_BUFFER_SIZE };
+    response_t response = {0};
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+
+    char *line;
+    while (arena && input.data && (line = request_line(fd, &input)) != NULL) {
+        int ok = 1;
+
+        if (strncmp(line, "SCAN ", 5) == 0) {
+            const char *path = line + 5;
+            ok = serve_scan(server, arena, path, NULL, 0, detect_file_type(path), &response);
+        } else if (strncmp(line, "DATA ", 5) == 0) {
+            char type[16];
+            unsigned long long length;
+            if (sscanf(line + 5, "%15s %llu", type, &length) != 2) {
+                response_error(&response, "Usage: DATA <type> <length>");
+                ok = 0;
+            } else if (length > SERVE_MAX_CONTENT_SIZE) {
+                // The payload cannot be skipped reliably - drop the client
+                response_error(&response, "Content too large");
+                send_response(fd, &response);
+                errors++;
+                requests++;
+                break;
+            } else {
+                file_type_t file_type = request_file_type(type);
+                if (!request_fill(fd, &input, (size_t)length)) break;
+                const char *data = input.data + input.start;
+                input.start += (size_t)length;
+                ok = serve_scan(server, arena, NULL, data, (size_t)length, file_type, &response);
+            }
+        } else if (strcmp(line, "PING") == 0) {
+            response.length = 0;
+            response_printf(&response, "{\"ok\":true}");
+        } else if (strcmp(line, "QUIT") == 0) {
+            break;
+        } else if (line[0] == '\0') {
+            continue;
+        } else {
+            response_error(&response, "Unknown request");
+            ok = 0;
+        }
+
+        requests++;
+        errors += ok ? 0 : 1;
+        if (!send_response(fd, &response)) break;
+    }
+
+    free(input.data);
+    free(response.data);
+    connection_finish(connection, arena, requests, errors);
+    return NULL;
+}
+
+// ==== Listening ====
+
+// Bind to path, replacing the socket file of a server that is gone
+static int bind_socket(int fd, const char *path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return 0;
+    }
+    strcpy(address.sun_path, path);
+
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) == 0) {
+        return 1;
+    }
+    if (errno != EADDRINUSE) return 0;
+
+    struct stat st;
+    if (lstat(path, &st) != 0 || !S_ISSOCK(st.st_mode)) {
+        errno = EADDRINUSE;
+        return 0;
+    }
+
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe < 0) return 0;
+    int live = connect(probe, (struct sockaddr *)&address, sizeof(address)) == 0 ||
+               errno != ECONNREFUSED;
+    close(probe);
+    if (live) {
+        errno = EADDRINUSE;
+        return 0;
+    }
+
+    unlink(path);
+    return bind(fd, (struct sockaddr *)&address, sizeof(address)) == 0;
+}
+
+// Hand a new client to a connection thread
+static void accept_client(scan_server_t *server, int client_fd) {
+    pthread_mutex_lock(&server->lock);
+    int slot = -1;
+    for (int i = 0; i < server->max_connections; i++) {
+        if (server->client_fds[i] < 0) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        server->stats.rejected++;
+        pthread_mutex_unlock(&server->lock);
+        static const char busy[] = "{\"ok\":false,\"error\":\"Too many connections\"}\n";
+        send_fully(client_fd, busy, sizeof(busy) - 1);
+        close(client_fd);
+        return;
+    }
+    server->client_fds[slot] = client_fd;
+    server->active++;
+    server->stats.connections++;
+    pthread_mutex_unlock(&server->lock);
+
+    connection_t *connection = malloc(sizeof(connection_t));
+    pthread_attr_t attr;
+    pthread_t thread;
+    int started = 0;
+    if (connection) {
+        connection->server = server;
+        connection->fd = client_fd;
+        connection->slot = slot;
+
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        started = pthread_create(&thread, &attr, connection_main, connection) == 0;
+        pthread_attr_destroy(&attr);
+    }
+
+    if (!started) {
+        pthread_mutex_lock(&server->lock);
+        server->client_fds[slot] = -1;
+        server->active--;
+        server->stats.rejected++;
+        pthread_mutex_unlock(&server->lock);
+        free(connection);
+        close(client_fd);
+    }
+}
+
+int scan_server_run(const scan_server_options_t *options, scan_server_stats_t *stats) {
+    if (!options || !options->socket_path) {
+        errno = EINVAL;
+        return 0;
+    }
+
+    scan_server_t server;
+    memset(&server, 0, sizeof(server));
+    server.options = options;
+    server.max_connections = options->max_connections > 0 ? options->max_connections
+                                                           : SERVE_DEFAULT_MAX_CONNECTIONS;
+    server.client_fds = malloc((size_t)server.max_connections * sizeof(int));
+    server.spare_arenas = calloc((size_t)server.max_connections, sizeof(arena_t*));
+    if (!server.client_fds || !server.spare_arenas) {
+        free(server.client_fds);
+        free(server.spare_arenas);
+        errno = ENOMEM;
+        return 0;
+    }
+    for (int i = 0; i < server.max_connections; i++) {
+        server.client_fds[i] = -1;
+    }
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 || !bind_socket(listen_fd, options->socket_path) ||
+        listen(listen_fd, SERVE_LISTEN_BACKLOG) != 0) {
+        int saved_errno = errno;
+        if (listen_fd >= 0) close(listen_fd);
+        free(server.client_fds);
+        free(server.spare_arenas);
+        errno = saved_errno;
+        return 0;
+    }
+
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.idle, NULL);
+
+    // Stop signals must interrupt the accept loop, not a connection thread
+    sigset_t blocked, previous;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+
+    while (!options->stop || !*options->stop) {
+        struct pollfd poll_fd = { .fd = listen_fd, .events = POLLIN, .revents = 0 };
+        int ready = poll(&poll_fd, 1, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        int client_fd = accept(listen_fd, NULL, NULL);
+        if (client_fd < 0) continue;
+
+        pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+        accept_client(&server, client_fd);
+        pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    }
+
+    close(listen_fd);
+    unlink(options->socket_path);
+
+    // Wake connection threads blocked in read() and wait for them
+    pthread_mutex_lock(&server.lock);
+    for (int i = 0; i < server.max_connections; i++) {
+        if (server.client_fds[i] >= 0) {
+            shutdown(server.client_fds[i], SHUT_RDWR);
+        }
+    }
+    while (server.active > 0) {
+        pthread_cond_wait(&server.idle, &server.lock);
+    }
+    pthread_mutex_unlock(&server.lock);
+
+    for (int i = 0; i < server.spare_count; i++) {
+        arena_destroy(server.spare_arenas[i]);
+    }
+    if (stats) {
+        *stats = server.stats;
+    }
+
+    pthread_cond_destroy(&server.idle);
+    pthread_mutex_destroy(&server.lock);
+    free(server.client_fds);
+    free(server.spare_arenas);
+    return 1;
+}
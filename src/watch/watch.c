@@ -0,0 +1,540 @@
+#define _POSIX_C_SOURCE 200809L
+#include "watch/watch.h"
+#include "parsers/archive_reader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <libgen.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+
+// Events that can change what a directory contains
+#define WATCH_DIR_EVENTS (IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | \
+                          IN_MOVED_TO | IN_ATTRIB)
+
+#define WATCH_EVENT_BUFFER_SIZE (64 * 1024)
+
+// A watched directory
+typedef struct {
+    int wd;
+    char *path;
+    int recursive;              // 0 = only watched for explicitly named files
+} watch_dir_t;
+
+// A file named on the command line, seen through its directory's watch
+typedef struct {
+    int wd;
+    char *name;                 // Entry name within the directory
+    char *path;                 // Path as given (and as stored in the batch)
+} watch_file_t;
+
+typedef struct {
+    int fd;
+    batch_t *batch;
+    const watch_options_t *options;
+
+    watch_dir_t *dirs;
+    size_t dir_count;
+    size_t dir_capacity;
+
+    watch_file_t *files;
+    size_t file_count;
+
+    // Paths changed since the last rescan
+    char **pending;
+    size_t pending_count;
+    size_t pending_capacity;
+    double first_change;
+    double last_change;
+} watcher_t;
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static char* join_path(const char *dir, const char *name) {
+    size_t dir_len = strlen(dir);
+    const char *separator = dir_len > 0 && dir[dir_len - 1] == '/' ? "" : "/";
+    size_t length = dir_len + strlen(separator) + strlen(name) + 1;
+
+    char *path = malloc(length);
+    if (path) {
+        snprintf(path, length, "%s%s%s", dir, separator, name);
+    }
+    return path;
+}
+
+// 1 if path is dir itself or lies below it
+static int path_is_under(const char *path, const char *dir) {
+    size_t dir_len = strlen(dir);
+    if (strncmp(path, dir, dir_len) != 0) return 0;
+    return path[dir_len] == '\0' || path[dir_len] == '/' ||
+           (dir_len > 0 && dir[dir_len - 1] == '/') ||
+           archive_member_prefix(path) == dir_len;   // Member of the archive dir
+}
+
+// Archive a record belongs to: its own path for an archive, the part before
+// "!/" for an archive member; 0 for other files
+static size_t archive_length(const char *path) {
+    size_t length = archive_member_prefix(path);
+    if (length == 0 && archive_format_of(path) != ARCHIVE_NONE) {
+        length = strlen(path);
+    }
+    return length;
+}
+
+// Whether the file behind a record still exists; members live as long as
+// their archive does
+static int record_on_disk(const char *path) {
+    size_t length = archive_member_prefix(path);
+    char *file = length ? strndup(path, length) : NULL;
+    struct stat st;
+    int exists = stat(file ? file : path, &st) == 0;
+    free(file);
+    return exists;
+}
+
+// ==== Watch descriptors ====
+
+static watch_dir_t* find_dir(watcher_t *watcher, int wd) {
+    for (size_t i = 0; i < watcher->dir_count; i++) {
+        if (watcher->dirs[i].wd == wd) {
+            return &watcher->dirs[i];
+        }
+    }
+    return NULL;
+}
+
+static watch_dir_t* add_dir_watch(watcher_t *watcher, const char *path, int recursive) {
+    int wd = inotify_add_watch(watcher->fd, path, WATCH_DIR_EVENTS | IN_ONLYDIR);
+    if (wd < 0) return NULL;
+
+    // A directory moved within the tree keeps its watch under a new name
+    watch_dir_t *dir = find_dir(watcher, wd);
+    if (dir) {
+        if (strcmp(dir->path, path) != 0) {
+            char *copy = strdup(path);
+            if (!copy) return NULL;
+            free(dir->path);
+            dir->path = copy;
+        }
+        dir->recursive |= recursive;
+        return dir;
+    }
+
+    if (watcher->dir_count >= watcher->dir_capacity) {
+        size_t new_capacity = watcher->dir_capacity ? watcher->dir_capacity * 2 : 16;
+        watch_dir_t *grown = realloc(watcher->dirs, new_capacity * sizeof(watch_dir_t));
+        if (!grown) return NULL;
+        watcher->dirs = grown;
+        watcher->dir_capacity = new_capacity;
+    }
+
+    dir = &watcher->dirs[watcher->dir_count];
+    dir->path = strdup(path);
+    if (!dir->path) return NULL;
+    dir->wd = wd;
+    dir->recursive = recursive;
+    watcher->dir_count++;
+    return dir;
+}
+
+// Watch a directory and everything below it (hidden entries are skipped,
+// as in batch_add_path)
+static int watch_tree(watcher_t *watcher, const char *path) {
+    if (!add_dir_watch(watcher, path, 1)) return 0;
+
+    DIR *dir = opendir(path);
+    if (!dir) return 0;
+
+    int ok = 1;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+
+        char *child = join_path(path, entry->d_name);
+        if (!child) {
+            ok = 0;
+            break;
+        }
+
+        struct stat st;
+        if (stat(child, &st) == 0 && S_ISDIR(st.st_mode)) {
+            ok &= watch_tree(watcher, child);
+        }
+        free(child);
+    }
+
+    closedir(dir);
+    return ok;
+}
+
+// Watch one file through its directory
+static int watch_single_file(watcher_t *watcher, const char *path) {
+    char *dir_copy = strdup(path);
+    char *name_copy = strdup(path);
+    if (!dir_copy || !name_copy) {
+        free(dir_copy);
+        free(name_copy);
+        return 0;
+    }
+
+    watch_dir_t *dir = add_dir_watch(watcher, dirname(dir_copy), 0);
+    watch_file_t *grown = dir ? realloc(watcher->files,
+                                        (watcher->file_count + 1) * sizeof(watch_file_t))
+                              : NULL;
+    if (!grown) {
+        free(dir_copy);
+        free(name_copy);
+        return 0;
+    }
+    watcher->files = grown;
+
+    watch_file_t *file = &watcher->files[watcher->file_count];
+    file->wd = dir->wd;
+    file->name = strdup(basename(name_copy));
+    file->path = strdup(path);
+    free(dir_copy);
+    free(name_copy);
+    if (!file->name || !file->path) {
+        free(file->name);
+        free(file->path);
+        return 0;
+    }
+
+    watcher->file_count++;
+    return 1;
+}
+
+static void forget_dir(watcher_t *watcher, int wd) {
+    for (size_t i = 0; i < watcher->dir_count; i++) {
+        if (watcher->dirs[i].wd == wd) {
+            free(watcher->dirs[i].path);
+            watcher->dirs[i] = watcher->dirs[--watcher->dir_count];
+            return;
+        }
+    }
+}
+
+// ==== Change collection ====
+
+static void add_pending(watcher_t *watcher, const char *path) {
+    for (size_t i = 0; i < watcher->pending_count; i++) {
+        if (strcmp(watcher->pending[i], path) == 0) return;
+    }
+
+    if (watcher->pending_count >= watcher->pending_capacity) {
+        size_t new_capacity = watcher->pending_capacity ? watcher->pending_capacity * 2 : 16;
+        char **grown = realloc(watcher->pending, new_capacity * sizeof(char*));
+        if (!grown) return;
+        watcher->pending = grown;
+        watcher->pending_capacity = new_capacity;
+    }
+
+    char *copy = strdup(path);
+    if (copy) {
+        watcher->pending[watcher->pending_count++] = copy;
+    }
+}
+
+// Returns 1 if the event touched something being watched
+static int handle_event(watcher_t *watcher, const struct inotify_event *event) {
+    if (event->mask & IN_Q_OVERFLOW) {
+        // Events were lost - look at everything again
+        for (size_t i = 0; i < watcher->dir_count; i++) {
+            if (watcher->dirs[i].recursive) {
+                add_pending(watcher, watcher->dirs[i].path);
+            }
+        }
+        for (size_t i = 0; i < watcher->file_count; i++) {
+            add_pending(watcher, watcher->files[i].path);
+        }
+        return 1;
+    }
+
+    if (event->mask & IN_IGNORED) {
+        forget_dir(watcher, event->wd);
+        return 0;
+    }
+
+    watch_dir_t *dir = find_dir(watcher, event->wd);
+    if (!dir || event->len == 0) return 0;
+
+    if (!dir->recursive) {
+        int touched = 0;
+        for (size_t i = 0; i < watcher->file_count; i++) {
+            if (watcher->files[i].wd == event->wd &&
+                strcmp(watcher->files[i].name, event->name) == 0) {
+                add_pending(watcher, watcher->files[i].path);
+                touched = 1;
+            }
+        }
+        return touched;
+    }
+
+    if (event->name[0] == '.') return 0;
+
+    char *path = join_path(dir->path, event->name);
+    if (!path) return 0;
+
+    // Watch new directories right away so files written into them are seen
+    if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+        watch_tree(watcher, path);
+    }
+
+    int touched = (event->mask & IN_ISDIR) ? !(event->mask & IN_ATTRIB)
+                                           : is_supported_file(path) ||
+                                             batch_find_file(watcher->batch, path) != NULL;
+    if (touched) {
+        add_pending(watcher, path);
+    }
+    free(path);
+    return touched;
+}
+
+// ==== Rescanning ====
+
+static int same_verdict(const batch_file_result_t *a, const batch_file_result_t *b) {
+    if (a->parsed != b->parsed) return 0;
+    if (!a->parsed) {
+        return strcmp(a->error_message ? a->error_message : "",
+                      b->error_message ? b->error_message : "") == 0;
+    }
+
+    const scan_result_t *left = a->scan_result;
+    const scan_result_t *right = b->scan_result;
+    if (left->result_count != right->result_count) return 0;
+    for (size_t i = 0; i < left->result_count; i++) {
+        if (left->results[i].passed != right->results[i].passed ||
+            strcmp(left->results[i].control_id, right->results[i].control_id) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int is_named_file(const watcher_t *watcher, const char *path) {
+    for (size_t i = 0; i < watcher->file_count; i++) {
+        if (strcmp(watcher->files[i].path, path) == 0) return 1;
+    }
+    return 0;
+}
+
+// Drop records of files under path that are gone from disk
+static void remove_missing(watcher_t *watcher, const char *path, double elapsed) {
+    batch_t *batch = watcher->batch;
+    const watch_options_t *options = watcher->options;
+
+    size_t i = 0;
+    while (i < batch->file_count) {
+        if (path_is_under(batch->files[i].path, path) &&
+            !record_on_disk(batch->files[i].path)) {
+            if (options->report) {
+                options->report(&batch->files[i], WATCH_FILE_REMOVED, elapsed, options->context);
+            }
+            batch_remove_file(batch, i);
+        } else {
+            i++;
+        }
+    }
+}
+
+// Drop records of rescanned archives that the rescan did not produce again:
+// members deleted from the archive, or its error record once it reads fine
+static void remove_stale_members(watcher_t *watcher, batch_t *updates, char **archives,
+                                 size_t archive_count, double elapsed) {
+    batch_t *batch = watcher->batch;
+    const watch_options_t *options = watcher->options;
+
+    size_t i = 0;
+    while (i < batch->file_count) {
+        const char *path = batch->files[i].path;
+        size_t length = archive_length(path);
+        int stale = 0;
+        for (size_t a = 0; length && a < archive_count && !stale; a++) {
+            stale = strlen(archives[a]) == length && strncmp(archives[a], path, length) == 0 &&
+                    !batch_find_file(updates, path);
+        }
+
+        if (stale) {
+            if (options->report) {
+                options->report(&batch->files[i], WATCH_FILE_REMOVED, elapsed, options->context);
+            }
+            batch_remove_file(batch, i);
+        } else {
+            i++;
+        }
+    }
+}
+
+// Rescan the pending paths and report the verdicts that changed
+static void flush_pending(watcher_t *watcher) {
+    batch_t *batch = watcher->batch;
+    const watch_options_t *options = watcher->options;
+    double elapsed = monotonic_seconds() - watcher->first_change;
+
+    batch_t *updates = batch_create();
+    if (updates) {
+        updates->framework = batch->framework;
+        updates->cache = batch->cache;
+    }
+
+    for (size_t i = 0; i < watcher->pending_count; i++) {
+        const char *path = watcher->pending[i];
+        struct stat st;
+
+        if (stat(path, &st) != 0) {
+            remove_missing(watcher, path, elapsed);
+        } else if (S_ISDIR(st.st_mode)) {
+            remove_missing(watcher, path, elapsed);
+            if (updates) batch_add_path(updates, path);
+        } else if (S_ISREG(st.st_mode) &&
+                   (is_supported_file(path) || is_named_file(watcher, path))) {
+            if (updates) batch_add_path(updates, path);
+        }
+        free(watcher->pending[i]);
+    }
+    watcher->pending_count = 0;
+
+    if (updates && updates->file_count > 0) {
+        int thread_count = options->thread_count > 0 ? options->thread_count : 1;
+        if ((size_t)thread_count > updates->file_count) {
+            thread_count = (int)updates->file_count;
+        }
+
+        // batch_run() replaces archives by their members - remember which
+        // ones were rescanned
+        char **archives = calloc(updates->file_count, sizeof(char*));
+        size_t archive_count = 0;
+        for (size_t i = 0; archives && i < updates->file_count; i++) {
+            if (archive_format_of(updates->files[i].path) != ARCHIVE_NONE) {
+                archives[archive_count] = strdup(updates->files[i].path);
+                if (archives[archive_count]) archive_count++;
+            }
+        }
+
+        batch_run(updates, thread_count);
+        elapsed = monotonic_seconds() - watcher->first_change;
+
+        remove_stale_members(watcher, updates, archives, archive_count, elapsed);
+        for (size_t i = 0; i < archive_count; i++) free(archives[i]);
+        free(archives);
+
+        for (size_t i = 0; i < updates->file_count; i++) {
+            batch_file_result_t *update = &updates->files[i];
+            const batch_file_result_t *previous = batch_find_file(batch, update->path);
+            watch_change_t change = previous ? WATCH_FILE_CHANGED : WATCH_FILE_ADDED;
+            int report = !previous || !same_verdict(previous, update);
+            const char *path = update->path;     // Moves into batch with the record
+
+            if (batch_put_file(batch, update) && report && options->report) {
+                options->report(batch_find_file(batch, path), change, elapsed,
+                                options->context);
+            }
+        }
+    }
+
+    batch_free(updates);
+    batch_tally(batch);
+}
+
+// ==== Event loop ====
+
+int watch_run(batch_t *batch, char **paths, int path_count, const watch_options_t *options) {
+    if (!batch || !paths || !options) {
+        errno = EINVAL;
+        return 0;
+    }
+
+    watcher_t watcher = {0};
+    watcher.batch = batch;
+    watcher.options = options;
+    watcher.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watcher.fd < 0) return 0;
+
+    int ok = 1;
+    for (int i = 0; i < path_count; i++) {
+        struct stat st;
+        if (stat(paths[i], &st) == 0 && S_ISDIR(st.st_mode)) {
+            ok &= watch_tree(&watcher, paths[i]);
+        } else {
+            ok &= watch_single_file(&watcher, paths[i]);
+        }
+    }
+
+    int saved_errno = errno;
+    if (!ok && watcher.dir_count == 0) {
+        close(watcher.fd);
+        free(watcher.files);
+        errno = saved_errno;
+        return 0;
+    }
+
+    double debounce = (options->debounce_ms > 0 ? options->debounce_ms
+                                                : WATCH_DEFAULT_DEBOUNCE_MS) / 1000.0;
+    // Event records are variable length; keep the buffer aligned for them
+    char buffer[WATCH_EVENT_BUFFER_SIZE]
+        __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    while (!options->stop || !*options->stop) {
+        int timeout = -1;
+        if (watcher.pending_count > 0) {
+            double now = monotonic_seconds();
+            double deadline = watcher.last_change + debounce;
+            double latest = watcher.first_change + debounce * WATCH_MAX_DEBOUNCE_PERIODS;
+            if (latest < deadline) deadline = latest;
+            timeout = deadline > now ? (int)((deadline - now) * 1000.0) + 1 : 0;
+        }
+
+        struct pollfd poll_fd = { .fd = watcher.fd, .events = POLLIN, .revents = 0 };
+        int ready = poll(&poll_fd, 1, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (ready == 0) {
+            if (watcher.pending_count > 0) {
+                flush_pending(&watcher);
+            }
+            continue;
+        }
+
+        ssize_t length;
+        while ((length = read(watcher.fd, buffer, sizeof(buffer))) > 0) {
+            for (char *p = buffer; p < buffer + length; ) {
+                const struct inotify_event *event = (const struct inotify_event *)p;
+                int idle = watcher.pending_count == 0;
+                if (handle_event(&watcher, event) && watcher.pending_count > 0) {
+                    double now = monotonic_seconds();
+                    if (idle) watcher.first_change = now;
+                    watcher.last_change = now;
+                }
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+    }
+
+    close(watcher.fd);
+    for (size_t i = 0; i < watcher.dir_count; i++) {
+        free(watcher.dirs[i].path);
+    }
+    for (size_t i = 0; i < watcher.file_count; i++) {
+        free(watcher.files[i].name);
+        free(watcher.files[i].path);
+    }
+    for (size_t i = 0; i < watcher.pending_count; i++) {
+        free(watcher.pending[i]);
+    }
+    free(watcher.dirs);
+    free(watcher.files);
+    free(watcher.pending);
+    return 1;
+}
@@ -17,9 +17,13 @@ BOLD='\033[1m'
 SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
 PROJECT_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
 SCANNER="$PROJECT_ROOT/complyd-scan"
+LIB_EXAMPLE="$PROJECT_ROOT/examples/libcomplyd/scan_files"
 TEST_FIXTURES="$PROJECT_ROOT/tests/fixtures"
 COMPLIANT_DIR="$TEST_FIXTURES/compliant"
 NON_COMPLIANT_DIR="$TEST_FIXTURES/non_compliant"
+RULES_DIR="$TEST_FIXTURES/rules"
+FRAMEWORKS_DIR="$TEST_FIXTURES/frameworks"
+ARCHIVES_DIR="$TEST_FIXTURES/archives"
 
 # Test counters
 TOTAL_TESTS=0
@@ -44,14 +48,18 @@ print_section() {
 run_test() {
     local test_file=$1
     local expected_result=$2  # "pass" or "fail"
+    shift 2                   # Remaining arguments are extra scanner options/paths
     local test_name=$(basename "$test_file")
+    if [ $# -gt 0 ]; then
+        test_name="$test_name $*"
+    fi
     
     TOTAL_TESTS=$((TOTAL_TESTS + 1))
     
     echo -e "${YELLOW}[TEST $TOTAL_TESTS]${NC} Testing: $test_name"
     
     # Run the scanner
-    if $SCANNER "$test_file" > /tmp/scanner_output_$$.txt 2>&1; then
+    if $SCANNER "$test_file" "$@" > /tmp/scanner_output_$$.txt 2>&1; then
         scan_exit_code=0
     else
         scan_exit_code=$?
@@ -81,6 +89,272 @@ run_test() {
     rm -f /tmp/scanner_output_$$.txt
 }
 
+# Run the scanner in watch mode on a copy of the compliant fixtures, break
+# one file and check that the changed verdict is pushed while it runs
+run_watch_test() {
+    TOTAL_TESTS=$((TOTAL_TESTS + 1))
+    
+    echo -e "${YELLOW}[TEST $TOTAL_TESTS]${NC} Testing: --watch (edit a file while watching)"
+    
+    local watch_dir=$(mktemp -d)
+    local output=/tmp/scanner_output_$$.txt
+    cp "$COMPLIANT_DIR"/* "$watch_dir"/
+    
+    $SCANNER --watch --debounce 20 -j 2 "$watch_dir" > "$output" 2>&1 &
+    local watch_pid=$!
+    
+    # Wait for the initial scan, then replace a compliant file
+    for i in $(seq 1 50); do
+        grep -q "Watching" "$output" && break
+        sleep 0.1
+    done
+    echo "encryption: disabled" > "$watch_dir/config-full-compliant.yaml"
+    
+    local updated=0
+    for i in $(seq 1 50); do
+        if grep -q "FAIL.*config-full-compliant.yaml" "$output"; then
+            updated=1
+            break
+        fi
+        sleep 0.1
+    done
+    
+    kill -INT $watch_pid
+    if wait $watch_pid; then
+        scan_exit_code=0
+    else
+        scan_exit_code=$?
+    fi
+    
+    if [ $updated -eq 1 ] && [ $scan_exit_code -ne 0 ]; then
+        echo -e "${GREEN}  ✓ PASSED${NC} - Changed verdict reported while watching (as expected)\n"
+        PASSED_TESTS=$((PASSED_TESTS + 1))
+    else
+        echo -e "${RED}  ✗ FAILED${NC} - Expected an updated FAIL verdict from watch mode\n"
+        FAILED_TESTS=$((FAILED_TESTS + 1))
+        cat "$output"
+    fi
+    
+    rm -rf "$watch_dir" "$output"
+}
+
+# Run the scan daemon and send it a path request and an inline request
+# (python3 is used as the socket client)
+run_serve_test() {
+    TOTAL_TESTS=$((TOTAL_TESTS + 1))
+    
+    echo -e "${YELLOW}[TEST $TOTAL_TESTS]${NC} Testing: --serve (path and inline requests)"
+    
+    local socket_path=$(mktemp -u /tmp/complyd-test-XXXXXX.sock)
+    local output=/tmp/scanner_output_$$.txt
+    
+    $SCANNER --serve "$socket_path" > "$output" 2>&1 &
+    local serve_pid=$!
+    
+    for i in $(seq 1 50); do
+        [ -S "$socket_path" ] && break
+        sleep 0.1
+    done
+    
+    local replies
+    replies=$(python3 - "$socket_path" "$COMPLIANT_DIR/config-full-compliant.yaml" <<'PYTHON'
+import socket, sys
+client = socket.socket(socket.AF_UNIX)
+client.connect(sys.argv[1])
+replies = client.makefile("rb")
+client.sendall(b"SCAN " + sys.argv[2].encode() + b"\n")
+print(replies.readline().decode().strip())
+content = b'{"encryption": {"at_rest": false}}'
+client.sendall(b"DATA json %d\n" % len(content) + content)
+print(replies.readline().decode().strip())
+PYTHON
+) || true
+    
+    kill -INT $serve_pid
+    wait $serve_pid || true
+    
+    if echo "$replies" | head -1 | grep -q '"pass":true' &&
+       echo "$replies" | tail -1 | grep -q '"pass":false' && [ ! -e "$socket_path" ]; then
+        echo -e "${GREEN}  ✓ PASSED${NC} - Daemon answered both requests (as expected)\n"
+        PASSED_TESTS=$((PASSED_TESTS + 1))
+    else
+        echo -e "${RED}  ✗ FAILED${NC} - Expected a passing and a failing verdict from the daemon\n"
+        FAILED_TESTS=$((FAILED_TESTS + 1))
+        echo "$replies"
+        cat "$output"
+    fi
+    
+    rm -f "$output"
+}
+
+# Scan a passing directory and a failing file in a machine-readable format
+# and check that the output parses and agrees with the exit code
+run_format_test() {
+    local format=$1
+    TOTAL_TESTS=$((TOTAL_TESTS + 1))
+    
+    echo -e "${YELLOW}[TEST $TOTAL_TESTS]${NC} Testing: --format $format"
+    
+    local output=/tmp/scanner_output_$$.txt
+    if $SCANNER --format "$format" -j 2 "$COMPLIANT_DIR" "$PROJECT_ROOT/README.md" > "$output" 2>&1; then
+        scan_exit_code=0
+    else
+        scan_exit_code=$?
+    fi
+    
+    if [ $scan_exit_code -ne 0 ] && python3 - "$format" "$output" <<'PYTHON'
+import json, sys
+text = open(sys.argv[2]).read()
+if sys.argv[1] == "ndjson":
+    records = [json.loads(line) for line in text.splitlines()]
+    files = [r for r in records if r["type"] == "file"]
+    summary = records[-1]
+    assert summary["type"] == "summary" and summary["files"] == len(files)
+    assert summary["failed"] == 1 and not summary["pass"]
+else:
+    run = json.loads(text)["runs"][0]
+    assert run["tool"]["driver"]["rules"]
+    assert run["results"] and all(r["locations"][0]["physicalLocation"]["artifactLocation"]["uri"]
+                                  .endswith("README.md") for r in run["results"])
+PYTHON
+    then
+        echo -e "${GREEN}  ✓ PASSED${NC} - Valid $format report of the failing file (as expected)\n"
+        PASSED_TESTS=$((PASSED_TESTS + 1))
+    else
+        echo -e "${RED}  ✗ FAILED${NC} - Expected a valid $format report with one failing file\n"
+        FAILED_TESTS=$((FAILED_TESTS + 1))
+        cat "$output"
+    fi
+    
+    rm -f "$output"
+}
+
+# Scan with --stats-file and check the textfile has stage timings and
+# per-check verdicts, and that --stats leaves stdout alone
+run_stats_test() {
+    TOTAL_TESTS=$((TOTAL_TESTS + 1))
+    
+    echo -e "${YELLOW}[TEST $TOTAL_TESTS]${NC} Testing: --stats --stats-file"
+    
+    local output=/tmp/scanner_output_$$.txt
+    local stats=/tmp/scanner_stats_$$.prom
+    $SCANNER --stats --stats-file "$stats" -j 2 "$COMPLIANT_DIR" > "$output" 2> "$output.err"
+    scan_exit_code=$?
+    
+    if [ $scan_exit_code -eq 0 ] && grep -q 'complyd_stage_seconds{stage="parse",format="yaml"}' "$stats" \
+            && grep -q 'complyd_check_results{control="[^"]*",result="pass"}' "$stats" \
+            && grep -q "Pipeline statistics" "$output.err" && ! grep -q "Pipeline statistics" "$output"; then
+        echo -e "${GREEN}  ✓ PASSED${NC} - Stage timings and check verdicts written (as expected)\n"
+        PASSED_TESTS=$((PASSED_TESTS + 1))
+    else
+        echo -e "${RED}  ✗ FAILED${NC} - Expected a stats table on stderr and a Prometheus textfile\n"
+        FAILED_TESTS=$((FAILED_TESTS + 1))
+        cat "$output" "$output.err" "$stats"
+    fi
+    
+    rm -f "$output" "$output.err" "$stats"
+}
+
+# Scan the fixtures in-process through libcomplyd (examples/libcomplyd) and
+# check every file gets a verdict and a failing file fails
+run_library_test() {
+    TOTAL_TESTS=$((TOTAL_TESTS + 1))
+    
+    echo -e "${YELLOW}[TEST $TOTAL_TESTS]${NC} Testing: complyd_scan_many"
+    
+    local output=/tmp/scanner_output_$$.txt
+    local files=("$COMPLIANT_DIR"/* "$FRAMEWORKS_DIR"/*)
+    local pass_exit_code=0
+    local fail_exit_code=0
+    $LIB_EXAMPLE "${files[@]}" > "$output" 2>&1 || pass_exit_code=$?
+    $LIB_EXAMPLE --framework hipaa,soc2 "$FRAMEWORKS_DIR"/* "$PROJECT_ROOT/README.md" >> "$output" 2>&1 \
+        || fail_exit_code=$?
+    
+    if [ $pass_exit_code -eq 0 ] && [ $fail_exit_code -eq 1 ] \
+            && [ "$(grep -c '^PASS' "$output")" -eq $((${#files[@]} + 1)) ] \
+            && grep -q '^FAIL .*README.md' "$output"; then
+        echo -e "${GREEN}  ✓ PASSED${NC} - Same verdicts through the library (as expected)\n"
+        PASSED_TESTS=$((PASSED_TESTS + 1))
+    else
+        echo -e "${RED}  ✗ FAILED${NC} - Expected every fixture to pass and README.md to fail\n"
+        FAILED_TESTS=$((FAILED_TESTS + 1))
+        cat "$output"
+    fi
+    
+    rm -f "$output"
+}
+
+# Scan the archive fixtures (every compliant fixture in a tar.gz and a zip)
+# and a tarball with one broken member; every member gets its own verdict
+run_archive_test() {
+    TOTAL_TESTS=$((TOTAL_TESTS + 1))
+    
+    echo -e "${YELLOW}[TEST $TOTAL_TESTS]${NC} Testing: tar.gz and zip members"
+    
+    local output=/tmp/scanner_output_$$.txt
+    local archive_dir=$(mktemp -d)
+    local pass_exit_code=0
+    local fail_exit_code=0
+    $SCANNER "$ARCHIVES_DIR" -j 2 --format ndjson > "$output" 2>&1 || pass_exit_code=$?
+    
+    cp "$COMPLIANT_DIR"/config-nested-compliant.json "$archive_dir"/
+    echo "encryption: disabled" > "$archive_dir/broken.yaml"
+    tar czf "$archive_dir/bundle.tgz" -C "$archive_dir" broken.yaml config-nested-compliant.json
+    $SCANNER "$archive_dir/bundle.tgz" --format ndjson >> "$output" 2>&1 || fail_exit_code=$?
+    
+    if [ $pass_exit_code -eq 0 ] && [ $fail_exit_code -eq 1 ] \
+            && [ "$(grep -c '\.tar\.gz!/configs/.*"status":"pass"' "$output")" -eq 5 ] \
+            && [ "$(grep -c '\.zip!/configs/.*"status":"pass"' "$output")" -eq 5 ] \
+            && ! grep -q 'backup' "$output" \
+            && grep -q 'bundle.tgz!/broken.yaml".*"status":"fail"' "$output" \
+            && grep -q 'bundle.tgz!/config-nested-compliant.json".*"status":"pass"' "$output"; then
+        echo -e "${GREEN}  ✓ PASSED${NC} - One verdict per archive member (as expected)\n"
+        PASSED_TESTS=$((PASSED_TESTS + 1))
+    else
+        echo -e "${RED}  ✗ FAILED${NC} - Expected a verdict per member and the broken one to fail\n"
+        FAILED_TESTS=$((FAILED_TESTS + 1))
+        cat "$output"
+    fi
+    
+    rm -rf "$archive_dir"
+    rm -f "$output"
+}
+
+# Scan the same key/value pairs as JSON (answered from the key/value index)
+# and as Markdown (text matcher only); both must fail the same controls
+run_index_case_test() {
+    TOTAL_TESTS=$((TOTAL_TESTS + 1))
+    
+    echo -e "${YELLOW}[TEST $TOTAL_TESTS]${NC} Testing: index and text matcher agree"
+    
+    local output=/tmp/scanner_output_$$.txt
+    local case_dir=$(mktemp -d)
+    local json_failed md_failed
+    local agree=1
+    for pair in "encryption: ENABLED" "Encryption: enabled" "encryption: enabled"; do
+        printf '{"%s": "%s"}\n' "${pair%%: *}" "${pair#*: }" > "$case_dir/pair.json"
+        printf '%s\n' "$pair" > "$case_dir/pair.md"
+        $SCANNER "$case_dir/pair.json" "$case_dir/pair.md" --format ndjson > "$output" 2>&1 || true
+        json_failed=$(grep '"path":"[^"]*pair.json"' "$output" | sed 's/.*"failed"://')
+        md_failed=$(grep '"path":"[^"]*pair.md"' "$output" | sed 's/.*"failed"://')
+        if [ -z "$json_failed" ] || [ "$json_failed" != "$md_failed" ]; then
+            agree=0
+            echo "  $pair: JSON failed $json_failed, Markdown failed $md_failed"
+        fi
+    done
+    
+    if [ $agree -eq 1 ]; then
+        echo -e "${GREEN}  ✓ PASSED${NC} - Same verdict with and without an index (as expected)\n"
+        PASSED_TESTS=$((PASSED_TESTS + 1))
+    else
+        echo -e "${RED}  ✗ FAILED${NC} - Expected JSON and Markdown to fail the same controls\n"
+        FAILED_TESTS=$((FAILED_TESTS + 1))
+    fi
+    
+    rm -rf "$case_dir"
+    rm -f "$output"
+}
+
 # Check if scanner exists
 check_scanner() {
     if [ ! -f "$SCANNER" ]; then
@@ -106,7 +380,7 @@ main() {
     print_section "Testing Compliant Configurations (Expected: 100% compliance)"
     
     if [ -d "$COMPLIANT_DIR" ]; then
-        for test_file in "$COMPLIANT_DIR"/*.json "$COMPLIANT_DIR"/*.md "$COMPLIANT_DIR"/*.yaml; do
+        for test_file in "$COMPLIANT_DIR"/*.json "$COMPLIANT_DIR"/*.md "$COMPLIANT_DIR"/*.yaml "$COMPLIANT_DIR"/*.pdf; do
             if [ -f "$test_file" ]; then
                 run_test "$test_file" "pass"
             fi
@@ -119,7 +393,7 @@ main() {
     print_section "Testing Non-Compliant Configurations (Expected: <80% compliance)"
     
     if [ -d "$NON_COMPLIANT_DIR" ]; then
-        for test_file in "$NON_COMPLIANT_DIR"/*.json "$NON_COMPLIANT_DIR"/*.md "$NON_COMPLIANT_DIR"/*.yaml; do
+        for test_file in "$NON_COMPLIANT_DIR"/*.json "$NON_COMPLIANT_DIR"/*.md "$NON_COMPLIANT_DIR"/*.yaml "$NON_COMPLIANT_DIR"/*.pdf; do
             if [ -f "$test_file" ]; then
                 run_test "$test_file" "fail"
             fi
@@ -128,6 +402,94 @@ main() {
         echo -e "${YELLOW}Warning: Non-compliant test directory not found${NC}"
     fi
     
+    # Test 3: Batch mode (one process, many files, single exit code)
+    print_section "Testing Batch Mode (Expected: aggregated exit code)"
+    
+    if [ -d "$COMPLIANT_DIR" ]; then
+        run_test "$COMPLIANT_DIR" "pass" -j 2
+        run_test "$COMPLIANT_DIR" "fail" -j 2 "$PROJECT_ROOT/README.md"
+    fi
+    
+    # Test 4: Rules loaded from YAML (--rules)
+    print_section "Testing YAML Rule Sets (Expected: same verdicts as built-in checks)"
+    
+    if [ -d "$COMPLIANT_DIR" ]; then
+        run_test "$COMPLIANT_DIR" "pass" -j 2 --rules "$PROJECT_ROOT/examples/rules/hipaa-core.yaml"
+        run_test "$COMPLIANT_DIR/config-full-compliant.yaml" "fail" --rules "$RULES_DIR/org-controls.yaml"
+    fi
+    
+    # Test 5: Result cache (--cache) - the second run is answered from the
+    # cache and must reach the same verdicts; a different rule set misses
+    print_section "Testing Result Cache (Expected: same verdicts from cached results)"
+    
+    if [ -d "$COMPLIANT_DIR" ]; then
+        CACHE_DIR=$(mktemp -d)
+        run_test "$COMPLIANT_DIR" "pass" -j 2 --cache "$CACHE_DIR"
+        run_test "$COMPLIANT_DIR" "pass" -j 2 --cache "$CACHE_DIR"
+        run_test "$COMPLIANT_DIR/config-full-compliant.yaml" "fail" --cache "$CACHE_DIR" \
+            --rules "$RULES_DIR/org-controls.yaml"
+        rm -rf "$CACHE_DIR"
+    fi
+    
+    # Test 6: Watch mode (--watch) - verdicts of edited files are pushed
+    print_section "Testing Watch Mode (Expected: updated verdict after an edit)"
+    
+    if [ -d "$COMPLIANT_DIR" ]; then
+        run_watch_test
+    fi
+    
+    # Test 7: Scan daemon (--serve) - requests over a Unix socket
+    print_section "Testing Scan Daemon (Expected: verdicts over the socket)"
+    
+    if [ -d "$COMPLIANT_DIR" ] && command -v python3 > /dev/null; then
+        run_serve_test
+    fi
+    
+    # Test 8: Machine-readable reports (--format ndjson|sarif)
+    print_section "Testing Report Formats (Expected: parseable NDJSON and SARIF)"
+    
+    if [ -d "$COMPLIANT_DIR" ] && command -v python3 > /dev/null; then
+        run_format_test ndjson
+        run_format_test sarif
+    fi
+    
+    # Test 9: Pipeline statistics (--stats, --stats-file)
+    print_section "Testing Pipeline Statistics (Expected: stage timings and verdicts)"
+    
+    if [ -d "$COMPLIANT_DIR" ]; then
+        run_stats_test
+    fi
+    
+    # Test 10: Several frameworks in one pass (--framework) - a file passes
+    # only when every selected framework does
+    print_section "Testing Multiple Frameworks (Expected: every framework must pass)"
+    
+    if [ -d "$FRAMEWORKS_DIR" ]; then
+        run_test "$FRAMEWORKS_DIR" "pass" --framework hipaa,soc2,pci-dss,iso27001
+        run_test "$COMPLIANT_DIR/config-full-compliant.yaml" "fail" --framework hipaa,soc2
+    fi
+    
+    # Test 11: Embeddable library (libcomplyd) - batch scan of in-memory documents
+    print_section "Testing libcomplyd (Expected: same verdicts in-process)"
+    
+    if [ -x "$LIB_EXAMPLE" ]; then
+        run_library_test
+    else
+        echo -e "${YELLOW}Warning: $LIB_EXAMPLE not built (make lib)${NC}"
+    fi
+    
+    # Test 12: Archives (tar, tar.gz, zip) - members scanned in place
+    print_section "Testing Archives (Expected: a verdict per member)"
+    
+    if [ -d "$ARCHIVES_DIR" ]; then
+        run_archive_test
+    fi
+    
+    # Test 13: Key/value index vs text matcher - case must matter in both
+    print_section "Testing Index Lookups (Expected: same verdict as the text matcher)"
+    
+    run_index_case_test
+    
     # Print summary
     print_section "TEST SUMMARY"
     